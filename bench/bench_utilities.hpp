@@ -0,0 +1,56 @@
+#ifndef __SDFONT_BENCH_UTILITIES_HPP__
+#define __SDFONT_BENCH_UTILITIES_HPP__
+
+#include <chrono>
+#include <functional>
+
+#include <sys/resource.h>
+
+using namespace std;
+
+namespace SDFont {
+
+/** @brief runs func numRuns times.
+ *
+ *  @return the shortest time of a run in seconds.
+ */
+static inline double bestOf( const long numRuns, const function< void() >& func )
+{
+    double best = 0.0;
+
+    for ( long i = 0; i < numRuns; i++ ) {
+
+        const auto startTime = chrono::steady_clock::now();
+
+        func();
+
+        const chrono::duration< double > elapsed = chrono::steady_clock::now() - startTime;
+
+        if ( i == 0 || elapsed.count() < best ) {
+
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+
+/** @return the peak resident set size of the process in megabytes. */
+static inline double peakRSSInMegaBytes()
+{
+    struct rusage usage;
+
+    getrusage( RUSAGE_SELF, &usage );
+
+#ifdef __APPLE__
+    // In bytes.
+    return usage.ru_maxrss / ( 1024.0 * 1024.0 );
+#else
+    // In kilobytes.
+    return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+} // namespace SDFont
+
+#endif /*__SDFONT_BENCH_UTILITIES_HPP__*/
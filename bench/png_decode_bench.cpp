@@ -0,0 +1,193 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <png.h>
+
+#include "sdfont/runtime_helper/texture_loader.hpp"
+#include "bench_utilities.hpp"
+
+using namespace std;
+using namespace SDFont;
+
+/** @brief decode throughput and peak memory of TextureLoader::loadPngImage()
+ *         on a large signed distance texture.
+ *
+ *         Usage: sdfont_bench_png_decode [temporary directory] [-read_png]
+ *
+ *         -read_png decodes with png_read_png() and copies the rows flipped
+ *         into a second buffer instead, as the loader did before it decoded
+ *         row by row, for comparison. The peak RSS is of the process, so the
+ *         two are run separately.
+ */
+
+static const long TextureSize = 8192;
+static const long NumRuns     = 3;
+
+
+/** @brief writes a gray PNG with a circle per 64x64 cell in the signed
+ *         distance, one row at a time.
+ */
+static bool writePng( const string& filePath )
+{
+    FILE* fp = fopen( filePath.c_str(), "wb" );
+
+    if ( fp == nullptr ) {
+        return false;
+    }
+
+    png_structp png  = png_create_write_struct( PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr );
+    png_infop   info = png_create_info_struct( png );
+
+    if ( setjmp( png_jmpbuf( png ) ) ) {
+
+        png_destroy_write_struct( &png, &info );
+        fclose( fp );
+        return false;
+    }
+
+    png_init_io( png, fp );
+    png_set_IHDR( png, info, TextureSize, TextureSize, 8, PNG_COLOR_TYPE_GRAY, PNG_INTERLACE_NONE,
+                  PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT );
+    png_write_info( png, info );
+
+    vector< unsigned char > row( TextureSize );
+
+    for ( long y = 0; y < TextureSize; y++ ) {
+
+        for ( long x = 0; x < TextureSize; x++ ) {
+
+            const float dx   = (float)( x % 64 ) - 31.5f;
+            const float dy   = (float)( y % 64 ) - 31.5f;
+            const float dist = 24.0f - sqrtf( dx * dx + dy * dy );
+
+            row[ x ] = (unsigned char)std::min( 255.0f, std::max( 0.0f, 128.0f + dist * 16.0f ) );
+        }
+        png_write_row( png, row.data() );
+    }
+
+    png_write_end( png, nullptr );
+    png_destroy_write_struct( &png, &info );
+    fclose( fp );
+
+    return true;
+}
+
+
+/** @brief the decoding before the rows were decoded in place. */
+static bool readPngWhole( const string& filePath, unsigned long& width, int& numChannels, unsigned char** data )
+{
+    FILE* fp = fopen( filePath.c_str(), "rb" );
+
+    if ( fp == nullptr ) {
+        return false;
+    }
+
+    png_structp png  = png_create_read_struct( PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr );
+    png_infop   info = png_create_info_struct( png );
+
+    if ( setjmp( png_jmpbuf( png ) ) ) {
+
+        png_destroy_read_struct( &png, &info, nullptr );
+        fclose( fp );
+        return false;
+    }
+
+    png_init_io( png, fp );
+
+    png_read_png( png, info, PNG_TRANSFORM_STRIP_16 | PNG_TRANSFORM_PACKING | PNG_TRANSFORM_EXPAND, nullptr );
+
+    width       = png_get_image_width( png, info );
+    numChannels = png_get_channels( png, info );
+
+    const long height   = png_get_image_height( png, info );
+    const auto rowBytes = png_get_rowbytes( png, info );
+    auto       rows     = png_get_rows( png, info );
+
+    *data = (unsigned char*) malloc( rowBytes * height );
+
+    for ( long i = 0; i < height; i++ ) {
+
+        memcpy( *data + rowBytes * ( height - 1 - i ), rows[i], rowBytes );
+    }
+
+    png_destroy_read_struct( &png, &info, nullptr );
+    fclose( fp );
+
+    return true;
+}
+
+
+int main( int argc, char* argv[] )
+{
+    string directory = ".";
+    bool   readPng   = false;
+
+    for ( int i = 1; i < argc; i++ ) {
+
+        if ( strcmp( argv[i], "-read_png" ) == 0 ) {
+
+            readPng = true;
+        }
+        else {
+            directory = argv[i];
+        }
+    }
+
+    const string filePath = directory + "/sdfont_bench_png_decode.png";
+
+    if ( !writePng( filePath ) ) {
+
+        cerr << "Can not write [" << filePath << "]\n";
+        return 1;
+    }
+
+    const double rssBefore = peakRSSInMegaBytes();
+
+    unsigned long width       = 0;
+    int           numChannels = 0;
+    bool          ok          = true;
+
+    const double seconds = bestOf( NumRuns, [ & ]() {
+
+        unsigned char* pixMap = nullptr;
+
+        if ( readPng ) {
+
+            ok = readPngWhole( filePath, width, numChannels, &pixMap ) && ok;
+        }
+        else {
+            auto allocate = [ &pixMap ]( unsigned long w, unsigned long h, size_t rowBytes ) {
+
+                pixMap = (GLubyte*) malloc( rowBytes * h );
+                return pixMap;
+            };
+            ok = TextureLoader::loadPngImage( filePath, width, numChannels, allocate ) && ok;
+        }
+        free( pixMap );
+    } );
+
+    remove( filePath.c_str() );
+
+    if ( !ok ) {
+
+        cerr << "Can not load [" << filePath << "]\n";
+        return 1;
+    }
+
+    const double megaBytes = (double)( width * width * numChannels ) / ( 1024.0 * 1024.0 );
+
+    cout << fixed << setprecision( 1 );
+    cout << "Decoder:      " << ( readPng ? "png_read_png() and copy" : "TextureLoader::loadPngImage()" ) << "\n";
+    cout << "Image:        " << width << "x" << width << " [" << numChannels << "] channel(s), [" << megaBytes << "] MB\n";
+    cout << "Decode:       " << megaBytes / seconds << " MB/s (best of " << NumRuns << ")\n";
+    cout << "Peak RSS:     " << peakRSSInMegaBytes() << " MB (" << rssBefore << " MB before decoding)\n";
+
+    return 0;
+}
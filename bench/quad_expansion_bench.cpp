@@ -0,0 +1,151 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sdfont/generator/generator.hpp"
+#include "sdfont/runtime_helper/runtime_helper.hpp"
+#include "bench_utilities.hpp"
+
+using namespace std;
+using namespace SDFont;
+
+/** @brief throughput of the vertices and the indices generated from the
+ *         glyphs and the origins by RuntimeHelper::generateOpenGLDrawElements()
+ *         in quads per second, against getBoundingBoxes() followed by
+ *         generateOpenGLDrawElements( bounds, ... ).
+ *
+ *         Usage: sdfont_bench_quad_expansion [FontPath]
+ *
+ *         The glyphs are picked at random from the ASCII atlas generated
+ *         from the font. The fused call is timed with the vertex buffer
+ *         aligned to 32 bytes, with which the streaming stores are used for
+ *         the large arrays, and shifted by a float, with which they are not.
+ */
+
+static const long  NumQuadsPerSize = 1L << 24;
+static const float FontSize        = 40.0f;
+static const float SpreadRatio     = 0.35f;
+static const float Z               = 0.5f;
+
+
+/** @brief the buffer of numFloats aligned to 64 bytes, and one more float
+ *         for the unaligned run.
+ */
+static float* allocateFloats( const size_t numFloats )
+{
+    const size_t bytes = ( ( numFloats + 1 ) * sizeof( float ) + 63 ) / 64 * 64;
+
+    return static_cast< float* >( aligned_alloc( 64, bytes ) );
+}
+
+
+/** @return false if the fused call differs from the two steps. */
+static bool benchSize( const RuntimeHelper& helper, const vector< const Glyph* >& pool, const long numGlyphs )
+{
+    mt19937 rng( 3 );
+
+    vector< const Glyph* > glyphs;
+    vector< Point2D >      origins;
+
+    for ( long i = 0; i < numGlyphs; i++ ) {
+
+        glyphs.push_back( pool[ rng() % pool.size() ] );
+        origins.emplace_back( ( rng() % 100000 ) * 0.37f - 3000.0f, ( rng() % 1000 ) * 1.3f );
+    }
+
+    const size_t numFloats  = numGlyphs * RuntimeHelper::NUM_FLOATS_PER_GLYPH;
+    const size_t numIndices = numGlyphs * RuntimeHelper::NUM_INDICES_PER_GLYPH;
+
+    float* twoSteps = allocateFloats( numFloats );
+    float* fused    = allocateFloats( numFloats );
+
+    vector< unsigned int > indicesTwoSteps( numIndices + 1 );
+    vector< unsigned int > indicesFused   ( numIndices + 1 );
+    vector< GlyphBound >   bounds;
+
+    const long numRuns = std::max( 3L, NumQuadsPerSize / std::max( 1L, numGlyphs ) );
+
+    const double secondsTwoSteps = bestOf( numRuns, [ & ]() {
+
+        helper.getBoundingBoxes( FontSize, SpreadRatio, glyphs, origins, bounds );
+        helper.generateOpenGLDrawElements( bounds, Z, twoSteps, 0, indicesTwoSteps.data() );
+    } );
+
+    const double secondsFused = bestOf( numRuns, [ & ]() {
+
+        helper.generateOpenGLDrawElements( FontSize, SpreadRatio, glyphs, origins, Z,
+                                           fused, 0, indicesFused.data() );
+    } );
+
+    bool same =    memcmp( twoSteps, fused, numFloats * sizeof( float ) ) == 0
+                && indicesTwoSteps == indicesFused;
+
+    const double secondsUnaligned = bestOf( numRuns, [ & ]() {
+
+        helper.generateOpenGLDrawElements( FontSize, SpreadRatio, glyphs, origins, Z,
+                                           fused + 1, 0, indicesFused.data() );
+    } );
+
+    same = same && memcmp( twoSteps, fused + 1, numFloats * sizeof( float ) ) == 0;
+
+    free( twoSteps );
+    free( fused );
+
+    cout << setw( 8 ) << numGlyphs << " glyphs: "
+         << setw( 7 ) << numGlyphs / secondsTwoSteps  / 1.0e6 << " M quads/s (two steps) "
+         << setw( 7 ) << numGlyphs / secondsFused     / 1.0e6 << " M quads/s (fused, aligned) "
+         << setw( 7 ) << numGlyphs / secondsUnaligned / 1.0e6 << " M quads/s (fused, unaligned)\n";
+
+    return same;
+}
+
+
+int main( int argc, char* argv[] )
+{
+    if ( argc < 2 ) {
+
+        cerr << "Usage: sdfont_bench_quad_expansion [FontPath]\n";
+        return 1;
+    }
+
+    GeneratorConfig conf;
+
+    conf.setFontPath( argv[1] );
+    conf.setOutputTextureSize( 512 );
+    conf.setGlyphBitmapSizeForSampling( 64 );
+    conf.addCharCodeRange( 0x20, 0x7E );
+
+    Generator generator( conf, false );
+    FontAtlas atlas;
+
+    if ( !generator.generate() || !generator.generateAtlas( atlas ) ) {
+
+        cerr << "Can not generate the atlas of [" << argv[1] << "]\n";
+        return 1;
+    }
+
+    RuntimeHelper          helper( std::move( atlas ) );
+    vector< const Glyph* > pool;
+
+    for ( const auto& pair : helper.glyphs() ) {
+
+        pool.push_back( &pair.second );
+    }
+
+    cout << fixed << setprecision( 1 );
+
+    for ( const long numGlyphs : { 1000L, 64L * 1024, 1024L * 1024 } ) {
+
+        if ( !benchSize( helper, pool, numGlyphs ) ) {
+
+            cerr << "The fused call differs from the two steps for [" << numGlyphs << "] glyphs.\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sdfont/generator/generator.hpp"
+#include "sdfont/runtime_helper/runtime_helper.hpp"
+#include "sdfont/runtime_helper/software_renderer.hpp"
+#include "bench_utilities.hpp"
+
+using namespace std;
+using namespace SDFont;
+
+/** @brief throughput of SoftwareRenderer::draw() for each effect on a
+ *         1024x768 image filled with lines of text.
+ *
+ *         Usage: sdfont_bench_software_renderer [FontPath] -enable_msdf -num_threads [num]
+ *
+ *         The atlas of the ASCII characters is generated from the font in
+ *         the process. The throughput is given in the pixels of the image,
+ *         and in the pixels covered by the glyph quads, which are the ones
+ *         shaded.
+ */
+
+static const long  ImageWidth  = 1024;
+static const long  ImageHeight = 768;
+static const long  NumRuns     = 20;
+static const float SpreadRatio = 1.0f;
+
+
+/** @brief lines of the printable ASCII characters in the sizes from 14 to
+ *         40 pixels from the top of the image to the bottom.
+ */
+static void layoutLines( const RuntimeHelper& helper, vector< GlyphBound >& bounds )
+{
+    const string       text = "The quick brown fox jumps over the lazy dog. 0123456789 !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~ ";
+    vector< uint32_t > codePoints;
+
+    while ( codePoints.size() < 400 ) {
+
+        for ( auto c : text ) {
+
+            codePoints.push_back( (uint32_t)c );
+        }
+    }
+
+    float baselineY = (float)ImageHeight;
+
+    for ( long line = 0; ; line++ ) {
+
+        const float fontSize = 14.0f + (float)( ( line * 7 ) % 27 );
+
+        baselineY -= fontSize * 1.2f;
+
+        if ( baselineY < fontSize * 0.3f ) {
+
+            break;
+        }
+
+        vector< const Glyph* > glyphs;
+        vector< Point2D >      origins;
+        float                  width, height, aboveBaselineY, belowBaselineY;
+        const float            leftX = 2.0f;
+
+        helper.getGlyphOriginsWidthAndHeight( codePoints, -1, fontSize, 1.0f, leftX, baselineY,
+                                              glyphs, origins, width, height, aboveBaselineY, belowBaselineY );
+
+        // Clipped to the glyphs that start in the image.
+        long numGlyphs = 0;
+
+        while ( numGlyphs < (long)origins.size() && origins[ numGlyphs ].mX < (float)ImageWidth ) {
+
+            numGlyphs++;
+        }
+        glyphs.erase ( glyphs.begin()  + numGlyphs, glyphs.end()  );
+        origins.erase( origins.begin() + numGlyphs, origins.end() );
+
+        vector< GlyphBound > lineBounds;
+
+        helper.getBoundingBoxes( fontSize, SpreadRatio, glyphs, origins, lineBounds );
+
+        bounds.insert( bounds.end(), lineBounds.begin(), lineBounds.end() );
+    }
+}
+
+
+int main( int argc, char* argv[] )
+{
+    string fontPath;
+    bool   multiChannel = false;
+    long   numThreads   = 0;
+
+    for ( int i = 1; i < argc; i++ ) {
+
+        if ( strcmp( argv[i], "-enable_msdf" ) == 0 ) {
+
+            multiChannel = true;
+        }
+        else if ( strcmp( argv[i], "-num_threads" ) == 0 && i + 1 < argc ) {
+
+            numThreads = atol( argv[ ++i ] );
+        }
+        else {
+            fontPath = argv[i];
+        }
+    }
+
+    if ( fontPath.empty() ) {
+
+        cerr << "Usage: sdfont_bench_software_renderer [FontPath] -enable_msdf -num_threads [num]\n";
+        return 1;
+    }
+
+    GeneratorConfig conf;
+
+    conf.setFontPath( fontPath );
+    conf.setOutputTextureSize( 512 );
+    conf.setGlyphBitmapSizeForSampling( 256 );
+    conf.setMultiChannel( multiChannel );
+    conf.addCharCodeRange( 0x20, 0x7E );
+
+    Generator generator( conf, false );
+    FontAtlas atlas;
+
+    if ( !generator.generate() || !generator.generateAtlas( atlas ) ) {
+
+        cerr << "Can not generate the atlas of [" << fontPath << "]\n";
+        return 1;
+    }
+
+    // The helper takes over the atlas.
+    const long        textureSize = atlas.textureSize();
+    const int         numChannels = atlas.numChannels();
+    vector< uint8_t > texture( atlas.pixels(), atlas.pixels() + textureSize * textureSize * numChannels );
+
+    RuntimeHelper        helper( std::move( atlas ) );
+    SoftwareRenderer     renderer( texture.data(), textureSize, numChannels, numThreads );
+    vector< GlyphBound > bounds;
+
+    layoutLines( helper, bounds );
+
+    double coveredPixels = 0.0;
+
+    for ( const auto& b : bounds ) {
+
+        coveredPixels += b.mFrame.mW * b.mFrame.mH;
+    }
+
+    const float baseColor  [3] = { 1.0f, 0.5f, 0.25f };
+    const float borderColor[3] = { 0.0f, 0.2f, 1.0f  };
+
+    vector< uint8_t > image( ImageWidth * ImageHeight * 4, 0 );
+
+    cout << fixed << setprecision( 1 );
+    cout << "Atlas:   " << textureSize << "x" << textureSize
+         << " [" << numChannels << "] channel(s)\n";
+    cout << "Image:   " << ImageWidth << "x" << ImageHeight << ", [" << bounds.size()
+         << "] glyphs covering [" << coveredPixels / 1.0e6 << "] MP\n";
+
+    for ( int effect = 0; effect <= 6; effect++ ) {
+
+        const double seconds = bestOf( NumRuns, [ & ]() {
+
+            renderer.draw( bounds, effect, 0.45f, 0.55f, 0.05f, baseColor, borderColor,
+                           image.data(), ImageWidth, ImageHeight );
+        } );
+
+        cout << "Effect " << effect << ": "
+             << setw( 7 ) << ImageWidth * ImageHeight / seconds / 1.0e6 << " MP/s (image) "
+             << setw( 7 ) << coveredPixels / seconds / 1.0e6 << " MP/s (covered)\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utfcpp/utf8.h"
+
+#include "sdfont/generator/generator.hpp"
+#include "sdfont/runtime_helper/runtime_helper.hpp"
+#include "sdfont/runtime_helper/utf8_decoder.hpp"
+#include "bench_utilities.hpp"
+
+using namespace std;
+using namespace SDFont;
+
+/** @brief decode throughput of UTF8Decoder on the mixed-script and the
+ *         ASCII text, against utf8::utf8to32() into a vector as the callers
+ *         did before the string_view overloads of RuntimeHelper.
+ *
+ *         Usage: sdfont_bench_utf8_decode [FontPath]
+ *
+ *         If the font is given, the atlas of U+0020-U+017F is generated
+ *         from it, and getMetrics() is timed on the text through the vector
+ *         and through the string_view as well. The characters missing from
+ *         the atlas are skipped by the layout in both.
+ */
+
+static const size_t TextSize = 12 * 1024;
+static const long   NumRuns  = 200;
+
+
+/** @brief the sample repeated to at least TextSize bytes. */
+static string repeatText( const string& sample )
+{
+    string text;
+
+    while ( text.size() < TextSize ) {
+
+        text += sample;
+    }
+    return text;
+}
+
+
+/** @return false if the two decoders disagree on the text. */
+static bool benchDecode( const string& name, const string& text )
+{
+    vector< uint32_t > codePoints;
+    uint32_t           sum = 0;
+
+    // A new vector per call as the callers did.
+    const double secondsVector = bestOf( NumRuns, [ & ]() {
+
+        vector< uint32_t > v;
+
+        utf8::utf8to32( text.begin(), text.end(), back_inserter( v ) );
+
+        codePoints.swap( v );
+    } );
+
+    const double secondsDecoder = bestOf( NumRuns, [ & ]() {
+
+        UTF8Decoder decoder( text );
+        uint32_t    code;
+
+        sum = 0;
+
+        while ( decoder.next( code ) ) {
+
+            sum += code;
+        }
+    } );
+
+    uint32_t expected = 0;
+
+    for ( auto c : codePoints ) {
+
+        expected += c;
+    }
+
+    const double megaBytes = text.size() / ( 1024.0 * 1024.0 );
+
+    cout << name << ": [" << text.size() << "] bytes, [" << codePoints.size() << "] code points\n";
+    cout << "  utf8to32 into vector: " << setw( 8 ) << secondsVector  * 1.0e6 << " us "
+         << setw( 8 ) << megaBytes / secondsVector  << " MB/s\n";
+    cout << "  UTF8Decoder:          " << setw( 8 ) << secondsDecoder * 1.0e6 << " us "
+         << setw( 8 ) << megaBytes / secondsDecoder << " MB/s\n";
+
+    return sum == expected;
+}
+
+
+static void benchLayout( const RuntimeHelper& helper, const string& name, const string& text )
+{
+    float                  width, firstBearingX, bearingY, belowBaselineY, advanceY;
+    vector< float >        posXs;
+    vector< const Glyph* > glyphs;
+
+    // getMetrics() appends to posXs.
+    const double secondsVector = bestOf( NumRuns, [ & ]() {
+
+        vector< uint32_t > codePoints;
+
+        posXs.clear();
+
+        utf8::utf8to32( text.begin(), text.end(), back_inserter( codePoints ) );
+
+        helper.getMetrics( codePoints, -1, 32.0f, width, posXs, firstBearingX,
+                           bearingY, belowBaselineY, advanceY, glyphs );
+    } );
+
+    const double secondsStringView = bestOf( NumRuns, [ & ]() {
+
+        posXs.clear();
+
+        helper.getMetrics( string_view( text ), -1, 32.0f, width, posXs, firstBearingX,
+                           bearingY, belowBaselineY, advanceY, glyphs );
+    } );
+
+    cout << name << " getMetrics(), [" << glyphs.size() << "] glyphs\n";
+    cout << "  utf8to32 and vector:  " << setw( 8 ) << secondsVector     * 1.0e6 << " us\n";
+    cout << "  string_view:          " << setw( 8 ) << secondsStringView * 1.0e6 << " us\n";
+}
+
+
+int main( int argc, char* argv[] )
+{
+    const string mixed = repeatText(
+        "The quick brown fox jumps over the lazy dog. "
+        "Größenmaßstäbe für Straßenüberquerungen, œuvre façade naïve. "
+        "Ελληνικά κείμενα και Русский текст для проверки. "
+        "日本語の文章と中文文本，한국어 문장도 함께。 "
+        "Emoji 😀🎉🚀 and symbols ∑∫√≈ ✓. "
+    );
+
+    const string ascii = repeatText(
+        "The quick brown fox jumps over the lazy dog. 0123456789 (ASCII only) "
+    );
+
+    cout << fixed << setprecision( 1 );
+
+    if ( !benchDecode( "Mixed", mixed ) || !benchDecode( "ASCII", ascii ) ) {
+
+        cerr << "UTF8Decoder and utf8to32 disagree.\n";
+        return 1;
+    }
+
+    if ( argc < 2 ) {
+
+        return 0;
+    }
+
+    GeneratorConfig conf;
+
+    conf.setFontPath( argv[1] );
+    conf.setOutputTextureSize( 1024 );
+    conf.setGlyphBitmapSizeForSampling( 64 );
+    conf.addCharCodeRange( 0x20, 0x17F );
+
+    Generator generator( conf, false );
+    FontAtlas atlas;
+
+    if ( !generator.generate() || !generator.generateAtlas( atlas ) ) {
+
+        cerr << "Can not generate the atlas of [" << argv[1] << "]\n";
+        return 1;
+    }
+
+    RuntimeHelper helper( std::move( atlas ) );
+
+    benchLayout( helper, "Mixed", mixed );
+    benchLayout( helper, "ASCII", ascii );
+
+    return 0;
+}
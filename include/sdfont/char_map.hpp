@@ -3,6 +3,8 @@
 
 #include <cstdint>
 #include <map>
+#include <string>
+#include <ostream>
 
 #include "sdfont/util.hpp"
 
@@ -0,0 +1,199 @@
+#ifndef __SDFONT_DYNAMIC_GLYPH_ATLAS_HPP__
+#define __SDFONT_DYNAMIC_GLYPH_ATLAS_HPP__
+
+#include <vector>
+#include <map>
+#include <list>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <GL/glew.h>
+
+#include "sdfont/glyph.hpp"
+#include "sdfont/generator/generator_config.hpp"
+#include "sdfont/generator/internal_glyph_thread_driver.hpp"
+#include "sdfont/runtime_helper/glyph_provider.hpp"
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file dynamic_glyph_atlas.hpp
+ *
+ *  @brief texture of the signed distance glyphs generated on demand.
+ *
+ *         The texture is divided into the square slots of the same size.
+ *         When a character is met for the first time, its metrics are
+ *         returned immediately, and its signed distance is generated on
+ *         the background thread with the same kernel as the generator.
+ *         Once generated, update() places it into a free slot, or the
+ *         slot of the least recently used glyph, with glTexSubImage2D().
+ *         Until then, the texture coordinates of the glyph point to the
+ *         empty slot 0, and nothing is drawn for it.
+ *
+ *         The texture memory is bounded by the texture size regardless
+ *         of the number of the glyphs in the font. The glyphs used in the
+ *         current frame are never evicted. If all the slots are in use in
+ *         the frame, the new glyphs wait until some slot is released.
+ *
+ *         The kernings are not available for the glyphs of this atlas.
+ *
+ *         Usage:
+ *
+ *             GeneratorConfig conf;
+ *             conf.setFontPath( "font.ttf" );
+ *             conf.setOutputTextureSize( 2048 );
+ *
+ *             DynamicGlyphAtlas atlas( conf, 64 );
+ *             RuntimeHelper     helper( atlas, atlas.spreadInTexture(), atlas.spreadInFontMetrics() );
+ *
+ *             // every frame on the render thread
+ *             atlas.update();
+ *             helper.getMetrics( ... );
+ *
+ *  @dependency FreeType : https://www.freetype.org
+ */
+class DynamicGlyphAtlas : public GlyphProvider {
+
+  public:
+
+    static const long DefaultMaxUploadsPerFrame = 32;
+
+    /** @param conf (in): the following are used.
+     *                    - fontPath()
+     *                    - outputTextureSize() : size of the texture
+     *                    - glyphBitmapSizeForSampling()
+     *                    - ratioSpreadToGlyph()
+     *                    - isDeadReckoningSet()
+     *                    - numThreads() : threads per glyph in addition to
+     *                                     the background thread.
+     *
+     *  @param slotSize (in): width and height of a slot in texels.
+     *
+     *  Call it on the render thread with the GL context current.
+     */
+    DynamicGlyphAtlas( const GeneratorConfig& conf, const long slotSize );
+
+    /** @brief destruct it on the render thread, as it deletes the texture. */
+    virtual ~DynamicGlyphAtlas();
+
+    bool   isOK()      const { return mOk; }
+
+    GLuint GLtexture() const { return mGLtexture; }
+
+    long   textureSize() const { return mConf.outputTextureSize(); }
+
+    long   numSlots() const { return mNumSlotsPerEdge * mNumSlotsPerEdge; }
+
+    long   numResidentGlyphs() const { return mSlotsInUse.size(); }
+
+    /** @brief see RuntimeHelper::spreadInTexture(). */
+    float  spreadInTexture() const;
+
+    /** @brief see RuntimeHelper::spreadInFontMetrics(). */
+    float  spreadInFontMetrics() const;
+
+    /** @brief returns the glyph, and marks it as used in the current frame.
+     *         It requests the generation if it is not in the texture.
+     *         Call it on the render thread.
+     *
+     *  @param charCode (in): Unicode code point.
+     */
+    const Glyph* provideGlyph( const uint32_t charCode ) override;
+
+    /** @brief starts a new frame, and uploads the glyphs generated since
+     *         the last call. Call it on the render thread once per frame.
+     *
+     *  @param maxUploads (in): max number of the glyphs uploaded in
+     *                          this call to bound the frame time.
+     */
+    void   update( const long maxUploads = DefaultMaxUploadsPerFrame );
+
+  private:
+
+    static const long NotResident = -1;
+
+    class Entry {
+
+      public:
+
+        Glyph      mGlyph;
+        long       mGlyphIndex;
+        long       mSlot;
+        bool       mRequested;
+    };
+
+    class Slot {
+
+      public:
+
+        uint32_t          mCharCode;
+        unsigned long     mLastUsedFrame;
+        list< long >::iterator
+                          mLruPosition;
+    };
+
+    /** @brief the signed distance generated by the background thread. */
+    class GeneratedGlyph {
+
+      public:
+
+        uint32_t                mCharCode;
+        long                    mWidth;
+        long                    mHeight;
+        float                   mTextureWidth;
+        float                   mTextureHeight;
+
+        /** @brief mWidth * mHeight texels with the first row at the bottom. */
+        vector< unsigned char > mTexels;
+    };
+
+    bool   initializeFreeType( FT_Library& library, FT_Face& face );
+    bool   findScale();
+    void   setBlankTextureCoords( Glyph& g ) const;
+    long   allocateSlot();
+    void   touchSlot( const long slot );
+    void   uploadToSlot( const long slot, const GeneratedGlyph& gen );
+
+    void   generateGlyphs();
+    bool   generateGlyph( const uint32_t charCode, const long glyphIndex, GeneratedGlyph& gen );
+
+    GeneratorConfig                mConf;
+    const long                     mSlotSize;
+    long                           mNumSlotsPerEdge;
+    bool                           mOk;
+    GLuint                         mGLtexture;
+
+    // Used only by the render thread.
+    FT_Library                     mFtLookupHandle;
+    FT_Face                        mFtLookupFace;
+    map< uint32_t, Entry >         mEntries;
+    vector< Slot >                 mSlots;
+    vector< long >                 mFreeSlots;
+    list< long >                   mSlotsInUse; // most recently used first
+    unsigned long                  mFrame;
+    deque< GeneratedGlyph >        mPendingUploads;
+
+    // Used only by the background thread.
+    FT_Library                     mFtGenHandle;
+    FT_Face                        mFtGenFace;
+    InternalGlyphThreadDriver*     mThreadDriver;
+
+    // Shared by the two threads.
+    mutex                          mMutex;
+    condition_variable             mCondition;
+    deque< pair< uint32_t, long> > mRequests;
+    deque< GeneratedGlyph >        mGenerated;
+    bool                           mTerminate;
+
+    thread                         mWorker;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_DYNAMIC_GLYPH_ATLAS_HPP__*/
@@ -0,0 +1,204 @@
+#ifndef __SDFONT_EMBEDDED_FONT_HPP__
+#define __SDFONT_EMBEDDED_FONT_HPP__
+
+#include <cstdint>
+
+namespace SDFont {
+
+/** @file embedded_font.hpp
+ *
+ *  @brief signed distance font compiled into the program, for the builds
+ *         without the file system at the start-up.
+ *
+ *         The generator writes a header with -emit_header, which defines
+ *         the glyphs, the char maps, the kernings, and the texture as the
+ *         static arrays, and EmbeddedFont over them as Font in the
+ *         namespace SDFontEmbedded::[output file name].
+ *
+ *         RuntimeHelper( const EmbeddedFont& ) looks them up without
+ *         parsing anything, and TextureLoader( const EmbeddedFont& )
+ *         uploads the texture.
+ *
+ *         All the tables are constexpr, and hence initialized before any
+ *         dynamic initialization in the other translation units. The
+ *         glyphs are in EmbeddedGlyph instead of Glyph, which has the name
+ *         in std::string. The names are not embedded.
+ */
+
+/** @brief Glyph without the name, as a literal type. */
+struct EmbeddedGlyph {
+
+    long  mCodePoint;
+    float mWidth;
+    float mHeight;
+    float mHorizontalBearingX;
+    float mHorizontalBearingY;
+    float mHorizontalAdvance;
+    float mVerticalBearingX;
+    float mVerticalBearingY;
+    float mVerticalAdvance;
+    float mTextureCoordX;
+    float mTextureCoordY;
+    float mTextureWidth;
+    float mTextureHeight;
+    long  mTextureChannel;
+};
+
+/** @brief a slot of the perfect hash of a char map. */
+struct EmbeddedCharMapSlot {
+
+    /** @brief EmbeddedCharMap::EmptyCharCode for the unused slots. */
+    uint32_t mCharCode;
+
+    /** @brief index into EmbeddedFont::mGlyphs. */
+    uint32_t mGlyphIndex;
+};
+
+
+/** @brief char map as a perfect hash by the displacements.
+ *
+ *         A char code is hashed with seed 0 into a bucket, and then with
+ *         the seed of the bucket into a slot. The seeds are chosen by the
+ *         generator so that no two char codes share a slot, and hence a
+ *         lookup is two hashes and one comparison.
+ */
+class EmbeddedCharMap {
+
+  public:
+
+    static constexpr uint32_t EmptyCharCode = 0xFFFFFFFF;
+
+    /** @brief the hash used by the generator and the lookup. */
+    static constexpr uint32_t hash( const uint32_t key, const uint32_t seed )
+    {
+        uint32_t h = key ^ ( seed * 0x9E3779B9u );
+
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+
+        return h;
+    }
+
+    /** @return index into EmbeddedFont::mGlyphs, or -1 if not found. */
+    constexpr long find( const uint32_t charCode ) const
+    {
+        if ( mNumSlots == 0 ) {
+
+            return -1;
+        }
+
+        const uint32_t seed = mSeeds[ hash( charCode, 0 ) % mNumBuckets ];
+
+        const EmbeddedCharMapSlot& slot = mSlots[ hash( charCode, seed ) % mNumSlots ];
+
+        return ( slot.mCharCode == charCode ) ? (long)slot.mGlyphIndex : -1;
+    }
+
+    bool                       mDefault;
+    const char*                mEncoding;
+    int32_t                    mPlatformId;
+    int32_t                    mEncodingId;
+    uint32_t                   mNumBuckets;
+    const uint32_t*            mSeeds;
+    uint32_t                   mNumSlots;
+    const EmbeddedCharMapSlot* mSlots;
+};
+
+
+/** @brief the arrays of KerningTable. */
+class EmbeddedKerning {
+
+  public:
+
+    /** @brief same as KerningTable::kerning(). */
+    constexpr float kerning( const long leftCodePoint, const long rightCodePoint ) const
+    {
+        if (    leftCodePoint  < 0 || leftCodePoint  >= mNumLeftCodePoints
+             || rightCodePoint < 0 || rightCodePoint >= mNumRightCodePoints ) {
+
+            return 0.0f;
+        }
+
+        return mValues[   (long)mLeftClasses [ leftCodePoint  ] * mNumRightClasses
+                        + mRightClasses[ rightCodePoint ] ];
+    }
+
+    long            mNumLeftClasses;
+    long            mNumRightClasses;
+    long            mNumLeftCodePoints;
+    const uint16_t* mLeftClasses;
+    long            mNumRightCodePoints;
+    const uint16_t* mRightClasses;
+
+    /** @brief mNumLeftClasses x mNumRightClasses in the row major. */
+    const float*    mValues;
+};
+
+
+class EmbeddedFont {
+
+  public:
+
+    /** @return index into mGlyphs for the code point, or -1 if not found.
+     *          The glyphs are in the ascending order of the code points.
+     */
+    constexpr long indexByCodePoint( const long codePoint ) const
+    {
+        long low  = 0;
+        long high = mNumGlyphs;
+
+        while ( low < high ) {
+
+            const long mid = ( low + high ) / 2;
+
+            if ( mGlyphs[ mid ].mCodePoint < codePoint ) {
+
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+
+        if ( low < mNumGlyphs && mGlyphs[ low ].mCodePoint == codePoint ) {
+
+            return low;
+        }
+        return -1;
+    }
+
+    /** @return index into mGlyphs for the character code in the char map,
+     *          or -1 if not found.
+     */
+    constexpr long indexByCharCode( const long charMapIndex, const uint32_t charCode ) const
+    {
+        return mCharMaps[ charMapIndex ].find( charCode );
+    }
+
+    /** @brief width and height of the texture in pixels. */
+    long                   mTextureSize;
+
+    /** @brief see FontAtlas::numChannels(). */
+    int                    mNumChannels;
+
+    /** @brief see FontAtlas::pixels(). */
+    const uint8_t*         mPixels;
+
+    float                  mSpreadInTexture;
+    float                  mSpreadInFontMetrics;
+
+    long                   mNumGlyphs;
+    const EmbeddedGlyph*   mGlyphs;
+
+    long                   mNumCharMaps;
+    const EmbeddedCharMap* mCharMaps;
+
+    EmbeddedKerning        mKerning;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_EMBEDDED_FONT_HPP__*/
@@ -0,0 +1,92 @@
+#ifndef __SDFONT_FONT_ATLAS_HPP__
+#define __SDFONT_FONT_ATLAS_HPP__
+
+#include <cstdint>
+#include <vector>
+#include <map>
+
+#include "sdfont/glyph.hpp"
+#include "sdfont/char_map.hpp"
+#include "sdfont/kerning_table.hpp"
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file font_atlas.hpp
+ *
+ *  @brief signed distance font in the memory, i.e., the texture and the
+ *         contents of the metrics file, for the applications that generate
+ *         the fonts in the process and use them without writing and parsing
+ *         the PNG and TXT files.
+ *
+ *         Produced by Generator::generateAtlas(), uploaded by
+ *         TextureLoader( const FontAtlas& ), and then moved into
+ *         RuntimeHelper( FontAtlas ), which takes over the glyphs, the
+ *         char maps, and the kernings, and frees the texture.
+ *
+ *         Move only, as the texture can be large.
+ */
+class FontAtlas {
+
+  public:
+
+    FontAtlas():
+        mTextureSize        ( 0   ),
+        mNumChannels        ( 1   ),
+        mSpreadInTexture    ( 0.0 ),
+        mSpreadInFontMetrics( 0.0 )
+        {;}
+
+    virtual ~FontAtlas() {;}
+
+    FontAtlas( FontAtlas const& ) = delete;
+    void operator = ( FontAtlas const& ) = delete;
+
+    FontAtlas( FontAtlas&& ) = default;
+    FontAtlas& operator = ( FontAtlas&& ) = default;
+
+    /** @brief width and height of the texture in pixels. */
+    long textureSize() const { return mTextureSize; }
+
+    /** @brief 1 for the signed distance, 3 for the multi-channel one,
+     *         4 for the glyphs packed in the RGBA channels.
+     */
+    int numChannels() const { return mNumChannels; }
+
+    /** @brief 8-bit per channel, tightly packed, with the first row at
+     *         the bottom as OpenGL expects.
+     */
+    const uint8_t* pixels() const { return mPixels.data(); }
+
+    bool empty() const { return mPixels.empty(); }
+
+    /** @brief see RuntimeHelper::spreadInTexture(). */
+    float spreadInTexture() const     { return mSpreadInTexture;     }
+
+    /** @brief see RuntimeHelper::spreadInFontMetrics(). */
+    float spreadInFontMetrics() const { return mSpreadInFontMetrics; }
+
+    /** @brief glyphs by code point. */
+    const map< long, Glyph >& glyphs()   const { return mGlyphs;   }
+
+    const vector< CharMap >&  charMaps() const { return mCharMaps; }
+
+    const KerningTable&       kerning()  const { return mKerning;  }
+
+    /** @brief frees the texture, e.g., after it is uploaded. */
+    void releaseTexture() { vector< uint8_t >().swap( mPixels ); }
+
+    long               mTextureSize;
+    int                mNumChannels;
+    vector< uint8_t >  mPixels;
+    float              mSpreadInTexture;
+    float              mSpreadInFontMetrics;
+    map< long, Glyph > mGlyphs;
+    vector< CharMap >  mCharMaps;
+    KerningTable       mKerning;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_FONT_ATLAS_HPP__*/
@@ -0,0 +1,129 @@
+#ifndef __SDFONT_BATCH_GENERATOR_HPP__
+#define __SDFONT_BATCH_GENERATOR_HPP__
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <iostream>
+#include <chrono>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "sdfont/generator/generator_config.hpp"
+#include "sdfont/generator/internal_glyph_thread_driver.hpp"
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file batch_generator.hpp
+ *
+ *  @brief generates many fonts in one process as listed in a manifest.
+ *
+ *         Each line of the manifest is a job, written with the same options
+ *         as sdfont_commandline. The empty lines and the lines that begin
+ *         with '#' are ignored. The options are separated by white spaces,
+ *         and hence the paths can not contain any.
+ *
+ *             # font size charset
+ *             -font_path Lato.ttf -texture_size 1024 -char_code_range 0X20-0X7E lato_ascii
+ *             -font_path Lato.ttf -texture_size 2048 -corpus strings_fr.txt lato_fr
+ *
+ *         The jobs run concurrently on the worker threads that share one
+ *         FreeType library. Each job runs on one worker, and the signed
+ *         distances of the glyphs of all the jobs are computed on one
+ *         pool of the threads, one per core, which the jobs take turns on
+ *         glyph by glyph. While a job is in a serial phase, such as the
+ *         kernings or the output, the others keep the pool busy, and a
+ *         single large job still gets all the cores. The option
+ *         -num_threads of the jobs is ignored with a warning.
+ *         The jobs are scheduled in the descending order of their estimated
+ *         costs, i.e., the number of the glyphs times the sampling area,
+ *         so that a large job does not start last and keep the other
+ *         workers idle.
+ *
+ *  @dependency FreeType : https://www.freetype.org
+ */
+class BatchGenerator {
+
+  public:
+
+    /** @param numWorkers (in): number of the worker threads.
+     *                          If 0, the number of the cores is used.
+     *  @param verbose    (in): passed to each Generator.
+     */
+    BatchGenerator( const long numWorkers, const bool verbose );
+
+    virtual ~BatchGenerator();
+
+    BatchGenerator( BatchGenerator const& ) = delete;
+    void operator = ( BatchGenerator const& ) = delete;
+
+    /** @brief reads the jobs in the manifest.
+     *
+     *  @return false if the file can not be read, or a line has an error.
+     */
+    bool loadManifest( const string& manifestPath );
+
+    /** @brief runs all the jobs.
+     *
+     *  @return true if all of them have succeeded.
+     */
+    bool run();
+
+    /** @brief prints the timing of each job in the order of the manifest. */
+    void emitSummary( ostream& os ) const;
+
+    long numJobs()    const { return mJobs.size(); }
+    long numWorkers() const { return mNumWorkers;  }
+    long numThreads() const { return mThreadDriver.m_num_threads; }
+
+  private:
+
+    class Job {
+
+      public:
+
+        long            mLineNumber;
+        string          mLine;
+        GeneratorConfig mConf;
+        double          mEstimatedCost;
+
+        bool            mOk;
+        long            mNumGlyphs;
+        long            mWorker;
+        double          mStartTime;
+        double          mGenerateTime;
+        double          mEmitTime;
+    };
+
+    bool   parseLine   ( const string& line, GeneratorConfig& conf ) const;
+    double estimateCost( const GeneratorConfig& conf );
+    void   runWorker   ( const long workerIndex );
+    bool   runJob      ( Job& job );
+    double secondsSinceStart() const;
+
+    const long                   mNumWorkers;
+    const bool                   mVerbose;
+    FT_Library                   mFtHandle;
+    mutex                        mFtHandleMutex;
+
+    // Shared by all the jobs.
+    InternalGlyphThreadDriver    mThreadDriver;
+
+    vector< Job >                mJobs;
+
+    // Indices to mJobs in the order of the scheduling.
+    vector< size_t >             mSchedule;
+    atomic< size_t >             mNextJob;
+
+    chrono::steady_clock::time_point
+                                 mStartTime;
+    double                       mWallTime;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_BATCH_GENERATOR_HPP__*/
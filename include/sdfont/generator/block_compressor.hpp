@@ -0,0 +1,90 @@
+#ifndef __SDFONT_BLOCK_COMPRESSOR_HPP__
+#define __SDFONT_BLOCK_COMPRESSOR_HPP__
+
+#include <vector>
+
+#include "sdfont/generator/internal_glyph_thread_driver.hpp"
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file block_compressor.hpp
+ *
+ *  @brief CPU encoders and decoders for the single channel block compressed
+ *         texture formats. Each 4x4 block of 8-bit texels is encoded into
+ *         8 bytes, i.e., half the size of GL_R8.
+ *
+ *         - BC4 (RGTC1) for the desktop GPUs.
+ *         - ETC2 EAC R11 for the mobile GPUs.
+ *
+ *         The texels of the blocks that stick out of the image are filled
+ *         with the nearest texels in the image.
+ *
+ *  @reference https://registry.khronos.org/DataFormat/specs/1.3/dataformat.1.3.html
+ */
+class BlockCompressor {
+
+  public:
+
+    enum Format {
+        BC4,
+        EAC_R11
+    };
+
+    static const long BytesPerBlock = 8;
+
+    /** @param threadDriver (in): if not nullptr, the rows of the blocks are
+     *                            encoded in parallel.
+     */
+    BlockCompressor( const Format format, InternalGlyphThreadDriver* threadDriver ):
+        mFormat       ( format       ),
+        mThreadDriver ( threadDriver )
+        {;}
+
+    virtual ~BlockCompressor() {;}
+
+    /** @brief encodes the image.
+     *
+     *  @param src    (in):  width * height texels, row by row.
+     *  @param dst    (out): the blocks, row by row.
+     */
+    void compress(
+        const unsigned char*     src,
+        const long               width,
+        const long               height,
+        vector< unsigned char >& dst
+    ) const;
+
+    /** @brief decodes the blocks into the 8-bit texels to check the quality
+     *         of the encoding.
+     */
+    void decompress(
+        const unsigned char*     src,
+        const long               width,
+        const long               height,
+        vector< unsigned char >& dst
+    ) const;
+
+    static void encodeBlockBC4   ( const unsigned char* texels, unsigned char* block );
+    static void decodeBlockBC4   ( const unsigned char* block,  unsigned char* texels );
+    static void encodeBlockEACR11( const unsigned char* texels, unsigned char* block );
+    static void decodeBlockEACR11( const unsigned char* block,  unsigned char* texels );
+
+  private:
+
+    void compressRowOfBlocks(
+        const unsigned char* src,
+        const long           width,
+        const long           height,
+        const long           blockRow,
+        unsigned char*       dst
+    ) const;
+
+    const Format               mFormat;
+    InternalGlyphThreadDriver* mThreadDriver;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_BLOCK_COMPRESSOR_HPP__*/
@@ -4,6 +4,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <mutex>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -11,7 +12,14 @@
 #include "sdfont/generator/internal_glyph_for_generator.hpp"
 #include "sdfont/generator/internal_glyph_thread_driver.hpp"
 #include "sdfont/generator/generator_config.hpp"
+#include "sdfont/generator/msdf_shape.hpp"
+#include "sdfont/generator/glyph_outline.hpp"
+#include "sdfont/generator/generator_cache.hpp"
 #include "sdfont/char_map.hpp"
+#include "sdfont/font_atlas.hpp"
+#include "sdfont/embedded_font.hpp"
+#include "sdfont/kerning_table.hpp"
+#include "sdfont/ktx2_container.hpp"
 
 namespace SDFont {
 
@@ -21,15 +29,85 @@ class Generator {
 
     Generator(GeneratorConfig& conf, bool verbose);
 
+    /** @brief shares the FreeType library with the other generators
+     *         running concurrently, such as in BatchGenerator.
+     *
+     *  @param sharedFtHandle      (in): initialized library, not owned.
+     *  @param sharedFtHandleMutex (in): held while the faces are created
+     *                                   and destroyed on the library.
+     *  @param sharedThreadDriver  (in): pool shared with the other
+     *                                   generators, not owned. If nullptr,
+     *                                   -num_threads of conf is used.
+     */
+    Generator(
+        GeneratorConfig&           conf,
+        bool                       verbose,
+        FT_Library                 sharedFtHandle,
+        mutex&                     sharedFtHandleMutex,
+        InternalGlyphThreadDriver* sharedThreadDriver = nullptr
+    );
+
     virtual ~Generator();
 
     bool generate();
     bool emitFilePNG();
+
+    /** @brief writes the texture and its mip chain in a KTX2 file
+     *         in the format specified by the config.
+     *         The mip chain is generated from the float signed distances.
+     */
+    bool emitFileKTX2();
     unsigned char** textureBitmap();
     void releaseTexture ();
     bool emitFileMetrics ();
+
+    /** @brief writes the C++ header with the glyphs, the char maps, the
+     *         kernings, and the texture as the static tables, for
+     *         RuntimeHelper( const EmbeddedFont& ). See embedded_font.hpp.
+     *
+     *         The char maps are written as the perfect hashes, with only
+     *         the characters whose glyphs are in the texture.
+     */
+    bool emitFileHeader();
+
+    /** @brief writes the metrics in the format of the TXT file. */
+    void emitMetrics( ostream& os );
     void generateMetrics(float& margin, vector<Glyph>& glyphs);
 
+    /** @brief kernings between the glyphs found by generate(). */
+    const KerningTable& kerning() const { return mKerning; }
+
+    /** @brief produces the texture and the metrics in the memory after
+     *         generate(), as emitFilePNG() and emitFileMetrics() would
+     *         write them.
+     *
+     *  @param atlas (out): see font_atlas.hpp.
+     */
+    bool generateAtlas( FontAtlas& atlas );
+
+    long numGlyphs() const { return mGlyphs.size(); }
+
+    /** @brief reuses the faces, the outlines, and the signed distance
+     *         of the earlier generations in the cache, and stores the new
+     *         ones in it. Call it before generate().
+     *
+     *  @param cache (in): not owned.
+     */
+    void setCache( GeneratorCache* cache ) { mCache = cache; }
+
+    /** @brief number of the glyphs whose signed distance was found in
+     *         the cache.
+     */
+    long numGlyphsFromCache() const { return mNumGlyphsFromCache; }
+
+    /** @brief number of the glyphs that share the rectangle of another
+     *         glyph with the same outline, or of the first empty glyph.
+     */
+    long numSharedGlyphs() const { return mGlyphs.size() - mPackedGlyphs.size(); }
+
+    /** @brief number of the glyphs without any point in the outline. */
+    long numEmptyGlyphs() const { return mNumEmptyGlyphs; }
+
     static const string Encoding_unicode;
     static const string Encoding_ms_symbol;
     static const string Encoding_sjis;
@@ -44,35 +122,121 @@ class Generator {
     static const string Encoding_apple_roman;
     static const string Encoding_old_latin_2;
 
+    /** @brief passed to MSDFShape::colorEdges(), which takes its sine as
+     *         the threshold on the cross product of the unit directions of
+     *         two consecutive edges. 3.0 gives sin( 3.0 ) = 0.141, i.e., a
+     *         turn of more than about 8 degrees is a corner in the
+     *         multi-channel signed distance field, as is a turn of 90
+     *         degrees or more.
+     */
+    static const double MSDFCornerAngleThreshold;
+
   private:
 
     bool  initializeFreeType      ( ) ;
     bool  generateGlyphs          ( ) ;
+
+    /** @brief loads the glyphs once, and captures their outlines, metrics
+     *         and names. The glyphs are loaded in parallel with a face per
+     *         thread over the mapped font file.
+     *
+     *  @param outlines (out): nullptr for the glyphs that can not be loaded.
+     */
+    bool  captureGlyphsWithCache  (
+              const vector< FT_UInt >& glyphIndices,
+              vector< GlyphOutline* >& outlines,
+              vector< string >&        glyphNames
+          );
+    bool  captureGlyphs           (
+              const vector< FT_UInt >& glyphIndices,
+              vector< GlyphOutline* >& outlines,
+              vector< string >&        glyphNames
+          );
+    bool  mapFontFile             ( );
+    FT_Error newMemoryFace        ( FT_Face& face );
+    FT_Error doneFace             ( FT_Face face );
+    void  unmapFontFile           ( );
     CharMap generateCharMap       ( FT_Face face, FT_CharMapRec* char_map, const bool is_default );
+
+    /** @brief collects the characters used in the corpora into the config. */
+    bool  scanCorpora             ( );
+    void  reportCorpusCoverage    ( );
     void  generateExtraGlyphs     ( );
     std::pair<float, float>
           findMeanGlyphDimension  ( ) ;
     void  addExtraGlyph           ( const long code_point, const string& glyph_name, const std::pair<float, float>& dim, const std::string& file_name );
     void  getKernings             ( ) ;
+
+    /** @brief finds the glyphs with the same outline by its hash, and lets
+     *         them share the rectangle of the first one, so that the signed
+     *         distance is generated and packed once. The empty glyphs share
+     *         the rectangle of the first empty one, which is left cleared.
+     *         The glyphs with their own rectangles go to mPackedGlyphs.
+     */
+    void  deduplicateGlyphs       ( ) ;
     long  fitGlyphsToTexture      ( ) ;
     long  findBestWidthForDefaultFontSize( long& bestHeight, long& maxNumGlyphsPerEdge );
     long  findHeightFromWidth     ( const long width, long& maxNumGlyphsPerEdge );
+
+    /** @return true if the glyphs scaled by the factor fit in the
+     *          channels of the packed texture, with the same packing as
+     *          generateGlyphBitmaps().
+     */
+    bool  fitsInPackedChannels    ( const float scale ) const;
+
+    /** @brief moves the shelf packing to the position of the next glyph.
+     *         With -pack_channels it moves on to the next channel if the
+     *         glyph does not fit in the rest of the current one.
+     *
+     *  @param width   (in): width of the glyph in pixels.
+     *  @param height  (in): height of the glyph in pixels.
+     *  @param baseX   (in/out): left of the glyph.
+     *  @param baseY   (in/out): bottom of the current row.
+     *  @param maxY    (in/out): height of the current row.
+     *  @param channel (in/out): channel of the packed texture.
+     */
+    void  nextPackingPosition     ( const long width, const long height, long& baseX, long& baseY, long& maxY, long& channel ) const;
     bool  generateGlyphBitmaps    ( long bestWidthForDefaultFontSize ) ;
+    bool  generateGlyphBitmap     ( InternalGlyphForGen* g );
     bool  generateTexture         ( bool reverseY ) ;
+    void  fillTexture             ( unsigned char** rows, bool reverseY );
+    float spreadInTexture         ( ) const;
+    float spreadInFontMetrics     ( ) const;
+    void  generateDistanceField   ( vector< float >& field );
+    void  downsampleDistanceField (
+              const vector< float >& src,
+              const long             srcWidth,
+              const float            lipschitzBound,
+              vector< float >&       dst
+          );
+    void  generateMipChain        ( vector< vector< unsigned char > >& levels );
+    bool  writeKTX2               ( const KTX2Container& container );
     FT_Error setEncoding          ( const string& s );
 
     GeneratorConfig&               mConf;
     bool                           mVerbose;
     FT_Library                     mFtHandle;
+    bool                           mOwnsFtHandle;
+    mutex*                         mFtHandleMutex;
     FT_Face                        mFtFace;
+    FT_Byte*                       mFontData;
+    size_t                         mFontDataSize;
     vector< InternalGlyphForGen* > mGlyphs;
+    vector< InternalGlyphForGen* > mPackedGlyphs;
     unsigned char*                 mPtrMain;
     unsigned char**                mPtrArray;
 
     vector< CharMap >              mCharMaps;
+    KerningTable                   mKerning;
     set< uint32_t >                mCodepointsToProcess;
+    set< uint32_t >                mSelectedGlyphIndices;
 
     InternalGlyphThreadDriver*     mThreadDriver;
+    bool                           mOwnsThreadDriver;
+
+    GeneratorCache*                mCache;
+    long                           mNumGlyphsFromCache;
+    long                           mNumEmptyGlyphs;
 };
 
 } // namespace SDFont
@@ -0,0 +1,166 @@
+#ifndef __SDFONT_GENERATOR_CACHE_HPP__
+#define __SDFONT_GENERATOR_CACHE_HPP__
+
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <memory>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "sdfont/generator/generator_config.hpp"
+#include "sdfont/generator/glyph_outline.hpp"
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file generator_cache.hpp
+ *
+ *  @brief keeps the work of a Generator for the next generations in the
+ *         same process, such as in GeneratorService.
+ *
+ *         - the font files mapped into the memory, and their faces.
+ *         - the outlines, the metrics, and the names of the glyphs loaded
+ *           at a sampling size.
+ *         - the signed distance of the glyphs under the parameters that
+ *           affect it, i.e., the sampling size, the spread ratio, the
+ *           scaling to the texture, dead reckoning, and multi-channel.
+ *
+ *         A generation that changes only the set of the characters, the
+ *         texture format, or the Y direction reuses the signed distance
+ *         of all the glyphs generated before. A change of the spread or the
+ *         scaling changes the signed distance of every glyph, and such a
+ *         generation reuses the faces and the outlines only.
+ *         The entries of a font file are dropped when the file is modified.
+ *
+ *         Used by one generation at a time.
+ */
+class GeneratorCache {
+
+  public:
+
+    static const size_t DefaultMaxSignedDistBytes = 512 * 1024 * 1024;
+
+    /** @param ftHandle      (in): library the faces are created on. Not owned.
+     *  @param ftHandleMutex (in): held while the faces are created and
+     *                             destroyed.
+     *  @param maxSignedDistBytes (in): the signed distances are dropped
+     *                             when their total size exceeds it.
+     */
+    GeneratorCache(
+        FT_Library   ftHandle,
+        mutex&       ftHandleMutex,
+        const size_t maxSignedDistBytes = DefaultMaxSignedDistBytes
+    );
+
+    virtual ~GeneratorCache();
+
+    GeneratorCache( GeneratorCache const& ) = delete;
+    void operator = ( GeneratorCache const& ) = delete;
+
+    /** @brief returns the face of the font file and its mapped contents,
+     *         which are owned by the cache.
+     *
+     *  @return false if the file can not be loaded.
+     */
+    bool findFace( const string& fontPath, FT_Face& face, FT_Byte*& data, size_t& dataSize );
+
+    /** @brief copies the glyph loaded before into outline.
+     *
+     *  @return false if not found.
+     */
+    bool findOutline(
+        const string&  fontPath,
+        const long     samplingSize,
+        const FT_UInt  glyphIndex,
+        GlyphOutline&  outline,
+        string&        glyphName
+    ) const;
+
+    void storeOutline(
+        const string&       fontPath,
+        const long          samplingSize,
+        const FT_UInt       glyphIndex,
+        const GlyphOutline& outline,
+        const string&       glyphName
+    );
+
+    class SignedDist {
+
+      public:
+
+        long            mWidth;
+        long            mHeight;
+        vector< float > mDist;
+        vector< float > mDistMulti;
+    };
+
+    /** @return nullptr if not found. */
+    const SignedDist* findSignedDist(
+        const GeneratorConfig& conf,
+        const FT_UInt          glyphIndex
+    ) const;
+
+    void storeSignedDist(
+        const GeneratorConfig& conf,
+        const FT_UInt          glyphIndex,
+        SignedDist&&           signedDist
+    );
+
+    /** @brief drops everything. */
+    void clear();
+
+    long numFonts()       const { return mFonts.size();       }
+    long numOutlines()    const { return mOutlines.size();    }
+    long numSignedDists() const { return mSignedDists.size(); }
+
+  private:
+
+    class Font {
+
+      public:
+
+        FT_Byte* mData;
+        size_t   mDataSize;
+        FT_Face  mFace;
+        time_t   mModifiedTime;
+    };
+
+    // font path, sampling size, glyph index
+    using OutlineKey = tuple< string, long, FT_UInt >;
+
+    class Outline {
+
+      public:
+
+        unique_ptr< GlyphOutline > mOutline;
+        string                     mGlyphName;
+    };
+
+    // font path, sampling size, spread ratio, scaling, dead reckoning,
+    // multi-channel, glyph index
+    using SignedDistKey = tuple< string, long, float, float, bool, bool, FT_UInt >;
+
+    static SignedDistKey makeSignedDistKey( const GeneratorConfig& conf, const FT_UInt glyphIndex );
+
+    bool loadFont( const string& fontPath, Font& font );
+    void releaseFont( Font& font );
+    void dropFont( const string& fontPath );
+
+    FT_Library                        mFtHandle;
+    mutex&                            mFtHandleMutex;
+    const size_t                      mMaxSignedDistBytes;
+
+    map< string, Font >               mFonts;
+    map< OutlineKey, Outline >        mOutlines;
+    map< SignedDistKey, SignedDist >  mSignedDists;
+    size_t                            mSignedDistBytes;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_GENERATOR_CACHE_HPP__*/
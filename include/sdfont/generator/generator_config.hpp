@@ -8,6 +8,7 @@
 #include <cmath>
 #include <vector>
 #include <utility>
+#include <set>
 
 namespace SDFont {
 
@@ -20,6 +21,11 @@ class GeneratorConfig {
     static const string FileNameExtraGlyphLineFeed;
     static const string FileNameExtraGlyphBlank;
 
+    static const string OutputFormatPNG;
+    static const string OutputFormatBC4;
+    static const string OutputFormatEACR11;
+    static const string OutputFormatR8;
+
     GeneratorConfig():
         mFontPath                   { DefaultFontPath },
         mExtraGlyphPath             { DefaultExtraGlyphPath },
@@ -34,6 +40,10 @@ class GeneratorConfig {
         mEncoding                   { DefaultEncoding },
         mEnableDeadReckoning        { DefaultEnableDeadReckoning },
         mReverseYDirectionForGlyphs { DefaultReverseYDirectionForGlyphs },
+        mEnableMultiChannel         { DefaultEnableMultiChannel },
+        mPackChannels               { DefaultPackChannels },
+        mEmitHeader                 { DefaultEmitHeader },
+        mOutputFormat               { DefaultOutputFormat },
         mFaceHasGlyphNames          { DefaultFaceHasGlyphNames }
         {;}
 
@@ -50,6 +60,9 @@ class GeneratorConfig {
                                             { mProcessHiddenGlyphs = b ; }
     void addCharCodeRange      ( const uint32_t s, const uint32_t f )
                                             { mCharCodeRanges.push_back( std::pair( s, f ) ); }
+    void addCorpusPath         ( string s ) { mCorpusPaths.push_back( s ); }
+    void setCorpusCharCodes    ( const set< uint32_t >& codes )
+                                            { mCorpusCharCodes = codes; }
     void setNumThreads         ( long v   ) { mNumThreads = v ; }
     void setGlyphScalingFromSamplingToPackedSignedDist
                                ( float v  ) { mGlyphScalingFromSamplingToPackedSignedDist = v; }
@@ -57,6 +70,10 @@ class GeneratorConfig {
     void setDeadReckoning      ( bool b )   { mEnableDeadReckoning = b; }
     void setReverseYDirectionForGlyphs
                                ( bool b )   { mReverseYDirectionForGlyphs = b; }
+    void setMultiChannel       ( bool b )   { mEnableMultiChannel = b; }
+    void setPackChannels       ( bool b )   { mPackChannels = b; }
+    void setEmitHeader         ( bool b )   { mEmitHeader = b; }
+    void setOutputFormat       ( string s ) { mOutputFormat = s; }
 
     string fontPath()          const { return mFontPath ;                         }
     string extraGlyphPath()    const { return mExtraGlyphPath ;                   }
@@ -78,18 +95,45 @@ class GeneratorConfig {
                                               * mGlyphScalingFromSamplingToPackedSignedDist
                                               * mRatioSpreadToGlyph );                      }
     const string& encoding()   const { return mEncoding;                          }
+    const vector< pair< long, long > >& charCodeRanges()
+                               const { return mCharCodeRanges;                    }
+    const vector< string >& corpusPaths()
+                               const { return mCorpusPaths;                       }
+    const set< uint32_t >& corpusCharCodes()
+                               const { return mCorpusCharCodes;                   }
 
     bool   isDeadReckoningSet()
                                const { return mEnableDeadReckoning; }
     bool   isReverseYDirectionForGlyphsSet()
                                const { return mReverseYDirectionForGlyphs; }
+    bool   isMultiChannelSet() const { return mEnableMultiChannel; }
+
+    /** @brief true if the glyphs are distributed over the R, G, B, and A
+     *         channels of the texture, each glyph in one of them.
+     */
+    bool   isPackChannelsSet() const { return mPackChannels; }
+    /** @brief true if the C++ header with the static tables of the font
+     *         is written in addition. See embedded_font.hpp.
+     */
+    bool   isEmitHeaderSet()   const { return mEmitHeader; }
+    long   numChannels()       const { return mPackChannels ? 4 : ( mEnableMultiChannel ? 3 : 1 ); }
+    const string& outputFormat()
+                               const { return mOutputFormat; }
+    string textureFileExtension()
+                               const { return ( mOutputFormat == OutputFormatPNG ) ? ".png" : ".ktx2"; }
 
     void   emitVerbose () const;
     void   outputMetricsHeader ( ostream& os ) const;
 
+    /** @brief true if the char code is in one of the ranges, or used in
+     *         the corpora. True for all if neither is specified.
+     */
     bool   isInACharCodeRange( const long charcode ) const
     {
-        if ( mCharCodeRanges.empty() ) {
+        if ( mCharCodeRanges.empty() && mCorpusPaths.empty() ) {
+            return true;
+        }
+        if ( mCorpusCharCodes.find( charcode ) != mCorpusCharCodes.end() ) {
             return true;
         }
         for ( const auto& pair: mCharCodeRanges ) {
@@ -116,9 +160,17 @@ class GeneratorConfig {
     long   mNumThreads;
     vector< pair< long, long > >
            mCharCodeRanges;
+    vector< string >
+           mCorpusPaths;
+    set< uint32_t >
+           mCorpusCharCodes;
     string mEncoding;
     bool   mEnableDeadReckoning;
     bool   mReverseYDirectionForGlyphs;
+    bool   mEnableMultiChannel;
+    bool   mPackChannels;
+    bool   mEmitHeader;
+    string mOutputFormat;
     bool   mFaceHasGlyphNames;
 
     static const string DefaultFontPath ;
@@ -132,6 +184,10 @@ class GeneratorConfig {
     static const string DefaultEncoding;
     static const bool   DefaultEnableDeadReckoning;
     static const bool   DefaultReverseYDirectionForGlyphs;
+    static const bool   DefaultEnableMultiChannel;
+    static const bool   DefaultPackChannels;
+    static const bool   DefaultEmitHeader;
+    static const string DefaultOutputFormat;
     static const bool   DefaultFaceHasGlyphNames;
 
     void trim( string& line ) const;
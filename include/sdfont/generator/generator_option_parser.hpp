@@ -31,6 +31,7 @@ class GeneratorOptionParser {
     void processGlyphSizeForSampling ( const string& s ) ;
     void processRatioSpreadToGlyph   ( const string& s ) ;
     void processCharCodeRange        ( const string& s ) ;
+    void processCorpus               ( const string& s ) ;
     void processProcessHiddenGlyphs  ( const bool    b ) ;
     void processNumThreads           ( const string& s ) ;
     void processOutputFileName       ( const string& s ) ;
@@ -38,6 +39,10 @@ class GeneratorOptionParser {
     void processDeadReckoning        ( const bool    b );
     void processReverseYDirectionForGlyphs
                                      ( const bool    b );
+    void processMultiChannel         ( const bool    b );
+    void processPackChannels         ( const bool    b );
+    void processEmitHeader           ( const bool    b );
+    void processOutputFormat         ( const string& s );
     bool doesFileExist               ( const string& s ) const ;
     bool doesDirectoryExist          ( const string& s ) const ;
     bool isValidFileName             ( const string& s ) const ;
@@ -55,9 +60,14 @@ class GeneratorOptionParser {
     static const string   RatioSpreadToGlyph;
     static const string   ProcessHiddenGlyphs;
     static const string   CharCodeRange;
+    static const string   Corpus;
     static const string   NumThreads;
     static const string   EnableDeadReckoning;
     static const string   ReverseYDirectionForGlyphs;
+    static const string   EnableMultiChannel;
+    static const string   PackChannels;
+    static const string   EmitHeader;
+    static const string   OutputFormat;
     static const string   Help;
     static const string   DashH;
     static const string   Verbose;
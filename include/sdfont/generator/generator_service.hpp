@@ -0,0 +1,117 @@
+#ifndef __SDFONT_GENERATOR_SERVICE_HPP__
+#define __SDFONT_GENERATOR_SERVICE_HPP__
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "sdfont/generator/generator_cache.hpp"
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file generator_service.hpp
+ *
+ *  @brief long running generator that serves the requests on a Unix domain
+ *         socket, for the tools that regenerate the fonts repeatedly,
+ *         such as an editor or an asset pipeline, without starting a
+ *         process and loading the font files each time.
+ *
+ *         The FreeType library, the faces, the glyph outlines, and the
+ *         signed distance of the glyphs are kept in a GeneratorCache over
+ *         the requests. See generator_cache.hpp for what is reused.
+ *
+ *         Protocol: all the integers are 32-bit unsigned little endian.
+ *         A connection can send any number of requests, and the requests
+ *         are processed one at a time in the order they arrive.
+ *
+ *         Request:  magic 'SDF1', type, payload size, payload.
+ *
+ *             RequestGenerate:   number of the arguments, and for each,
+ *                                its length and its bytes. The arguments
+ *                                are the options of sdfont_commandline
+ *                                without the program name. The output
+ *                                file name is required but not used, and
+ *                                nothing is written to the files.
+ *             RequestClearCache: no payload.
+ *             RequestShutdown:   no payload. The service stops after the
+ *                                response.
+ *
+ *         Response: magic 'SDF1', status, payload size, payload.
+ *
+ *             StatusOK for RequestGenerate: texture size, number of the
+ *                 channels, number of the glyphs, number of the glyphs
+ *                 found in the cache, size of the metrics, the texture in
+ *                 8-bit per channel from the top row, and the metrics in
+ *                 the format of the TXT file. -output_format is ignored.
+ *             StatusError: the error message.
+ *
+ *  @dependency FreeType : https://www.freetype.org
+ */
+class GeneratorService {
+
+  public:
+
+    static const uint32_t Magic             = 0x31464453; // "SDF1"
+
+    static const uint32_t RequestGenerate   = 1;
+    static const uint32_t RequestClearCache = 2;
+    static const uint32_t RequestShutdown   = 3;
+
+    static const uint32_t StatusOK          = 0;
+    static const uint32_t StatusError       = 1;
+
+    static const uint32_t MaxRequestPayload = 1024 * 1024;
+
+    /** @param socketPath (in): path of the socket created by run().
+     *  @param verbose    (in): passed to each Generator.
+     */
+    GeneratorService( const string& socketPath, const bool verbose );
+
+    virtual ~GeneratorService();
+
+    GeneratorService( GeneratorService const& ) = delete;
+    void operator = ( GeneratorService const& ) = delete;
+
+    /** @brief serves the requests until RequestShutdown.
+     *
+     *  @return false if the socket can not be created.
+     */
+    bool run();
+
+  private:
+
+    /** @return false if RequestShutdown is received. */
+    bool serveConnection( const int fd );
+
+    void handleGenerate(
+        const vector< uint8_t >& payload,
+        uint32_t&                status,
+        vector< uint8_t >&       response
+    );
+
+    bool parseArguments( const vector< uint8_t >& payload, vector< string >& args ) const;
+
+    static bool readFully ( const int fd, void* buf, const size_t size );
+    static bool writeFully( const int fd, const void* buf, const size_t size );
+    static bool sendResponse( const int fd, const uint32_t status, const vector< uint8_t >& payload );
+
+    static void     put32( vector< uint8_t >& buf, const uint32_t v );
+    static uint32_t get32( const uint8_t* p );
+
+    const string   mSocketPath;
+    const bool     mVerbose;
+    FT_Library     mFtHandle;
+    mutex          mFtHandleMutex;
+    GeneratorCache* mCache;
+    int            mListenFd;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_GENERATOR_SERVICE_HPP__*/
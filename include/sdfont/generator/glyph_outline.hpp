@@ -0,0 +1,95 @@
+#ifndef __SDFONT_GLYPH_OUTLINE_HPP__
+#define __SDFONT_GLYPH_OUTLINE_HPP__
+
+#include <functional>
+#include <cstddef>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_GLYPH_H
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file glyph_outline.hpp
+ *
+ *  @brief copy of a glyph loaded into a glyph slot, i.e., the hinted
+ *         outline and the metrics, owned independently of the face.
+ *
+ *         The glyphs are loaded once with FT_Load_Glyph(), and the later
+ *         stages rasterize them from this copy without loading them again.
+ *         The rasterization is done by FreeType in the same way as
+ *         FT_Render_Glyph() on the glyph slot.
+ *
+ *  @dependency FreeType : https://www.freetype.org
+ */
+class GlyphOutline {
+
+  public:
+
+    GlyphOutline();
+
+    virtual ~GlyphOutline();
+
+    GlyphOutline( GlyphOutline const& ) = delete;
+    void operator = ( GlyphOutline const& ) = delete;
+
+    /** @brief copies the glyph currently loaded into the slot.
+     *
+     *  @return FreeType error code.
+     */
+    FT_Error capture( FT_GlyphSlot slot );
+
+    /** @brief copies another captured glyph.
+     *
+     *  @return FreeType error code.
+     */
+    FT_Error copyFrom( const GlyphOutline& src );
+
+    const FT_Glyph_Metrics& metrics() const { return mMetrics; }
+
+    /** @return the outline, or nullptr if the glyph is not an outline. */
+    const FT_Outline* outline() const;
+
+    /** @return true if the glyph is an outline without any point, e.g.,
+     *          a space.
+     */
+    bool isEmpty() const;
+
+    /** @brief hash of the points, the tags, and the contours of the
+     *         outline, and the width and the height in the metrics,
+     *         i.e., all that the signed distance depends on.
+     *         0 if the glyph is not an outline.
+     */
+    size_t shapeHash() const;
+
+    /** @return true if the both are the outlines with the same points,
+     *          tags, contours, width, and height, which rasterize to the
+     *          same signed distance.
+     */
+    bool hasSameShape( const GlyphOutline& other ) const;
+
+    /** @brief rasterizes the glyph into a 1-bit bitmap, and passes it to
+     *         the function with the position of its left and top sides
+     *         in pixels in the outline coordinates.
+     *         The bitmap is released on return.
+     *
+     *  @return FreeType error code.
+     */
+    FT_Error renderMono(
+        const function< void( FT_Bitmap& bm, const long left, const long top ) >& consume
+    ) const;
+
+    /** @brief releases the copy. */
+    void release();
+
+  private:
+
+    FT_Glyph         mGlyph;
+    FT_Glyph_Metrics mMetrics;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_GLYPH_OUTLINE_HPP__*/
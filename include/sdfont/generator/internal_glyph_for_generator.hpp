@@ -5,6 +5,8 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include "sdfont/generator/generator_config.hpp"
+#include "sdfont/generator/msdf_shape.hpp"
+#include "sdfont/generator/glyph_outline.hpp"
 #include "sdfont/glyph.hpp"
 
 using namespace std;
@@ -59,8 +61,16 @@ class InternalGlyphForGen {
 
     inline float signedDist( long x, long y ) const;
 
+    /** @brief returns the value of the channel in the multi-channel field.
+     *         It falls back to signedDist() if the field is not generated.
+     */
+    inline float signedDistMulti( long x, long y, long channel ) const;
+
 
-    void addKerning( long followingCodePoint, FT_Pos v );
+    /** @brief converts the kerning from FT_Get_Kerning() to the font
+     *         metrics for the font size 1.0, as the other metrics.
+     */
+    float normalizedKerning( FT_Pos v ) const;
 
     /** @brief generates an internal matrix that contains the 
      *         signed distance.
@@ -72,6 +82,38 @@ class InternalGlyphForGen {
     void setSignedDist( FT_Bitmap& bm );
     void setSignedDist();
 
+    /** @brief generates the multi-channel signed distance from the outline.
+     *         It also sets mSignedDist to the median of the channels.
+     *
+     *  @param bm    (in): FreeType bitmap rendered from the outline.
+     *                     It is used to fix the signs far from the edges.
+     *  @param shape (in): the outline with the colored edges.
+     *  @param left  (in): X coordinate of the left side of bm in the
+     *                     outline coordinates in pixels.
+     *  @param top   (in): Y coordinate of the top side of bm in the
+     *                     outline coordinates in pixels.
+     */
+    void setSignedDistMultiChannel( FT_Bitmap& bm, const MSDFShape& shape, const long left, const long top );
+
+    /** @brief copies out the signed distance generated by setSignedDist()
+     *         or setSignedDistMultiChannel().
+     *
+     *  @param dist      (out): signedDistWidth() * signedDistHeight() values.
+     *  @param distMulti (out): 3 values per texel, or empty if not
+     *                          multi-channel.
+     */
+    void copySignedDist( vector< float >& dist, vector< float >& distMulti ) const;
+
+    /** @brief sets the signed distance copied out by copySignedDist() from
+     *         the same glyph under the same configuration.
+     */
+    void restoreSignedDist(
+        const long             width,
+        const long             height,
+        const vector< float >& dist,
+        const vector< float >& distMulti
+    );
+
 
     /** @brief set the coordinates of this glyph in the PNG coordinate system
      *         and the normalized texture coordinate system.
@@ -83,6 +125,36 @@ class InternalGlyphForGen {
      */
     void setBaseXY( long x, long y );
 
+    /** @brief sets the channel of the packed texture this glyph is in. */
+    void setTextureChannel( const long c ) { mTextureChannel = c; }
+
+    long textureChannel() const { return mTextureChannel; }
+
+    /** @brief lets this glyph use the rectangle of the other glyph with
+     *         the same signed distance instead of its own. The signed
+     *         distance of this glyph is not generated, and the position
+     *         of the other is given to setBaseXY() after the packing.
+     */
+    void shareRectangleOf( const InternalGlyphForGen* owner ) { mRectangleOwner = owner; }
+
+    /** @return the glyph whose rectangle this glyph uses, or nullptr if
+     *          it has its own.
+     */
+    const InternalGlyphForGen* rectangleOwner() const { return mRectangleOwner; }
+
+    /** @brief marks the glyph without any point in the outline, e.g., a
+     *         space. Its signed distance is far outside everywhere, i.e.,
+     *         the cleared texture, and it is not generated.
+     */
+    void setEmpty() { mEmpty = true; }
+
+    bool isEmpty() const { return mEmpty; }
+
+    /** @brief sets the size of the signed distance under the current
+     *         scaling without generating it, for the empty glyph.
+     */
+    void setEmptySignedDist();
+
     float width()  const { return mWidth;  }
     float height() const { return mHeight; }
 
@@ -90,12 +162,19 @@ class InternalGlyphForGen {
 
     void visualize   ( ostream& os ) const ;
     void emitMetrics ( ostream& os ) const ;
-    void emitKernings( ostream& os ) const ;
 
     Glyph generateSDGlyph() const;
 
     bool hasExternalBitmap() const { return mHasExternalBitmap; }
 
+    /** @brief takes the ownership of the outline captured at loading. */
+    void setOutline( GlyphOutline* outline ) { releaseOutline(); mOutline = outline; }
+
+    /** @return the outline, or nullptr if not set or released. */
+    const GlyphOutline* outline() const { return mOutline; }
+
+    void releaseOutline();
+
   private:
 
     /** @brief calculates the signed distance value from the current point
@@ -302,6 +381,7 @@ class InternalGlyphForGen {
     float               mTextureCoordY;
     float               mTextureWidth;
     float               mTextureHeight;
+    long                mTextureChannel;
 
     short               mWidth;
     short               mHeight;
@@ -315,13 +395,12 @@ class InternalGlyphForGen {
     short               mVerticalAdvance;
 
     float*              mSignedDist;
+    float*              mSignedDistMulti;
     short               mSignedDistWidth;
     short               mSignedDistHeight;
     short               mSignedDistBaseX;
     short               mSignedDistBaseY;
 
-    map< long, FT_Pos > mKernings;
-
     static const long   FREE_TYPE_FIXED_POINT_SCALING;
 
     bool                mHasExternalBitmap;
@@ -329,6 +408,12 @@ class InternalGlyphForGen {
     long                mExternalBitmapHeight;
     unsigned char*      mExternalBitmap;
 
+    GlyphOutline*       mOutline;
+
+    const InternalGlyphForGen*
+                        mRectangleOwner;
+    bool                mEmpty;
+
 friend class InternalGlyphThreadDriver;
 };
 
@@ -361,6 +446,19 @@ float InternalGlyphForGen::signedDist( long x, long y ) const {
 }
 
 
+float InternalGlyphForGen::signedDistMulti( long x, long y, long channel ) const {
+
+    if ( mSignedDistMulti != nullptr ) {
+
+        return mSignedDistMulti [ ( y * mSignedDistWidth + x ) * 3 + channel ];
+    }
+    else {
+
+        return signedDist( x, y );
+    }
+}
+
+
 bool InternalGlyphForGen::isPixelSet( FT_Bitmap& bm, long x, long y ) {
 
     if ( x < 0 || y < 0 || x >= bm.width || y >= bm.rows ) {
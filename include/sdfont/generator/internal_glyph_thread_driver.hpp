@@ -3,6 +3,8 @@
 
 #include <cstdint>
 #include <vector>
+#include <mutex>
+#include <functional>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -16,6 +18,11 @@ namespace SDFont {
 
 class InternalGlyphForGen;
 
+/** @brief pool of threads that runs the rows of a glyph, or any rows, in
+ *         parallel. It can be shared by the generators on different
+ *         threads, such as in BatchGenerator. The callers of run() and
+ *         runRows() then take turns, and each call gets all the threads.
+ */
 class InternalGlyphThreadDriver {
 public:
 
@@ -31,6 +38,11 @@ public:
         long                 offset
     );
 
+    /** @brief runs the given function for each row in [0, numRows)
+     *         distributing the rows over the threads in the same way as run().
+     */
+    void runRows( const long numRows, const std::function< void( long ) >& rowFunc );
+
 
     InternalGlyphThreadDriver( InternalGlyphThreadDriver const& ) = delete;
     void operator = ( InternalGlyphThreadDriver const& ) = delete;
@@ -45,6 +57,13 @@ public:
     float                       m_scale;
     long                        m_spreadInBitmapPixels;
     long                        m_offset;
+
+    long                        m_num_rows;
+    const std::function< void( long ) >*
+                                m_row_func;
+
+    // Held by the caller of run() or runRows() while the threads work.
+    std::mutex                  m_caller_mutex;
 };
 
 } // namespace SDFont
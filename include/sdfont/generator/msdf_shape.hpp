@@ -0,0 +1,189 @@
+#ifndef __SDFONT_MSDF_SHAPE_HPP__
+#define __SDFONT_MSDF_SHAPE_HPP__
+
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_OUTLINE_H
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file msdf_shape.hpp
+ *
+ *  @brief glyph outline decomposed into linear, quadratic, and cubic
+ *         segments to generate a multi-channel signed distance field (MSDF).
+ *
+ *         The edges are colored such that each channel sees a different
+ *         subset of the edges at the corners. The median of the three
+ *         channels then reconstructs sharp corners that a single channel
+ *         field rounds off.
+ *
+ *  @reference V. Chlumsky, "Shape Decomposition for Multi-channel Distance
+ *             Fields", Master's thesis, Czech Technical University, 2015.
+ *
+ *             The implementation is adapted from msdfgen by the same author,
+ *             under the MIT license. See msdf_shape.cpp.
+ */
+class MSDFShape {
+
+  public:
+
+    enum EdgeColor {
+        BLACK   = 0,
+        RED     = 1,
+        GREEN   = 2,
+        YELLOW  = 3,
+        BLUE    = 4,
+        MAGENTA = 5,
+        CYAN    = 6,
+        WHITE   = 7
+    };
+
+    class Vec2 {
+      public:
+        double mX;
+        double mY;
+
+        Vec2() : mX{ 0.0 }, mY{ 0.0 } {}
+        Vec2( const double x, const double y ) : mX{ x }, mY{ y } {}
+
+        Vec2   operator + ( const Vec2& v ) const { return Vec2( mX + v.mX, mY + v.mY ); }
+        Vec2   operator - ( const Vec2& v ) const { return Vec2( mX - v.mX, mY - v.mY ); }
+        Vec2   operator * ( const double s ) const { return Vec2( mX * s, mY * s ); }
+        double dot  ( const Vec2& v ) const { return mX * v.mX + mY * v.mY; }
+        double cross( const Vec2& v ) const { return mX * v.mY - mY * v.mX; }
+        double length() const;
+        Vec2   normalize() const;
+    };
+
+    /** @brief distance from a point to an edge with the tie breaker
+     *         used when two edges are equally close to the point.
+     */
+    class SignedDistance {
+      public:
+        double mDistance;
+        double mDot;
+
+        SignedDistance();
+        SignedDistance( const double d, const double dot ) : mDistance{ d }, mDot{ dot } {}
+
+        bool operator < ( const SignedDistance& rhs ) const;
+    };
+
+    /** @brief one Bezier segment of degree 1, 2, or 3.
+     */
+    class Edge {
+      public:
+        int       mDegree;
+        Vec2      mP[ 4 ];
+        EdgeColor mColor;
+
+        Vec2 point    ( const double t ) const;
+        Vec2 direction( const double t ) const;
+
+        /** @brief returns the edge between the parameters t0 and t1. */
+        Edge subEdge  ( const double t0, const double t1 ) const;
+
+        /** @param param (out): parameter of the point on the edge
+         *                      closest to p. It can be outside of [0, 1]
+         *                      for the end points.
+         */
+        SignedDistance signedDistance( const Vec2& p, double& param ) const;
+
+        /** @brief replaces the distance to an end point by the distance
+         *         to the extension of the edge beyond the end point,
+         *         if it is closer.
+         */
+        void distanceToPseudoDistance( SignedDistance& d, const Vec2& p, const double param ) const;
+    };
+
+    using Contour = vector< Edge >;
+
+    MSDFShape() {;}
+
+    virtual ~MSDFShape() {;}
+
+    /** @brief decomposes the FreeType outline into the contours.
+     *         The coordinates are converted from 26.6 to pixels.
+     *
+     *  @return false if the outline could not be decomposed.
+     */
+    bool loadFromOutline( const FT_Outline& outline );
+
+    /** @brief assigns the colors to the edges.
+     *
+     *  @param angleThreshold (in): two consecutive edges meet at a corner
+     *                              if the absolute cross product of their
+     *                              unit directions exceeds sin( angleThreshold ),
+     *                              or if the turn is 90 degrees or more.
+     *                              E.g., 3.0 makes a turn of more than about
+     *                              8 degrees a corner.
+     */
+    void colorEdges( const double angleThreshold );
+
+    /** @brief generates the multi-channel field.
+     *
+     *  @param dst     (out): width * height * 3 floats in RGB order. Row 0
+     *                        is the top row. 0.5 is on the edge, and
+     *                        the values above 0.5 are inside.
+     *
+     *  @param row     (in):  the row to generate.
+     *
+     *  @param width   (in):  number of the samples per row.
+     *
+     *  @param left    (in):  X coordinate of the left side of the sampling
+     *                        area in the outline coordinates in pixels.
+     *
+     *  @param top     (in):  Y coordinate of the top side of the sampling
+     *                        area in the outline coordinates in pixels.
+     *
+     *  @param step    (in):  distance between two samples in pixels.
+     *
+     *  @param range   (in):  the distance in pixels mapped to the value
+     *                        range [0.0, 1.0].
+     */
+    void generateRow(
+        float*       dst,
+        const long   row,
+        const long   width,
+        const double left,
+        const double top,
+        const double step,
+        const double range
+    ) const;
+
+    /** @brief finds the texels whose channels interpolate to a wrong
+     *         median against their neighbors (clashes), and replaces their
+     *         channels with the median.
+     *
+     *  @param threshold (in): minimum difference between two neighbors in
+     *                         the normalized value to be a clash.
+     */
+    static void correctErrors( float* msd, const long width, const long height, const float threshold );
+
+    static float median( const float r, const float g, const float b );
+
+    bool isEmpty() const { return mContours.empty(); }
+
+  private:
+
+    static int moveTo ( const FT_Vector* to, void* user );
+    static int lineTo ( const FT_Vector* to, void* user );
+    static int conicTo( const FT_Vector* control, const FT_Vector* to, void* user );
+    static int cubicTo( const FT_Vector* control1, const FT_Vector* control2, const FT_Vector* to, void* user );
+
+    static bool detectClash( const float* a, const float* b, const float threshold );
+
+    static void switchColor( EdgeColor& color, unsigned long long& seed, const EdgeColor banned = BLACK );
+
+    vector< Contour > mContours;
+    Vec2              mCursor;
+    double            mOrientationSign;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_MSDF_SHAPE_HPP__*/
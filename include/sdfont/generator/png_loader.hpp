@@ -2,18 +2,36 @@
 #define __SDFONT_PNG_LOADER__HPP__
 
 #include <string>
+#include <functional>
 
 namespace SDFont {
 
 using namespace std;
 
+/** @brief provides the buffer the rows are decoded into. It is called
+ *         once the dimensions are known and before any row is decoded.
+ *
+ *  @param width    (in): width of the image in pixels
+ *
+ *  @param height   (in): height of the image in pixels
+ *
+ *  @param rowBytes (in): bytes per row without any padding
+ *
+ *  @return buffer of at least rowBytes * height bytes, or nullptr to abort.
+ */
+using PngDestinationAllocator = function< unsigned char* (
+                                    unsigned long width,
+                                    unsigned long height,
+                                    size_t        rowBytes
+                                ) >;
+
 /** @brief load a PNG image file.
  *
  *  @param filepath (in):  path to the PNG file
  *
  *  @param width     (out): from png_get_IHDR(). upto 2^31
  *
- *  @param data      (out): the pixmap data loaded
+ *  @param data      (out): the pixmap data loaded, allocated with malloc().
  *
  *  @reference https://gist.github.com/mortennobel/5299151
  */
@@ -25,6 +43,34 @@ bool loadPngImage(
     unsigned char** data
 );
 
+/** @brief load a PNG image file into the buffer given by the caller.
+ *         The rows are decoded one by one directly into the buffer with
+ *         the first row at the bottom, without any intermediate copy.
+ *
+ *  @param allocate (in): called once to get the destination buffer.
+ *                        It can be a buffer owned by the caller or
+ *                        a mapped GL buffer.
+ */
+bool loadPngImage(
+
+    string                         filePath,
+    unsigned long&                 width,
+    unsigned long&                 height,
+    const PngDestinationAllocator& allocate
+);
+
+/** @brief load a PNG image file into the buffer of bufferSize bytes.
+ *         It fails if the buffer is too small.
+ */
+bool loadPngImage(
+
+    string          filePath,
+    unsigned long&  width,
+    unsigned long&  height,
+    unsigned char*  buffer,
+    size_t          bufferSize
+);
+
 } // namespace SDFont
 
 #endif/*__SDFONT_PNG_LOADER__HPP__*/
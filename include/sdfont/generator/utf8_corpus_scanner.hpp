@@ -0,0 +1,94 @@
+#ifndef __SDFONT_UTF8_CORPUS_SCANNER_HPP__
+#define __SDFONT_UTF8_CORPUS_SCANNER_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <set>
+
+#include "sdfont/generator/internal_glyph_thread_driver.hpp"
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file utf8_corpus_scanner.hpp
+ *
+ *  @brief collects the set of the code points used in UTF-8 text files,
+ *         such as the localized string tables of a product, to generate
+ *         only the glyphs actually displayed.
+ *
+ *         The text is split into as many chunks as the threads at the
+ *         boundaries of the characters, and the chunks are decoded in
+ *         parallel into their own bit sets, which are merged at the end.
+ *         The runs of ASCII characters are detected 16 bytes at a time with
+ *         SSE2 or NEON on AArch64.
+ *
+ *         The control characters below U+0020, DEL, and the byte order
+ *         mark are not collected. The invalid sequences, i.e., the stray
+ *         continuation bytes, the overlong forms, the surrogates, and the
+ *         code points above U+10FFFF, are skipped one byte at a time and
+ *         counted.
+ *
+ *         Note this is not the same as UTF8Decoder of the runtime, which
+ *         replaces each maximal subpart of an invalid sequence with U+FFFD.
+ *         Both collect the same valid characters, but the numbers of the
+ *         invalid sequences can differ, and the scanner never collects
+ *         U+FFFD for them. Keep the two in mind together when changing
+ *         either.
+ */
+class UTF8CorpusScanner {
+
+  public:
+
+    static const uint32_t MaxCodePoint = 0x10FFFF;
+
+    /** @param threadDriver (in): if not nullptr, the text is scanned
+     *                            in parallel.
+     */
+    UTF8CorpusScanner( InternalGlyphThreadDriver* threadDriver );
+
+    virtual ~UTF8CorpusScanner() {;}
+
+    /** @brief reads the file and collects its code points.
+     *
+     *  @return false if the file can not be read.
+     */
+    bool scanFile( const string& filePath );
+
+    /** @brief collects the code points in the text.
+     *
+     *  @param text (in): UTF-8 text, not necessarily null-terminated.
+     *  @param len  (in): length of the text in bytes.
+     */
+    void scan( const unsigned char* text, const size_t len );
+
+    /** @brief code points collected so far in the ascending order. */
+    set< uint32_t > codePoints() const;
+
+    long numInvalidSequences() const { return mNumInvalidSequences; }
+
+  private:
+
+    static const size_t NumWords = ( MaxCodePoint + 1 + 63 ) / 64;
+
+    /** @brief decodes [begin, end) into the bit set.
+     *
+     *  @return number of the invalid sequences.
+     */
+    static long scanChunk(
+        const unsigned char* begin,
+        const unsigned char* end,
+        uint64_t*            bits
+    );
+
+    static size_t skipContinuationBytes( const unsigned char* text, const size_t len, size_t pos );
+
+    InternalGlyphThreadDriver* mThreadDriver;
+    vector< uint64_t >         mBits;
+    long                       mNumInvalidSequences;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_UTF8_CORPUS_SCANNER_HPP__*/
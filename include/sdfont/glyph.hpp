@@ -24,14 +24,13 @@ class Glyph {
     float mTextureWidth;
     float mTextureHeight;
 
-    std::string mGlyphName;
+    // The channel of the texture packed with -pack_channels, 0 - 3 for
+    // R, G, B, and A. Always 0 for the other textures.
+    long  mTextureChannel = 0;
 
-    /*
-     *  key:   code point
-     *  value: kerning
-     */
-    std::map< long, float > mKernings;
+    std::string mGlyphName;
 
+    // The kernings are in KerningTable.
 };
 
 
@@ -0,0 +1,302 @@
+#ifndef __SDFONT_KERNING_TABLE_HPP__
+#define __SDFONT_KERNING_TABLE_HPP__
+
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <utility>
+#include <ostream>
+
+#include "sdfont/util.hpp"
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file kerning_table.hpp
+ *
+ *  @brief kernings by the classes of the glyphs, as in the class based
+ *         pair adjustment of the fonts.
+ *
+ *         Each glyph belongs to a left class as the preceding glyph and
+ *         to a right class as the following one, and the kerning is looked
+ *         up in the dense matrix of the classes. The glyphs with the same
+ *         kernings share a class, and the class 0 has no kerning on both
+ *         sides. The explicit pairs are grouped into the classes without
+ *         loss by KerningTableBuilder.
+ *
+ *         The classes are indexed by the code points of the glyphs, which
+ *         are dense, as they are the glyph indices of the face.
+ *
+ *         In the metrics file:
+ *
+ *         KERNING CLASSES
+ *         CLASSES (tab) Num Left Classes (tab) Num Right Classes
+ *         LEFT    (tab) Class (tab) Code Point 1 (tab) Code Point 2 ...
+ *         RIGHT   (tab) Class (tab) Code Point 1 (tab) Code Point 2 ...
+ *         VALUES  (tab) Left Class (tab) Kerning for Right Class 0 ...
+ *
+ *         The classes and the rows of the values not listed are 0.
+ */
+class KerningTable {
+
+  public:
+
+    static const char* const CLASSES;
+    static const char* const LEFT;
+    static const char* const RIGHT;
+    static const char* const VALUES;
+
+    /** @brief no kerning. The values are not allocated until resize(),
+     *         as the class arrays are empty.
+     */
+    KerningTable():
+        mNumLeftClasses ( 1 ),
+        mNumRightClasses( 1 )
+        {;}
+
+    virtual ~KerningTable() {;}
+
+    /** @brief kerning in the font metrics for the font size 1.0 between
+     *         the two glyphs in this order, or 0.0 if not defined.
+     */
+    float kerning( const long leftCodePoint, const long rightCodePoint ) const
+    {
+        if (    leftCodePoint  < 0 || leftCodePoint  >= (long)mLeftClasses.size()
+             || rightCodePoint < 0 || rightCodePoint >= (long)mRightClasses.size() ) {
+
+            return 0.0f;
+        }
+
+        return mValues[   (size_t)mLeftClasses [ leftCodePoint  ] * mNumRightClasses
+                        + mRightClasses[ rightCodePoint ] ];
+    }
+
+    bool empty() const { return mNumLeftClasses <= 1 || mNumRightClasses <= 1; }
+
+    long numLeftClasses()  const { return mNumLeftClasses;  }
+
+    long numRightClasses() const { return mNumRightClasses; }
+
+    /** @brief resizes the matrix of the values, which are cleared. */
+    void resize( const long numLeftClasses, const long numRightClasses )
+    {
+        mNumLeftClasses  = numLeftClasses;
+        mNumRightClasses = numRightClasses;
+        mValues.assign( (size_t)numLeftClasses * numRightClasses, 0.0f );
+    }
+
+    /** @brief sets the class of the glyph. */
+    void setLeftClass( const long codePoint, const uint16_t c )
+    {
+        if ( codePoint >= (long)mLeftClasses.size() ) {
+
+            mLeftClasses.resize( codePoint + 1, 0 );
+        }
+        mLeftClasses[ codePoint ] = c;
+    }
+
+    void setRightClass( const long codePoint, const uint16_t c )
+    {
+        if ( codePoint >= (long)mRightClasses.size() ) {
+
+            mRightClasses.resize( codePoint + 1, 0 );
+        }
+        mRightClasses[ codePoint ] = c;
+    }
+
+    float& value( const long leftClass, const long rightClass )
+    {
+        return mValues[ (size_t)leftClass * mNumRightClasses + rightClass ];
+    }
+
+    /** @brief writes the section of the metrics file after its header. */
+    void emit( ostream& os ) const
+    {
+        os << CLASSES << "\t" << mNumLeftClasses << "\t" << mNumRightClasses << "\n";
+
+        emitClasses( os, LEFT,  mLeftClasses,  mNumLeftClasses  );
+        emitClasses( os, RIGHT, mRightClasses, mNumRightClasses );
+
+        for ( long l = 1; l < mNumLeftClasses; l++ ) {
+
+            os << VALUES << "\t" << l;
+
+            for ( long r = 0; r < mNumRightClasses; r++ ) {
+
+                os << "\t" << mValues[ (size_t)l * mNumRightClasses + r ];
+            }
+            os << "\n";
+        }
+    }
+
+    long               mNumLeftClasses;
+    long               mNumRightClasses;
+
+    /** @brief by code point. */
+    vector< uint16_t > mLeftClasses;
+    vector< uint16_t > mRightClasses;
+
+    /** @brief mNumLeftClasses x mNumRightClasses in the row major. */
+    vector< float >    mValues;
+
+  private:
+
+    static void emitClasses(
+        ostream&                  os,
+        const char*               tag,
+        const vector< uint16_t >& classes,
+        const long                numClasses
+    ) {
+        vector< vector< long > > members( numClasses );
+
+        for ( long i = 0; i < (long)classes.size(); i++ ) {
+
+            if ( classes[ i ] != 0 ) {
+
+                members[ classes[ i ] ].push_back( i );
+            }
+        }
+
+        for ( long c = 1; c < numClasses; c++ ) {
+
+            os << tag << "\t" << c;
+
+            for ( const auto cp : members[ c ] ) {
+
+                os << "\t0X" << toHexString( (uint32_t) cp );
+            }
+            os << "\n";
+        }
+    }
+};
+
+inline const char* const KerningTable::CLASSES = "CLASSES";
+inline const char* const KerningTable::LEFT    = "LEFT";
+inline const char* const KerningTable::RIGHT   = "RIGHT";
+inline const char* const KerningTable::VALUES  = "VALUES";
+
+
+/** @brief groups the explicit kerning pairs into the classes.
+ *
+ *         The preceding glyphs with the same list of the pairs share a
+ *         left class, and then the following glyphs with the same column
+ *         over the left classes share a right class. Only the distinct
+ *         lists are kept while the pairs are added.
+ */
+class KerningTableBuilder {
+
+  public:
+
+    /** @brief (following code point, kerning) in the ascending order. */
+    using Row = vector< pair< long, float > >;
+
+    KerningTableBuilder() {;}
+
+    virtual ~KerningTableBuilder() {;}
+
+    /** @param row (in): the kernings following the glyph. Zeros are
+     *                   ignored. Each glyph is added at most once.
+     */
+    void addRow( const long leftCodePoint, Row row )
+    {
+        Row nonZero;
+
+        for ( const auto& p : row ) {
+
+            if ( p.second != 0.0f ) {
+
+                nonZero.push_back( p );
+            }
+        }
+
+        if ( nonZero.empty() ) {
+
+            return;
+        }
+
+        const auto it = mRowClasses.find( nonZero );
+
+        if ( it != mRowClasses.end() ) {
+
+            mLeftClasses.emplace_back( leftCodePoint, it->second );
+            return;
+        }
+
+        const uint16_t c = (uint16_t)( mRows.size() + 1 );
+
+        mRowClasses.emplace( nonZero, c );
+        mRows.push_back( std::move( nonZero ) );
+        mLeftClasses.emplace_back( leftCodePoint, c );
+    }
+
+    /** @brief builds the table from the rows added so far. */
+    void build( KerningTable& table ) const
+    {
+        // Column of each following glyph as (left class, kerning).
+        map< long, Row > columns;
+
+        for ( long l = 0; l < (long)mRows.size(); l++ ) {
+
+            for ( const auto& p : mRows[ l ] ) {
+
+                columns[ p.first ].emplace_back( l + 1, p.second );
+            }
+        }
+
+        map< Row, uint16_t >            columnClasses;
+        vector< pair< long, uint16_t > > rightClasses;
+        vector< const Row* >            distinctColumns;
+
+        for ( const auto& col : columns ) {
+
+            auto it = columnClasses.find( col.second );
+
+            if ( it == columnClasses.end() ) {
+
+                const uint16_t c = (uint16_t)( distinctColumns.size() + 1 );
+
+                it = columnClasses.emplace( col.second, c ).first;
+                distinctColumns.push_back( &( it->first ) );
+            }
+            rightClasses.emplace_back( col.first, it->second );
+        }
+
+        table = KerningTable();
+
+        if ( mRows.empty() ) {
+
+            return;
+        }
+
+        table.resize( mRows.size() + 1, distinctColumns.size() + 1 );
+
+        for ( const auto& lc : mLeftClasses ) {
+
+            table.setLeftClass( lc.first, lc.second );
+        }
+
+        for ( const auto& rc : rightClasses ) {
+
+            table.setRightClass( rc.first, rc.second );
+        }
+
+        for ( long r = 0; r < (long)distinctColumns.size(); r++ ) {
+
+            for ( const auto& p : *distinctColumns[ r ] ) {
+
+                table.value( p.first, r + 1 ) = p.second;
+            }
+        }
+    }
+
+  private:
+
+    map< Row, uint16_t >             mRowClasses;
+    vector< Row >                    mRows;
+    vector< pair< long, uint16_t > > mLeftClasses;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_KERNING_TABLE_HPP__*/
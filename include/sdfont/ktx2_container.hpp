@@ -0,0 +1,323 @@
+#ifndef __SDFONT_KTX2_CONTAINER_HPP__
+#define __SDFONT_KTX2_CONTAINER_HPP__
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file ktx2_container.hpp
+ *
+ *  @brief minimal KTX2 container for the single channel signed distance
+ *         textures with a full mip chain. It is shared by the generator
+ *         and the runtime helper.
+ *
+ *         The images are stored with the first row at the bottom
+ *         (KTXorientation "ru") so that they can be passed to OpenGL
+ *         as they are.
+ *
+ *  @reference https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+ */
+class KTX2Container {
+
+  public:
+
+    static const uint32_t VK_FORMAT_R8_UNORM          = 9;
+    static const uint32_t VK_FORMAT_BC4_UNORM_BLOCK   = 139;
+    static const uint32_t VK_FORMAT_EAC_R11_UNORM_BLOCK = 153;
+
+    KTX2Container():
+        mVkFormat( VK_FORMAT_R8_UNORM ),
+        mWidth   ( 0 ),
+        mHeight  ( 0 )
+        {;}
+
+    KTX2Container( const uint32_t vkFormat, const uint32_t width, const uint32_t height ):
+        mVkFormat( vkFormat ),
+        mWidth   ( width    ),
+        mHeight  ( height   )
+        {;}
+
+    virtual ~KTX2Container() {;}
+
+    uint32_t vkFormat() const { return mVkFormat; }
+    uint32_t width()    const { return mWidth;    }
+    uint32_t height()   const { return mHeight;   }
+
+    bool     isBlockCompressed() const { return mVkFormat != VK_FORMAT_R8_UNORM; }
+    uint32_t bytesPerBlock()     const { return isBlockCompressed() ? 8 : 1; }
+    uint32_t blockDimension()    const { return isBlockCompressed() ? 4 : 1; }
+
+    uint32_t levelWidth ( const size_t level ) const { return std::max( 1u, shiftDown( mWidth,  level ) ); }
+    uint32_t levelHeight( const size_t level ) const { return std::max( 1u, shiftDown( mHeight, level ) ); }
+
+    /** @brief number of the levels from the base level down to 1x1. */
+    static size_t fullMipChainLength( uint32_t width, uint32_t height )
+    {
+        size_t len = 1;
+        while ( width > 1 || height > 1 ) {
+            width  = std::max( 1u, width  >> 1 );
+            height = std::max( 1u, height >> 1 );
+            len++;
+        }
+        return len;
+    }
+
+    /** @brief expected size of the level in bytes. */
+    size_t levelByteLength( const size_t level ) const
+    {
+        const auto dim = blockDimension();
+        const size_t blocksX = ( levelWidth ( level ) + dim - 1 ) / dim;
+        const size_t blocksY = ( levelHeight( level ) + dim - 1 ) / dim;
+        return blocksX * blocksY * bytesPerBlock();
+    }
+
+    void addLevel( vector< unsigned char >&& data ) { mLevels.push_back( std::move( data ) ); }
+
+    size_t numLevels() const { return mLevels.size(); }
+
+    const vector< unsigned char >& level( const size_t i ) const { return mLevels[ i ]; }
+
+    bool writeToFile( const string& filePath ) const
+    {
+        vector< unsigned char > bytes;
+
+        bytes.insert( bytes.end(), Identifier, Identifier + IdentifierSize );
+
+        const uint32_t numLevels = mLevels.size();
+
+        putU32( bytes, mVkFormat );
+        putU32( bytes, 1         ); // typeSize
+        putU32( bytes, mWidth    );
+        putU32( bytes, mHeight   );
+        putU32( bytes, 0         ); // pixelDepth
+        putU32( bytes, 0         ); // layerCount
+        putU32( bytes, 1         ); // faceCount
+        putU32( bytes, numLevels );
+        putU32( bytes, 0         ); // supercompressionScheme
+
+        const auto dfd = dataFormatDescriptor();
+        const auto kvd = keyValueData();
+
+        const uint32_t dfdOffset = HeaderSize + IndexSize + LevelIndexEntrySize * numLevels;
+        const uint32_t kvdOffset = dfdOffset + dfd.size();
+
+        putU32( bytes, dfdOffset  );
+        putU32( bytes, dfd.size() );
+        putU32( bytes, kvdOffset  );
+        putU32( bytes, kvd.size() );
+        putU64( bytes, 0          ); // sgdByteOffset
+        putU64( bytes, 0          ); // sgdByteLength
+
+        // The level data are stored from the smallest to the largest.
+        vector< uint64_t > offsets( numLevels, 0 );
+        uint64_t           pos = kvdOffset + kvd.size();
+
+        for ( long i = (long)numLevels - 1; i >= 0; i-- ) {
+
+            pos = alignUp( pos, LevelAlignment );
+            offsets[ i ] = pos;
+            pos += mLevels[ i ].size();
+        }
+
+        for ( size_t i = 0; i < numLevels; i++ ) {
+
+            putU64( bytes, offsets[ i ]         );
+            putU64( bytes, mLevels[ i ].size()  );
+            putU64( bytes, mLevels[ i ].size()  ); // uncompressedByteLength
+        }
+
+        bytes.insert( bytes.end(), dfd.begin(), dfd.end() );
+        bytes.insert( bytes.end(), kvd.begin(), kvd.end() );
+
+        for ( long i = (long)numLevels - 1; i >= 0; i-- ) {
+
+            bytes.resize( offsets[ i ], 0 );
+            bytes.insert( bytes.end(), mLevels[ i ].begin(), mLevels[ i ].end() );
+        }
+
+        ofstream os( filePath, ios::binary );
+
+        if ( !os ) {
+            return false;
+        }
+
+        os.write( reinterpret_cast< const char* >( bytes.data() ), bytes.size() );
+
+        return os.good();
+    }
+
+    /** @return false if the file is not a KTX2 file this class can handle.
+     *          The file may be untrusted. All the offsets and the lengths
+     *          are checked against the file size without overflow.
+     */
+    bool readFromFile( const string& filePath )
+    {
+        ifstream is( filePath, ios::binary );
+
+        if ( !is ) {
+            return false;
+        }
+
+        vector< unsigned char > bytes( ( istreambuf_iterator< char >( is ) ), istreambuf_iterator< char >() );
+
+        if (    bytes.size() < HeaderSize + IndexSize
+             || memcmp( bytes.data(), Identifier, IdentifierSize ) != 0 ) {
+            return false;
+        }
+
+        mVkFormat = getU32( bytes, 12 );
+        mWidth    = getU32( bytes, 20 );
+        mHeight   = getU32( bytes, 24 );
+
+        const size_t numLevels = std::max( 1u, getU32( bytes, 40 ) );
+        const auto   superComp = getU32( bytes, 44 );
+
+        if (    superComp != 0
+             || numLevels > fullMipChainLength( mWidth, mHeight )
+             || (    mVkFormat != VK_FORMAT_R8_UNORM
+                  && mVkFormat != VK_FORMAT_BC4_UNORM_BLOCK
+                  && mVkFormat != VK_FORMAT_EAC_R11_UNORM_BLOCK ) ) {
+            return false;
+        }
+
+        if ( bytes.size() < HeaderSize + IndexSize + (size_t)LevelIndexEntrySize * numLevels ) {
+            return false;
+        }
+
+        mLevels.clear();
+
+        for ( size_t i = 0; i < numLevels; i++ ) {
+
+            const size_t entry  = HeaderSize + IndexSize + LevelIndexEntrySize * i;
+            const auto   offset = getU64( bytes, entry     );
+            const auto   length = getU64( bytes, entry + 8 );
+
+            if (    offset > bytes.size()
+                 || length > bytes.size() - offset
+                 || length != levelByteLength( i ) ) {
+
+                mLevels.clear();
+                return false;
+            }
+
+            mLevels.emplace_back( bytes.begin() + offset, bytes.begin() + offset + length );
+        }
+
+        return true;
+    }
+
+  private:
+
+    static constexpr size_t        IdentifierSize = 12;
+    static constexpr unsigned char Identifier[ IdentifierSize ] =
+        { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+    static const uint32_t HeaderSize          = 48;
+    static const uint32_t IndexSize           = 32;
+    static const uint32_t LevelIndexEntrySize = 24;
+    static const uint32_t LevelAlignment      = 8;
+
+    static void putU32( vector< unsigned char >& v, const uint32_t x )
+    {
+        for ( int i = 0; i < 4; i++ ) {
+            v.push_back( ( x >> ( 8 * i ) ) & 0xFF );
+        }
+    }
+
+    static void putU64( vector< unsigned char >& v, const uint64_t x )
+    {
+        for ( int i = 0; i < 8; i++ ) {
+            v.push_back( ( x >> ( 8 * i ) ) & 0xFF );
+        }
+    }
+
+    static uint32_t getU32( const vector< unsigned char >& v, const size_t pos )
+    {
+        uint32_t x = 0;
+        for ( int i = 3; i >= 0; i-- ) {
+            x = ( x << 8 ) | v[ pos + i ];
+        }
+        return x;
+    }
+
+    static uint64_t getU64( const vector< unsigned char >& v, const size_t pos )
+    {
+        uint64_t x = 0;
+        for ( int i = 7; i >= 0; i-- ) {
+            x = ( x << 8 ) | v[ pos + i ];
+        }
+        return x;
+    }
+
+    /** @brief x >> n, and 0 for n of 32 or more instead of the undefined shift. */
+    static uint32_t shiftDown( const uint32_t x, const size_t n ) { return ( n < 32 ) ? ( x >> n ) : 0; }
+
+    static uint64_t alignUp( const uint64_t x, const uint64_t a ) { return ( x + a - 1 ) / a * a; }
+
+    /** @brief basic data format descriptor with one sample for the red
+     *         (or the only) channel.
+     */
+    vector< unsigned char > dataFormatDescriptor() const
+    {
+        static const uint32_t KHR_DF_MODEL_RGBSDA = 1;
+        static const uint32_t KHR_DF_MODEL_BC4    = 131;
+        static const uint32_t KHR_DF_MODEL_ETC2   = 161;
+        static const uint32_t BlockSize           = 24 + 16;
+
+        vector< unsigned char > v;
+
+        const uint32_t model =   ( mVkFormat == VK_FORMAT_BC4_UNORM_BLOCK     ) ? KHR_DF_MODEL_BC4
+                               : ( mVkFormat == VK_FORMAT_EAC_R11_UNORM_BLOCK ) ? KHR_DF_MODEL_ETC2
+                               :                                                  KHR_DF_MODEL_RGBSDA;
+        const uint32_t dim   = blockDimension() - 1;
+
+        putU32( v, 4 + BlockSize );                    // dfdTotalSize
+        putU32( v, 0 );                                // vendorId, descriptorType
+        putU32( v, 2 | ( BlockSize << 16 ) );          // versionNumber, descriptorBlockSize
+        putU32( v, model | ( 1 << 8 ) | ( 1 << 16 ) ); // model, BT709 primaries, linear, no flags
+        putU32( v, dim | ( dim << 8 ) );               // texelBlockDimension
+        putU32( v, bytesPerBlock() );                  // bytesPlane0
+        putU32( v, 0 );                                // bytesPlane4-7
+
+        const uint32_t bitLength = bytesPerBlock() * 8 - 1;
+
+        putU32( v, bitLength << 16 );                  // bitOffset 0, bitLength, channel 0 (red)
+        putU32( v, 0 );                                // samplePosition
+        putU32( v, 0 );                                // sampleLower
+        putU32( v, isBlockCompressed() ? 0xFFFFFFFF : 0xFF ); // sampleUpper
+
+        return v;
+    }
+
+    static vector< unsigned char > keyValueData()
+    {
+        static const char key  [] = "KTXorientation";
+        static const char value[] = "ru";
+
+        vector< unsigned char > v;
+
+        putU32( v, sizeof( key ) + sizeof( value ) );
+        v.insert( v.end(), key,   key   + sizeof( key   ) );
+        v.insert( v.end(), value, value + sizeof( value ) );
+        v.resize( alignUp( v.size(), 4 ), 0 );
+
+        return v;
+    }
+
+    uint32_t                           mVkFormat;
+    uint32_t                           mWidth;
+    uint32_t                           mHeight;
+    vector< vector< unsigned char > >  mLevels;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_KTX2_CONTAINER_HPP__*/
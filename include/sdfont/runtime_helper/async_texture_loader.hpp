@@ -0,0 +1,210 @@
+#ifndef __SDFONT_ASYNC_TEXTURE_LOADER_HPP__
+#define __SDFONT_ASYNC_TEXTURE_LOADER_HPP__
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <chrono>
+
+#include "sdfont/runtime_helper/texture_loader.hpp"
+
+using namespace std;
+
+namespace SDFont {
+
+/** @brief GL calls made by AsyncTextureLoader to upload the texture.
+ *         All of them are called on the render thread.
+ *         Replace it with a mock to run the loader without any GL context.
+ */
+class TextureUploadBackend {
+
+  public:
+
+    virtual ~TextureUploadBackend() {;}
+
+    /** @brief allocates the storage of the texture without any data. */
+    virtual GLuint createTexture( long width, int numChannels ) = 0;
+
+    /** @brief sets the filters once all the rows have been uploaded. */
+    virtual void   finishTexture( GLuint texture ) = 0;
+    virtual void   deleteTexture( GLuint texture ) = 0;
+
+    virtual GLuint createPixelBuffer( size_t size ) = 0;
+    virtual void   deletePixelBuffer( GLuint buffer ) = 0;
+
+    /** @return pointer to write size bytes to, or nullptr on failure. */
+    virtual void*  mapPixelBuffer   ( GLuint buffer, size_t size ) = 0;
+    virtual bool   unmapPixelBuffer ( GLuint buffer ) = 0;
+
+    /** @brief glTexSubImage2D() of the rows in the pixel buffer. */
+    virtual void   uploadRows(
+        GLuint texture,
+        GLuint buffer,
+        long   yOffset,
+        long   width,
+        long   numRows,
+        int    numChannels
+    ) = 0;
+
+    /** @brief fence after the last upload from a pixel buffer, so that the
+     *         buffer is not written while the GPU is still reading it.
+     */
+    virtual GLsync insertFence() = 0;
+    virtual bool   isFenceSignaled( GLsync fence ) = 0;
+    virtual void   deleteFence( GLsync fence ) = 0;
+};
+
+
+/** @brief uploads with the OpenGL 3.2 calls. */
+class OpenGLTextureUploadBackend : public TextureUploadBackend {
+
+  public:
+
+    OpenGLTextureUploadBackend() {;}
+    virtual ~OpenGLTextureUploadBackend() {;}
+
+    GLuint createTexture( long width, int numChannels ) override;
+    void   finishTexture( GLuint texture ) override;
+    void   deleteTexture( GLuint texture ) override;
+
+    GLuint createPixelBuffer( size_t size ) override;
+    void   deletePixelBuffer( GLuint buffer ) override;
+
+    void*  mapPixelBuffer   ( GLuint buffer, size_t size ) override;
+    bool   unmapPixelBuffer ( GLuint buffer ) override;
+
+    void   uploadRows(
+        GLuint texture,
+        GLuint buffer,
+        long   yOffset,
+        long   width,
+        long   numRows,
+        int    numChannels
+    ) override;
+
+    GLsync insertFence() override;
+    bool   isFenceSignaled( GLsync fence ) override;
+    void   deleteFence( GLsync fence ) override;
+};
+
+
+/** @brief loads a PNG texture without blocking the render thread.
+ *
+ *         A worker thread decodes the rows into the main memory.
+ *         The render thread calls update() once per frame, which copies
+ *         the rows decoded so far into a ring of pixel unpack buffers and
+ *         uploads them with glTexSubImage2D(), until the time budget for
+ *         the frame runs out. A pixel buffer is reused only after the
+ *         fence of its last upload has been signaled, so update() never
+ *         waits for the GPU.
+ *
+ *         Usage:
+ *
+ *             AsyncTextureLoader loader( "font.png" );
+ *             ...
+ *             // every frame on the render thread
+ *             if ( loader.update( chrono::microseconds( 2000 ) ) ) {
+ *                 // loader.GLtexture() is ready.
+ *             }
+ */
+class AsyncTextureLoader {
+
+  public:
+
+    static const long   DefaultNumPixelBuffers = 3;
+    static const size_t DefaultChunkSize       = 1024 * 1024;
+
+    /** @param backend (in): if nullptr, OpenGLTextureUploadBackend is used.
+     *                        Not owned, and must outlive the loader.
+     *
+     *  @param numPixelBuffers (in): length of the ring of pixel buffers.
+     *
+     *  @param chunkSize (in): max bytes uploaded in one glTexSubImage2D().
+     *                         At least one row is uploaded at a time.
+     */
+    AsyncTextureLoader(
+        string                filePath,
+        TextureUploadBackend* backend         = nullptr,
+        const long            numPixelBuffers = DefaultNumPixelBuffers,
+        const size_t          chunkSize       = DefaultChunkSize
+    );
+
+    /** @brief must be destructed on the render thread, as it releases
+     *         the pixel buffers. The decoding in progress is aborted.
+     */
+    virtual ~AsyncTextureLoader();
+
+    /** @brief uploads the rows decoded so far within the time budget.
+     *         Call it on the render thread with the GL context current.
+     *
+     *  @return true if the texture is ready.
+     */
+    bool   update( const chrono::microseconds budget );
+
+    /** @brief true once the texture has been uploaded. */
+    bool   isReady()  const { return mReady.load( memory_order_acquire ); }
+
+    /** @brief true if the file could not be loaded. */
+    bool   hasFailed() const { return mFailed.load( memory_order_acquire ); }
+
+    /** @brief becomes true when the texture is ready, or false on failure.
+     *         Do not wait on it on the render thread, as the upload
+     *         progresses only in update().
+     */
+    shared_future< bool > readyFuture() const { return mReadyFuture; }
+
+    GLuint GLtexture()   const { return mGLtexture; }
+    int    size()        const { return mWidth; }
+    int    numChannels() const { return mNumChannels; }
+
+  private:
+
+    void   decode();
+    bool   startUpload();
+    bool   uploadChunk( const long numRowsDecoded );
+    void   releasePixelBuffers();
+    void   finish( const bool ok );
+
+    struct PixelBuffer {
+
+        GLuint mBuffer;
+        GLsync mFence;
+    };
+
+    string                   mFilePath;
+    OpenGLTextureUploadBackend
+                             mOpenGLBackend;
+    TextureUploadBackend*    mBackend;
+    const long               mNumPixelBuffers;
+    const size_t             mChunkSize;
+
+    // Written by the worker before mHeaderDecoded is set.
+    GLubyte*                 mPixMap;
+    unsigned long            mWidth;
+    size_t                   mRowBytes;
+
+    atomic< bool >           mHeaderDecoded;
+    atomic< long >           mNumRowsDecoded;
+    atomic< bool >           mDecodeFailed;
+    atomic< bool >           mAbort;
+
+    // Touched only by the render thread.
+    vector< PixelBuffer >    mPixelBuffers;
+    long                     mNextPixelBuffer;
+    long                     mNumRowsUploaded;
+    int                      mNumChannels;
+    GLuint                   mGLtexture;
+
+    atomic< bool >           mReady;
+    atomic< bool >           mFailed;
+    promise< bool >          mReadyPromise;
+    shared_future< bool >    mReadyFuture;
+
+    thread                   mWorker;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_ASYNC_TEXTURE_LOADER_HPP__*/
@@ -0,0 +1,81 @@
+#ifndef __SDFONT_GL_STATE_CACHE_HPP__
+#define __SDFONT_GL_STATE_CACHE_HPP__
+
+#ifdef __MAC_LIB__
+
+  #define GL_SILENCE_DEPRECATION
+
+#endif
+
+#include <GL/glew.h>
+
+namespace SDFont {
+
+/** @file gl_state_cache.hpp
+ *
+ *  @brief keeps the OpenGL state set by a shader manager, and skips the
+ *         calls that would set the same state again. It also counts the
+ *         OpenGL calls issued through it, so that the number of the calls
+ *         per frame can be checked.
+ *
+ *         The cache does not know the state changed by the other code.
+ *         Call invalidate() when the state may have been changed, e.g.,
+ *         at the beginning of a frame.
+ */
+class GLStateCache {
+
+  public:
+
+    GLStateCache() : mNumCalls( 0 ) { invalidate(); }
+
+    virtual ~GLStateCache() {;}
+
+    /** @brief forgets the state. The next calls are all issued. */
+    void invalidate();
+
+    void useProgram      ( const GLuint program );
+    void bindVertexArray ( const GLuint vertexArray );
+
+    /** @brief for GL_ARRAY_BUFFER and GL_UNIFORM_BUFFER.
+     *         GL_ELEMENT_ARRAY_BUFFER is a part of the vertex array.
+     */
+    void bindBuffer      ( const GLenum target, const GLuint buffer );
+    void bindBufferBase  ( const GLenum target, const GLuint index, const GLuint buffer );
+    void activeTexture   ( const GLenum unit );
+    void bindTexture2D   ( const GLuint texture );
+    void enableBlend     ( const bool enable );
+    void depthMask       ( const bool enable );
+    void blendFunc       ( const GLenum src, const GLenum dst );
+
+    /** @brief records the calls issued directly, e.g., the uploads and
+     *         the draw calls, which are not cached.
+     */
+    void count( const long numCalls = 1 ) { mNumCalls += numCalls; }
+
+    /** @brief number of the OpenGL calls issued through this. */
+    long numCalls() const { return mNumCalls; }
+
+    void resetNumCalls() { mNumCalls = 0; }
+
+  private:
+
+    static const GLuint Unknown = 0xffffffff;
+
+    long   mNumCalls;
+
+    GLuint mProgram;
+    GLuint mVertexArray;
+    GLuint mArrayBuffer;
+    GLuint mUniformBuffer;
+    GLuint mUniformBufferIndex;
+    GLenum mActiveTexture;
+    GLuint mTexture2D;
+    GLuint mBlend;
+    GLuint mDepthMask;
+    GLenum mBlendSrc;
+    GLenum mBlendDst;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_GL_STATE_CACHE_HPP__*/
@@ -0,0 +1,36 @@
+#ifndef __SDFONT_GLYPH_PROVIDER_HPP__
+#define __SDFONT_GLYPH_PROVIDER_HPP__
+
+#include <cstdint>
+
+#include "sdfont/glyph.hpp"
+
+namespace SDFont {
+
+/** @file glyph_provider.hpp
+ *
+ *  @brief source of the glyphs that are not in the metrics file.
+ *         RuntimeHelper asks it for the characters it has not found.
+ */
+class GlyphProvider {
+
+  public:
+
+    virtual ~GlyphProvider() {;}
+
+    /** @brief returns the glyph for the character code.
+     *
+     *         The glyph stays valid as long as the provider.
+     *         Its texture coordinates can point to an empty area
+     *         while its signed distance is not in the texture.
+     *
+     *  @param charCode (in): character code in the encoding of the provider.
+     *
+     *  @return nullptr if the font does not have the character.
+     */
+    virtual const Glyph* provideGlyph( const uint32_t charCode ) = 0;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_GLYPH_PROVIDER_HPP__*/
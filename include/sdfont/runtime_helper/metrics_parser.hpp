@@ -5,6 +5,7 @@
 #include <string>
 #include "sdfont/glyph.hpp"
 #include "sdfont/char_map.hpp"
+#include "sdfont/kerning_table.hpp"
 
 using namespace std;
 
@@ -19,11 +20,20 @@ class MetricsParser {
      *
      *  @param  G (in/out) graph to which nodes and edges are to be added
      */
-    MetricsParser( map< long, Glyph>& glyphs, float& spreadInTexture, float& spreadInFontMetrics, vector< CharMap >& charMaps ):
+    MetricsParser(
+        map< long, Glyph>&  glyphs,
+        float&              spreadInTexture,
+        float&              spreadInFontMetrics,
+        vector< CharMap >&  charMaps,
+        KerningTable&       kerning
+    ):
         mSpreadInTexture(spreadInTexture),
         mSpreadInFontMetrics(spreadInFontMetrics),
         mGlyphs(glyphs),
-        mCharMaps( charMaps ) {;}
+        mCharMaps( charMaps ),
+        mKerning( kerning ),
+        mHasKerningPairs( false ),
+        mHasKerningClasses( false ) {;}
 
 
     virtual ~MetricsParser(){;}
@@ -40,6 +50,7 @@ class MetricsParser {
     static const string SPREAD_IN_FONT_METRICS;
     static const string GLYPHS;
     static const string KERNINGS;
+    static const string KERNING_CLASSES;
     static const string CHAR_MAPS;
     static const string CHAR_MAP_DEFAULT;
 
@@ -51,6 +62,7 @@ class MetricsParser {
         IN_SPREAD_IN_FONT_METRICS,
         IN_GLYPHS,
         IN_KERNINGS,
+        IN_KERNING_CLASSES,
         IN_CHAR_MAPS,
         END
     };
@@ -97,6 +109,14 @@ class MetricsParser {
         bool&  errorFlag
     );
 
+    /** @brief the section written by KerningTable::emit(). */
+    void handleKerningClass(
+        string line,
+        string fileName,
+        long   lineNumber,
+        bool&  errorFlag
+    );
+
     void handleCharMap(
         string line,
         string fileName,
@@ -119,6 +139,14 @@ class MetricsParser {
     /** @brief used during parsing to find a node from a node number.*/
     map< long, Glyph >& mGlyphs;
     vector< CharMap >&  mCharMaps;
+    KerningTable&       mKerning;
+
+    /** @brief the explicit pairs of the older files, which are grouped
+     *         into the classes at the end.
+     */
+    KerningTableBuilder mKerningBuilder;
+    bool                mHasKerningPairs;
+    bool                mHasKerningClasses;
 };
 
 
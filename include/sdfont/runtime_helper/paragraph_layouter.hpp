@@ -0,0 +1,395 @@
+#ifndef __SDFONT_PARAGRAPH_LAYOUTER_HPP__
+#define __SDFONT_PARAGRAPH_LAYOUTER_HPP__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "sdfont/runtime_helper/runtime_helper.hpp"
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file paragraph_layouter.hpp
+ *
+ *  @brief lays out UTF-8 text into the lines of the given width, and keeps
+ *         the words, the lines, and the OpenGL draw elements for the
+ *         text, so that an edit is laid out again only where it changes.
+ *
+ *         The words are separated by the spaces, and '\n' is a hard break
+ *         that ends a paragraph. The lines are broken either greedily, or
+ *         optimally per paragraph to minimize the sum of the squares of
+ *         the spaces left at the ends of the lines, except the last line.
+ *
+ *         Each word owns the slots of its glyphs in the vertex and the
+ *         index arrays, each slot holding NUM_FLOATS_PER_GLYPH floats and
+ *         NUM_INDICES_PER_GLYPH indices as generateOpenGLDrawElements().
+ *         The slots are kept while the word exists, and the freed slots are
+ *         filled with the degenerate quads, so that the arrays can be drawn
+ *         as a whole, and only the slots of the words that are added or
+ *         moved are rewritten. They are reported by dirtySlotRanges() to be
+ *         uploaded, e.g., with glBufferSubData().
+ *
+ *         On an edit, the lines are broken again from the line before the
+ *         edit (from the start of the paragraph for the optimal breaking)
+ *         until a line starts at the same word as before. The following
+ *         lines are kept, and they are moved only if the number of the lines
+ *         changes. The moves of the text and of the arrays of the words and
+ *         the lines are the only costs in the size of the text.
+ *
+ *         The first baseline is at baselineY, and the baselines are
+ *         lineAdvance() apart downward. The width is unlimited by default,
+ *         i.e., the lines are broken only at the hard breaks.
+ */
+class ParagraphLayouter {
+
+  public:
+
+    enum LineBreaking {
+        GREEDY,
+        OPTIMAL
+    };
+
+    enum Alignment {
+        ALIGN_LEFT,
+        ALIGN_RIGHT,
+        ALIGN_CENTER,
+
+        /** @brief except the last lines of the paragraphs, which are
+         *         aligned to the left.
+         */
+        ALIGN_JUSTIFY,
+
+        /** @brief including the last lines. */
+        ALIGN_JUSTIFY_ALL
+    };
+
+    /** @brief a word, or a hard break. */
+    class Word {
+
+      public:
+
+        Word( const size_t begin, const size_t end, const bool isBreak ):
+            mBegin         ( begin ),
+            mEnd           ( end ),
+            mIsBreak       ( isBreak ),
+            mWidth         ( 0.0f ),
+            mAboveBaselineY( 0.0f ),
+            mBelowBaselineY( 0.0f ),
+            mFirstSlot     ( 0 ),
+            mNumGlyphs     ( 0 ),
+            mPlaced        ( false ),
+            mX             ( 0.0f ),
+            mBaselineY     ( 0.0f )
+            {;}
+
+        /** @brief range in the text in bytes. */
+        size_t mBegin;
+        size_t mEnd;
+        bool   mIsBreak;
+
+        float  mWidth;
+        float  mAboveBaselineY;
+        float  mBelowBaselineY;
+
+        /** @brief the glyphs are in the slots
+         *         [ mFirstSlot, mFirstSlot + mNumGlyphs ).
+         */
+        long   mFirstSlot;
+        long   mNumGlyphs;
+
+        /** @brief position of the draw elements in the slots. */
+        bool   mPlaced;
+        float  mX;
+        float  mBaselineY;
+    };
+
+    class Line {
+
+      public:
+
+        Line( const long firstWord ):
+            mFirstWord     ( firstWord ),
+            mEndWord       ( firstWord ),
+            mLeftX         ( 0.0f ),
+            mSpace         ( 0.0f ),
+            mNaturalWidth  ( 0.0f ),
+            mBaselineY     ( 0.0f ),
+            mAboveBaselineY( 0.0f ),
+            mBelowBaselineY( 0.0f )
+            {;}
+
+        /** @brief the words in [ mFirstWord, mEndWord ), including the
+         *         hard break at the end if any.
+         */
+        long  mFirstWord;
+        long  mEndWord;
+
+        /** @brief left edge of the first word. */
+        float mLeftX;
+
+        /** @brief space between the words. */
+        float mSpace;
+
+        /** @brief width with the normal spaces. */
+        float mNaturalWidth;
+
+        float mBaselineY;
+
+        /** @brief extents of the glyphs around the baseline without
+         *         the spread.
+         */
+        float mAboveBaselineY;
+        float mBelowBaselineY;
+    };
+
+    /** @brief a position between the glyphs, before the glyph mGlyph of
+     *         the word, or after the word if mGlyph is its number of the
+     *         glyphs. It is invalidated by the edits and the setters.
+     */
+    class Caret {
+
+      public:
+
+        Caret():
+            mLine ( 0 ),
+            mWord ( 0 ),
+            mGlyph( 0 )
+            {;}
+
+        long mLine;
+        long mWord;
+        long mGlyph;
+    };
+
+    /** @param helper        (in): not owned. Must outlive this layouter.
+     *  @param fontSize      (in): font size in the render coordinates.
+     *  @param spreadRatio   (in): see RuntimeHelper::getBoundingBoxes().
+     *  @param letterSpacing (in): see RuntimeHelper::getGlyphOriginsWidthAndHeight().
+     *  @param charMapIndex  (in): -1 for the default map.
+     */
+    ParagraphLayouter(
+        const RuntimeHelper& helper,
+        const float          fontSize,
+        const float          spreadRatio,
+        const float          letterSpacing = 1.0f,
+        const int32_t        charMapIndex  = -1
+    );
+
+    virtual ~ParagraphLayouter() {;}
+
+    /** @brief the following setters lay out the whole text again, but
+     *         only the words moved are rewritten.
+     */
+    void setWidth       ( const float width );
+    void setLineBreaking( const LineBreaking lineBreaking );
+    void setAlignment   ( const Alignment alignment );
+    void setPosition    ( const float leftX, const float baselineY, const float Z = 0.0f );
+
+    /** @brief multiplied to the vertical advance of the font. */
+    void setLineSpacing ( const float lineSpacing );
+
+    /** @brief replaces the whole text. */
+    void setText( const string_view utf8 );
+
+    /** @brief replaces the bytes [ pos, pos + len ) of the text.
+     *
+     *  @return false if the range is out of the text.
+     */
+    bool replace( const size_t pos, const size_t len, const string_view utf8 );
+
+    bool insert( const size_t pos, const string_view utf8 ) { return replace( pos, 0, utf8 ); }
+
+    bool erase( const size_t pos, const size_t len ) { return replace( pos, len, "" ); }
+
+    const string&         text()  const { return mText;  }
+    const vector< Word >& words() const { return mWords; }
+    const vector< Line >& lines() const { return mLines; }
+
+    float width()       const { return mWidth;       }
+    float lineAdvance() const { return mLineAdvance; }
+    float spaceWidth()  const { return mSpaceWidth;  }
+
+    /** @brief draw elements for numSlots() glyphs. */
+    const vector< float >&        vertices() const { return mVertices; }
+    const vector< unsigned int >& indices()  const { return mIndices;  }
+
+    long numSlots() const { return mNumSlots; }
+
+    /** @brief the glyph in the slot, or nullptr for a free slot. */
+    const Glyph* slotGlyph( const long slot ) const { return mSlotGlyphs[ slot ]; }
+
+    /** @brief the origin of the glyph in the slot relative to the left
+     *         edge and the baseline of the word.
+     */
+    const Point2D& slotOrigin( const long slot ) const { return mSlotOrigins[ slot ]; }
+
+    /** @brief the slots rewritten since the last clearDirtySlots(), as the
+     *         sorted and disjoint [ begin, end ). The arrays may have grown.
+     */
+    vector< pair< long, long > > dirtySlotRanges() const;
+
+    void clearDirtySlots() { mDirtySlots.clear(); }
+
+    /** @brief finds the lines whose quads may intersect [ bottomY, topY ]
+     *         by the binary search over the baselines, which are the
+     *         prefix sums of the line advances.
+     *
+     *  @param firstLine (out): the first line.
+     *  @param endLine   (out): the line after the last, or firstLine if none.
+     */
+    void findVisibleLines(
+        const float bottomY,
+        const float topY,
+        long&       firstLine,
+        long&       endLine
+    ) const;
+
+    /** @brief copies the draw elements of the words whose quads intersect
+     *         the clip rectangle, so that the text larger than the view,
+     *         e.g., a scrolled log, is drawn in the cost of the glyphs
+     *         visible.
+     *
+     *  @param clip     (in):  in the render coordinates.
+     *  @param arrayBuf (out): NUM_FLOATS_PER_GLYPH floats per glyph.
+     *  @param indices  (out): NUM_INDICES_PER_GLYPH indices per glyph
+     *                         into arrayBuf.
+     *
+     *  @return the number of the glyphs.
+     */
+    long generateVisibleElements(
+        const Rect&             clip,
+        vector< float >&        arrayBuf,
+        vector< unsigned int >& indices
+    ) const;
+
+    /** @brief finds the caret nearest to the point in the render
+     *         coordinates. Each line takes the band of lineAdvance() around
+     *         it, the first and the last taking the points beyond. The line,
+     *         the word, and the glyph are found by the binary searches over
+     *         the baselines, the positions of the words, and the origins of
+     *         the glyphs.
+     *
+     *  @return false if there is no line.
+     */
+    bool hitTest( const float x, const float y, Caret& caret ) const;
+
+    /** @brief X of the caret in the render coordinates. */
+    float caretX( const Caret& caret ) const;
+
+    /** @brief the band of the line in the render coordinates. */
+    Rect lineRect( const long line ) const;
+
+    /** @brief the rectangles of the selection between the carets, one per
+     *         line, in the cost of the number of the lines selected.
+     */
+    void selectionRects( const Caret& from, const Caret& to, vector< Rect >& rects ) const;
+
+  private:
+
+    /** @brief appends the words and the breaks in text[ begin, end ). */
+    void tokenize( const size_t begin, const size_t end, vector< Word >& words ) const;
+
+    /** @brief measures the glyphs and allocates the slots. */
+    void measure( Word& word );
+
+    /** @brief breaks the lines from the start of the line fromLine.
+     *
+     *  @param endNewWords (in): the lines are broken at least up to here.
+     *  @param wordDelta   (in): the change in the number of the words
+     *                           in the old lines after endNewWords.
+     */
+    void relayout( const long fromLine, const long endNewWords, const long wordDelta );
+
+    /** @brief the lines broken from the word, which is the start of a
+     *         paragraph for OPTIMAL.
+     *
+     *  @return the word after the lines.
+     */
+    long breakGreedy ( const long firstWord, vector< Line >& lines ) const;
+    long breakOptimal( const long firstWord, vector< Line >& lines ) const;
+
+    /** @brief sets the horizontal positions of the line. */
+    void alignLine( Line& line ) const;
+
+    /** @brief rewrites the slots of the words in the line if moved. */
+    void placeLine( const Line& line );
+
+    void placeWord( Word& word, const float x, const float baselineY );
+
+    long allocateSlots( const long num );
+
+    void freeSlots( const long first, const long num );
+
+    void addFreeSlots( const long first, const long num );
+
+    /** @brief index of the line that contains the word. */
+    long findLine( const long word ) const;
+
+    bool endsParagraph( const Line& line ) const;
+
+    /** @brief the words in the line without the hard break. */
+    long endOfWords( const Line& line ) const;
+
+    /** @brief right edge of the glyph bounding boxes of the word. */
+    float wordRight( const Word& word ) const;
+
+    /** @brief distance from the bottom of the band of a line to its
+     *         baseline, with the leading split evenly above and below.
+     */
+    float lineBandBelowBaseline() const;
+
+    const RuntimeHelper&        mHelper;
+    const float                 mFontSize;
+    const float                 mSpreadRatio;
+    const float                 mLetterSpacing;
+    const int32_t               mCharMapIndex;
+
+    float                       mWidth;
+    LineBreaking                mLineBreaking;
+    Alignment                   mAlignment;
+    float                       mLeftX;
+    float                       mBaselineY;
+    float                       mZ;
+    float                       mSpaceWidth;
+    float                       mVerticalAdvance;
+    float                       mLineAdvance;
+
+    /** @brief the largest extents of the words so far for
+     *         findVisibleLines().
+     */
+    float                       mMaxAboveBaselineY;
+    float                       mMaxBelowBaselineY;
+
+    string                      mText;
+    vector< Word >              mWords;
+    vector< Line >              mLines;
+
+    vector< float >             mVertices;
+    vector< unsigned int >      mIndices;
+    vector< const Glyph* >      mSlotGlyphs;
+    vector< Point2D >           mSlotOrigins;
+    long                        mNumSlots;
+
+    /** @brief for measure(). */
+    vector< const Glyph* >      mGlyphsWork;
+    vector< Point2D >           mOriginsWork;
+    vector< Point2D >           mPlacedWork;
+
+    /** @brief the free runs of the slots by the first slot, and by the
+     *         number of the slots for the best fit.
+     */
+    map< long, long >           mFreeSlots;
+    set< pair< long, long > >   mFreeSlotsBySize;
+
+    vector< pair< long, long > > mDirtySlots;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_PARAGRAPH_LAYOUTER_HPP__*/
@@ -3,10 +3,15 @@
 
 #include <vector>
 #include <map>
+#include <string_view>
 
 #include "sdfont/glyph.hpp"
 #include "sdfont/runtime_helper/metrics_parser.hpp"
+#include "sdfont/runtime_helper/glyph_provider.hpp"
 #include "sdfont/char_map.hpp"
+#include "sdfont/font_atlas.hpp"
+#include "sdfont/kerning_table.hpp"
+#include "sdfont/embedded_font.hpp"
 
 using namespace std;
 
@@ -39,13 +44,18 @@ class Rect {
  *           render coordinate system.
  *
  *         - mTexture is to specify the bounding box in the uv texture coordinate system.
+ *
+ *         - mTextureChannel is the channel of the glyph in the texture packed
+ *           with -pack_channels, and 0 otherwise.
  */
 class GlyphBound {
   public:
     Rect mFrame;
     Rect mTexture;
+    long mTextureChannel;
 
-    GlyphBound( const Rect& frame, const Rect& texture ) noexcept : mFrame{frame}, mTexture{texture} {}
+    GlyphBound( const Rect& frame, const Rect& texture, const long textureChannel = 0 ) noexcept
+        : mFrame{frame}, mTexture{texture}, mTextureChannel{textureChannel} {}
 };
 
 class RuntimeHelper {
@@ -57,8 +67,67 @@ class RuntimeHelper {
     static const int NUM_FLOATS_PER_GLYPH;
     static const int NUM_INDICES_PER_GLYPH;
 
+    /** @brief the channel of the glyph in the texture packed with
+     *         -pack_channels is carried in the texture coordinate X of the
+     *         vertices, offset by this times the channel. The vertex
+     *         shader takes the channel out with floor( ( u + 0.5 ) / 2 ),
+     *         and the texture is sampled at the coordinate without the
+     *         offset, or the same texel with GL_REPEAT. The vertices stay
+     *         in 8 floats, and nothing changes for the other textures.
+     *
+     *         The offset is added only to the vertices written by
+     *         generateOpenGLDrawElements(). The glyphs and the bounds keep
+     *         the texture coordinates as they are, and carry the channel in
+     *         mTextureChannel.
+     */
+    static const float TEXTURE_CHANNEL_OFFSET;
+
     RuntimeHelper( string fileName );
 
+    /** @brief takes over the glyphs and the char maps of the atlas
+     *         generated in the process without parsing the metrics file.
+     *         The texture is freed with the atlas, and hence it must be
+     *         loaded, e.g., with TextureLoader( const FontAtlas& ), before.
+     *
+     *         RuntimeHelper helper( std::move( atlas ) );
+     */
+    RuntimeHelper( FontAtlas atlas );
+
+    /** @brief looks up the glyphs, the char maps, and the kernings in the
+     *         static tables of the header written with -emit_header.
+     *         Nothing is parsed. The char maps and the kernings are used
+     *         in place, and the glyphs are copied into one array of Glyph,
+     *         the only allocation, as the pointers to them are returned.
+     *
+     *         glyphs() and kerning() are empty, and charMap() is not
+     *         available for it. See embeddedFont().
+     *
+     *         RuntimeHelper helper( SDFontEmbedded::lato::Font );
+     *
+     *  @param font (in): not owned. Usually a constexpr in the header.
+     */
+    RuntimeHelper( const EmbeddedFont& font );
+
+    /** @brief the glyphs are obtained from the provider on demand,
+     *         e.g., from DynamicGlyphAtlas, instead of the metrics file.
+     *         The character codes are passed to the provider as they are.
+     *
+     *  @param provider            (in): not owned. Must outlive this helper.
+     *  @param spreadInTexture     (in): see spreadInTexture().
+     *  @param spreadInFontMetrics (in): see spreadInFontMetrics().
+     */
+    RuntimeHelper(
+        GlyphProvider& provider,
+        const float    spreadInTexture,
+        const float    spreadInFontMetrics
+    );
+
+    /** @brief asks the provider for the characters not in the metrics file.
+     *
+     *  @param provider (in): not owned. nullptr to stop asking.
+     */
+    void setGlyphProvider( GlyphProvider* provider ) { mGlyphProvider = provider; }
+
     virtual ~RuntimeHelper();
 
     /** @brief
@@ -79,8 +148,18 @@ class RuntimeHelper {
 
     const map< long, Glyph>& glyphs() const { return mGlyphs; }
 
-    int32_t numCharMaps() const { return mCharMaps.size(); }
+    /** @brief kernings between the glyphs in the metrics file by their
+     *         code points, not for the glyphs from the provider.
+     */
+    const KerningTable& kerning() const { return mKerning; }
+
+    /** @brief the font given to the constructor, or nullptr. */
+    const EmbeddedFont* embeddedFont() const { return mEmbeddedFont; }
+
+    int32_t numCharMaps() const;
     int32_t getActiveCharMapIndex() const;
+
+    /** @brief not for the embedded font. */
     const CharMap& charMap( int32_t index ) const { return mCharMaps[index]; }
 
     /** @brief typesets a word.
@@ -148,6 +227,26 @@ class RuntimeHelper {
         float&                  belowBaselineY
     ) const;
 
+    /** @brief same as above for the UTF-8 text, which is decoded in place
+     *         by UTF8Decoder. The invalid sequences are looked up as U+FFFD.
+     */
+    void getGlyphOriginsWidthAndHeight(
+
+        const string_view       utf8,
+        const int32_t           charMapIndex,
+        const float             fontSize,
+        const float             letterSpacing,
+        const float&            leftX,
+        const float&            baselineY,
+
+        vector< const Glyph* >& glyphs,
+        vector< Point2D >&      instanceOrigins,
+        float&                  width,
+        float&                  height,
+        float&                  aboveBaselineY,
+        float&                  belowBaselineY
+    ) const;
+
 
     /** @brief generates bounding boxes for rendering.
      *
@@ -225,6 +324,21 @@ class RuntimeHelper {
         vector< const Glyph* >& glyphs
     ) const;
 
+    /** @brief same as above for the UTF-8 text. */
+    void getMetrics(
+
+        const string_view       utf8,
+        const int32_t           charMapIndex,
+        const float             fontSize,
+        float&                  width,
+        vector< float >&        posXs,
+        float&                  firstBearingX,
+        float&                  bearingY,
+        float&                  belowBaselineY,
+        float&                  advanceY,
+        vector< const Glyph* >& glyphs
+    ) const;
+
 
     void getMetricsNormalized(
 
@@ -239,6 +353,75 @@ class RuntimeHelper {
         vector< const Glyph* >& glyphs
     ) const;
 
+    /** @brief same as above for the UTF-8 text. */
+    void getMetricsNormalized(
+
+        const string_view       utf8,
+        const int32_t           charMapIndex,
+        float&                  width,
+        vector< float >&        posXs,
+        float&                  firstBearingX,
+        float&                  bearingY,
+        float&                  belowBaselineY,
+        float&                  advanceY,
+        vector< const Glyph* >& glyphs
+    ) const;
+
+    /** @brief same as getMetrics() for the UTF-8 text, on multiple threads
+     *         for a large text, e.g., the buffer of a log viewer.
+     *
+     *         The text is split into chunks at the code point boundaries.
+     *         The chunks are decoded and looked up in parallel, each with
+     *         the sum of its advances, then the sums and the kernings over
+     *         the chunk boundaries are combined by an exclusive scan, and
+     *         the positions are written in parallel.
+     *
+     *         The results are bit-identical to getMetrics(), as the X
+     *         positions are accumulated in the fixed point of 1/2^32 of
+     *         the font size on both paths, which does not depend on the
+     *         order of the additions.
+     *
+     *         If a glyph provider is set, the text is laid out on the
+     *         calling thread, as the provider is not thread-safe.
+     *
+     *  @param numThreads (in): number of threads including the calling one.
+     *                          0 for the number of the hardware threads.
+     *
+     *         The other parameters are as in getMetrics(), except posXs,
+     *         which is cleared first.
+     */
+    void getMetricsParallel(
+
+        const string_view       utf8,
+        const int32_t           charMapIndex,
+        const float             fontSize,
+        float&                  width,
+        vector< float >&        posXs,
+        float&                  firstBearingX,
+        float&                  bearingY,
+        float&                  belowBaselineY,
+        float&                  advanceY,
+        vector< const Glyph* >& glyphs,
+        const long              numThreads = 0
+    ) const;
+
+    /** @brief same as getMetricsNormalized() on multiple threads.
+     *         See getMetricsParallel().
+     */
+    void getMetricsNormalizedParallel(
+
+        const string_view       utf8,
+        const int32_t           charMapIndex,
+        float&                  width,
+        vector< float >&        posXs,
+        float&                  firstBearingX,
+        float&                  bearingY,
+        float&                  belowBaselineY,
+        float&                  advanceY,
+        vector< const Glyph* >& glyphs,
+        const long              numThreads = 0
+    ) const;
+
 
     /** @brief generates bounding boxes for rendering.
      *
@@ -321,6 +504,31 @@ class RuntimeHelper {
         unsigned int*               indices
     ) const;
 
+    /** @brief same as getBoundingBoxes() followed by
+     *         generateOpenGLDrawElements( bounds, ... ) above, without the
+     *         bounds in between.
+     *
+     *         The glyphs are transposed into the SoA form and expanded
+     *         8 at a time with AVX2, or 4 at a time with SSE2 or NEON,
+     *         with the same arithmetic as the scalar functions. The
+     *         vertices are written with the streaming stores if arrayBuf
+     *         is aligned to 32 bytes and the glyphs are too many to stay
+     *         in the cache, on x86.
+     *
+     *         The parameters are as in the functions above.
+     */
+    void generateOpenGLDrawElements (
+
+        const float                   fontSize,
+        const float                   spreadRatio,
+        const vector< const Glyph* >& glyphs,
+        const vector< Point2D >&      instanceOrigins,
+        const float                   Z,
+        float*                        arrayBuf,
+        const unsigned int            indexStart,
+        unsigned int*                 indices
+    ) const;
+
     /** @brief generates OpenGL VBOs for the given glyph, i.e.
      *         elements for  GL_ARRAY_BUFFER and
      *         indices for GL_ELEMENT_ARRAY_BUFFER.
@@ -453,11 +661,126 @@ class RuntimeHelper {
 
     ) const;
 
+    /** @brief same as above for the glyphs from getMetricsParallel(),
+     *         on multiple threads. Each glyph is written as by
+     *         generateOpenGLDrawElementsForOneChar(), and the entries for
+     *         nullptr are left untouched.
+     *
+     *  @param numThreads (in): number of threads including the calling one.
+     *                          0 for the number of the hardware threads.
+     */
+    void generateOpenGLDrawElementsParallel (
+
+        const vector< const Glyph* >& glyphs,
+        const vector< float >&        posXs,
+        const float                   leftX,
+        const float                   baselineY,
+        const float                   fontSize,
+        const float                   spreadRatio,
+        const float                   distribution,
+        const float                   Z,
+        float*                        arrayBuf,
+        const unsigned int            indexStart,
+        unsigned int*                 indices,
+        const long                    numThreads = 0
+
+    ) const;
+
   private:
-    float             mSpreadInTexture;
-    float             mSpreadInFontMetrics;
-    map< long, Glyph> mGlyphs;
-    vector< CharMap > mCharMaps;
+
+    /** @brief the layouts over the code points from the source, i.e.,
+     *         UTF8Decoder or the vector of the code points, which has
+     *         bool next( uint32_t& code ).
+     */
+    template< class Source >
+    void glyphOriginsWidthAndHeight(
+
+        Source&                 source,
+        const int32_t           charMapIndex,
+        const float             fontSize,
+        const float             letterSpacing,
+        const float&            leftX,
+        const float&            baselineY,
+
+        vector< const Glyph* >& glyphs,
+        vector< Point2D >&      instanceOrigins,
+        float&                  width,
+        float&                  height,
+        float&                  aboveBaselineY,
+        float&                  belowBaselineY
+    ) const;
+
+    template< class Source >
+    void metricsNormalized(
+
+        Source&                 source,
+        const int32_t           charMapIndex,
+        float&                  width,
+        vector< float >&        posXs,
+        float&                  firstBearingX,
+        float&                  bearingY,
+        float&                  belowBaselineY,
+        float&                  advanceY,
+        vector< const Glyph* >& glyphs
+    ) const;
+
+    /** @brief getMetricsParallel() if scale, getMetricsNormalizedParallel()
+     *         otherwise.
+     */
+    void metricsParallel(
+
+        const string_view       utf8,
+        const int32_t           charMapIndex,
+        const bool              scale,
+        const float             fontSize,
+        float&                  width,
+        vector< float >&        posXs,
+        float&                  firstBearingX,
+        float&                  bearingY,
+        float&                  belowBaselineY,
+        float&                  advanceY,
+        vector< const Glyph* >& glyphs,
+        const long              numThreads
+    ) const;
+
+    static void scaleMetrics(
+
+        const float             fontSize,
+        float&                  width,
+        vector< float >&        posXs,
+        float&                  firstBearingX,
+        float&                  bearingY,
+        float&                  belowBaselineY,
+        float&                  advanceY
+    );
+
+    /** @brief finds the glyph for the character code in the metrics file,
+     *         or in the embedded font, and then asks the provider if not found.
+     *
+     *  @param charMap (in): index from findCharMap(). -1 if there is no char map.
+     */
+    const Glyph* findGlyph( const int32_t charMap, const uint32_t charCode ) const;
+
+    /** @param fromProvider (out): true if the glyph is asked to the provider. */
+    const Glyph* findGlyph( const int32_t charMap, const uint32_t charCode, bool& fromProvider ) const;
+
+    /** @return the index of the char map, or -1 if there is none. */
+    int32_t findCharMap( const int32_t charMapIndex ) const;
+
+    /** @brief kerning from the metrics file or the embedded font. */
+    float kerningBetween( const long leftCodePoint, const long rightCodePoint ) const;
+
+    float               mSpreadInTexture;
+    float               mSpreadInFontMetrics;
+    map< long, Glyph>   mGlyphs;
+    vector< CharMap >   mCharMaps;
+    KerningTable        mKerning;
+    const EmbeddedFont* mEmbeddedFont;
+
+    /** @brief EmbeddedFont::mGlyphs as Glyph in the same order. */
+    vector< Glyph >     mEmbeddedGlyphs;
+
+    GlyphProvider*      mGlyphProvider;
 };
 
 
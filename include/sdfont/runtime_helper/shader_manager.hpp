@@ -18,6 +18,31 @@ using namespace std;
 
 namespace SDFont {
 
+/** @brief how the program was loaded, for the instrumentation of the
+ *         start up time.
+ */
+class ProgramLoadStats {
+
+  public:
+
+    ProgramLoadStats():
+        mFromCache    ( false ),
+        mStoredToCache( false ),
+        mSeconds      ( 0.0   )
+        {;}
+
+    /** @brief true if the program binary was loaded from the cache. */
+    bool   mFromCache;
+
+    /** @brief true if the program was compiled and stored to the cache. */
+    bool   mStoredToCache;
+
+    /** @brief time to load the program, i.e., to compile and link it,
+     *         or to load the binary from the cache.
+     */
+    double mSeconds;
+};
+
 class ShaderManager {
 
   public:
@@ -41,17 +66,51 @@ class ShaderManager {
         // glDisableVertexAttribArray( slot );
     }
 
+    /** @brief keeps the linked programs in the directory with
+     *         glGetProgramBinary(), and loads them with glProgramBinary()
+     *         on the next launch instead of compiling the shaders.
+     *
+     *         The binaries are keyed by GL_VENDOR, GL_RENDERER, GL_VERSION,
+     *         and the hash of the sources. The shaders are compiled if the
+     *         binary is not found, or rejected by the driver, e.g., after
+     *         an update of the driver with the same version string.
+     *         Nothing is cached if the driver has no binary format.
+     *
+     *         Set it before the shader managers are constructed.
+     *
+     *  @param dirPath (in): existing directory. Empty to disable the cache.
+     */
+    static void setProgramBinaryCacheDir( const string& dirPath ) { mProgramBinaryCacheDir = dirPath; }
+
+    static const string& programBinaryCacheDir() { return mProgramBinaryCacheDir; }
+
+    const ProgramLoadStats& loadStats() const { return mLoadStats; }
+
   protected:
 
     void loadShaders( string vertexPath, string fragmentPath )
     {
-        mOK = loadShaderPair( vertexPath, fragmentPath, mProgramID );
+        loadShadersFromStrings( fileToString( vertexPath ), fileToString( fragmentPath ) );
     }
 
-    void loadShadersFromStrings( string vertexStr, string fragmentStr )
-    {
-        mOK = loadShaderPairFromStrings( vertexStr, fragmentStr, mProgramID );
-    }
+    void loadShadersFromStrings( string vertexStr, string fragmentStr );
+
+    /** @brief compiles and links a program, or loads it from the cache,
+     *         for the subclasses that have more than one program.
+     *
+     *  @param progID (out): the program owned by the caller.
+     *  @param stats  (out): how the program was loaded.
+     *
+     *  @return false if the program could not be built.
+     */
+    static bool loadProgramFromStrings(
+        const string&     vertexStr,
+        const string&     fragmentStr,
+        GLuint&           progID,
+        ProgramLoadStats& stats
+    );
+
+    static void unloadProgram( GLuint progID ) { unloadShaderPair( progID ); }
 
     void unloadShaders()
     {
@@ -62,23 +121,34 @@ class ShaderManager {
 
     }
 
-    bool   mOK;
-    GLuint mProgramID;
+    bool             mOK;
+    GLuint           mProgramID;
+    ProgramLoadStats mLoadStats;
 
   private:
 
-    static bool loadShaderPair (
-        string  vertexPath,
-        string  fragmentPath,
-        GLuint& progID
-    );
-
     static bool loadShaderPairFromStrings (
         string  vertexShaderCode,
         string  fragmentShaderCode,
-        GLuint& progID
+        GLuint& progID,
+        bool    retrievable = false
     );
 
+    /** @return path of the cached binary for the sources on the current
+     *          context, or empty if the cache is disabled.
+     */
+    static string programBinaryPath (
+        const string& vertexShaderCode,
+        const string& fragmentShaderCode,
+        string&       key
+    );
+
+    static bool loadProgramBinary  ( const string& path, const string& key, GLuint& progID );
+
+    static bool storeProgramBinary ( const string& path, const string& key, GLuint progID );
+
+    static string mProgramBinaryCacheDir;
+
     static string fileToString ( string path );
 
     static bool   compile (const string& code, GLuint id );
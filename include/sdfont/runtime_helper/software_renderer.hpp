@@ -0,0 +1,148 @@
+#ifndef __SDFONT_SOFTWARE_RENDERER_HPP__
+#define __SDFONT_SOFTWARE_RENDERER_HPP__
+
+#include <cstdint>
+#include <vector>
+
+#include "sdfont/font_atlas.hpp"
+#include "sdfont/runtime_helper/runtime_helper.hpp"
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file software_renderer.hpp
+ *
+ *  @brief renders the glyph bounds from RuntimeHelper::getBoundingBoxes()
+ *         into an RGBA image on the CPU, for the machines without OpenGL,
+ *         e.g., to make thumbnails on a server.
+ *
+ *         The effects are the same as the fragment shader of
+ *         VanillaShaderManager, i.e., 0: raw, 1: softened edge,
+ *         2: sharp edge, 3: sharp edge with outer glow, 4: with border,
+ *         5: softened, and otherwise the rectangles for debugging.
+ *         The texture is sampled as GL_LINEAR with GL_REPEAT, and the
+ *         median of the three channels is taken for the multi-channel
+ *         texture, and the channel of the glyph for the packed texture.
+ *         The lighting is not supported.
+ *
+ *         The render coordinates are in pixels of the image, with the
+ *         origin at the bottom left corner and Y upward, as with an
+ *         orthographic projection of the size of the image.
+ *         A pixel is covered by a glyph if its center is in the frame.
+ *
+ *         The image is divided into the bands of TileHeight rows, which
+ *         are rendered in parallel, and 4 pixels in a row are shaded at a
+ *         time with SSE2 or NEON if available.
+ */
+class SoftwareRenderer {
+
+  public:
+
+    static const long TileHeight;
+
+    /** @param texture     (in): 8-bit per channel, tightly packed, with the
+     *                           first row at the bottom, e.g., the pixmap
+     *                           from TextureLoader::loadPngImage(). Not owned.
+     *  @param textureSize (in): width and height of the texture.
+     *  @param numChannels (in): 1, 3 for the multi-channel texture, or 4
+     *                           for the packed texture.
+     *  @param numThreads  (in): 0 for the number of the cores.
+     */
+    SoftwareRenderer(
+        const uint8_t* texture,
+        const long     textureSize,
+        const int      numChannels,
+        const long     numThreads = 0
+    );
+
+    /** @param atlas (in): its texture must be kept while this is used. */
+    SoftwareRenderer( const FontAtlas& atlas, const long numThreads = 0 );
+
+    virtual ~SoftwareRenderer();
+
+    SoftwareRenderer( SoftwareRenderer const& ) = delete;
+    void operator = ( SoftwareRenderer const& ) = delete;
+
+    /** @brief blends the glyphs over the image in the order of the bounds,
+     *         as with glBlendFuncSeparate( GL_SRC_ALPHA,
+     *         GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA ),
+     *         i.e., the image is in the premultiplied alpha. It is the same
+     *         as the shader on an opaque image.
+     *
+     *  @param bounds        (in): glyph bounds in the render coordinates.
+     *  @param effect        (in): see above.
+     *  @param lowThreshold  (in): same as the uniform of the shader.
+     *  @param highThreshold (in): same as the uniform of the shader.
+     *  @param smoothing     (in): same as the uniform of the shader.
+     *  @param baseColor     (in): RGB in [0.0, 1.0].
+     *  @param borderColor   (in): RGB in [0.0, 1.0].
+     *  @param rgba          (in/out): image with the first row at the top.
+     *  @param width         (in): width of the image in pixels.
+     *  @param height        (in): height of the image in pixels.
+     *  @param rowBytes      (in): bytes from a row to the next, 0 for width * 4.
+     *
+     *  @return false if the texture is not valid.
+     */
+    bool draw(
+        const vector< GlyphBound >& bounds,
+        const int                   effect,
+        const float                 lowThreshold,
+        const float                 highThreshold,
+        const float                 smoothing,
+        const float                 baseColor[3],
+        const float                 borderColor[3],
+        uint8_t*                    rgba,
+        const long                  width,
+        const long                  height,
+        const long                  rowBytes = 0
+    ) const;
+
+  private:
+
+    class Shading {
+
+      public:
+
+        int   mEffect;
+        float mLowThreshold;
+        float mHighThreshold;
+        float mSmoothing;
+        float mBaseColor  [3];
+        float mBorderColor[3];
+    };
+
+    /** @brief renders the bounds in the rows [rowBegin, rowEnd). */
+    void drawTile(
+        const vector< GlyphBound >& bounds,
+        const vector< long >&       boundIndices,
+        const Shading&              shading,
+        uint8_t*                    rgba,
+        const long                  width,
+        const long                  height,
+        const long                  rowBytes,
+        const long                  rowBegin,
+        const long                  rowEnd
+    ) const;
+
+    /** @brief renders the pixels [pxBegin, pxEnd) in a row of a glyph. */
+    void drawSpan(
+        const GlyphBound& b,
+        const Shading&    shading,
+        uint8_t*          row,
+        const float       cy,
+        const long        pxBegin,
+        const long        pxEnd
+    ) const;
+
+    long wrap( const long i ) const;
+
+    const uint8_t* mTexture;
+    const long     mTextureSize;
+    const int      mNumChannels;
+    const long     mNumThreads;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_SOFTWARE_RENDERER_HPP__*/
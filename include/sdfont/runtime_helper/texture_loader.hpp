@@ -2,19 +2,29 @@
 #define __SDFONT_TEXTURE_LOADER_HPP__
 
 #include <string>
+#include <functional>
 
 #ifdef __MAC_LIB__
 
   #define GL_SILENCE_DEPRECATION
-  #include <gl.h>
 
-#else
+#endif
+
+#include <GL/glew.h>
 
-  #include <GL/gl.h>
+#include <png.h>
 
+#include "sdfont/ktx2_container.hpp"
+#include "sdfont/font_atlas.hpp"
+#include "sdfont/embedded_font.hpp"
+
+#ifndef GL_COMPRESSED_RED_RGTC1
+#define GL_COMPRESSED_RED_RGTC1 0x8DBB
 #endif
 
-#include <png.h>
+#ifndef GL_COMPRESSED_R11_EAC
+#define GL_COMPRESSED_R11_EAC   0x9270
+#endif
 
 using namespace std;
 
@@ -24,14 +34,71 @@ class TextureLoader {
 
   public:
 
+    /** @param filePath (in): PNG file, or KTX2 file if the extension
+     *                         is ".ktx2". The KTX2 file is uploaded with
+     *                         its mip chain, compressed if it is in BC4
+     *                         or EAC R11.
+     */
     TextureLoader ( string filePath );
-    TextureLoader ( GLubyte* pixMap, int width );
+    /** @param numChannels (in): 1 for the signed distance in GL_RED,
+     *                            3 for the multi-channel one in GL_RGB,
+     *                            4 for the packed channels in GL_RGBA.
+     */
+    TextureLoader ( GLubyte* pixMap, int width, int numChannels = 1 );
+
+    /** @brief uploads the texture of the atlas generated in the process
+     *         as it is. The atlas is not modified, and its texture can be
+     *         released after this.
+     */
+    TextureLoader ( const FontAtlas& atlas );
+
+    /** @brief uploads the texture of the font embedded with -emit_header
+     *         directly from its static array.
+     */
+    TextureLoader ( const EmbeddedFont& font );
 
     virtual ~TextureLoader();
 
     bool   isOK() const { return mOk; }
     GLuint GLtexture() const { return mGLtexture; }
     int    size() const { return mWidth ; }
+    int    numChannels() const { return mNumChannels ; }
+
+    /** @brief provides the buffer the rows are decoded into, once the
+     *         dimensions are known. Returns nullptr to abort.
+     */
+    using DestinationAllocator = function< GLubyte* (
+                                     unsigned long width,
+                                     unsigned long height,
+                                     size_t        rowBytes
+                                 ) >;
+
+    /** @brief called after each row is decoded with the number of the
+     *         rows decoded so far. Returns false to abort.
+     */
+    using RowCallback = function< bool ( unsigned long numRowsDecoded ) >;
+
+    /** @brief load a PNG image file row by row directly into the buffer
+     *         given by allocate, with the first row at the bottom.
+     *         The buffer can be owned by the caller or a mapped
+     *         GL_PIXEL_UNPACK_BUFFER.
+     *
+     *  @param rowDecoded (in): optional. The rows are decoded from the top
+     *                          of the image, i.e., from the end of the buffer.
+     */
+    static bool loadPngImage(
+        string                      filePath,
+        unsigned long&              width,
+        int&                        numChannels,
+        const DestinationAllocator& allocate,
+        const RowCallback&          rowDecoded = RowCallback()
+    );
+
+    /** @return GL_R8, GL_RGB8, or GL_RGBA8 for the number of the channels. */
+    static GLint  internalFormat( const int numChannels );
+
+    /** @return GL_RED, GL_RGB, or GL_RGBA for the number of the channels. */
+    static GLenum pixelFormat   ( const int numChannels );
 
   private:
 
@@ -46,15 +113,18 @@ class TextureLoader {
     static bool loadPngImage(
         string         filePath,
         unsigned long& width,
+        int&           numChannels,
         GLubyte**      data
     );
 
     void generateOpenGLTexture();
+    void generateOpenGLTextureFromKTX2( const KTX2Container& ktx2 );
 
     bool          mOk ;
     GLubyte*      mPixMap ;
     bool          mPixMapAllocated ;
     unsigned long mWidth ;
+    int           mNumChannels ;
     GLuint        mGLtexture ;
 
 };
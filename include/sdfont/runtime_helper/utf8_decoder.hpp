@@ -0,0 +1,95 @@
+#ifndef __SDFONT_UTF8_DECODER_HPP__
+#define __SDFONT_UTF8_DECODER_HPP__
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+using namespace std;
+
+namespace SDFont {
+
+/** @file utf8_decoder.hpp
+ *
+ *  @brief decodes UTF-8 text into the code points one at a time, for the
+ *         layout functions of RuntimeHelper to read the text in place
+ *         without the vector of the code points.
+ *
+ *         The runs of ASCII characters are found 16 bytes at a time with
+ *         SSE2 or NEON, and the characters in a run are returned without
+ *         the checks of the sequences.
+ *
+ *         Each maximal subpart of an invalid sequence, i.e., a stray
+ *         continuation byte, an overlong form, a surrogate, a code point
+ *         above U+10FFFF, or a truncated sequence, is decoded to U+FFFD as
+ *         recommended by the Unicode standard.
+ */
+class UTF8Decoder {
+
+  public:
+
+    static const uint32_t ReplacementCharacter = 0xFFFD;
+
+    UTF8Decoder( const string_view text ):
+        mText        ( reinterpret_cast< const unsigned char* >( text.data() ) ),
+        mLen         ( text.size() ),
+        mPos         ( 0 ),
+        mAsciiEnd    ( 0 ),
+        mNumInvalid  ( 0 )
+        {;}
+
+    virtual ~UTF8Decoder() {;}
+
+    /** @brief decodes the next character.
+     *
+     *  @param code (out): the code point, or U+FFFD for an invalid sequence.
+     *
+     *  @return false at the end of the text.
+     */
+    bool next( uint32_t& code )
+    {
+        if ( mPos < mAsciiEnd ) {
+
+            code = mText[ mPos++ ];
+            return true;
+        }
+
+        if ( mPos >= mLen ) {
+
+            return false;
+        }
+
+        if ( mText[ mPos ] < 0x80 ) {
+
+            mAsciiEnd = findAsciiEnd( mText, mLen, mPos );
+            code      = mText[ mPos++ ];
+            return true;
+        }
+
+        code = decodeSequence();
+        return true;
+    }
+
+    /** @brief number of the invalid sequences decoded so far. */
+    long numInvalidSequences() const { return mNumInvalid; }
+
+    /** @return the position of the first non-ASCII byte at or after pos,
+     *          or len if there is none.
+     */
+    static size_t findAsciiEnd( const unsigned char* text, const size_t len, size_t pos );
+
+  private:
+
+    /** @brief decodes the multi-byte sequence at mPos. */
+    uint32_t decodeSequence();
+
+    const unsigned char* mText;
+    const size_t         mLen;
+    size_t               mPos;
+    size_t               mAsciiEnd;
+    long                 mNumInvalid;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_UTF8_DECODER_HPP__*/
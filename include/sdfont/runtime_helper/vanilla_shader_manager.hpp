@@ -4,15 +4,43 @@
 #include <glm/glm.hpp>
 #include <GL/glew.h>
 
+#include <cstdint>
+
 #include "sdfont/runtime_helper/shader_manager.hpp"
+#include "sdfont/runtime_helper/gl_state_cache.hpp"
 
 namespace SDFont {
 
+/** @brief draws the glyphs with the shaders below.
+ *
+ *         The parameters of a draw are in a uniform buffer, and only the
+ *         bytes changed from the previous draw are uploaded. The vertex
+ *         layout is recorded in the vertex array once, and the state set
+ *         by load() and draw() goes through GLStateCache. In a steady state
+ *         a draw issues the two uploads of the vertices and the indices,
+ *         the draw call, and the upload of the parameters if changed.
+ *
+ *         A program is built for each combination of the effect and the
+ *         lighting, with them defined in the sources, so that a fragment
+ *         runs only the path of the effect instead of branching on the
+ *         uniforms. The variants are built on their first draw, or by
+ *         prepareVariant(), and loadStats() is accumulated over them.
+ */
 class VanillaShaderManager : public ShaderManager {
 
   public:
 
-    VanillaShaderManager( GLuint textureObjectName, GLuint textureActiveNum );
+    /** @param multiChannel   (in): true if the texture is the multi-channel
+     *                               signed distance field in RGB.
+     *  @param packedChannels (in): true if the glyphs are packed in the RGBA
+     *                               channels with -pack_channels.
+     */
+    VanillaShaderManager(
+        GLuint textureObjectName,
+        GLuint textureActiveNum,
+        bool   multiChannel   = false,
+        bool   packedChannels = false
+    );
 
     virtual ~VanillaShaderManager();
 
@@ -39,33 +67,86 @@ class VanillaShaderManager : public ShaderManager {
 
     virtual void unload() override;
 
+    /** @brief number of the OpenGL calls issued by load() and draw(). */
+    long numGLCalls() const { return mStateCache.numCalls(); }
+
+    void resetGLCallCount() { mStateCache.resetNumCalls(); }
+
+    /** @brief builds the program for the effect and the lighting ahead of
+     *         the first draw with them, e.g., at the start up.
+     *
+     *  @return false if the program could not be built.
+     */
+    bool prepareVariant( const int effect, const bool useLight );
+
+    /** @brief parameters of a draw in the std140 layout of the uniform
+     *         block DrawParams in the shaders.
+     */
+    class DrawParams {
+
+      public:
+
+        float   mP          [16];
+        float   mM          [16];
+        float   mV          [16];
+        float   mLightWCS   [4];
+        float   mBaseColor  [4];
+        float   mBorderColor[4];
+        int32_t mEffect;
+        int32_t mUseLight;
+        float   mLowThreshold;
+        float   mHighThreshold;
+        float   mSmoothing;
+        int32_t mMultiChannel;
+        int32_t mPackedChannels;
+        int32_t mPadding    [1];
+    };
+
+    /** @brief binding point of the uniform buffer. */
+    static const GLuint DrawParamsBinding;
+
+    /** @brief effects 0 - 5, and the rectangles for the others. */
+    static const int    NumEffectVariants = 7;
+
   protected:
 
+    /** @brief uploads the range of the parameters changed since the
+     *         last draw.
+     */
+    void updateDrawParams( const DrawParams& params );
+
+    /** @return the program of the variant, built if not yet, or 0 if it
+     *          could not be built.
+     */
+    GLuint program( const int effect, const bool useLight );
+
+    /** @brief sets up an attribute of the interleaved vertices of 8 floats.
+     *
+     *  @param offset (in): in floats.
+     */
+    void enableAttribute( const GLuint slot, const GLint size, const long offset );
+
     GLuint mVertexBuffer;
     GLuint mVertexArray;
     GLuint mIndexBuffer;
+    GLuint mUniformBuffer;
 
     GLuint mTextureObjectName;
-    GLuint mTextureUniform;
     GLint  mTextureActiveNum;
 
-    GLuint mUniformP;
-    GLuint mUniformM;
-    GLuint mUniformV;
-    GLuint mUniformLightWCS;
+    bool   mMultiChannel;
+    bool   mPackedChannels;
 
-    GLuint mUniformLowThreshold;
-    GLuint mUniformHighThreshold;
-    GLuint mUniformSmoothing;
-    GLuint mUniformEffect;
-    GLuint mUniformUseLight;
-    GLuint mUniformBaseColor;
-    GLuint mUniformBorderColor;
+    DrawParams   mDrawParams;
+    bool         mDrawParamsValid;
+    GLStateCache mStateCache;
 
-    GLuint mVertexSlot;
-    GLuint mNormalSlot;
-    GLuint mTexCoordSlot;
+    /** @brief by the effect and the lighting. 0 if not built yet. */
+    GLuint mPrograms[ NumEffectVariants ][ 2 ];
+    long   mNumVariantsLoaded;
 
+    /** @brief the sources below are prefixed with it and the defines. */
+    static const char* VERSION_STR;
     static const char* VERTEX_STR;
     static const char* FRAGMENT_STR;
 };
@@ -3,6 +3,7 @@
 precision mediump float;
 
 in vec2 texCoordOut;
+flat in int textureChannel;
 in vec3 vertexWCS;
 in vec3 normalECS;
 in vec3 vertexToEyeECS;
@@ -11,101 +12,159 @@ in vec3 vertexToLightECS;
 out vec4 color;
 
 uniform sampler2D fontTexture;
-uniform int       effect;
-uniform bool      useLight;
-uniform float     lowThreshold;
-uniform float     highThreshold;
-uniform float     smoothing;
-uniform vec3      baseColor;
-uniform vec3      borderColor;
+
+layout(std140) uniform DrawParams {
+    mat4  P;
+    mat4  M;
+    mat4  V;
+    vec4  lightWCS;
+    vec4  baseColor;
+    vec4  borderColor;
+    int   effect;
+    int   useLight;
+    float lowThreshold;
+    float highThreshold;
+    float smoothing;
+    int   multiChannel;
+    int   packedChannels;
+};
+
+#ifdef EFFECT
+  #define SELECTED_EFFECT EFFECT
+#else
+  #define SELECTED_EFFECT effect
+#endif
+
+#ifdef USE_LIGHT
+  #define SELECTED_USE_LIGHT ( USE_LIGHT != 0 )
+#else
+  #define SELECTED_USE_LIGHT ( useLight != 0 )
+#endif
+
+#ifdef MULTI_CHANNEL
+  #define SELECTED_MULTI_CHANNEL ( MULTI_CHANNEL != 0 )
+#else
+  #define SELECTED_MULTI_CHANNEL ( multiChannel != 0 )
+#endif
+
+#ifdef PACKED_CHANNELS
+  #define SELECTED_PACKED_CHANNELS ( PACKED_CHANNELS != 0 )
+#else
+  #define SELECTED_PACKED_CHANNELS ( packedChannels != 0 )
+#endif
+
+float median( float r, float g, float b ) {
+
+    return max( min( r, g ), min( max( r, g ), b ) );
+}
+
+// The signed distance is the median of the three channels
+// for the multi-channel texture, and the channel of the glyph
+// for the packed texture.
+float sampleDistance( vec2 uv ) {
+
+    if ( SELECTED_PACKED_CHANNELS ) {
+
+        return texture( fontTexture, uv )[ textureChannel ];
+    }
+
+    vec3 s = texture( fontTexture, uv ).rgb;
+
+    if ( SELECTED_MULTI_CHANNEL ) {
+
+        return median( s.r, s.g, s.b );
+    }
+    return s.r;
+}
+
 
 void main (void) {
 
-    if ( effect == 0 ) {
+    if ( SELECTED_EFFECT == 0 ) {
 
         // Raw output with interpolation.
 
-        color.rgb = baseColor;
-        color.a   = texture( fontTexture, texCoordOut ).r;
+        color.rgb = baseColor.rgb;
+        color.a   = sampleDistance( texCoordOut );
     }
-    else if ( effect == 1 ) {
+    else if ( SELECTED_EFFECT == 1 ) {
 
         // Softened edge.
 
-        color.rgb = baseColor;
-        color.a   = smoothstep( 0.5 - smoothing,
-                                0.5 + smoothing, 
-                                texture( fontTexture, texCoordOut ).r );
+        color.rgb = baseColor.rgb;
+        color.a   = smoothstep( lowThreshold - smoothing,
+                                highThreshold + smoothing,
+                                sampleDistance( texCoordOut ) );
     }
-    else if ( effect == 2 ) {
+    else if ( SELECTED_EFFECT == 2 ) {
 
         // Sharp edge.
 
-        float alpha = texture(fontTexture, texCoordOut).r;
+        float alpha = sampleDistance( texCoordOut );
 
         if ( alpha >= lowThreshold ) {
 
-            color.rgb = baseColor;
+            color.rgb = baseColor.rgb;
             color.a   = 1.0;
         }
         else {
 
-            color.rgb = baseColor;
+            color.rgb = baseColor.rgb;
             color.a   = 0.0;
         }
     }
-    else if ( effect == 3 ) {
+    else if ( SELECTED_EFFECT == 3 ) {
 
         // Sharp edge with outer glow.
 
-        float alpha = texture(fontTexture, texCoordOut).r;
+        float alpha = sampleDistance( texCoordOut );
 
         if ( alpha >= lowThreshold ) {
 
-            color.rgb = baseColor;
+            color.rgb = baseColor.rgb;
             color.a   = 1.0;
         }
         else {
 
-            color.rgb = borderColor;
+            color.rgb = borderColor.rgb;
             color.a   = alpha;
         }
-    }        
-    else if ( effect == 4 ) {
+    }
+    else if ( SELECTED_EFFECT == 4 ) {
 
         // With border.
 
-        float alpha = texture(fontTexture, texCoordOut).r;
+        float alpha = sampleDistance( texCoordOut );
 
         if ( alpha >= lowThreshold && alpha <= highThreshold ) {
 
-            color.rgb = borderColor;
+            color.rgb = borderColor.rgb;
             color.a   = 1.0;
         }
         else if ( alpha >= highThreshold ) {
 
-            color.rgb = baseColor;
+            color.rgb = baseColor.rgb;
             color.a   = 1.0;
         }
         else {
 
-            color.rgb = baseColor;
+            color.rgb = baseColor.rgb;
             color.a = 0.0;
         }
     }
-    else if ( effect == 5 ) {
+    else if ( SELECTED_EFFECT == 5 ) {
         // Softened edge.
-        float alpha = texture(fontTexture, texCoordOut).r;
-        color.rgb = baseColor;
+        float alpha = sampleDistance( texCoordOut );
+        color.rgb = baseColor.rgb;
 
         if ( alpha < 0.5) {
             color.a = smoothstep( 0.5 - smoothing,
                                   0.5 + smoothing, 
-                                  alpha            ); 
-        }                               
+                                  alpha            );
+        }
         else {
             color.a = 0.5 -  smoothstep( 0.5 - smoothing,
-                                         0.5 + smoothing, 
+                                         0.5 + smoothing,
                                          0.75 * alpha     ); 
         }
     }
@@ -113,16 +172,15 @@ void main (void) {
 
         // Rect box for debugging
 
-        color.rgb = baseColor;
+        color.rgb = baseColor.rgb;
         color.a   = 1.0;
 
     }
 
-    float dist = distance( vertexToLightECS, vec3( 0.0, 0.0, 0.0 ) );
+    if ( SELECTED_USE_LIGHT ) {
 
-    if ( useLight ) {
+        float dist = distance( vertexToLightECS, vec3( 0.0, 0.0, 0.0 ) );
 
         color.rgb = color.rgb / sqrt(dist);
     }
 }
-
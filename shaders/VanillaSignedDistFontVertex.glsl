@@ -1,16 +1,28 @@
 #version 330 core
 
-in vec3 vertexLCS;
-in vec3 normalLCS;
-in vec2 texCoordIn;
-
-uniform mat4 P;
-uniform mat4 M;
-uniform mat4 V;
-uniform vec3 lightWCS;
+layout(location = 0) in vec3 vertexLCS;
+layout(location = 1) in vec3 normalLCS;
+layout(location = 2) in vec2 texCoordIn;
+
+layout(std140) uniform DrawParams {
+    mat4  P;
+    mat4  M;
+    mat4  V;
+    vec4  lightWCS;
+    vec4  baseColor;
+    vec4  borderColor;
+    int   effect;
+    int   useLight;
+    float lowThreshold;
+    float highThreshold;
+    float smoothing;
+    int   multiChannel;
+    int   packedChannels;
+};
 
 out vec3 vertexWCS;
 out vec2 texCoordOut;
+flat out int textureChannel;
 out vec3 normalECS;
 out vec3 vertexToEyeECS;
 out vec3 vertexToLightECS;
@@ -20,11 +32,15 @@ void main() {
 
     mat4 MV  = V * M;
 
-    mat4 MVP = P * MV;   
+    mat4 MVP = P * MV;
 
     gl_Position      = ( MVP * vec4( vertexLCS, 1.0 ) );
 
-    texCoordOut      = texCoordIn;
+    // The channel of the packed texture is in the integer part of
+    // the texture coordinate X, offset by 2 per channel.
+    textureChannel   = int( floor( ( texCoordIn.x + 0.5 ) / 2.0 ) );
+
+    texCoordOut      = vec2( texCoordIn.x - 2.0 * float( textureChannel ), texCoordIn.y );
 
     vertexWCS        = ( M   * vec4( vertexLCS, 1.0 ) ).xyz;
 
@@ -32,7 +48,7 @@ void main() {
 
     normalECS        = ( MV  * vec4( normalLCS, 0.0 ) ).xyz;
 
-    vec3 lightECS    = ( V   * vec4( lightWCS,  1.0 ) ).xyz;
+    vec3 lightECS    = ( V   * vec4( lightWCS.xyz, 1.0 ) ).xyz;
 
     vertexToEyeECS   = vec3(0,0,0) - vertexECS;
 
@@ -2,6 +2,8 @@
 #include "sdfont/generator/generator_option_parser.hpp"
 #include "sdfont/generator/generator_config.hpp"
 #include "sdfont/generator/generator.hpp"
+#include "sdfont/generator/batch_generator.hpp"
+#include "sdfont/generator/generator_service.hpp"
 
 using namespace std;
 
@@ -11,8 +13,119 @@ using namespace std;
  *  @brief command line tool to invoke SDFont::Generator
  */
 
+static const string BatchUsage = "Usage: "
+                                 "sdfont_commandline "
+                                 "-batch [ManifestPath] "
+                                 "-num_workers [num] "
+                                 "-verbose "
+                                 "\n";
+
+/** @brief runs the jobs in the manifest with SDFont::BatchGenerator.
+ *
+ *  @return exit status.
+ */
+static int runBatch( int argc, char* argv[] )
+{
+    string manifestPath;
+    long   numWorkers = 0;
+    bool   verbose    = false;
+
+    for ( auto i = 1; i < argc; i++ ) {
+
+        const string arg( argv[i] );
+
+        if ( arg == "-batch" && i < argc - 1 ) {
+
+            manifestPath = argv[++i];
+        }
+        else if ( arg == "-num_workers" && i < argc - 1 ) {
+
+            numWorkers = atoi( argv[++i] );
+        }
+        else if ( arg == "-verbose" ) {
+
+            verbose = true;
+        }
+        else {
+            cerr << BatchUsage;
+            return 1;
+        }
+    }
+
+    SDFont::BatchGenerator batch( numWorkers, verbose );
+
+    if ( !batch.loadManifest( manifestPath ) ) {
+
+        cerr << BatchUsage;
+        return 1;
+    }
+
+    const bool res = batch.run();
+
+    batch.emitSummary( cout );
+
+    return res ? 0 : 1;
+}
+
+
+static const string ServeUsage = "Usage: "
+                                 "sdfont_commandline "
+                                 "-serve [SocketPath] "
+                                 "-verbose "
+                                 "\n";
+
+/** @brief serves the requests with SDFont::GeneratorService until it is
+ *         shut down by a client.
+ *
+ *  @return exit status.
+ */
+static int runService( int argc, char* argv[] )
+{
+    string socketPath;
+    bool   verbose = false;
+
+    for ( auto i = 1; i < argc; i++ ) {
+
+        const string arg( argv[i] );
+
+        if ( arg == "-serve" && i < argc - 1 ) {
+
+            socketPath = argv[++i];
+        }
+        else if ( arg == "-verbose" ) {
+
+            verbose = true;
+        }
+        else {
+            cerr << ServeUsage;
+            return 1;
+        }
+    }
+
+    SDFont::GeneratorService service( socketPath, verbose );
+
+    if ( !service.run() ) {
+
+        cerr << ServeUsage;
+        return 1;
+    }
+
+    return 0;
+}
+
+
 int main ( int argc, char* argv[] )
 {
+    if ( argc > 1 && string( argv[1] ) == "-batch" ) {
+
+        return runBatch( argc, argv );
+    }
+
+    if ( argc > 1 && string( argv[1] ) == "-serve" ) {
+
+        return runService( argc, argv );
+    }
+
     auto time_begin = std::chrono::high_resolution_clock::now();
 
     SDFont::GeneratorConfig conf;
@@ -39,7 +152,13 @@ int main ( int argc, char* argv[] )
         exit(1);
     }
 
-    res = generator.emitFilePNG();
+    if ( conf.outputFormat() == SDFont::GeneratorConfig::OutputFormatPNG ) {
+
+        res = generator.emitFilePNG();
+    }
+    else {
+        res = generator.emitFileKTX2();
+    }
 
     if ( !res ) {
 
@@ -55,6 +174,17 @@ int main ( int argc, char* argv[] )
         exit(1);
     }
 
+    if ( conf.isEmitHeaderSet() ) {
+
+        res = generator.emitFileHeader();
+
+        if ( !res ) {
+
+            cerr << parser.Usage;
+            exit(1);
+        }
+    }
+
     auto time_end = std::chrono::high_resolution_clock::now();
 
     if ( parser.hasVerbose() ) {
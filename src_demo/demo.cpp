@@ -7,6 +7,7 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <filesystem>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
@@ -20,10 +21,9 @@
 #include "sdfont/runtime_helper/metrics_parser.hpp"
 #include "sdfont/runtime_helper/texture_loader.hpp"
 #include "sdfont/runtime_helper/runtime_helper.hpp"
+#include "sdfont/runtime_helper/paragraph_layouter.hpp"
 #include "sdfont/runtime_helper/vanilla_shader_manager.hpp"
 
-#include "utfcpp/utf8.h"
-
 using namespace std;
 
 /** @file sdfont_demo.cpp
@@ -37,38 +37,49 @@ using namespace std;
  *    GLM
  */
 
-static size_t splitLine(
-    const string&   txt,
-    vector<string>& strs,
-    char            ch
+/** @brief lays out the lines of the text justified to the width, or to the
+ *         longest line if it does not fit, as each line of the crawl is
+ *         given with a hard break.
+ */
+static void layoutJustified(
+    SDFont::ParagraphLayouter& layouter,
+    const string&              str,
+    const float                width,
+    const float                lineSpacing
 ) {
+    layouter.setText( str );
 
-    auto   pos        = txt.find( ch );
-    size_t initialPos = 0;
+    float maxWidth = width;
 
-    strs.clear();
+    for ( auto& line : layouter.lines() ) {
 
-    while( pos != std::string::npos && initialPos < txt.size() ) {
+        maxWidth = std::max( maxWidth, line.mNaturalWidth );
+    }
 
-        if ( pos > initialPos ) {
+    layouter.setAlignment  ( SDFont::ParagraphLayouter::ALIGN_JUSTIFY_ALL );
+    layouter.setLineSpacing( lineSpacing );
+    layouter.setWidth      ( maxWidth );
+}
 
-            strs.push_back( txt.substr( initialPos, pos - initialPos ) );
-        }
 
-        initialPos = pos + 1;
+/** @brief lays out a line with the spaces stretched to the ratio of the
+ *         sum of the widths of the words.
+ */
+static void layoutStretched(
+    SDFont::ParagraphLayouter& layouter,
+    const string&              str,
+    const float                ratio
+) {
+    layouter.setText( str );
 
-        if ( initialPos < txt.size() ) {
+    float sum = 0.0;
 
-            pos = txt.find( ch, initialPos );
-        }
+    for ( auto& word : layouter.words() ) {
 
+        sum += word.mWidth;
     }
 
-    if ( initialPos < txt.size() ) {
-
-        strs.push_back( txt.substr( initialPos, txt.size() - initialPos) );
-    }
-    return strs.size();
+    layoutJustified( layouter, str, sum * ratio, 1.0 );
 }
 
 
@@ -467,342 +478,6 @@ class DeltaTime {
 };
 
 
-class Word {
-
-  public:
-    Word(
-        SDFont::RuntimeHelper& helper, 
-        const string           str, 
-        const float            fontSize, 
-        const float            spreadRatio,
-        const float            letterSpacing
-    ):
-        mHelper        (helper),
-        mString        (str),
-        mLeftX         (0.0),
-        mBaselineY     (0.0),
-        mWidth         (0.0),
-        mHeight        (0.0),
-        mAboveBaselineY(0.0),
-        mBelowBaselineY(0.0),
-        mFontSize      (fontSize),
-        mLetterSpacing (letterSpacing),
-        mSpreadRatio   (spreadRatio),
-        mZ             (0.0)
-    {
-        vector< uint32_t > unicodeSequence;
-        auto* c_str = str.c_str();
-
-        utf8::utf8to32( c_str, c_str + strlen( c_str ), back_inserter( unicodeSequence ) );
-
-        mHelper.getGlyphOriginsWidthAndHeight(
-
-            unicodeSequence,
-            -1,
-            mFontSize,
-            mLetterSpacing,
-            mLeftX,
-            mBaselineY,
-            mGlyphs,
-            mGlyphOrigins,
-            mWidth,
-            mHeight,
-            mAboveBaselineY,
-            mBelowBaselineY
-        );
-    }
-
-    long len() const { return mGlyphs.size(); }
-
-    float width() const {return mWidth; }
-
-    float bearingY() const {return mAboveBaselineY; }
-
-    float belowBaselineY() const {return mBelowBaselineY; }
-
-    float advanceY() const {return mGlyphs[0]->mVerticalAdvance * mFontSize; }
-
-    void setPos( const float leftX, const float baselineY ) {
-        mLeftX = leftX;
-        mBaselineY = baselineY;
-        for ( auto& origin: mGlyphOrigins ) {
-            origin.mX += leftX;
-            origin.mY += baselineY;
-        }
-    }
-
-    void generateElements(float* elements, GLuint* indices, long startIndex) {
-
-        vector< SDFont::GlyphBound > bounds;
-
-        mHelper.getBoundingBoxes(
-            mFontSize,
-            mSpreadRatio,
-            mGlyphs,
-            mGlyphOrigins,
-            bounds
-        );
-
-        mHelper.generateOpenGLDrawElements (
-            bounds,
-            mZ,
-            &( elements[   SDFont::RuntimeHelper::NUM_FLOATS_PER_GLYPH
-                         * startIndex                                   ] ) ,
-            SDFont::RuntimeHelper::NUM_POINTS_PER_GLYPH * startIndex,
-            & ( indices[   SDFont::RuntimeHelper::NUM_INDICES_PER_GLYPH
-                         * startIndex                                   ] )
-        );
-    }
-
-    ~Word() {;}
-
-    SDFont::RuntimeHelper&   mHelper;
-    string                   mString;
-    float                    mWidth;
-    float                    mHeight;
-    float                    mAboveBaselineY;
-    float                    mBelowBaselineY;
-    vector< const SDFont::Glyph* > mGlyphs;
-    vector< SDFont::Point2D> mGlyphOrigins;
-    float                    mLeftX;
-    float                    mBaselineY;
-    float                    mFontSize;
-    float                    mLetterSpacing;
-    float                    mSpreadRatio;
-    float                    mZ;
-};
-
-
-class Line {
-
-  public:
-
-    Line(SDFont::RuntimeHelper& helper, string str, float fontSize, float spreadRatio ) :
-        mHelper ( helper ),
-        mWidth  ( 1.0    )
-    {
-
-        vector<string> strs;
-
-        splitLine( str, strs, ' ' );
-        for (auto& s : strs) {
-            mWords.emplace_back(helper, s, fontSize, spreadRatio, 1.0 );
-        }
-    }
-
-    virtual ~Line(){;}
-
-    vector<Word>& words() { return mWords; }
-
-    long len() const { 
-        long sum = 0;
-        for ( auto& w : mWords ) {
-            sum += w.len();
-        }
-        return sum;
-    }
-
-    float bearingY() const {
-
-        float maxBearingY = 0.0;
-        for ( auto& w : mWords ) {
-            maxBearingY = std::max(maxBearingY, w.bearingY());
-        }
-        return maxBearingY;
-    }
-
-    float belowBaselineY() const {
-
-        float maxBelowBaselineY = 0.0;
-        for ( auto& w : mWords ) {
-            maxBelowBaselineY = std::max(maxBelowBaselineY,w.belowBaselineY());
-        }
-        return maxBelowBaselineY;
-    }
-
-    float advanceY() const {
-
-        float maxAdvanceY = 0.0;
-        for ( auto& w : mWords ) {
-            maxAdvanceY = std::max( maxAdvanceY, w.advanceY() );
-        }
-        return maxAdvanceY;
-    }
-
-    float totalWidth() const {
-
-        float sum = 0.0;
-        for ( auto& w : mWords ) {
-            sum += w.width();
-        }
-        return sum;
-    }
-
-    void setWidth( float w ) { mWidth = w; }
-
-    float width() const { return mWidth; }
-
-    void setPos( float leftX, float baselineY ) {
-        mLeftX     = leftX;
-        mBaselineY = baselineY;
-    }
-
-    void assignPosForWords() {
-
-        auto minWidth = totalWidth();
-        auto margin   = mWidth - minWidth;
-        auto space    = margin / (float)(mWords.size()- 1);
-        auto leftX    = mLeftX;
-        for ( auto& w : mWords ) {
-            w.setPos(leftX, mBaselineY);
-            leftX += ( w.width() + space );
-        }
-
-    }
-
-    void generateElements(float* elements, GLuint* indices, long startIndex) {
-        
-        for ( auto& w : mWords ) {
-
-            w.generateElements ( elements, indices, startIndex );
-            startIndex += w.len();
-        }
-    }
-
-  private:
-
-    SDFont::RuntimeHelper& mHelper;    
-    float                  mLeftX;
-    float                  mBaselineY;
-    float                  mWidth;
-    vector<Word>           mWords;
-};
-
-
-class Paragraph {
-
-  public:
-
-    Paragraph(SDFont::RuntimeHelper& helper, string str, float fontSize, float spreadRatio) :
-        mHelper ( helper ),
-        mWidth  ( 1.0    )
-    {
-
-        vector<string> strs;
-
-        splitLine( str, strs, '\n' );
-        for (auto& s : strs) {
-            mLines.emplace_back(helper, s, fontSize, spreadRatio);
-        }
-    }
-
-    virtual ~Paragraph(){;}
-
-    vector<Line>& lines() { return mLines; }
-
-    long len() const { 
-        long sum = 0;
-        for ( auto& line : mLines ) {
-            sum += line.len();
-        }
-        return sum;
-    }
-
-    float maxWidth() const {
-
-        float width = 0.0;
-
-        for ( auto& line : mLines ) {
-
-            width = std::max ( width, line.totalWidth() );
-        }
-        return width;
-    }
-
-
-    void setWidth( float w ) { 
-
-        mWidth = w;
-        for ( auto& line : mLines ) {
-
-            line.setWidth( w );
-        }
-    }
-
-    float width() const { return mWidth; }
-
-    void setPos( float leftX, float bottomBaselineY ) {
-        mLeftX           = leftX;
-        mBottomBaselineY = bottomBaselineY;
-    }
-
-
-    float totalHeight() {   
-
-        float sum = 0.0;
-
-        sum += mLines[0].bearingY();
-
-        for ( auto i = 0; i < ( mLines.size() - 1 ) ; i++ ) {
-
-            sum += mLines[ i ].advanceY();
-        }
-        sum += mLines[ mLines.size() - 1 ].belowBaselineY();
-
-        mMinHeight = sum;
-        return sum;
-
-    }
-
-    void setHeight(float h) { mHeight = h; }
-
-    float height() { return mHeight; }
-
-    void assignPosForWords() {
-
-        float scale        = mHeight / mMinHeight;
-        float curBaselineY = mBottomBaselineY;
-
-        for ( auto i = mLines.size() - 1 ; i > 0 ; i-- ) {
-
-            auto& line = mLines[i];
-
-            line.setPos( mLeftX, curBaselineY ) ;
-            line.assignPosForWords() ;
-
-            auto& prevLine = mLines[ i - 1 ];
-
-            curBaselineY += ( prevLine.advanceY() * scale );
-            
-        }
-
-        mLines[0].setPos( mLeftX, curBaselineY ) ;
-        mLines[0].assignPosForWords() ;
-    }
-
-    void generateElements(float* elements, GLuint* indices, long startIndex) {
-        
-        for ( auto& line : mLines ) {
-
-            line.generateElements ( elements, indices, startIndex );
-            startIndex += line.len();
-        }
-    }
-
-  private:
-
-    SDFont::RuntimeHelper& mHelper;    
-    float                  mLeftX;
-    float                  mBottomBaselineY;
-    float                  mWidth;
-    float                  mHeight;
-    float                  mMinHeight;
-    vector<Line>           mLines;
-
-};
-
-
-
 class SequenceElement {
 
   public:
@@ -850,6 +525,24 @@ class SequenceElement {
 
     }
 
+    /** @brief copies the draw elements of the layouter to the glyphs from
+     *         startIndex.
+     */
+    void copyElements( const SDFont::ParagraphLayouter& layouter, const long startIndex ) {
+
+        const auto& vertices = layouter.vertices();
+        const auto& indices  = layouter.indices();
+
+        std::copy( vertices.begin(), vertices.end(),
+                   &( mGLattr[ SDFont::RuntimeHelper::NUM_FLOATS_PER_GLYPH * startIndex ] ) );
+
+        for ( size_t i = 0; i < indices.size(); i++ ) {
+
+            mGLindices[ SDFont::RuntimeHelper::NUM_INDICES_PER_GLYPH * startIndex + i ]
+                = indices[ i ] + SDFont::RuntimeHelper::NUM_POINTS_PER_GLYPH * startIndex;
+        }
+    }
+
     void draw() {
         mShader.draw(
             mGLattr ,
@@ -901,23 +594,21 @@ class SeqPrologue :public SequenceElement {
     ) : SequenceElement( helper, shader )
     {
 
-        Line line1 ( mHelper, mStr1, fontSize, spreadRatio );
-        Line line2 ( mHelper, mStr2, fontSize, spreadRatio );
+        SDFont::ParagraphLayouter line1 ( mHelper, fontSize, spreadRatio );
+        SDFont::ParagraphLayouter line2 ( mHelper, fontSize, spreadRatio );
 
-        mNumElements = line1.len() + line2.len();
+        layoutStretched( line1, mStr1, 1.2 );
+        layoutStretched( line2, mStr2, 1.1 );
 
-        line1.setWidth( line1.totalWidth() * 1.2 );
-        line2.setWidth( line2.totalWidth() * 1.1 );
+        mNumElements = line1.numSlots() + line2.numSlots();
 
         allocAttrIndices();
 
-        line1.setPos( -0.5 * line1.width(), +0.5 * line1.advanceY());
-        line1.assignPosForWords();
-        line1.generateElements( mGLattr, mGLindices, 0 );
+        line1.setPosition( -0.5 * line1.width(), +0.5 * line1.lineAdvance() );
+        line2.setPosition( -0.5 * line1.width(), -0.5 * line2.lineAdvance() );
 
-        line2.setPos( -0.5 * line1.width(), -0.5 * line2.advanceY());
-        line2.assignPosForWords();
-        line2.generateElements( mGLattr, mGLindices, line1.len() );
+        copyElements( line1, 0 );
+        copyElements( line2, line1.numSlots() );
 
         mEffect         = 1;
         mLightingEffect = false;
@@ -989,23 +680,21 @@ class SeqTitle :public SequenceElement {
     ) : SequenceElement( helper, shader )
     {
 
-        Line line1 ( mHelper, mStr1, fontSize, spreadRatio );
-        Line line2 ( mHelper, mStr2, fontSize, spreadRatio );
+        SDFont::ParagraphLayouter line1 ( mHelper, fontSize, spreadRatio );
+        SDFont::ParagraphLayouter line2 ( mHelper, fontSize, spreadRatio );
 
-        mNumElements = line1.len() + line2.len();
+        layoutStretched( line1, mStr1, 1.0 );
+        layoutStretched( line2, mStr2, 1.0 );
 
-        line1.setWidth( line1.totalWidth() * 1.0 );
-        line2.setWidth( line2.totalWidth() * 1.0 );
+        mNumElements = line1.numSlots() + line2.numSlots();
 
         allocAttrIndices();
 
-        line1.setPos( -0.5 * line1.width(), +0.5 * line1.advanceY());
-        line1.assignPosForWords();
-        line1.generateElements( mGLattr, mGLindices, 0 );
+        line1.setPosition( -0.5 * line1.width(), +0.5 * line1.lineAdvance() );
+        line2.setPosition( -0.5 * line2.width(), -0.5 * line2.lineAdvance() );
 
-        line2.setPos( -0.5 * line2.width(), -0.5 * line2.advanceY());
-        line2.assignPosForWords();
-        line2.generateElements( mGLattr, mGLindices, line1.len() );
+        copyElements( line1, 0 );
+        copyElements( line2, line1.numSlots() );
 
         mEffect         = 5;
         mLightingEffect = false;
@@ -1085,52 +774,42 @@ class SeqMainRoll :public SequenceElement {
     ) : SequenceElement( helper, shader )
     {
 
-        Line      line1 ( mHelper, mEpisode   , fontSize, spreadRatio );
-        Line      line2 ( mHelper, mTitle     , fontSize, spreadRatio );
-        Paragraph para1 ( mHelper, mParagraph1, fontSize, spreadRatio );
-        Paragraph para2 ( mHelper, mParagraph2, fontSize, spreadRatio );
-        Paragraph para3 ( mHelper, mParagraph3, fontSize, spreadRatio );
-
-        mNumElements =   line1.len() + line2.len()
-                       + para1.len() + para2.len() + para3.len();
+        SDFont::ParagraphLayouter line1 ( mHelper, fontSize, spreadRatio );
+        SDFont::ParagraphLayouter line2 ( mHelper, fontSize, spreadRatio );
+        SDFont::ParagraphLayouter para1 ( mHelper, fontSize, spreadRatio );
+        SDFont::ParagraphLayouter para2 ( mHelper, fontSize, spreadRatio );
+        SDFont::ParagraphLayouter para3 ( mHelper, fontSize, spreadRatio );
 
-        line1.setWidth( line1.totalWidth() * 1.2 );
-        line2.setWidth( line2.totalWidth() * 1.1 );
-
-        allocAttrIndices();
-        
-        line1.setPos( -0.5 * line1.width(), +0.5 * line1.advanceY());
-        line1.assignPosForWords();
-        line1.generateElements( mGLattr, mGLindices, 0 );
+        layoutStretched( line1, mEpisode, 1.2 );
+        layoutStretched( line2, mTitle,   1.1 );
 
-        line2.setPos( -0.5 * line2.width(), -1.2 * line2.advanceY());
-        line2.assignPosForWords();
-        line2.generateElements( mGLattr, mGLindices, line1.len() );
+        layoutJustified( para1, mParagraph1, 2.0, 1.2 );
+        layoutJustified( para2, mParagraph2, 2.0, 1.2 );
+        layoutJustified( para3, mParagraph3, 2.0, 1.2 );
 
-        para1.setWidth(2.0);
-        para2.setWidth(2.0);
-        para3.setWidth(2.0);
+        mNumElements =   line1.numSlots() + line2.numSlots()
+                       + para1.numSlots() + para2.numSlots() + para3.numSlots();
 
-        para1.setHeight( para1.totalHeight() * 1.2 );
-        para2.setHeight( para2.totalHeight() * 1.2 );
-        para3.setHeight( para3.totalHeight() * 1.2 );
+        allocAttrIndices();
 
-        para1.setPos( -0.5 * para1.width(), -1.2 );
-        para2.setPos( -0.5 * para2.width(), -2.7 );
-        para3.setPos( -0.5 * para3.width(), -4.0 );
+        line1.setPosition( -0.5 * line1.width(), +0.5 * line1.lineAdvance() );
+        line2.setPosition( -0.5 * line2.width(), -1.2 * line2.lineAdvance() );
 
-        para1.assignPosForWords();
-        para2.assignPosForWords();
-        para3.assignPosForWords();
+        // By the bottom baselines.
+        para1.setPosition( -0.5 * para1.width(),
+                           -1.2 + ( para1.lines().size() - 1 ) * para1.lineAdvance() );
+        para2.setPosition( -0.5 * para2.width(),
+                           -2.7 + ( para2.lines().size() - 1 ) * para2.lineAdvance() );
+        para3.setPosition( -0.5 * para3.width(),
+                           -4.0 + ( para3.lines().size() - 1 ) * para3.lineAdvance() );
 
-        para1.generateElements( mGLattr, mGLindices, 
-            line1.len() + line2.len() );
+        long startIndex = 0;
 
-        para2.generateElements( mGLattr, mGLindices, 
-            line1.len() + line2.len() + para1.len() );
+        for ( auto* layouter : { &line1, &line2, &para1, &para2, &para3 } ) {
 
-        para3.generateElements( mGLattr, mGLindices, 
-            line1.len() + line2.len() + para1.len() + para2.len() );
+            copyElements( *layouter, startIndex );
+            startIndex += layouter->numSlots();
+        }
 
         mEffect         = 1;
         mLightingEffect = true;
@@ -1263,11 +942,22 @@ int main( int argc, char* argv[] )
     string baseFilePathWOExt( argv[1] );
     string extTXT(".txt");
     string extPNG(".png");
+    string extKTX2(".ktx2");
+
+    // The compressed texture from -output_format bc4/eac_r11 is preferred.
+    const string texturePath = std::filesystem::exists( baseFilePathWOExt + extKTX2 )
+                               ? baseFilePathWOExt + extKTX2
+                               : baseFilePathWOExt + extPNG ;
 
     SDFont::RuntimeHelper helper ( baseFilePathWOExt + extTXT );
-    SDFont::TextureLoader loader ( baseFilePathWOExt + extPNG );
+    SDFont::TextureLoader loader ( texturePath );
+
+    SDFont::VanillaShaderManager shader ( loader.GLtexture(), 0, loader.numChannels() == 3 );
 
-    SDFont::VanillaShaderManager shader ( loader.GLtexture(), 0 );
+    // The variants used by the sequences below, built before the first frame.
+    shader.prepareVariant( 1, false );
+    shader.prepareVariant( 5, false );
+    shader.prepareVariant( 1, true  );
 
     glfw.configGLFW();
 
@@ -0,0 +1,493 @@
+#include <iostream>
+#include <algorithm>
+
+#include "sdfont/dynamic_atlas/dynamic_glyph_atlas.hpp"
+#include "sdfont/generator/internal_glyph_for_generator.hpp"
+
+namespace SDFont {
+
+DynamicGlyphAtlas::DynamicGlyphAtlas( const GeneratorConfig& conf, const long slotSize ):
+    mConf            ( conf ),
+    mSlotSize        ( slotSize ),
+    mNumSlotsPerEdge ( conf.outputTextureSize() / slotSize ),
+    mOk              ( false ),
+    mGLtexture       ( 0 ),
+    mFtLookupHandle  ( nullptr ),
+    mFtLookupFace    ( nullptr ),
+    mFrame           ( 0 ),
+    mFtGenHandle     ( nullptr ),
+    mFtGenFace       ( nullptr ),
+    mThreadDriver    ( nullptr ),
+    mTerminate       ( false )
+{
+    // Slot 0 is kept empty for the glyphs not in the texture.
+    if ( mNumSlotsPerEdge * mNumSlotsPerEdge < 2 ) {
+
+        cerr << "Texture size too small for the slot size.\n";
+        return;
+    }
+
+    if (    !initializeFreeType( mFtLookupHandle, mFtLookupFace )
+         || !initializeFreeType( mFtGenHandle,    mFtGenFace    )
+         || !findScale()                                           ) {
+        return;
+    }
+
+    mSlots.resize( numSlots() );
+
+    for ( long i = numSlots() - 1; i >= 1; i-- ) {
+
+        mFreeSlots.push_back( i );
+    }
+
+    const long len = textureSize();
+
+    // Zero is the farthest outside, and nothing is drawn.
+    vector< unsigned char > zeros( len * len, 0 );
+
+    glGenTextures( 1, &mGLtexture );
+
+    glBindTexture( GL_TEXTURE_2D, mGLtexture );
+
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_R8, len, len, 0, GL_RED, GL_UNSIGNED_BYTE, zeros.data() );
+
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE );
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE );
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR        );
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR        );
+
+    if ( mConf.numThreads() != 0 ) {
+
+        mThreadDriver = new InternalGlyphThreadDriver( mConf.numThreads() );
+    }
+
+    mWorker = thread( &DynamicGlyphAtlas::generateGlyphs, this );
+
+    mOk = true;
+}
+
+
+DynamicGlyphAtlas::~DynamicGlyphAtlas()
+{
+    {
+        lock_guard< mutex > lock( mMutex );
+        mTerminate = true;
+    }
+    mCondition.notify_all();
+
+    if ( mWorker.joinable() ) {
+
+        mWorker.join();
+    }
+
+    if ( mThreadDriver != nullptr ) {
+
+        delete mThreadDriver;
+    }
+
+    if ( mFtLookupFace != nullptr ) {
+
+        FT_Done_Face( mFtLookupFace );
+    }
+    if ( mFtLookupHandle != nullptr ) {
+
+        FT_Done_FreeType( mFtLookupHandle );
+    }
+    if ( mFtGenFace != nullptr ) {
+
+        FT_Done_Face( mFtGenFace );
+    }
+    if ( mFtGenHandle != nullptr ) {
+
+        FT_Done_FreeType( mFtGenHandle );
+    }
+
+    if ( mGLtexture != 0 ) {
+
+        glDeleteTextures( 1, &mGLtexture );
+    }
+}
+
+
+bool DynamicGlyphAtlas::initializeFreeType( FT_Library& library, FT_Face& face )
+{
+    // The threads have their own library and face, as FreeType objects
+    // must not be used from two threads at the same time.
+    auto ftError = FT_Init_FreeType( &library );
+
+    if ( ftError != FT_Err_Ok ) {
+
+        cerr << "FreeType error: " << ftError << "\n";
+        return false;
+    }
+
+    ftError = FT_New_Face( library, mConf.fontPath().c_str(), 0, &face );
+
+    if ( ftError != FT_Err_Ok ) {
+
+        cerr << "FreeType error: " << ftError << "\n";
+        return false;
+    }
+
+    ftError = FT_Select_Charmap( face, FT_ENCODING_UNICODE );
+
+    if ( ftError != FT_Err_Ok ) {
+
+        cerr << "FreeType error: " << ftError << "\n";
+        return false;
+    }
+
+    ftError = FT_Set_Pixel_Sizes( face, 0, mConf.glyphBitmapSizeForSampling() );
+
+    if ( ftError != FT_Err_Ok ) {
+
+        cerr << "FreeType error: " << ftError << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+bool DynamicGlyphAtlas::findScale()
+{
+    if ( !FT_IS_SCALABLE( mFtLookupFace ) ) {
+
+        cerr << "The font is not scalable.\n";
+        return false;
+    }
+
+    // The largest glyph fits in a slot with the spread around it.
+    const auto& bbox    = mFtLookupFace->bbox;
+    const auto& metrics = mFtLookupFace->size->metrics;
+
+    const float bboxWidth  = FT_MulFix( bbox.xMax - bbox.xMin, metrics.x_scale ) / 64.0f;
+    const float bboxHeight = FT_MulFix( bbox.yMax - bbox.yMin, metrics.y_scale ) / 64.0f;
+
+    const float maxDim = std::max( bboxWidth, bboxHeight )
+                         + 2.0f * mConf.ratioSpreadToGlyph() * mConf.glyphBitmapSizeForSampling();
+
+    mConf.setGlyphScalingFromSamplingToPackedSignedDist( (float)( mSlotSize - 1 ) / maxDim );
+
+    return true;
+}
+
+
+float DynamicGlyphAtlas::spreadInTexture() const
+{
+    return (float)mConf.signedDistExtent() / (float)textureSize();
+}
+
+
+float DynamicGlyphAtlas::spreadInFontMetrics() const
+{
+    return   (float)mConf.signedDistExtent()
+           / mConf.glyphScalingFromSamplingToPackedSignedDist()
+           / (float)mConf.glyphBitmapSizeForSampling();
+}
+
+
+void DynamicGlyphAtlas::setBlankTextureCoords( Glyph& g ) const
+{
+    g.mTextureCoordX = 0.0f;
+    g.mTextureCoordY = 0.0f;
+}
+
+
+const Glyph* DynamicGlyphAtlas::provideGlyph( const uint32_t charCode )
+{
+    if ( !mOk ) {
+
+        return nullptr;
+    }
+
+    auto eit = mEntries.find( charCode );
+
+    if ( eit == mEntries.end() ) {
+
+        Entry e;
+
+        e.mGlyphIndex = FT_Get_Char_Index( mFtLookupFace, charCode );
+        e.mSlot       = NotResident;
+        e.mRequested  = false;
+
+        if (    e.mGlyphIndex != 0
+             && FT_Load_Glyph( mFtLookupFace, e.mGlyphIndex, FT_LOAD_DEFAULT ) == FT_Err_Ok ) {
+
+            // Same metrics as the generator, without the signed distance.
+            InternalGlyphForGen g( mConf, nullptr, e.mGlyphIndex, mFtLookupFace->glyph->metrics, "" );
+
+            e.mGlyph = g.generateSDGlyph();
+
+            setBlankTextureCoords( e.mGlyph );
+
+            // Nothing to draw for the glyphs like the space.
+            if ( e.mGlyph.mWidth <= 0.0f || e.mGlyph.mHeight <= 0.0f ) {
+
+                e.mRequested = true;
+            }
+        }
+        else {
+            e.mGlyphIndex = 0;
+        }
+
+        eit = mEntries.insert( pair( charCode, e ) ).first;
+    }
+
+    auto& e = eit->second;
+
+    if ( e.mGlyphIndex == 0 ) {
+
+        return nullptr;
+    }
+
+    if ( e.mSlot != NotResident ) {
+
+        touchSlot( e.mSlot );
+    }
+    else if ( !e.mRequested ) {
+
+        {
+            lock_guard< mutex > lock( mMutex );
+            mRequests.emplace_back( charCode, e.mGlyphIndex );
+        }
+        mCondition.notify_one();
+
+        e.mRequested = true;
+    }
+
+    return &( e.mGlyph );
+}
+
+
+void DynamicGlyphAtlas::update( const long maxUploads )
+{
+    if ( !mOk ) {
+
+        return;
+    }
+
+    mFrame++;
+
+    {
+        lock_guard< mutex > lock( mMutex );
+
+        while ( !mGenerated.empty() ) {
+
+            mPendingUploads.push_back( std::move( mGenerated.front() ) );
+            mGenerated.pop_front();
+        }
+    }
+
+    long numUploads = 0;
+
+    while ( !mPendingUploads.empty() && numUploads < maxUploads ) {
+
+        const auto& gen = mPendingUploads.front();
+        auto&       e   = mEntries[ gen.mCharCode ];
+
+        if ( gen.mWidth == 0 || e.mSlot != NotResident ) {
+
+            // Failed to generate. It is not requested again.
+            mPendingUploads.pop_front();
+            continue;
+        }
+
+        const long slot = allocateSlot();
+
+        if ( slot == NotResident ) {
+
+            // All the slots are on the screen. Try again next frame.
+            break;
+        }
+
+        uploadToSlot( slot, gen );
+
+        const float fDim  = (float)textureSize();
+        const long  slotX = ( slot % mNumSlotsPerEdge ) * mSlotSize;
+        const long  slotY = ( slot / mNumSlotsPerEdge ) * mSlotSize;
+
+        // Same as InternalGlyphForGen::setBaseXY().
+        e.mGlyph.mTextureCoordX = (float)( slotX + mConf.signedDistExtent() ) / fDim;
+        e.mGlyph.mTextureCoordY = ( (float)( slotY + mConf.signedDistExtent() ) + 0.5f ) / fDim;
+        e.mGlyph.mTextureWidth  = gen.mTextureWidth;
+        e.mGlyph.mTextureHeight = gen.mTextureHeight;
+        e.mSlot                 = slot;
+
+        mSlots[ slot ].mCharCode = gen.mCharCode;
+
+        mPendingUploads.pop_front();
+        numUploads++;
+    }
+}
+
+
+long DynamicGlyphAtlas::allocateSlot()
+{
+    long slot;
+
+    if ( !mFreeSlots.empty() ) {
+
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    else {
+        slot = mSlotsInUse.back();
+
+        // The glyphs used in the last frame are likely on the screen.
+        if ( mSlots[ slot ].mLastUsedFrame + 1 >= mFrame ) {
+
+            return NotResident;
+        }
+
+        auto& evicted = mEntries[ mSlots[ slot ].mCharCode ];
+
+        evicted.mSlot      = NotResident;
+        evicted.mRequested = false;
+        setBlankTextureCoords( evicted.mGlyph );
+
+        mSlotsInUse.pop_back();
+    }
+
+    mSlotsInUse.push_front( slot );
+
+    mSlots[ slot ].mLruPosition   = mSlotsInUse.begin();
+    mSlots[ slot ].mLastUsedFrame = mFrame;
+
+    return slot;
+}
+
+
+void DynamicGlyphAtlas::touchSlot( const long slot )
+{
+    auto& s = mSlots[ slot ];
+
+    if ( s.mLastUsedFrame != mFrame ) {
+
+        mSlotsInUse.splice( mSlotsInUse.begin(), mSlotsInUse, s.mLruPosition );
+        s.mLastUsedFrame = mFrame;
+    }
+}
+
+
+void DynamicGlyphAtlas::uploadToSlot( const long slot, const GeneratedGlyph& gen )
+{
+    // The whole slot is uploaded to clear the previous glyph.
+    vector< unsigned char > texels( mSlotSize * mSlotSize, 0 );
+
+    for ( long y = 0; y < gen.mHeight; y++ ) {
+
+        std::copy( gen.mTexels.begin() + y * gen.mWidth,
+                   gen.mTexels.begin() + ( y + 1 ) * gen.mWidth,
+                   texels.begin() + y * mSlotSize                 );
+    }
+
+    glBindTexture( GL_TEXTURE_2D, mGLtexture );
+
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+    glTexSubImage2D( GL_TEXTURE_2D,
+                     0,
+                     ( slot % mNumSlotsPerEdge ) * mSlotSize,
+                     ( slot / mNumSlotsPerEdge ) * mSlotSize,
+                     mSlotSize,
+                     mSlotSize,
+                     GL_RED,
+                     GL_UNSIGNED_BYTE,
+                     texels.data()                              );
+}
+
+
+void DynamicGlyphAtlas::generateGlyphs()
+{
+    while ( true ) {
+
+        pair< uint32_t, long > request;
+
+        {
+            unique_lock< mutex > lock( mMutex );
+
+            mCondition.wait( lock, [ this ]{ return mTerminate || !mRequests.empty(); } );
+
+            if ( mTerminate ) {
+
+                return;
+            }
+
+            request = mRequests.front();
+            mRequests.pop_front();
+        }
+
+        GeneratedGlyph gen;
+
+        if ( !generateGlyph( request.first, request.second, gen ) ) {
+
+            gen.mCharCode = request.first;
+            gen.mWidth    = 0;
+            gen.mHeight   = 0;
+        }
+
+        lock_guard< mutex > lock( mMutex );
+
+        mGenerated.push_back( std::move( gen ) );
+    }
+}
+
+
+bool DynamicGlyphAtlas::generateGlyph(
+    const uint32_t  charCode,
+    const long      glyphIndex,
+    GeneratedGlyph& gen
+) {
+    auto ftError = FT_Load_Glyph( mFtGenFace, glyphIndex, FT_LOAD_DEFAULT );
+
+    if ( ftError != FT_Err_Ok ) {
+
+        cerr << "FreeType error: " << ftError << "\n";
+        return false;
+    }
+
+    InternalGlyphForGen g( mConf, mThreadDriver, glyphIndex, mFtGenFace->glyph->metrics, "" );
+
+    ftError = FT_Render_Glyph( mFtGenFace->glyph, FT_RENDER_MODE_MONO );
+
+    if ( ftError != FT_Err_Ok ) {
+
+        cerr << "FreeType error: " << ftError << "\n";
+        return false;
+    }
+
+    g.setSignedDist( mFtGenFace->glyph->bitmap );
+
+    // Only for the texture width and height.
+    g.setBaseXY( 0, 0 );
+
+    const auto sdGlyph = g.generateSDGlyph();
+
+    gen.mCharCode      = charCode;
+    gen.mWidth         = std::min( g.signedDistWidth(),  mSlotSize );
+    gen.mHeight        = std::min( g.signedDistHeight(), mSlotSize );
+    gen.mTextureWidth  = sdGlyph.mTextureWidth;
+    gen.mTextureHeight = sdGlyph.mTextureHeight;
+    gen.mTexels.resize( gen.mWidth * gen.mHeight );
+
+    // The rows are flipped such that the first row is at the bottom
+    // as in Generator::generateTexture().
+    for ( long y = 0; y < gen.mHeight; y++ ) {
+
+        const long srcY = g.signedDistHeight() - 1 - y;
+
+        for ( long x = 0; x < gen.mWidth; x++ ) {
+
+            const auto dist = g.signedDist( x, srcY );
+
+            gen.mTexels[ y * gen.mWidth + x ] = (unsigned char)min( 255, max( 0, (int)( dist * 255.0 ) ) );
+        }
+    }
+
+    return true;
+}
+
+} // namespace SDFont
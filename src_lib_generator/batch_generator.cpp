@@ -0,0 +1,335 @@
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <algorithm>
+
+#include "sdfont/generator/batch_generator.hpp"
+#include "sdfont/generator/generator_option_parser.hpp"
+#include "sdfont/generator/generator.hpp"
+
+namespace SDFont {
+
+static long numCores()
+{
+    return std::max( 1L, (long)thread::hardware_concurrency() );
+}
+
+BatchGenerator::BatchGenerator( const long numWorkers, const bool verbose ):
+    mNumWorkers   ( ( numWorkers > 0 ) ? numWorkers : numCores() ),
+    mVerbose      ( verbose ),
+    mFtHandle     ( nullptr ),
+    mThreadDriver ( numCores() ),
+    mNextJob      ( 0 ),
+    mWallTime   ( 0.0 )
+{
+    auto ftError = FT_Init_FreeType( &mFtHandle );
+
+    if ( ftError != FT_Err_Ok ) {
+
+        cerr << "FreeType error: " << ftError << "\n";
+        mFtHandle = nullptr;
+    }
+}
+
+
+BatchGenerator::~BatchGenerator()
+{
+    if ( mFtHandle != nullptr ) {
+
+        FT_Done_FreeType( mFtHandle );
+    }
+}
+
+
+bool BatchGenerator::loadManifest( const string& manifestPath )
+{
+    ifstream is( manifestPath );
+
+    if ( !is ) {
+
+        cerr << "Can not open the manifest [" << manifestPath << "]\n";
+        return false;
+    }
+
+    bool   ok         = true;
+    long   lineNumber = 0;
+    string line;
+
+    while ( getline( is, line ) ) {
+
+        lineNumber++;
+
+        if ( !line.empty() && line[ line.size() - 1 ] == '\r' ) {
+
+            line.erase( line.size() - 1 );
+        }
+
+        const auto pos = line.find_first_not_of( " \t" );
+
+        if ( pos == string::npos || line[ pos ] == '#' ) {
+
+            continue;
+        }
+
+        Job job;
+
+        job.mLineNumber    = lineNumber;
+        job.mLine          = line.substr( pos );
+        job.mOk            = false;
+        job.mNumGlyphs     = 0;
+        job.mWorker        = -1;
+        job.mStartTime     = 0.0;
+        job.mGenerateTime  = 0.0;
+        job.mEmitTime      = 0.0;
+
+        if ( !parseLine( job.mLine, job.mConf ) ) {
+
+            cerr << manifestPath << ":" << lineNumber << ": invalid job [" << job.mLine << "]\n";
+            ok = false;
+            continue;
+        }
+
+        // The glyphs of all the jobs are computed on the shared pool.
+        if ( job.mConf.numThreads() != 0 ) {
+
+            cerr << manifestPath << ":" << lineNumber << ": -num_threads "
+                 << job.mConf.numThreads() << " is ignored. The jobs share a pool of ["
+                 << mThreadDriver.m_num_threads << "] threads.\n";
+
+            job.mConf.setNumThreads( 0 );
+        }
+
+        job.mEstimatedCost = estimateCost( job.mConf );
+
+        mJobs.push_back( job );
+    }
+
+    return ok;
+}
+
+
+bool BatchGenerator::parseLine( const string& line, GeneratorConfig& conf ) const
+{
+    istringstream   is( line );
+    vector< string > args{ "sdfont_commandline" };
+    string          arg;
+
+    while ( is >> arg ) {
+
+        args.push_back( arg );
+    }
+
+    vector< char* > argv;
+
+    for ( auto& a : args ) {
+
+        argv.push_back( &a[0] );
+    }
+
+    GeneratorOptionParser parser( conf );
+
+    return parser.parse( argv.size(), argv.data() ) && !parser.hasHelp();
+}
+
+
+double BatchGenerator::estimateCost( const GeneratorConfig& conf )
+{
+    if ( mFtHandle == nullptr ) {
+
+        return 0.0;
+    }
+
+    FT_Face face;
+    long    numGlyphs;
+
+    {
+        lock_guard< mutex > lock( mFtHandleMutex );
+
+        if ( FT_New_Face( mFtHandle, conf.fontPath().c_str(), 0, &face ) != FT_Err_Ok ) {
+
+            return 0.0;
+        }
+
+        numGlyphs = face->num_glyphs;
+
+        FT_Done_Face( face );
+    }
+
+    // The characters in the corpora are not known until they are scanned.
+    if ( !conf.charCodeRanges().empty() && conf.corpusPaths().empty() ) {
+
+        long numInRanges = 0;
+
+        for ( const auto& range : conf.charCodeRanges() ) {
+
+            numInRanges += range.second - range.first;
+        }
+
+        numGlyphs = std::min( numGlyphs, numInRanges );
+    }
+
+    const double samplingSize = conf.glyphBitmapSizeForSampling();
+
+    return numGlyphs * samplingSize * samplingSize;
+}
+
+
+bool BatchGenerator::run()
+{
+    if ( mFtHandle == nullptr ) {
+
+        return false;
+    }
+
+    mSchedule.clear();
+
+    for ( size_t i = 0; i < mJobs.size(); i++ ) {
+
+        mSchedule.push_back( i );
+    }
+
+    // Longest first, and in the order of the manifest for the same cost.
+    stable_sort( mSchedule.begin(), mSchedule.end(), [ this ]( const size_t a, const size_t b ) {
+
+        return mJobs[ a ].mEstimatedCost > mJobs[ b ].mEstimatedCost;
+    } );
+
+    mNextJob.store( 0 );
+
+    mStartTime = chrono::steady_clock::now();
+
+    vector< thread > workers;
+
+    for ( long i = 0; i < std::min( mNumWorkers, (long)mJobs.size() ); i++ ) {
+
+        workers.emplace_back( &BatchGenerator::runWorker, this, i );
+    }
+
+    for ( auto& t : workers ) {
+
+        t.join();
+    }
+
+    mWallTime = secondsSinceStart();
+
+    for ( const auto& job : mJobs ) {
+
+        if ( !job.mOk ) {
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void BatchGenerator::runWorker( const long workerIndex )
+{
+    while ( true ) {
+
+        const size_t next = mNextJob.fetch_add( 1 );
+
+        if ( next >= mSchedule.size() ) {
+
+            break;
+        }
+
+        auto& job = mJobs[ mSchedule[ next ] ];
+
+        job.mWorker = workerIndex;
+        job.mOk     = runJob( job );
+
+        if ( !job.mOk ) {
+
+            cerr << "Job at line " << job.mLineNumber << " failed [" << job.mLine << "]\n";
+        }
+    }
+}
+
+
+bool BatchGenerator::runJob( Job& job )
+{
+    job.mStartTime = secondsSinceStart();
+
+    Generator generator( job.mConf, mVerbose, mFtHandle, mFtHandleMutex, &mThreadDriver );
+
+    bool res = generator.generate();
+
+    job.mNumGlyphs    = generator.numGlyphs();
+    job.mGenerateTime = secondsSinceStart() - job.mStartTime;
+
+    if ( !res ) {
+
+        return false;
+    }
+
+    if ( job.mConf.outputFormat() == GeneratorConfig::OutputFormatPNG ) {
+
+        res = generator.emitFilePNG();
+    }
+    else {
+        res = generator.emitFileKTX2();
+    }
+
+    res = res && generator.emitFileMetrics();
+
+    if ( job.mConf.isEmitHeaderSet() ) {
+
+        res = res && generator.emitFileHeader();
+    }
+
+    job.mEmitTime = secondsSinceStart() - job.mStartTime - job.mGenerateTime;
+
+    return res;
+}
+
+
+double BatchGenerator::secondsSinceStart() const
+{
+    const chrono::duration< double > d = chrono::steady_clock::now() - mStartTime;
+
+    return d.count();
+}
+
+
+void BatchGenerator::emitSummary( ostream& os ) const
+{
+    double sumOfJobs = 0.0;
+
+    os << "Line\tOutput\tGlyphs\tWorker\tStart[s]\tGenerate[s]\tEmit[s]\tTotal[s]\tStatus\n";
+
+    for ( const auto& job : mJobs ) {
+
+        const double total = job.mGenerateTime + job.mEmitTime;
+
+        sumOfJobs += total;
+
+        os << job.mLineNumber                 << "\t";
+        os << job.mConf.outputFileName()      << "\t";
+        os << job.mNumGlyphs                  << "\t";
+        os << job.mWorker                     << "\t";
+        os << fixed << setprecision( 3 );
+        os << job.mStartTime                  << "\t";
+        os << job.mGenerateTime               << "\t";
+        os << job.mEmitTime                   << "\t";
+        os << total                           << "\t";
+        os << ( job.mOk ? "OK" : "FAILED" )   << "\n";
+        os << defaultfloat;
+    }
+
+    const double utilization = ( mWallTime > 0.0 ) ? sumOfJobs / ( mWallTime * mNumWorkers ) : 0.0;
+
+    os << "Jobs: "              << mJobs.size();
+    os << "  Workers: "         << mNumWorkers;
+    os << "  Threads: "         << mThreadDriver.m_num_threads;
+    os << fixed << setprecision( 3 );
+    os << "  Wall: "            << mWallTime  << "[s]";
+    os << "  Sum of the jobs: " << sumOfJobs  << "[s]";
+    os << setprecision( 1 );
+    os << "  Utilization: "     << utilization * 100.0 << "[%]\n";
+    os << defaultfloat;
+}
+
+} // namespace SDFont
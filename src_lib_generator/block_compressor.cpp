@@ -0,0 +1,469 @@
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+#include "sdfont/generator/block_compressor.hpp"
+
+namespace SDFont {
+
+// Modifier tables shared by EAC R11 and the alpha channel of ETC2.
+static const int EACModifierTable[16][8] = {
+    { -3, -6,  -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5,  -8, -13, 1, 4, 7, 12 },
+    { -2, -4,  -6, -13, 1, 3, 5, 12 },
+    { -3, -6,  -8, -12, 2, 5, 7, 11 },
+    { -3, -7,  -9, -11, 2, 6, 8, 10 },
+    { -4, -7,  -8, -11, 3, 6, 7, 10 },
+    { -3, -5,  -8, -11, 2, 4, 7, 10 },
+    { -2, -6,  -8, -10, 1, 5, 7,  9 },
+    { -2, -5,  -8, -10, 1, 4, 7,  9 },
+    { -2, -4,  -8, -10, 1, 3, 7,  9 },
+    { -2, -5,  -7, -10, 1, 4, 6,  9 },
+    { -3, -4,  -7, -10, 2, 3, 6,  9 },
+    { -1, -2,  -3, -10, 0, 1, 2,  9 },
+    { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+    { -3, -5,  -7,  -9, 2, 4, 6,  8 }
+};
+
+
+static void makePaletteBC4( const int r0, const int r1, int* palette )
+{
+    palette[0] = r0;
+    palette[1] = r1;
+
+    if ( r0 > r1 ) {
+
+        for ( int j = 2; j < 8; j++ ) {
+
+            palette[j] = ( ( 8 - j ) * r0 + ( j - 1 ) * r1 + 3 ) / 7;
+        }
+    }
+    else {
+        for ( int j = 2; j < 6; j++ ) {
+
+            palette[j] = ( ( 6 - j ) * r0 + ( j - 1 ) * r1 + 2 ) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+
+static int decodeEACR11Value( const int base, const int multiplier, const int modifier )
+{
+    const int v = ( multiplier == 0 ) ?   base * 8 + 4 + modifier
+                                      :   base * 8 + 4 + modifier * multiplier * 8;
+
+    return std::max( 0, std::min( 2047, v ) );
+}
+
+
+void BlockCompressor::encodeBlockBC4( const unsigned char* texels, unsigned char* block )
+{
+    int lo = 255;
+    int hi = 0;
+
+#if defined( __SSE2__ )
+
+    const __m128i v = _mm_loadu_si128( reinterpret_cast< const __m128i* >( texels ) );
+
+    __m128i vMin = _mm_min_epu8( v,    _mm_srli_si128( v,    8 ) );
+    __m128i vMax = _mm_max_epu8( v,    _mm_srli_si128( v,    8 ) );
+    vMin         = _mm_min_epu8( vMin, _mm_srli_si128( vMin, 4 ) );
+    vMax         = _mm_max_epu8( vMax, _mm_srli_si128( vMax, 4 ) );
+    vMin         = _mm_min_epu8( vMin, _mm_srli_si128( vMin, 2 ) );
+    vMax         = _mm_max_epu8( vMax, _mm_srli_si128( vMax, 2 ) );
+    vMin         = _mm_min_epu8( vMin, _mm_srli_si128( vMin, 1 ) );
+    vMax         = _mm_max_epu8( vMax, _mm_srli_si128( vMax, 1 ) );
+
+    lo = _mm_cvtsi128_si32( vMin ) & 0xFF;
+    hi = _mm_cvtsi128_si32( vMax ) & 0xFF;
+
+#else
+
+    for ( int i = 0; i < 16; i++ ) {
+
+        lo = std::min( lo, (int)texels[i] );
+        hi = std::max( hi, (int)texels[i] );
+    }
+
+#endif
+
+    block[0] = (unsigned char)hi;
+    block[1] = (unsigned char)lo;
+
+    for ( int i = 2; i < 8; i++ ) {
+        block[i] = 0;
+    }
+
+    if ( hi == lo ) {
+        return;
+    }
+
+    // 8 value mode. The palette entries sorted from lo to hi are the
+    // indices 1, 7, 6, 5, 4, 3, 2, 0. A texel at or above the midpoint
+    // between two consecutive entries takes the upper one.
+    int palette[8];
+    makePaletteBC4( hi, lo, palette );
+
+    static const int levelToIndex[8] = { 1, 7, 6, 5, 4, 3, 2, 0 };
+
+    int thresholds[8];
+    for ( int k = 1; k < 8; k++ ) {
+
+        thresholds[k] = ( palette[ levelToIndex[ k - 1 ] ] + palette[ levelToIndex[ k ] ] + 1 ) / 2;
+    }
+
+    unsigned char levels[16];
+
+#if defined( __SSE2__ )
+
+    // Unsigned comparison by flipping the sign bits.
+    const __m128i bias   = _mm_set1_epi8( (char)0x80 );
+    const __m128i vb     = _mm_xor_si128( v, bias );
+    __m128i       vLevel = _mm_setzero_si128();
+
+    for ( int k = 1; k < 8; k++ ) {
+
+        const __m128i t    = _mm_set1_epi8( (char)( ( thresholds[k] - 1 ) ^ 0x80 ) );
+        const __m128i mask = _mm_cmpgt_epi8( vb, t );
+        vLevel             = _mm_sub_epi8( vLevel, mask );
+    }
+
+    _mm_storeu_si128( reinterpret_cast< __m128i* >( levels ), vLevel );
+
+#else
+
+    for ( int i = 0; i < 16; i++ ) {
+
+        int level = 0;
+        for ( int k = 1; k < 8; k++ ) {
+            if ( texels[i] >= thresholds[k] ) {
+                level++;
+            }
+        }
+        levels[i] = level;
+    }
+
+#endif
+
+    uint64_t bits = 0;
+
+    for ( int i = 0; i < 16; i++ ) {
+
+        bits |= (uint64_t)levelToIndex[ levels[i] ] << ( 3 * i );
+    }
+
+    for ( int i = 0; i < 6; i++ ) {
+
+        block[ 2 + i ] = ( bits >> ( 8 * i ) ) & 0xFF;
+    }
+}
+
+
+void BlockCompressor::decodeBlockBC4( const unsigned char* block, unsigned char* texels )
+{
+    int palette[8];
+    makePaletteBC4( block[0], block[1], palette );
+
+    uint64_t bits = 0;
+
+    for ( int i = 0; i < 6; i++ ) {
+
+        bits |= (uint64_t)block[ 2 + i ] << ( 8 * i );
+    }
+
+    for ( int i = 0; i < 16; i++ ) {
+
+        texels[i] = palette[ ( bits >> ( 3 * i ) ) & 0x7 ];
+    }
+}
+
+
+void BlockCompressor::encodeBlockEACR11( const unsigned char* texels, unsigned char* block )
+{
+    // Targets in the 11-bit range.
+    int targets[16];
+    int lo = 2047;
+    int hi = 0;
+
+    for ( int i = 0; i < 16; i++ ) {
+
+        targets[i] = ( texels[i] * 2047 + 127 ) / 255;
+        lo = std::min( lo, targets[i] );
+        hi = std::max( hi, targets[i] );
+    }
+
+#if defined( __SSE2__ )
+
+    const __m128i t0 = _mm_setr_epi16( targets[0], targets[1], targets[2],  targets[3],
+                                       targets[4], targets[5], targets[6],  targets[7]  );
+    const __m128i t1 = _mm_setr_epi16( targets[8], targets[9], targets[10], targets[11],
+                                       targets[12],targets[13],targets[14], targets[15] );
+#endif
+
+    // Sum of the squared errors of the texels against their nearest entries.
+    auto evaluate = [ & ]( const int table, const int base, const int multiplier ) -> long {
+
+        int palette[8];
+        for ( int j = 0; j < 8; j++ ) {
+            palette[j] = decodeEACR11Value( base, multiplier, EACModifierTable[ table ][ j ] );
+        }
+
+#if defined( __SSE2__ )
+
+        const __m128i zero = _mm_setzero_si128();
+        __m128i       min0 = _mm_set1_epi16( 0x7FFF );
+        __m128i       min1 = _mm_set1_epi16( 0x7FFF );
+
+        for ( int j = 0; j < 8; j++ ) {
+
+            const __m128i p  = _mm_set1_epi16( palette[j] );
+            const __m128i d0 = _mm_sub_epi16( t0, p );
+            const __m128i d1 = _mm_sub_epi16( t1, p );
+            min0 = _mm_min_epi16( min0, _mm_max_epi16( d0, _mm_sub_epi16( zero, d0 ) ) );
+            min1 = _mm_min_epi16( min1, _mm_max_epi16( d1, _mm_sub_epi16( zero, d1 ) ) );
+        }
+
+        const __m128i sq = _mm_add_epi32( _mm_madd_epi16( min0, min0 ), _mm_madd_epi16( min1, min1 ) );
+
+        int32_t lanes[4];
+        _mm_storeu_si128( reinterpret_cast< __m128i* >( lanes ), sq );
+
+        return (long)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+#else
+
+        long sum = 0;
+        for ( int i = 0; i < 16; i++ ) {
+
+            int best = 2048;
+            for ( int j = 0; j < 8; j++ ) {
+                best = std::min( best, std::abs( targets[i] - palette[j] ) );
+            }
+            sum += best * best;
+        }
+        return sum;
+
+#endif
+    };
+
+    int  bestTable      = 0;
+    int  bestBase       = ( lo + hi ) / 16;
+    int  bestMultiplier = 1;
+    long bestError      = -1;
+
+    for ( int table = 0; table < 16; table++ ) {
+
+        const int modMin = EACModifierTable[ table ][ 3 ];
+        const int modMax = EACModifierTable[ table ][ 7 ];
+
+        // Stretch the table over [lo, hi] and try the neighbors of the
+        // quantized base and multiplier.
+        const int mult0 = std::max( 1, std::min( 15,
+                              ( hi - lo + 4 * ( modMax - modMin ) ) / ( 8 * ( modMax - modMin ) ) ) );
+
+        for ( int multiplier = std::max( 1, mult0 - 1 ); multiplier <= std::min( 15, mult0 + 1 ); multiplier++ ) {
+
+            const int center = ( lo + hi ) / 2 - 4 - multiplier * 4 * ( modMax + modMin );
+            const int base0  = std::max( 0, std::min( 255, ( center + 4 ) / 8 ) );
+
+            for ( int base = std::max( 0, base0 - 1 ); base <= std::min( 255, base0 + 1 ); base++ ) {
+
+                const long error = evaluate( table, base, multiplier );
+
+                if ( bestError < 0 || error < bestError ) {
+
+                    bestError      = error;
+                    bestTable      = table;
+                    bestBase       = base;
+                    bestMultiplier = multiplier;
+                }
+            }
+        }
+
+        if ( bestError == 0 ) {
+            break;
+        }
+    }
+
+    uint64_t bits =   ( (uint64_t)bestBase       << 56 )
+                    | ( (uint64_t)bestMultiplier << 52 )
+                    | ( (uint64_t)bestTable      << 48 );
+
+    for ( int i = 0; i < 16; i++ ) {
+
+        int bestIndex = 0;
+        int bestDiff  = 4096;
+
+        for ( int j = 0; j < 8; j++ ) {
+
+            const int diff = std::abs(   targets[i]
+                                       - decodeEACR11Value( bestBase, bestMultiplier, EACModifierTable[ bestTable ][ j ] ) );
+            if ( diff < bestDiff ) {
+                bestDiff  = diff;
+                bestIndex = j;
+            }
+        }
+
+        // The indices are in the column major order.
+        const int x   = i % 4;
+        const int y   = i / 4;
+        const int pos = x * 4 + y;
+
+        bits |= (uint64_t)bestIndex << ( 45 - 3 * pos );
+    }
+
+    for ( int i = 0; i < 8; i++ ) {
+
+        block[i] = ( bits >> ( 56 - 8 * i ) ) & 0xFF;
+    }
+}
+
+
+void BlockCompressor::decodeBlockEACR11( const unsigned char* block, unsigned char* texels )
+{
+    uint64_t bits = 0;
+
+    for ( int i = 0; i < 8; i++ ) {
+
+        bits = ( bits << 8 ) | block[i];
+    }
+
+    const int base       = ( bits >> 56 ) & 0xFF;
+    const int multiplier = ( bits >> 52 ) & 0x0F;
+    const int table      = ( bits >> 48 ) & 0x0F;
+
+    for ( int i = 0; i < 16; i++ ) {
+
+        const int x     = i % 4;
+        const int y     = i / 4;
+        const int pos   = x * 4 + y;
+        const int index = ( bits >> ( 45 - 3 * pos ) ) & 0x7;
+        const int v     = decodeEACR11Value( base, multiplier, EACModifierTable[ table ][ index ] );
+
+        texels[i] = ( v * 255 + 1023 ) / 2047;
+    }
+}
+
+
+void BlockCompressor::compressRowOfBlocks(
+    const unsigned char* src,
+    const long           width,
+    const long           height,
+    const long           blockRow,
+    unsigned char*       dst
+) const {
+
+    const long blocksX = ( width + 3 ) / 4;
+
+    unsigned char texels[16];
+
+    for ( long bx = 0; bx < blocksX; bx++ ) {
+
+        for ( long j = 0; j < 4; j++ ) {
+
+            const long y = std::min( height - 1, blockRow * 4 + j );
+
+            for ( long i = 0; i < 4; i++ ) {
+
+                const long x = std::min( width - 1, bx * 4 + i );
+
+                texels[ j * 4 + i ] = src[ y * width + x ];
+            }
+        }
+
+        auto* block = &dst[ ( blockRow * blocksX + bx ) * BytesPerBlock ];
+
+        if ( mFormat == BC4 ) {
+
+            encodeBlockBC4( texels, block );
+        }
+        else {
+            encodeBlockEACR11( texels, block );
+        }
+    }
+}
+
+
+void BlockCompressor::compress(
+    const unsigned char*     src,
+    const long               width,
+    const long               height,
+    vector< unsigned char >& dst
+) const {
+
+    const long blocksX = ( width  + 3 ) / 4;
+    const long blocksY = ( height + 3 ) / 4;
+
+    dst.assign( blocksX * blocksY * BytesPerBlock, 0 );
+
+    const std::function< void( long ) > rowFunc = [ this, src, width, height, &dst ]( long blockRow ) {
+
+        compressRowOfBlocks( src, width, height, blockRow, dst.data() );
+    };
+
+    if ( mThreadDriver == nullptr ) {
+
+        for ( long by = 0; by < blocksY; by++ ) {
+
+            rowFunc( by );
+        }
+    }
+    else {
+        mThreadDriver->runRows( blocksY, rowFunc );
+    }
+}
+
+
+void BlockCompressor::decompress(
+    const unsigned char*     src,
+    const long               width,
+    const long               height,
+    vector< unsigned char >& dst
+) const {
+
+    const long blocksX = ( width  + 3 ) / 4;
+    const long blocksY = ( height + 3 ) / 4;
+
+    dst.assign( width * height, 0 );
+
+    unsigned char texels[16];
+
+    for ( long by = 0; by < blocksY; by++ ) {
+
+        for ( long bx = 0; bx < blocksX; bx++ ) {
+
+            const auto* block = &src[ ( by * blocksX + bx ) * BytesPerBlock ];
+
+            if ( mFormat == BC4 ) {
+
+                decodeBlockBC4( block, texels );
+            }
+            else {
+                decodeBlockEACR11( block, texels );
+            }
+
+            for ( long j = 0; j < 4; j++ ) {
+
+                for ( long i = 0; i < 4; i++ ) {
+
+                    const long x = bx * 4 + i;
+                    const long y = by * 4 + j;
+
+                    if ( x < width && y < height ) {
+
+                        dst[ y * width + x ] = texels[ j * 4 + i ];
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace SDFont
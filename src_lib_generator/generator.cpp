@@ -1,12 +1,20 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <unordered_map>
 #include <math.h>
 #include <png.h>
 #include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "sdfont/generator/generator.hpp"
 #include "sdfont/generator/png_loader.hpp"
+#include "sdfont/generator/block_compressor.hpp"
+#include "sdfont/generator/utf8_corpus_scanner.hpp"
 #include "sdfont/free_type_utilities.hpp"
 
 namespace SDFont {
@@ -25,12 +33,23 @@ const string Generator::Encoding_adobe_custom   = "adobe_custom";
 const string Generator::Encoding_apple_roman    = "apple_roman";
 const string Generator::Encoding_old_latin_2    = "old_latin_2";
 
+const double Generator::MSDFCornerAngleThreshold = 3.0;
+
 Generator::Generator(GeneratorConfig& conf, bool verbose):
     mConf    ( conf    ),
     mVerbose ( verbose ),
+    mFtHandle( nullptr ),
+    mOwnsFtHandle( true ),
+    mFtHandleMutex( nullptr ),
+    mFontData( nullptr ),
+    mFontDataSize( 0 ),
     mPtrMain ( nullptr ),
     mPtrArray( nullptr ),
-    mThreadDriver( nullptr )
+    mThreadDriver( nullptr ),
+    mOwnsThreadDriver( true ),
+    mCache( nullptr ),
+    mNumGlyphsFromCache( 0 ),
+    mNumEmptyGlyphs( 0 )
 {
     if ( mConf.numThreads() != 0 ) {
 
@@ -39,6 +58,31 @@ Generator::Generator(GeneratorConfig& conf, bool verbose):
 }
 
 
+Generator::Generator(
+    GeneratorConfig&           conf,
+    bool                       verbose,
+    FT_Library                 sharedFtHandle,
+    mutex&                     sharedFtHandleMutex,
+    InternalGlyphThreadDriver* sharedThreadDriver
+):
+    Generator( conf, verbose )
+{
+    mFtHandle      = sharedFtHandle;
+    mOwnsFtHandle  = false;
+    mFtHandleMutex = &sharedFtHandleMutex;
+
+    if ( sharedThreadDriver != nullptr ) {
+
+        if ( mThreadDriver != nullptr ) {
+
+            delete mThreadDriver;
+        }
+        mThreadDriver     = sharedThreadDriver;
+        mOwnsThreadDriver = false;
+    }
+}
+
+
 Generator::~Generator()
 {
     releaseTexture();
@@ -48,10 +92,12 @@ Generator::~Generator()
         delete g;
     }
 
-    if ( mThreadDriver != nullptr ) {
+    if ( mThreadDriver != nullptr && mOwnsThreadDriver ) {
 
         delete mThreadDriver;
     }
+
+    unmapFontFile();
 }
 
 
@@ -62,6 +108,11 @@ bool Generator::generate()
         mConf.emitVerbose();
     }
 
+    if ( !scanCorpora() ) {
+
+        return false;
+    }
+
     if ( !initializeFreeType() ) {
 
         return false;
@@ -77,6 +128,8 @@ bool Generator::generate()
        generateExtraGlyphs();
     }
 
+    deduplicateGlyphs();
+
     getKernings();
 
     const auto bestWidthForDefaultFontSize = fitGlyphsToTexture();
@@ -86,24 +139,65 @@ bool Generator::generate()
         return false;
     }
 
-    auto ftError = FT_Done_Face( mFtFace );
+    // The outlines belong to the library.
+    for ( auto* g : mGlyphs ) {
 
-    if ( ftError != FT_Err_Ok ) {
+        g->releaseOutline();
+    }
+
+    FT_Error ftError;
+
+    if ( mCache == nullptr ) {
+
+        ftError = doneFace( mFtFace );
+
+        if ( ftError != FT_Err_Ok ) {
 
-        cerr << "FT_DONE_Face error: " << ftError << "\n";
+            cerr << "FT_DONE_Face error: " << ftError << "\n";
+        }
     }
 
-    ftError = FT_Done_FreeType( mFtHandle );
+    if ( mOwnsFtHandle ) {
 
-    if ( ftError != FT_Err_Ok ) {
+        ftError = FT_Done_FreeType( mFtHandle );
 
-        cerr << "FT_DONE_FreeType error: " << ftError << "\n";
+        if ( ftError != FT_Err_Ok ) {
+
+            cerr << "FT_DONE_FreeType error: " << ftError << "\n";
+        }
     }
 
     return true;
 }
 
 
+FT_Error Generator::newMemoryFace( FT_Face& face )
+{
+    // FT_New_Face() and FT_Done_Face() must be serialized on a shared library.
+    if ( mFtHandleMutex != nullptr ) {
+
+        lock_guard< mutex > lock( *mFtHandleMutex );
+
+        return FT_New_Memory_Face( mFtHandle, mFontData, mFontDataSize, 0, &face );
+    }
+
+    return FT_New_Memory_Face( mFtHandle, mFontData, mFontDataSize, 0, &face );
+}
+
+
+FT_Error Generator::doneFace( FT_Face face )
+{
+    if ( mFtHandleMutex != nullptr ) {
+
+        lock_guard< mutex > lock( *mFtHandleMutex );
+
+        return FT_Done_Face( face );
+    }
+
+    return FT_Done_Face( face );
+}
+
+
 FT_Error Generator::setEncoding ( const string& s )
 {
     if ( s.compare(Encoding_unicode) == 0 ) {
@@ -165,25 +259,40 @@ FT_Error Generator::setEncoding ( const string& s )
 
 bool Generator::initializeFreeType()
 {
-    auto ftError = FT_Init_FreeType( &mFtHandle );
+    FT_Error ftError;
 
-    if ( ftError != FT_Err_Ok ) {
+    if ( mOwnsFtHandle ) {
 
-        cerr << "FreeType error: " << ftError << "\n";
-        return false;
+        ftError = FT_Init_FreeType( &mFtHandle );
+
+        if ( ftError != FT_Err_Ok ) {
+
+            cerr << "FreeType error: " << ftError << "\n";
+            return false;
+        }
     }
 
-    ftError = FT_New_Face(
-                  mFtHandle,
-                  mConf.fontPath().c_str(),
-                  0,
-                  &mFtFace 
-              );
+    if ( mCache != nullptr ) {
 
-    if ( ftError != FT_Err_Ok ) {
+        // The face and the file are kept by the cache.
+        if ( !mCache->findFace( mConf.fontPath(), mFtFace, mFontData, mFontDataSize ) ) {
 
-        cerr << "Free Type error: " << ftError << "\n";
-        return false;
+            return false;
+        }
+    }
+    else {
+        if ( !mapFontFile() ) {
+
+            return false;
+        }
+
+        ftError = newMemoryFace( mFtFace );
+
+        if ( ftError != FT_Err_Ok ) {
+
+            cerr << "Free Type error: " << ftError << "\n";
+            return false;
+        }
     }
 
     cerr << "Number of glyphs: " << mFtFace->num_glyphs << "\n";
@@ -259,10 +368,31 @@ bool Generator::initializeFreeType()
         cerr << "\n";
     }
 
-    for ( int i = 0; i < mFtFace->num_charmaps; i++ ) {
+    // The Unicode charmaps first, as the glyphs selected by the corpora
+    // through them are the ones selected in the other charmaps.
+    map< int, CharMap > charMaps;
+
+    for ( int pass = 0; pass < 2; pass++ ) {
+
+        for ( int i = 0; i < mFtFace->num_charmaps; i++ ) {
 
-        const auto charMap = generateCharMap( mFtFace, mFtFace->charmaps[i], i == active_charmap_index );
-        mCharMaps.push_back( charMap );
+            const bool isUnicode = ( mFtFace->charmaps[i]->encoding == FT_ENCODING_UNICODE );
+
+            if ( isUnicode == ( pass == 0 ) ) {
+
+                charMaps.emplace( i, generateCharMap( mFtFace, mFtFace->charmaps[i], i == active_charmap_index ) );
+            }
+        }
+    }
+
+    for ( const auto& e : charMaps ) {
+
+        mCharMaps.push_back( e.second );
+    }
+
+    if ( !mConf.corpusPaths().empty() ) {
+
+        reportCorpusCoverage();
     }
 
     if ( ! mConf.processHiddenGlyphs() ) {
@@ -282,14 +412,22 @@ bool Generator::initializeFreeType()
 
 void Generator::getKernings()
 {
+    mKerning = KerningTable();
+
     if ( FT_HAS_KERNING( mFtFace ) ) {;
 
+        // The pairs are grouped into the classes one preceding glyph at a
+        // time, so that only the distinct rows are kept.
+        KerningTableBuilder builder;
+
         for ( auto* g1 : mGlyphs ) {
 
             if ( g1->hasExternalBitmap() ) {
                 continue;
             }
 
+            KerningTableBuilder::Row row;
+
             for ( auto* g2 : mGlyphs ) {
 
                 if ( g2->hasExternalBitmap() ) {
@@ -301,11 +439,84 @@ void Generator::getKernings()
 
                 if ( kerning.x != 0 ) {
 
-                    g1->addKerning( g2->codePoint(), kerning.x );
+                    row.emplace_back( g2->codePoint(), g1->normalizedKerning( kerning.x ) );
                 }
             }
+
+            sort( row.begin(), row.end() );
+
+            builder.addRow( g1->codePoint(), std::move( row ) );
+        }
+
+        builder.build( mKerning );
+    }
+}
+
+
+void Generator::deduplicateGlyphs()
+{
+    unordered_map< size_t, vector< const InternalGlyphForGen* > > owners;
+
+    const InternalGlyphForGen* firstEmpty = nullptr;
+
+    mPackedGlyphs.clear();
+    mNumEmptyGlyphs = 0;
+
+    for ( auto* g : mGlyphs ) {
+
+        const GlyphOutline* outline = g->outline();
+
+        if ( outline == nullptr || outline->outline() == nullptr ) {
+
+            // The extra glyphs and the bitmap glyphs.
+            mPackedGlyphs.push_back( g );
+            continue;
+        }
+
+        if ( outline->isEmpty() ) {
+
+            g->setEmpty();
+            mNumEmptyGlyphs++;
+
+            if ( firstEmpty == nullptr ) {
+
+                firstEmpty = g;
+                mPackedGlyphs.push_back( g );
+            }
+            else {
+                g->shareRectangleOf( firstEmpty );
+            }
+            continue;
+        }
+
+        auto& candidates = owners[ outline->shapeHash() ];
+
+        const InternalGlyphForGen* owner = nullptr;
+
+        for ( const auto* c : candidates ) {
+
+            if ( c->outline()->hasSameShape( *outline ) ) {
+
+                owner = c;
+                break;
+            }
+        }
+
+        if ( owner != nullptr ) {
+
+            g->shareRectangleOf( owner );
+        }
+        else {
+            candidates.push_back( g );
+            mPackedGlyphs.push_back( g );
         }
     }
+
+    if ( mVerbose ) {
+
+        cerr << "Number of glyphs sharing a rectangle is " << numSharedGlyphs() << ", "
+             << mNumEmptyGlyphs << " of them empty.\n";
+    }
 }
 
 
@@ -325,6 +536,35 @@ long Generator::fitGlyphsToTexture()
     auto factorX = (float)(mConf.outputTextureSize() - maxNumGlyphsPerEdge) / (float)bestWidth;
     auto factorY = (float)(mConf.outputTextureSize() - maxNumGlyphsPerEdge) / (float)bestHeight;
     auto factor = min(factorX, factorY);
+
+    if ( mConf.isPackChannelsSet() && fitsInPackedChannels( factor ) ) {
+
+        // The glyphs that fit in one channel are spread over the four with
+        // the largest scale found by bisection, about twice as large.
+        auto low  = factor;
+        auto high = factor * 2.0f;
+
+        while ( fitsInPackedChannels( high ) ) {
+
+            low   = high;
+            high *= 2.0f;
+        }
+
+        for ( auto i = 0; i < 20; i++ ) {
+
+            const auto mid = ( low + high ) * 0.5f;
+
+            if ( fitsInPackedChannels( mid ) ) {
+                low  = mid;
+            }
+            else {
+                high = mid;
+            }
+        }
+
+        factor = low;
+    }
+
     mConf.setGlyphScalingFromSamplingToPackedSignedDist( factor );
 
     if ( mVerbose ) {
@@ -346,9 +586,9 @@ long Generator::findHeightFromWidth( const long width, long& maxNumGlyphsPerEdge
     long numGlyphsPerRow = 0;
     long numGlyphsPerColumn = 1;
 
-    for ( auto i = 0; i < mGlyphs.size(); i++ ) {
+    for ( auto i = 0; i < mPackedGlyphs.size(); i++ ) {
 
-        auto* g = mGlyphs[ i ];
+        auto* g = mPackedGlyphs[ i ];
 
         if ( leftX + g->signedDistWidth() > width ) {
 
@@ -380,9 +620,78 @@ long Generator::findHeightFromWidth( const long width, long& maxNumGlyphsPerEdge
 }
 
 
+bool Generator::fitsInPackedChannels( const float scale ) const
+{
+    const auto len    = mConf.outputTextureSize();
+
+    // Same as the size set to the glyphs by setSignedDist() under the scale.
+    const auto extent = (long)(   mConf.glyphBitmapSizeForSampling()
+                                * scale
+                                * mConf.ratioSpreadToGlyph()         );
+    long baseX   = 0;
+    long baseY   = 0;
+    long maxY    = 0;
+    long channel = 0;
+
+    for ( const auto* g : mPackedGlyphs ) {
+
+        const long width  = ceil( g->width()  * scale + 2 * extent );
+        const long height = ceil( g->height() * scale + 2 * extent );
+
+        if ( width > len ) {
+
+            return false;
+        }
+
+        nextPackingPosition( width, height, baseX, baseY, maxY, channel );
+
+        baseX += width;
+        maxY   = std::max( maxY, height );
+
+        // Only the last channel can overflow.
+        if ( baseY + maxY > len ) {
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void Generator::nextPackingPosition(
+    const long width,
+    const long height,
+    long&      baseX,
+    long&      baseY,
+    long&      maxY,
+    long&      channel
+) const {
+
+    const auto len = mConf.outputTextureSize();
+
+    if ( baseX + width > len ) {
+
+        baseX = 0;
+        baseY += maxY;
+        maxY = 0;
+    }
+
+    if (    mConf.isPackChannelsSet()
+         && baseY + height > len
+         && channel < mConf.numChannels() - 1 ) {
+
+        baseX = 0;
+        baseY = 0;
+        maxY  = 0;
+        channel++;
+    }
+}
+
+
 long Generator::findBestWidthForDefaultFontSize( long& bestHeight, long& maxNumGlyphsPerEdge )
 {
-    const auto initialWidth = (long) sqrt ( mGlyphs.size() ) * mConf.glyphBitmapSizeForSampling();
+    const auto initialWidth = (long) sqrt ( mPackedGlyphs.size() ) * mConf.glyphBitmapSizeForSampling();
 
     const auto initialHeight = findHeightFromWidth( initialWidth, maxNumGlyphsPerEdge );
 
@@ -457,141 +766,418 @@ long Generator::findBestWidthForDefaultFontSize( long& bestHeight, long& maxNumG
 
 bool Generator::generateGlyphs()
 {
-    char glyph_name_buffer[256];
-    string glyph_name( "" );
+    vector< FT_UInt > glyphIndices;
 
     if ( mConf.processHiddenGlyphs() ) {
 
         for ( FT_ULong i = 0; i <= mFtFace->num_glyphs; i++ ) {
 
-            auto ftError = FT_Load_Glyph ( mFtFace, i, FT_LOAD_DEFAULT );
-
-            if ( ftError != FT_Err_Ok ) {
-
-                // no glyph present for the codepoint
-                continue;
-            }
-
-            if ( mConf.faceHasGlyphNames() ) {
-
-                ftError = FT_Get_Glyph_Name( mFtFace, i, glyph_name_buffer, 256 );
-
-                if ( ftError != FT_Err_Ok ) {
-
-                    cerr << "FreeType error: " << ftError << "\n";
-                    return false;
-                }
-
-                glyph_name_buffer[255] = 0;
-                glyph_name = glyph_name_buffer;
-            }
-
-            auto* g = new InternalGlyphForGen( mConf, mThreadDriver, i, mFtFace->glyph->metrics, glyph_name );
-            mGlyphs.push_back ( g );
+            glyphIndices.push_back( i );
         }
     }
     else {
         for ( const FT_ULong i : mCodepointsToProcess ) {
 
-            auto ftError = FT_Load_Glyph ( mFtFace, i, FT_LOAD_DEFAULT );
-
-            if ( ftError != FT_Err_Ok ) {
+            glyphIndices.push_back( i );
+        }
+    }
 
-                // no glyph present for the codepoint
-                continue;
-            }
+    vector< GlyphOutline* > outlines( glyphIndices.size(), nullptr );
+    vector< string >        glyphNames( glyphIndices.size() );
 
-            if ( mConf.faceHasGlyphNames() ) {
+    if ( !captureGlyphsWithCache( glyphIndices, outlines, glyphNames ) ) {
 
-                ftError = FT_Get_Glyph_Name( mFtFace, i, glyph_name_buffer, 256 );
+        for ( auto* o : outlines ) {
 
-                if ( ftError != FT_Err_Ok ) {
+            delete o;
+        }
+        return false;
+    }
 
-                    cerr << "FreeType error: " << ftError << "\n";
-                    return false;
-                }
+    for ( size_t k = 0; k < glyphIndices.size(); k++ ) {
 
-                glyph_name_buffer[255] = 0;
-                glyph_name = glyph_name_buffer;
-            }
+        if ( outlines[k] == nullptr ) {
 
-            auto* g = new InternalGlyphForGen( mConf, mThreadDriver, i, mFtFace->glyph->metrics, glyph_name );
-            mGlyphs.push_back ( g );
+            // no glyph present for the codepoint
+            continue;
         }
+
+        FT_Glyph_Metrics metrics = outlines[k]->metrics();
+
+        auto* g = new InternalGlyphForGen( mConf, mThreadDriver, glyphIndices[k], metrics, glyphNames[k] );
+        g->setOutline( outlines[k] );
+        mGlyphs.push_back ( g );
     }
 
     return true;
 }
 
-CharMap Generator::generateCharMap(
-    FT_Face        ftFace,
-    FT_CharMapRec* ftCharMap,
-    const bool     isDefault
+
+bool Generator::captureGlyphsWithCache(
+    const vector< FT_UInt >& glyphIndices,
+    vector< GlyphOutline* >& outlines,
+    vector< string >&        glyphNames
 ) {
-    CharMap charMap(
-        isDefault,
-        FTUtilStringEncoding( ftCharMap->encoding ),
-        ftCharMap->platform_id,
-        ftCharMap->encoding_id
-    );
+    if ( mCache == nullptr ) {
 
-    auto ftError = FT_Set_Charmap( ftFace, ftCharMap );
+        return captureGlyphs( glyphIndices, outlines, glyphNames );
+    }
 
-    if ( ftError != FT_Err_Ok ) {
+    const auto samplingSize = mConf.glyphBitmapSizeForSampling();
 
-        cerr << "FreeType error: FT_Set_Charmap" << ftError << "\n";
+    vector< size_t >  missing;
+    vector< FT_UInt > missingIndices;
 
-        return charMap;
-    }
+    for ( size_t k = 0; k < glyphIndices.size(); k++ ) {
 
-    FT_UInt gindex = 0;
+        auto* outline = new GlyphOutline();
 
-    FT_ULong charcode = FT_Get_First_Char( ftFace, &gindex );
+        if ( mCache->findOutline( mConf.fontPath(), samplingSize, glyphIndices[k], *outline, glyphNames[k] ) ) {
 
-    while ( gindex != 0 ) {
+            outlines[k] = outline;
+        }
+        else {
+            delete outline;
+            missing.push_back( k );
+            missingIndices.push_back( glyphIndices[k] );
+        }
+    }
 
-        if ( mConf.isInACharCodeRange( charcode ) ) {
+    vector< GlyphOutline* > missingOutlines( missing.size(), nullptr );
+    vector< string >        missingNames( missing.size() );
 
-            charMap.m_char_to_codepoint.insert( pair( charcode, gindex ) );
-        }
+    if ( !captureGlyphs( missingIndices, missingOutlines, missingNames ) ) {
 
-        charcode = FT_Get_Next_Char( ftFace, charcode, &gindex );
+        for ( auto* o : missingOutlines ) {
+
+            delete o;
+        }
+        return false;
     }
-    return charMap;
-}
 
+    for ( size_t m = 0; m < missing.size(); m++ ) {
 
-std::pair<float, float> Generator::findMeanGlyphDimension()
-{
-    float width { 0.0f };
-    float height{ 0.0f };
-    float count { 0.0f };
-    for ( auto* g : mGlyphs ) {
-        if ( g->width() > 0.0f &&  g->height() > 0.0f ) {
-            width  += g->width();
-            height += g->height();
-            count  += 1.0f;
+        const auto k = missing[m];
+
+        outlines[k]   = missingOutlines[m];
+        glyphNames[k] = missingNames[m];
+
+        // The glyphs that can not be loaded are tried again next time.
+        if ( outlines[k] != nullptr ) {
+
+            mCache->storeOutline( mConf.fontPath(), samplingSize, glyphIndices[k], *outlines[k], glyphNames[k] );
         }
     }
-    return std::pair( width / count, height / count );
+
+    return true;
 }
 
-void Generator::generateExtraGlyphs()
-{
-    const auto dim  = findMeanGlyphDimension();
 
-    addExtraGlyph( 0x0A, "extra line feed", dim, GeneratorConfig::FileNameExtraGlyphLineFeed );
+bool Generator::captureGlyphs(
+    const vector< FT_UInt >& glyphIndices,
+    vector< GlyphOutline* >& outlines,
+    vector< string >&        glyphNames
+) {
+    // One face per thread over the same mapped font file,
+    // as a face can not be used by multiple threads at a time.
+    vector< FT_Face > faces{ mFtFace };
 
-    addExtraGlyph( 0x00, "extra blank", dim, GeneratorConfig::FileNameExtraGlyphBlank          );
-}
+    if ( mThreadDriver != nullptr ) {
 
-void Generator::addExtraGlyph( const long code_point, const string& glyph_name, const std::pair<float, float>& dim, const std::string& file_name )
-{
-    const auto base_path = std::filesystem::path{ mConf.extraGlyphPath() };
-    const auto file_path = std::filesystem::path{ file_name };
+        for ( long i = 1; i < mThreadDriver->m_num_threads && i < (long)glyphIndices.size(); i++ ) {
 
-    unsigned long width, height;
-    unsigned char* data;
+            FT_Face face;
+
+            auto ftError = newMemoryFace( face );
+
+            if ( ftError != FT_Err_Ok ) {
+
+                cerr << "FreeType error: " << ftError << "\n";
+                break;
+            }
+
+            ftError = FT_Set_Pixel_Sizes ( face, 0, mConf.glyphBitmapSizeForSampling() );
+
+            if ( ftError != FT_Err_Ok ) {
+
+                cerr << "FreeType error: " << ftError << "\n";
+                doneFace( face );
+                break;
+            }
+
+            faces.push_back( face );
+        }
+    }
+
+    const long         numFaces = faces.size();
+    vector< FT_Error > errors( numFaces, FT_Err_Ok );
+
+    auto captureEveryNth = [ & ]( const long faceIndex ) {
+
+        FT_Face face = faces[ faceIndex ];
+        char    glyph_name_buffer[256];
+
+        for ( size_t k = faceIndex; k < glyphIndices.size(); k += numFaces ) {
+
+            auto ftError = FT_Load_Glyph ( face, glyphIndices[k], FT_LOAD_DEFAULT );
+
+            if ( ftError != FT_Err_Ok ) {
+
+                // no glyph present for the codepoint
+                continue;
+            }
+
+            if ( mConf.faceHasGlyphNames() ) {
+
+                ftError = FT_Get_Glyph_Name( face, glyphIndices[k], glyph_name_buffer, 256 );
+
+                if ( ftError != FT_Err_Ok ) {
+
+                    errors[ faceIndex ] = ftError;
+                    return;
+                }
+
+                glyph_name_buffer[255] = 0;
+                glyphNames[k] = glyph_name_buffer;
+            }
+
+            auto* outline = new GlyphOutline();
+
+            ftError = outline->capture( face->glyph );
+
+            if ( ftError != FT_Err_Ok ) {
+
+                delete outline;
+                errors[ faceIndex ] = ftError;
+                return;
+            }
+
+            outlines[k] = outline;
+        }
+    };
+
+    if ( numFaces > 1 ) {
+
+        // Each of the rows [0, numFaces) is run by its own thread.
+        mThreadDriver->runRows( numFaces, captureEveryNth );
+    }
+    else {
+        captureEveryNth( 0 );
+    }
+
+    for ( long i = 1; i < numFaces; i++ ) {
+
+        doneFace( faces[i] );
+    }
+
+    for ( const auto ftError : errors ) {
+
+        if ( ftError != FT_Err_Ok ) {
+
+            cerr << "FreeType error: " << ftError << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool Generator::mapFontFile()
+{
+    const int fd = open( mConf.fontPath().c_str(), O_RDONLY );
+
+    if ( fd < 0 ) {
+
+        cerr << "Can not open [" << mConf.fontPath() << "]\n";
+        return false;
+    }
+
+    struct stat st;
+
+    if ( fstat( fd, &st ) != 0 || st.st_size == 0 ) {
+
+        cerr << "Can not read [" << mConf.fontPath() << "]\n";
+        close( fd );
+        return false;
+    }
+
+    void* data = mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+    close( fd );
+
+    if ( data == MAP_FAILED ) {
+
+        cerr << "Can not map [" << mConf.fontPath() << "]\n";
+        return false;
+    }
+
+    mFontData     = static_cast< FT_Byte* >( data );
+    mFontDataSize = st.st_size;
+
+    return true;
+}
+
+
+void Generator::unmapFontFile()
+{
+    // The file mapped by the cache is kept there.
+    if ( mFontData != nullptr && mCache == nullptr ) {
+
+        munmap( mFontData, mFontDataSize );
+        mFontData     = nullptr;
+        mFontDataSize = 0;
+    }
+}
+
+CharMap Generator::generateCharMap(
+    FT_Face        ftFace,
+    FT_CharMapRec* ftCharMap,
+    const bool     isDefault
+) {
+    CharMap charMap(
+        isDefault,
+        FTUtilStringEncoding( ftCharMap->encoding ),
+        ftCharMap->platform_id,
+        ftCharMap->encoding_id
+    );
+
+    auto ftError = FT_Set_Charmap( ftFace, ftCharMap );
+
+    if ( ftError != FT_Err_Ok ) {
+
+        cerr << "FreeType error: FT_Set_Charmap" << ftError << "\n";
+
+        return charMap;
+    }
+
+    FT_UInt gindex = 0;
+
+    FT_ULong charcode = FT_Get_First_Char( ftFace, &gindex );
+
+    // The corpora are in Unicode. The other charmaps take the glyphs
+    // selected through the Unicode charmaps.
+    const bool byGlyphIndex =    !mConf.corpusPaths().empty()
+                              && ftCharMap->encoding != FT_ENCODING_UNICODE;
+
+    while ( gindex != 0 ) {
+
+        const bool selected = byGlyphIndex ?
+                                  mSelectedGlyphIndices.find( gindex ) != mSelectedGlyphIndices.end()
+                                : mConf.isInACharCodeRange( charcode );
+        if ( selected ) {
+
+            charMap.m_char_to_codepoint.insert( pair( charcode, gindex ) );
+
+            if ( !byGlyphIndex ) {
+
+                mSelectedGlyphIndices.insert( gindex );
+            }
+        }
+
+        charcode = FT_Get_Next_Char( ftFace, charcode, &gindex );
+    }
+    return charMap;
+}
+
+
+bool Generator::scanCorpora()
+{
+    if ( mConf.corpusPaths().empty() ) {
+
+        return true;
+    }
+
+    UTF8CorpusScanner scanner( mThreadDriver );
+
+    for ( const auto& path : mConf.corpusPaths() ) {
+
+        if ( !scanner.scanFile( path ) ) {
+
+            return false;
+        }
+    }
+
+    if ( scanner.numInvalidSequences() > 0 ) {
+
+        cerr << "Corpora: " << scanner.numInvalidSequences() << " invalid UTF-8 sequences skipped.\n";
+    }
+
+    const auto codes = scanner.codePoints();
+
+    cerr << "Corpora: " << codes.size() << " distinct characters.\n";
+
+    mConf.setCorpusCharCodes( codes );
+
+    return true;
+}
+
+
+void Generator::reportCorpusCoverage()
+{
+    for ( const auto& charMap : mCharMaps ) {
+
+        if ( charMap.m_encoding != FTUtilStringEncoding( FT_ENCODING_UNICODE ) ) {
+
+            continue;
+        }
+
+        long numMissing = 0;
+
+        for ( const auto code : mConf.corpusCharCodes() ) {
+
+            if ( charMap.m_char_to_codepoint.find( code ) == charMap.m_char_to_codepoint.end() ) {
+
+                if ( mVerbose ) {
+
+                    cerr << "Corpora: 0X" << hex << uppercase << code << dec << nouppercase << " not in the font.\n";
+                }
+                numMissing++;
+            }
+        }
+
+        if ( numMissing > 0 ) {
+
+            cerr << "Corpora: " << numMissing << " characters not in the font.\n";
+        }
+        return;
+    }
+
+    cerr << "Corpora: the font has no Unicode charmap.\n";
+}
+
+
+std::pair<float, float> Generator::findMeanGlyphDimension()
+{
+    float width { 0.0f };
+    float height{ 0.0f };
+    float count { 0.0f };
+    for ( auto* g : mGlyphs ) {
+        if ( g->width() > 0.0f &&  g->height() > 0.0f ) {
+            width  += g->width();
+            height += g->height();
+            count  += 1.0f;
+        }
+    }
+    return std::pair( width / count, height / count );
+}
+
+void Generator::generateExtraGlyphs()
+{
+    const auto dim  = findMeanGlyphDimension();
+
+    addExtraGlyph( 0x0A, "extra line feed", dim, GeneratorConfig::FileNameExtraGlyphLineFeed );
+
+    addExtraGlyph( 0x00, "extra blank", dim, GeneratorConfig::FileNameExtraGlyphBlank          );
+}
+
+void Generator::addExtraGlyph( const long code_point, const string& glyph_name, const std::pair<float, float>& dim, const std::string& file_name )
+{
+    const auto base_path = std::filesystem::path{ mConf.extraGlyphPath() };
+    const auto file_path = std::filesystem::path{ file_name };
+
+    unsigned long width, height;
+    unsigned char* data;
 
     const auto result = loadPngImage( base_path / file_path, width, height, &data );
 
@@ -611,320 +1197,1065 @@ void Generator::addExtraGlyph( const long code_point, const string& glyph_name,
         height
     );
 
-    mGlyphs.push_back( g );
+    mGlyphs.push_back( g );
+}
+
+bool Generator::generateGlyphBitmaps( long bestWidthForDefaultFontSize )
+{
+    long baseX    = 0;
+    long baseY    = 0;
+    long maxY     = 0;
+    long channel  = 0;
+
+    long numGlyphsProcessed = 1;
+
+    for ( auto* g : mPackedGlyphs ) {
+
+        if ( g->hasExternalBitmap() ) {
+
+            g->setSignedDist();
+        }
+        else if ( g->isEmpty() ) {
+
+            g->setEmptySignedDist();
+            g->releaseOutline();
+        }
+        else {
+            const GeneratorCache::SignedDist* cached = nullptr;
+
+            if ( mCache != nullptr ) {
+
+                cached = mCache->findSignedDist( mConf, g->codePoint() );
+            }
+
+            if ( cached != nullptr ) {
+
+                g->restoreSignedDist( cached->mWidth, cached->mHeight, cached->mDist, cached->mDistMulti );
+                g->releaseOutline();
+                mNumGlyphsFromCache++;
+            }
+            else if ( !generateGlyphBitmap( g ) ) {
+
+                return false;
+            }
+        }
+
+        nextPackingPosition( g->signedDistWidth(), g->signedDistHeight(), baseX, baseY, maxY, channel );
+
+        g->setBaseXY(baseX, baseY);
+        g->setTextureChannel( channel );
+        baseX += g->signedDistWidth();
+        maxY = std::max( maxY, g->signedDistHeight() );
+
+        if ( mVerbose ) {
+
+            g->visualize(cerr);
+            cerr << "Num Glyphs Processed: " << numGlyphsProcessed << "/" << mPackedGlyphs.size() << "\n";
+            cerr << "Base:[" << baseX << " , " << baseY << "] Channel:[" << channel << "]\n";
+            cerr << "\n";
+        }
+
+        numGlyphsProcessed++;
+    }
+
+    // The texture coordinates are set from the own width and height,
+    // which are the same as the owner's.
+    for ( auto* g : mGlyphs ) {
+
+        const auto* owner = g->rectangleOwner();
+
+        if ( owner != nullptr ) {
+
+            g->setBaseXY( owner->baseX(), owner->baseY() );
+            g->setTextureChannel( owner->textureChannel() );
+        }
+    }
+
+    return true;
+}
+
+
+bool Generator::generateGlyphBitmap( InternalGlyphForGen* g )
+{
+    // Rasterized from the outline captured in generateGlyphs()
+    // without loading the glyph again.
+    const GlyphOutline* glyphOutline = g->outline();
+
+    if ( glyphOutline == nullptr ) {
+
+        cerr << "No outline captured for the glyph: " << g->codePoint() << "\n";
+        return false;
+    }
+
+    MSDFShape shape;
+
+    const bool multiChannel =    mConf.isMultiChannelSet()
+                              && glyphOutline->outline() != nullptr
+                              && shape.loadFromOutline( *glyphOutline->outline() )
+                              && !shape.isEmpty();
+    if ( multiChannel ) {
+
+        shape.colorEdges( MSDFCornerAngleThreshold );
+    }
+
+    auto ftError = glyphOutline->renderMono( [ & ]( FT_Bitmap& bm, const long left, const long top ) {
+
+        if ( multiChannel ) {
+
+            g->setSignedDistMultiChannel( bm, shape, left, top );
+        }
+        else {
+            g->setSignedDist( bm );
+        }
+    } );
+
+    if (ftError != FT_Err_Ok) {
+
+        cerr << "FreeType error: " << ftError << "\n";
+        return false;
+    }
+
+    g->releaseOutline();
+
+    if ( mCache != nullptr ) {
+
+        GeneratorCache::SignedDist signedDist;
+
+        signedDist.mWidth  = g->signedDistWidth();
+        signedDist.mHeight = g->signedDistHeight();
+        g->copySignedDist( signedDist.mDist, signedDist.mDistMulti );
+
+        mCache->storeSignedDist( mConf, g->codePoint(), std::move( signedDist ) );
+    }
+
+    return true;
+}
+
+
+bool Generator::generateTexture( bool reverseY )
+{
+
+    auto len = mConf.outputTextureSize();
+
+    const auto numChannels = mConf.numChannels();
+
+    mPtrMain = (unsigned char*) malloc (sizeof(unsigned char) * 4 * len * len);
+
+    if ( mPtrMain == nullptr ) {
+
+        std::cerr << "Error\n";
+        return false;
+    }
+
+    memset ( mPtrMain, (int)0, sizeof(unsigned char) * 4 * len * len );
+
+    mPtrArray = (unsigned char**) malloc ( sizeof(unsigned char*) * len ) ;
+               
+
+    if ( mPtrArray == nullptr ) {
+
+        free(mPtrMain);
+        std::cerr << "Error\n";
+        return false;
+    }
+
+    for (auto i = 0; i < len; i++ ) {
+
+        mPtrArray[i] = &( mPtrMain[ sizeof(unsigned char) * numChannels * len * i ] );
+    }
+
+    fillTexture( mPtrArray, reverseY );
+
+    return true;
+}
+
+
+void Generator::fillTexture( unsigned char** rows, bool reverseY )
+{
+    const auto len         = mConf.outputTextureSize();
+    const auto numChannels = mConf.numChannels();
+
+    for ( auto* g : mPackedGlyphs ) {
+
+        for ( auto srcY = 0; srcY < g->signedDistHeight(); srcY++ ) {
+
+            auto dstY    = len - 1 - ( srcY + g->baseY() );
+
+            if ( dstY < 0 || len <= dstY ) {
+                continue;
+            }
+            auto* curRow = rows [dstY];
+
+            for ( auto srcX = 0; srcX < g->signedDistWidth(); srcX++ ) {
+
+                auto dstX  = ( srcX + g->baseX() );
+                if ( dstX < 0 || len <= dstX ) {
+                    continue;
+                }
+
+                const auto srcYFlipped = reverseY ? srcY : (g->signedDistHeight() - 1 - srcY);
+
+                if ( numChannels == 1 || mConf.isPackChannelsSet() ) {
+
+                    auto dist  = g->signedDist( srcX, srcYFlipped );
+
+                    auto alpha = min ( 255, max( 0, (int)( dist * 255.0 ) ) );
+                    curRow [ dstX * numChannels + g->textureChannel() ] = (unsigned char)alpha;
+                }
+                else {
+                    // The glyphs without the outline have the same value
+                    // in all the channels.
+                    for ( long c = 0; c < numChannels; c++ ) {
+
+                        auto dist  = g->signedDistMulti( srcX, srcYFlipped, c );
+
+                        auto alpha = min ( 255, max( 0, (int)( dist * 255.0 ) ) );
+                        curRow [ dstX * numChannels + c ] = (unsigned char)alpha;
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+void Generator::releaseTexture()
+{
+    if ( mPtrMain != nullptr ) {
+
+        free ( mPtrMain  );
+        free ( mPtrArray );
+        
+        mPtrMain  = nullptr;
+        mPtrArray = nullptr;
+    }
+}
+
+
+unsigned char** Generator::textureBitmap()
+{
+    if ( !generateTexture( mConf.isReverseYDirectionForGlyphsSet() ) ) {
+
+        std::cerr << "Error\n";
+
+        return nullptr;
+    }
+    return mPtrArray;
+}
+
+
+bool Generator::emitFilePNG()
+{
+    if ( !generateTexture( mConf.isReverseYDirectionForGlyphsSet() ) ) {
+
+        std::cerr << "Error\n";
+        return false;
+    }
+
+    string outputFileNamePNG = mConf.outputFileName() + ".png";
+
+    FILE*  pngOut = fopen( outputFileNamePNG.c_str(), "wb" );
+
+    if ( pngOut == nullptr ) {
+
+        releaseTexture();
+        std::cerr << "Error\n";
+        return false;
+    }
+
+    png_structp pngWritePtr = png_create_write_struct( PNG_LIBPNG_VER_STRING,
+                                                       NULL,
+                                                       NULL,
+                                                       NULL
+                                                     );
+    if ( pngWritePtr == nullptr ) {
+
+        fclose ( pngOut   );
+        releaseTexture();
+        std::cerr << "Error\n";
+        return false;
+    }
+
+    png_infop pngInfoPtr = png_create_info_struct( pngWritePtr );
+
+    if ( pngInfoPtr == nullptr ) {
+
+        png_destroy_write_struct( &pngWritePtr, (png_infopp)NULL ) ;
+        fclose ( pngOut   );
+        releaseTexture();
+        std::cerr << "Error\n";
+        return false;
+    }
+
+    if ( setjmp( png_jmpbuf( pngWritePtr ) ) != 0 ) {
+
+        png_destroy_write_struct( &pngWritePtr, &pngInfoPtr ) ;
+        fclose ( pngOut   );
+        releaseTexture();
+        std::cerr << "Error\n";
+        return false;
+    }
+
+    png_init_io( pngWritePtr, pngOut );
+
+    if ( setjmp( png_jmpbuf( pngWritePtr ) ) != 0 ) {
+
+        png_destroy_write_struct( &pngWritePtr, &pngInfoPtr ) ;
+        fclose ( pngOut   );
+        releaseTexture();
+        std::cerr << "Error\n";
+        return false;
+    }
+
+    const auto colorType =   mConf.isPackChannelsSet() ? PNG_COLOR_TYPE_RGBA
+                           : mConf.isMultiChannelSet() ? PNG_COLOR_TYPE_RGB
+                           :                             PNG_COLOR_TYPE_GRAY;
+
+    png_set_IHDR( pngWritePtr,
+                  pngInfoPtr,
+                  mConf.outputTextureSize(),
+                  mConf.outputTextureSize(),
+                  8,
+                  colorType,
+                  PNG_INTERLACE_NONE,
+                  PNG_COMPRESSION_TYPE_BASE,
+                  PNG_FILTER_TYPE_BASE
+                );
+
+    png_write_info( pngWritePtr, pngInfoPtr );
+
+    if ( setjmp( png_jmpbuf( pngWritePtr ) ) != 0 ) {
+
+        png_destroy_write_struct( &pngWritePtr, &pngInfoPtr ) ;
+        fclose ( pngOut   );
+        releaseTexture();
+        std::cerr << "Error\n";
+        return false;
+    }
+
+    png_write_image( pngWritePtr, mPtrArray );
+
+    if ( setjmp( png_jmpbuf( pngWritePtr ) ) != 0 ) {
+
+        png_destroy_write_struct( &pngWritePtr, &pngInfoPtr ) ;
+        fclose ( pngOut   );
+        releaseTexture();
+        std::cerr << "Error\n";
+        return false;
+    }
+
+    png_write_end( pngWritePtr, NULL );
+
+    png_destroy_write_struct( &pngWritePtr, &pngInfoPtr ) ;
+
+    fclose ( pngOut   );
+    releaseTexture();
+
+    return true;
+}
+
+
+void Generator::generateDistanceField( vector< float >& field )
+{
+    const long len      = mConf.outputTextureSize();
+    const bool reverseY = mConf.isReverseYDirectionForGlyphsSet();
+
+    // The area not covered by the glyphs is far outside as in generateTexture().
+    field.assign( len * len, 0.0f );
+
+    for ( auto* g : mPackedGlyphs ) {
+
+        for ( auto srcY = 0; srcY < g->signedDistHeight(); srcY++ ) {
+
+            // The first row is at the bottom as in OpenGL.
+            const auto dstY = srcY + g->baseY();
+
+            if ( dstY < 0 || len <= dstY ) {
+                continue;
+            }
+
+            const auto srcYFlipped = reverseY ? srcY : (g->signedDistHeight() - 1 - srcY);
+
+            for ( auto srcX = 0; srcX < g->signedDistWidth(); srcX++ ) {
+
+                const auto dstX = srcX + g->baseX();
+
+                if ( dstX < 0 || len <= dstX ) {
+                    continue;
+                }
+
+                field[ dstY * len + dstX ] = g->signedDist( srcX, srcYFlipped );
+            }
+        }
+    }
+}
+
+
+void Generator::downsampleDistanceField(
+    const vector< float >& src,
+    const long             srcWidth,
+    const float            lipschitzBound,
+    vector< float >&       dst
+) {
+    const long dstWidth = std::max( 1L, srcWidth / 2 );
+
+    dst.assign( dstWidth * dstWidth, 0.0f );
+
+    auto rowFunc = [ & ]( const long y ) {
+
+        const long y0 = std::min( 2 * y,     srcWidth - 1 );
+        const long y1 = std::min( 2 * y + 1, srcWidth - 1 );
+
+        for ( long x = 0; x < dstWidth; x++ ) {
+
+            const long x0 = std::min( 2 * x,     srcWidth - 1 );
+            const long x1 = std::min( 2 * x + 1, srcWidth - 1 );
+
+            const float children[4] = { src[ y0 * srcWidth + x0 ],
+                                        src[ y0 * srcWidth + x1 ],
+                                        src[ y1 * srcWidth + x0 ],
+                                        src[ y1 * srcWidth + x1 ] };
+
+            // The mean is the exact distance at the center if the field
+            // is linear over the four children.
+            float mean  = 0.25f * ( children[0] + children[1] + children[2] + children[3] );
+
+            // Each child bounds the distance at the center by its own
+            // distance plus/minus the distance to the center. The children
+            // clamped at 0.0 or 1.0 give only one side, as their true
+            // distance is further out. This keeps the mean from drifting
+            // toward the edge around the saturated texels.
+            float lower = 0.0f;
+            float upper = 1.0f;
+
+            for ( const auto c : children ) {
+
+                if ( c > 0.0f ) {
+                    upper = std::min( upper, c + lipschitzBound );
+                }
+                if ( c < 1.0f ) {
+                    lower = std::max( lower, c - lipschitzBound );
+                }
+            }
+
+            if ( lower <= upper ) {
+
+                mean = std::max( lower, std::min( upper, mean ) );
+            }
+
+            dst[ y * dstWidth + x ] = mean;
+        }
+    };
+
+    if ( mThreadDriver == nullptr ) {
+
+        for ( long y = 0; y < dstWidth; y++ ) {
+
+            rowFunc( y );
+        }
+    }
+    else {
+        mThreadDriver->runRows( dstWidth, rowFunc );
+    }
+}
+
+
+void Generator::generateMipChain( vector< vector< unsigned char > >& levels )
+{
+    long width = mConf.outputTextureSize();
+
+    vector< float > field;
+
+    generateDistanceField( field );
+
+    // Distance in the normalized signed distance between the center of a
+    // texel and the center of its parent in the next level, at level 0.
+    float lipschitzBound = 0.5f * sqrt( 2.0f ) / ( 2.0f * mConf.signedDistExtent() );
+
+    levels.clear();
+
+    while ( true ) {
+
+        // Each level is quantized only once from the float field,
+        // in the same way as generateTexture().
+        vector< unsigned char > level( field.size() );
+
+        for ( size_t i = 0; i < field.size(); i++ ) {
+
+            level[ i ] = (unsigned char) min ( 255, max( 0, (int)( field[ i ] * 255.0 ) ) );
+        }
+
+        levels.push_back( std::move( level ) );
+
+        if ( width == 1 ) {
+            break;
+        }
+
+        vector< float > next;
+
+        downsampleDistanceField( field, width, lipschitzBound, next );
+
+        field.swap( next );
+        width          = std::max( 1L, width / 2 );
+        lipschitzBound *= 2.0f;
+    }
+}
+
+
+bool Generator::emitFileKTX2()
+{
+    vector< vector< unsigned char > > levels;
+
+    generateMipChain( levels );
+
+    const long len = mConf.outputTextureSize();
+
+    if ( mConf.outputFormat() == GeneratorConfig::OutputFormatR8 ) {
+
+        KTX2Container container( KTX2Container::VK_FORMAT_R8_UNORM, len, len );
+
+        for ( auto& level : levels ) {
+
+            container.addLevel( std::move( level ) );
+        }
+
+        return writeKTX2( container );
+    }
+
+    const bool isBC4 = ( mConf.outputFormat() == GeneratorConfig::OutputFormatBC4 );
+
+    BlockCompressor compressor(
+        isBC4 ? BlockCompressor::BC4 : BlockCompressor::EAC_R11,
+        mThreadDriver
+    );
+
+    KTX2Container container(
+        isBC4 ? KTX2Container::VK_FORMAT_BC4_UNORM_BLOCK : KTX2Container::VK_FORMAT_EAC_R11_UNORM_BLOCK,
+        len,
+        len
+    );
+
+    for ( size_t i = 0; i < levels.size(); i++ ) {
+
+        const long width = container.levelWidth( i );
+
+        vector< unsigned char > blocks;
+
+        compressor.compress( levels[i].data(), width, width, blocks );
+
+        if ( mVerbose ) {
+
+            // Decode on the CPU to report the quality of the encoding.
+            vector< unsigned char > decoded;
+
+            compressor.decompress( blocks.data(), width, width, decoded );
+
+            long   maxError = 0;
+            double sqError  = 0.0;
+
+            for ( size_t k = 0; k < decoded.size(); k++ ) {
+
+                const long e = std::abs( (long)decoded[k] - (long)levels[i][k] );
+
+                maxError = std::max( maxError, e );
+                sqError += (double)( e * e );
+            }
+
+            const double mse  = sqError / (double)decoded.size();
+            const double psnr = ( mse > 0.0 ) ? 10.0 * log10( 255.0 * 255.0 / mse ) : 99.0;
+
+            cerr << "Level " << i << " [" << width << "x" << width << "] "
+                 << "Max Error: " << maxError << " PSNR: " << psnr << "[dB]\n";
+        }
+
+        container.addLevel( std::move( blocks ) );
+    }
+
+    return writeKTX2( container );
+}
+
+
+bool Generator::writeKTX2( const KTX2Container& container )
+{
+    const string outputFileName = mConf.outputFileName() + mConf.textureFileExtension();
+
+    if ( !container.writeToFile( outputFileName ) ) {
+
+        std::cerr << "Error\n";
+        return false;
+    }
+
+    if ( mVerbose ) {
+
+        cerr << "Output Texture written to [" << outputFileName << "]\n";
+    }
+
+    return true;
+}
+
+
+bool Generator::emitFileMetrics()
+{
+    ofstream osMetrics(mConf.outputFileName() + ".txt");
+
+    if ( !osMetrics ) {
+
+        std::cerr << "Error\n";
+        return false;
+    }
+
+    emitMetrics( osMetrics );
+
+    osMetrics.close();
+
+    if ( mVerbose ) {
+
+        cerr << "Output Metrics written to ["
+             << mConf.outputFileName() << ".txt]\n";
+    }
+
+    return true;
 }
 
-bool Generator::generateGlyphBitmaps( long bestWidthForDefaultFontSize )
+
+void Generator::emitMetrics( ostream& osMetrics )
 {
-    long baseX    = 0;
-    long baseY    = 0;
-    long maxY     = 0;
+    mConf.outputMetricsHeader( osMetrics );
 
-    long numGlyphsProcessed = 1;
+    osMetrics << "SPREAD IN TEXTURE\n";
+    osMetrics << spreadInTexture();
+    osMetrics << "\n";
+    osMetrics << "SPREAD IN FONT METRICS\n";
+    osMetrics << spreadInFontMetrics();
+    osMetrics << "\n";
+    osMetrics << "GLYPHS\n";
 
     for ( auto* g : mGlyphs ) {
 
-        if ( g->hasExternalBitmap() ) {
+        g->emitMetrics( osMetrics );
+        osMetrics << "\n";
 
-            g->setSignedDist();
-        }
-        else {
-            auto ftError = FT_Load_Glyph( mFtFace, g->codePoint(), FT_LOAD_DEFAULT );
+    }
 
-            if (ftError != FT_Err_Ok) {
+    osMetrics << "#Kerning Classes\tCLASSES\tNum Left Classes\tNum Right Classes\n";
+    osMetrics << "#\tLEFT\tLeft Class\tPred Code Point 1\tPred Code Point 2...\n";
+    osMetrics << "#\tRIGHT\tRight Class\tSucc Code Point 1\tSucc Code Point 2...\n";
+    osMetrics << "#\tVALUES\tLeft Class\tKerning for Right Class 0\tKerning for Right Class 1...\n";
 
-                cerr << "FreeType error: " << ftError << "\n";
-                return false;
-            }
+    osMetrics << "KERNING CLASSES\n";
 
-            ftError = FT_Render_Glyph( mFtFace->glyph, FT_RENDER_MODE_MONO );
+    mKerning.emit( osMetrics );
 
-            if (ftError != FT_Err_Ok) {
+    osMetrics << "#Char Maps\tEncoding\tPlatform ID\tEncoding ID\tDefault?\tNum Chars\t";
+    osMetrics << "#Char Code 1\tGlyph Code Point 1\tChar Code 2\tGlyph Code Point 2...\n";
+    osMetrics << "CHAR MAPS\n";
 
-                cerr << "FreeType error: " << ftError << "\n";
-                return false;
-            }
+    for ( auto& char_map : mCharMaps ) {
 
-            auto& bm = mFtFace->glyph->bitmap;
-            g->setSignedDist( bm );
-        }
+        char_map.emit( osMetrics );
+    }
+}
 
-        if ( baseX + g->signedDistWidth() > mConf.outputTextureSize() ) {
 
-            baseX = 0;
-            baseY += maxY;
-            maxY = 0;
-        }
+/** @return the float as a C++ literal that reads back to the same value. */
+static string floatLiteral( const float v )
+{
+    char buf[ 32 ];
 
-        g->setBaseXY(baseX, baseY);
-        baseX += g->signedDistWidth();
-        maxY = std::max( maxY, g->signedDistHeight() );
+    snprintf( buf, sizeof( buf ), "%.9g", v );
 
-        if ( mVerbose ) {
+    string s( buf );
 
-            g->visualize(cerr);
-            cerr << "Num Glyphs Processed: " << numGlyphsProcessed << "/" << mGlyphs.size() << "\n";
-            cerr << "Base:[" << baseX << " , " << baseY << "]\n";
-            cerr << "\n";
-        }
+    if ( s.find_first_of( ".en" ) == string::npos ) {
 
-        numGlyphsProcessed++;
+        s += ".0";
     }
+    return s + "f";
+}
 
-    return true;
+
+/** @return the name with the characters not allowed in an identifier
+ *          replaced with '_'.
+ */
+static string toIdentifier( const string& name )
+{
+    string s;
+
+    for ( const auto c : name ) {
+
+        s += isalnum( (unsigned char)c ) ? c : '_';
+    }
+
+    if ( s.empty() || isdigit( (unsigned char)s[ 0 ] ) ) {
+
+        s = "_" + s;
+    }
+    return s;
 }
 
 
-bool Generator::generateTexture( bool reverseY )
+/** @brief writes the body of a static array, 16 elements per line.
+ *         An empty array is written with a 0, as C++ does not allow it,
+ *         and its length is given separately.
+ */
+template< class T, class F >
+static void emitArrayBody( ostream& os, const vector< T >& values, F toLiteral )
 {
+    os << "{\n";
 
-    auto len = mConf.outputTextureSize();
+    if ( values.empty() ) {
 
-    mPtrMain = (unsigned char*) malloc (sizeof(unsigned char) * 4 * len * len);
+        os << "    0\n";
+    }
 
-    if ( mPtrMain == nullptr ) {
+    for ( size_t i = 0; i < values.size(); i++ ) {
 
-        std::cerr << "Error\n";
-        return false;
+        os << ( ( i % 16 == 0 ) ? "    " : " " ) << toLiteral( values[ i ] ) << ",";
+
+        if ( i % 16 == 15 || i == values.size() - 1 ) {
+
+            os << "\n";
+        }
     }
+    os << "};\n\n";
+}
 
-    memset ( mPtrMain, (int)0, sizeof(unsigned char) * 4 * len * len );
 
-    mPtrArray = (unsigned char**) malloc ( sizeof(unsigned char*) * len ) ;
-               
+/** @brief finds the seeds of EmbeddedCharMap for the char codes.
+ *
+ *         The buckets are placed from the largest, each with the first
+ *         seed that sends all its char codes to the free slots. If a
+ *         bucket finds no seed, the slots are increased and it starts over.
+ *
+ *  @param charCodes (in):  pairs of the char code and the glyph index.
+ *  @param seeds     (out): seed per bucket.
+ *  @param slots     (out): the char code and the glyph index per slot.
+ */
+static void buildPerfectHash(
+    const vector< pair< uint32_t, uint32_t > >& charCodes,
+    vector< uint32_t >&                         seeds,
+    vector< EmbeddedCharMapSlot >&              slots
+) {
+    static const uint32_t MaxSeed = 1 << 16;
 
-    if ( mPtrArray == nullptr ) {
+    const size_t n          = charCodes.size();
+    const size_t numBuckets = std::max( (size_t)1, ( n + 3 ) / 4 );
 
-        free(mPtrMain);
-        std::cerr << "Error\n";
-        return false;
+    vector< vector< size_t > > buckets( numBuckets );
+
+    for ( size_t i = 0; i < n; i++ ) {
+
+        buckets[ EmbeddedCharMap::hash( charCodes[ i ].first, 0 ) % numBuckets ].push_back( i );
     }
 
-    for (auto i = 0; i < len; i++ ) {
+    vector< size_t > order( numBuckets );
 
-        mPtrArray[i] = &( mPtrMain[ sizeof(unsigned char) * len * i ] );
+    for ( size_t b = 0; b < numBuckets; b++ ) {
+
+        order[ b ] = b;
     }
 
-    for ( auto* g : mGlyphs ) {
+    stable_sort( order.begin(), order.end(), [ & ]( const size_t a, const size_t b ) {
+        return buckets[ a ].size() > buckets[ b ].size();
+    } );
 
-        for ( auto srcY = 0; srcY < g->signedDistHeight(); srcY++ ) {
+    size_t numSlots = std::max( (size_t)1, n + n / 4 );
 
-            auto dstY    = len - 1 - ( srcY + g->baseY() );
+    while ( true ) {
 
-            if ( dstY < 0 || len <= dstY ) {
-                continue;
+        seeds.assign( numBuckets, 1 );
+        slots.assign( numSlots, EmbeddedCharMapSlot{ EmbeddedCharMap::EmptyCharCode, 0 } );
+
+        bool failed = false;
+
+        for ( const auto b : order ) {
+
+            if ( buckets[ b ].empty() ) {
+
+                break;
             }
-            auto* curRow = mPtrArray [dstY];
 
-            for ( auto srcX = 0; srcX < g->signedDistWidth(); srcX++ ) {
+            vector< size_t > positions;
+            uint32_t         seed = 1;
 
-                auto dstX  = ( srcX + g->baseX() );
-                if ( dstX < 0 || len <= dstX ) {
-                    continue;
+            for ( ; seed < MaxSeed; seed++ ) {
+
+                positions.clear();
+
+                for ( const auto i : buckets[ b ] ) {
+
+                    const size_t pos = EmbeddedCharMap::hash( charCodes[ i ].first, seed ) % numSlots;
+
+                    if (    slots[ pos ].mCharCode != EmbeddedCharMap::EmptyCharCode
+                         || find( positions.begin(), positions.end(), pos ) != positions.end() ) {
+
+                        break;
+                    }
+                    positions.push_back( pos );
                 }
 
-                auto dist  = g->signedDist(
-                    srcX, 
-                    reverseY ? srcY : (g->signedDistHeight() - 1 - srcY)
-                );
+                if ( positions.size() == buckets[ b ].size() ) {
 
-                auto alpha = min ( 255, max( 0, (int)( dist * 255.0 ) ) );
-                curRow [ dstX ] = (unsigned char)alpha;
+                    break;
+                }
             }
-        }
-    }
-
-    return true;
-}
 
+            if ( seed == MaxSeed ) {
 
-void Generator::releaseTexture()
-{
-    if ( mPtrMain != nullptr ) {
+                failed = true;
+                break;
+            }
 
-        free ( mPtrMain  );
-        free ( mPtrArray );
-        
-        mPtrMain  = nullptr;
-        mPtrArray = nullptr;
-    }
-}
+            seeds[ b ] = seed;
 
+            for ( size_t k = 0; k < positions.size(); k++ ) {
 
-unsigned char** Generator::textureBitmap()
-{
-    if ( !generateTexture( mConf.isReverseYDirectionForGlyphsSet() ) ) {
+                slots[ positions[ k ] ] = EmbeddedCharMapSlot{ charCodes[ buckets[ b ][ k ] ].first,
+                                                               charCodes[ buckets[ b ][ k ] ].second };
+            }
+        }
 
-        std::cerr << "Error\n";
+        if ( !failed ) {
 
-        return nullptr;
+            return;
+        }
+        numSlots += numSlots / 4 + 1;
     }
-    return mPtrArray;
 }
 
 
-bool Generator::emitFilePNG()
+bool Generator::emitFileHeader()
 {
-    if ( !generateTexture( mConf.isReverseYDirectionForGlyphsSet() ) ) {
+    FontAtlas atlas;
+
+    if ( !generateAtlas( atlas ) ) {
 
         std::cerr << "Error\n";
         return false;
     }
 
-    string outputFileNamePNG = mConf.outputFileName() + ".png";
+    const string fileName = mConf.outputFileName() + ".hpp";
 
-    FILE*  pngOut = fopen( outputFileNamePNG.c_str(), "wb" );
+    ofstream os( fileName );
 
-    if ( pngOut == nullptr ) {
+    if ( !os ) {
 
-        releaseTexture();
         std::cerr << "Error\n";
         return false;
     }
 
-    png_structp pngWritePtr = png_create_write_struct( PNG_LIBPNG_VER_STRING,
-                                                       NULL,
-                                                       NULL,
-                                                       NULL
-                                                     );
-    if ( pngWritePtr == nullptr ) {
+    const string name  = toIdentifier( std::filesystem::path( mConf.outputFileName() ).filename().string() );
+    string       guard = "__SDFONT_EMBEDDED_" + name + "_HPP__";
 
-        fclose ( pngOut   );
-        releaseTexture();
-        std::cerr << "Error\n";
-        return false;
-    }
+    transform( guard.begin(), guard.end(), guard.begin(), ::toupper );
 
-    png_infop pngInfoPtr = png_create_info_struct( pngWritePtr );
+    os << "// Generated by SDFont from " << mConf.fontPath() << ". Do not edit.\n";
+    os << "//\n";
+    os << "// SDFont::RuntimeHelper helper( SDFontEmbedded::" << name << "::Font );\n";
+    os << "// SDFont::TextureLoader texture( SDFontEmbedded::" << name << "::Font );\n\n";
+    os << "#ifndef " << guard << "\n";
+    os << "#define " << guard << "\n\n";
+    os << "#include <cstdint>\n\n";
+    os << "#include \"sdfont/embedded_font.hpp\"\n\n";
+    os << "namespace SDFontEmbedded {\n\n";
+    os << "namespace " << name << " {\n\n";
 
-    if ( pngInfoPtr == nullptr ) {
+    // Glyphs in the ascending order of the code points, for
+    // EmbeddedFont::indexByCodePoint().
+    map< long, uint32_t > glyphIndices;
 
-        png_destroy_write_struct( &pngWritePtr, (png_infopp)NULL ) ;
-        fclose ( pngOut   );
-        releaseTexture();
-        std::cerr << "Error\n";
-        return false;
-    }
+    os << "// Code Point, Width, Height, Horizontal Bearing X, Horizontal Bearing Y, Horizontal Advance,\n";
+    os << "// Vertical Bearing X, Vertical Bearing Y, Vertical Advance,\n";
+    os << "// Texture Coord X, Texture Coord Y, Texture Width, Texture Height, Texture Channel\n";
+    os << "inline constexpr SDFont::EmbeddedGlyph Glyphs[] = {\n";
 
-    if ( setjmp( png_jmpbuf( pngWritePtr ) ) != 0 ) {
+    for ( const auto& pair : atlas.mGlyphs ) {
 
-        png_destroy_write_struct( &pngWritePtr, &pngInfoPtr ) ;
-        fclose ( pngOut   );
-        releaseTexture();
-        std::cerr << "Error\n";
-        return false;
+        const auto& g = pair.second;
+
+        glyphIndices.emplace( g.mCodePoint, (uint32_t)glyphIndices.size() );
+
+        os << "    { 0X" << toHexString( (uint32_t)g.mCodePoint )
+           << ", " << floatLiteral( g.mWidth )
+           << ", " << floatLiteral( g.mHeight )
+           << ", " << floatLiteral( g.mHorizontalBearingX )
+           << ", " << floatLiteral( g.mHorizontalBearingY )
+           << ", " << floatLiteral( g.mHorizontalAdvance )
+           << ", " << floatLiteral( g.mVerticalBearingX )
+           << ", " << floatLiteral( g.mVerticalBearingY )
+           << ", " << floatLiteral( g.mVerticalAdvance )
+           << ", " << floatLiteral( g.mTextureCoordX )
+           << ", " << floatLiteral( g.mTextureCoordY )
+           << ", " << floatLiteral( g.mTextureWidth )
+           << ", " << floatLiteral( g.mTextureHeight )
+           << ", " << g.mTextureChannel
+           << " },\n";
     }
+    os << "};\n\n";
 
-    png_init_io( pngWritePtr, pngOut );
+    // Char maps with only the glyphs in the texture.
+    vector< pair< size_t, size_t > > numBucketsAndSlots;
 
-    if ( setjmp( png_jmpbuf( pngWritePtr ) ) != 0 ) {
+    for ( size_t i = 0; i < atlas.mCharMaps.size(); i++ ) {
 
-        png_destroy_write_struct( &pngWritePtr, &pngInfoPtr ) ;
-        fclose ( pngOut   );
-        releaseTexture();
-        std::cerr << "Error\n";
-        return false;
-    }
+        vector< pair< uint32_t, uint32_t > > charCodes;
 
-    png_set_IHDR( pngWritePtr,
-                  pngInfoPtr,
-                  mConf.outputTextureSize(),
-                  mConf.outputTextureSize(),
-                  8,
-                  PNG_COLOR_TYPE_GRAY,
-                  PNG_INTERLACE_NONE,
-                  PNG_COMPRESSION_TYPE_BASE,
-                  PNG_FILTER_TYPE_BASE
-                );
+        for ( const auto& pe : atlas.mCharMaps[ i ].m_char_to_codepoint ) {
 
-    png_write_info( pngWritePtr, pngInfoPtr );
+            const auto it = glyphIndices.find( pe.second );
 
-    if ( setjmp( png_jmpbuf( pngWritePtr ) ) != 0 ) {
+            if ( it != glyphIndices.end() && pe.first != EmbeddedCharMap::EmptyCharCode ) {
 
-        png_destroy_write_struct( &pngWritePtr, &pngInfoPtr ) ;
-        fclose ( pngOut   );
-        releaseTexture();
-        std::cerr << "Error\n";
-        return false;
+                charCodes.emplace_back( pe.first, it->second );
+            }
+        }
+
+        vector< uint32_t >            seeds;
+        vector< EmbeddedCharMapSlot > slots;
+
+        if ( !charCodes.empty() ) {
+
+            buildPerfectHash( charCodes, seeds, slots );
+        }
+        numBucketsAndSlots.emplace_back( seeds.size(), slots.size() );
+
+        os << "inline constexpr uint32_t CharMap" << i << "Seeds[] = ";
+        emitArrayBody( os, seeds, []( const uint32_t v ) { return to_string( v ); } );
+
+        os << "inline constexpr SDFont::EmbeddedCharMapSlot CharMap" << i << "Slots[] = ";
+        emitArrayBody( os, slots, []( const EmbeddedCharMapSlot& v ) {
+            return "{ 0X" + toHexString( v.mCharCode ) + ", " + to_string( v.mGlyphIndex ) + " }";
+        } );
+
+        if ( mVerbose ) {
+
+            cerr << "Char map [" << atlas.mCharMaps[ i ].m_encoding << "] is hashed into ["
+                 << slots.size() << "] slots for [" << charCodes.size() << "] chars.\n";
+        }
     }
 
-    png_write_image( pngWritePtr, mPtrArray );
+    os << "inline constexpr SDFont::EmbeddedCharMap CharMaps[] = {\n";
 
-    if ( setjmp( png_jmpbuf( pngWritePtr ) ) != 0 ) {
+    for ( size_t i = 0; i < atlas.mCharMaps.size(); i++ ) {
 
-        png_destroy_write_struct( &pngWritePtr, &pngInfoPtr ) ;
-        fclose ( pngOut   );
-        releaseTexture();
-        std::cerr << "Error\n";
-        return false;
+        const auto& charMap = atlas.mCharMaps[ i ];
+
+        os << "    { " << ( charMap.m_default ? "true" : "false" )
+           << ", \"" << charMap.m_encoding << "\""
+           << ", " << charMap.m_platform_id
+           << ", " << charMap.m_encoding_id
+           << ", " << numBucketsAndSlots[ i ].first  << ", CharMap" << i << "Seeds"
+           << ", " << numBucketsAndSlots[ i ].second << ", CharMap" << i << "Slots"
+           << " },\n";
     }
 
-    png_write_end( pngWritePtr, NULL );
+    if ( atlas.mCharMaps.empty() ) {
 
-    png_destroy_write_struct( &pngWritePtr, &pngInfoPtr ) ;
+        os << "    { false, \"\", 0, 0, 0, nullptr, 0, nullptr }\n";
+    }
+    os << "};\n\n";
 
-    fclose ( pngOut   );
-    releaseTexture();
+    const auto& kerning = atlas.mKerning;
 
-    return true;
-}
+    os << "inline constexpr uint16_t KerningLeftClasses[] = ";
+    emitArrayBody( os, kerning.mLeftClasses,  []( const uint16_t v ) { return to_string( v ); } );
 
+    os << "inline constexpr uint16_t KerningRightClasses[] = ";
+    emitArrayBody( os, kerning.mRightClasses, []( const uint16_t v ) { return to_string( v ); } );
 
-bool Generator::emitFileMetrics()
-{
-    ofstream osMetrics(mConf.outputFileName() + ".txt");
+    os << "inline constexpr float KerningValues[] = ";
+    emitArrayBody( os, kerning.mValues,       []( const float v ) { return floatLiteral( v ); } );
 
-    if ( !osMetrics ) {
+    // The texture with the first row at the bottom, as in FontAtlas.
+    os << "alignas( 16 ) inline constexpr uint8_t Pixels[] = ";
+    emitArrayBody( os, atlas.mPixels, []( const uint8_t v ) { return to_string( v ); } );
+
+    os << "inline constexpr SDFont::EmbeddedFont Font = {\n"
+       << "    " << atlas.mTextureSize << ", " << atlas.mNumChannels << ", Pixels,\n"
+       << "    " << floatLiteral( atlas.mSpreadInTexture ) << ", "
+                 << floatLiteral( atlas.mSpreadInFontMetrics ) << ",\n"
+       << "    " << atlas.mGlyphs.size() << ", Glyphs,\n"
+       << "    " << atlas.mCharMaps.size() << ", CharMaps,\n"
+       << "    { " << kerning.mNumLeftClasses << ", " << kerning.mNumRightClasses << ",\n"
+       << "      " << kerning.mLeftClasses.size()  << ", KerningLeftClasses,\n"
+       << "      " << kerning.mRightClasses.size() << ", KerningRightClasses,\n"
+       << "      KerningValues }\n"
+       << "};\n\n";
+
+    os << "} // namespace " << name << "\n\n";
+    os << "} // namespace SDFontEmbedded\n\n";
+    os << "#endif /*" << guard << "*/\n";
+
+    os.close();
+
+    if ( !os ) {
 
         std::cerr << "Error\n";
         return false;
     }
 
-    mConf.outputMetricsHeader( osMetrics );
+    if ( mVerbose ) {
 
-    osMetrics << "SPREAD IN TEXTURE\n";
-    osMetrics << (float)mConf.signedDistExtent() / (float) mConf.outputTextureSize();
-    osMetrics << "\n";
-    osMetrics << "SPREAD IN FONT METRICS\n";
-    osMetrics << (float)mConf.signedDistExtent() / mConf.glyphScalingFromSamplingToPackedSignedDist() / (float) mConf.glyphBitmapSizeForSampling();
-    osMetrics << "\n";
-    osMetrics << "GLYPHS\n";
+        cerr << "Output Header written to [" << fileName << "]\n";
+    }
 
-    for ( auto* g : mGlyphs ) {
+    return true;
+}
 
-        g->emitMetrics( osMetrics );
-        osMetrics << "\n";
 
-    }
+float Generator::spreadInTexture() const
+{
+    return (float)mConf.signedDistExtent() / (float) mConf.outputTextureSize();
+}
+
 
-    osMetrics << "#Kernings\tPred Code Point\tSucc Code Point 1"
-                 "\tKerning1\tSucc Code Point 2\tKerning 2...\n";
+float Generator::spreadInFontMetrics() const
+{
+    return (float)mConf.signedDistExtent() / mConf.glyphScalingFromSamplingToPackedSignedDist() / (float) mConf.glyphBitmapSizeForSampling();
+}
 
-    osMetrics << "KERNINGS\n";
 
-    for ( auto* g : mGlyphs ) {
+bool Generator::generateAtlas( FontAtlas& atlas )
+{
+    const auto len         = mConf.outputTextureSize();
+    const auto numChannels = mConf.numChannels();
+    const auto rowBytes    = numChannels * len;
 
-        g->emitKernings( osMetrics );
+    atlas.mTextureSize = len;
+    atlas.mNumChannels = numChannels;
+    atlas.mPixels.assign( rowBytes * len, 0 );
 
+    // The texture is filled top row first into the rows laid out from the
+    // bottom, so that it can be uploaded without being flipped.
+    vector< unsigned char* > rows( len );
+
+    for ( auto i = 0; i < len; i++ ) {
+
+        rows[ i ] = &( atlas.mPixels[ rowBytes * ( len - 1 - i ) ] );
     }
 
-    osMetrics << "#Char Maps\tEncoding\tPlatform ID\tEncoding ID\tDefault?\tNum Chars\t";
-    osMetrics << "#Char Code 1\tGlyph Code Point 1\tChar Code 2\tGlyph Code Point 2...\n";
-    osMetrics << "CHAR MAPS\n";
+    fillTexture( rows.data(), mConf.isReverseYDirectionForGlyphsSet() );
 
-    for ( auto& char_map : mCharMaps ) {
+    atlas.mSpreadInTexture     = spreadInTexture();
+    atlas.mSpreadInFontMetrics = spreadInFontMetrics();
 
-        char_map.emit( osMetrics );
+    atlas.mGlyphs.clear();
+
+    for ( auto* g : mGlyphs ) {
+
+        auto sdg = g->generateSDGlyph();
+        atlas.mGlyphs.emplace( sdg.mCodePoint, std::move( sdg ) );
     }
 
-    osMetrics.close();
+    atlas.mCharMaps.clear();
 
-    if ( mVerbose ) {
+    for ( const auto& charMap : mCharMaps ) {
 
-        cerr << "Output Metrics written to ["
-             << mConf.outputFileName() << ".txt]\n";
+        atlas.mCharMaps.push_back( charMap );
     }
 
+    atlas.mKerning = mKerning;
+
     return true;
 }
 
@@ -934,7 +2265,7 @@ void Generator::generateMetrics(float& margin, vector<Glyph>& glyphs)
 
     glyphs.clear();
 
-    margin =  (float)mConf.signedDistExtent() / (float) mConf.outputTextureSize();
+    margin = spreadInTexture();
 
     for ( auto* g : mGlyphs ) {
 
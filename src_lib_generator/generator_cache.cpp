@@ -0,0 +1,278 @@
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "sdfont/generator/generator_cache.hpp"
+
+namespace SDFont {
+
+GeneratorCache::GeneratorCache(
+    FT_Library   ftHandle,
+    mutex&       ftHandleMutex,
+    const size_t maxSignedDistBytes
+):
+    mFtHandle           ( ftHandle ),
+    mFtHandleMutex      ( ftHandleMutex ),
+    mMaxSignedDistBytes ( maxSignedDistBytes ),
+    mSignedDistBytes    ( 0 )
+    {;}
+
+
+GeneratorCache::~GeneratorCache()
+{
+    clear();
+}
+
+
+void GeneratorCache::clear()
+{
+    // The outlines belong to the library, not to the faces.
+    mOutlines.clear();
+    mSignedDists.clear();
+    mSignedDistBytes = 0;
+
+    for ( auto& e : mFonts ) {
+
+        releaseFont( e.second );
+    }
+    mFonts.clear();
+}
+
+
+bool GeneratorCache::findFace( const string& fontPath, FT_Face& face, FT_Byte*& data, size_t& dataSize )
+{
+    struct stat st;
+
+    if ( stat( fontPath.c_str(), &st ) != 0 ) {
+
+        cerr << "Can not open [" << fontPath << "]\n";
+        return false;
+    }
+
+    auto it = mFonts.find( fontPath );
+
+    if ( it != mFonts.end() && it->second.mModifiedTime != st.st_mtime ) {
+
+        dropFont( fontPath );
+        it = mFonts.end();
+    }
+
+    if ( it == mFonts.end() ) {
+
+        Font font;
+
+        if ( !loadFont( fontPath, font ) ) {
+
+            return false;
+        }
+
+        font.mModifiedTime = st.st_mtime;
+
+        it = mFonts.emplace( fontPath, font ).first;
+    }
+
+    face     = it->second.mFace;
+    data     = it->second.mData;
+    dataSize = it->second.mDataSize;
+
+    return true;
+}
+
+
+bool GeneratorCache::loadFont( const string& fontPath, Font& font )
+{
+    const int fd = open( fontPath.c_str(), O_RDONLY );
+
+    if ( fd < 0 ) {
+
+        cerr << "Can not open [" << fontPath << "]\n";
+        return false;
+    }
+
+    struct stat st;
+
+    if ( fstat( fd, &st ) != 0 || st.st_size == 0 ) {
+
+        cerr << "Can not read [" << fontPath << "]\n";
+        close( fd );
+        return false;
+    }
+
+    void* data = mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+    close( fd );
+
+    if ( data == MAP_FAILED ) {
+
+        cerr << "Can not map [" << fontPath << "]\n";
+        return false;
+    }
+
+    font.mData     = static_cast< FT_Byte* >( data );
+    font.mDataSize = st.st_size;
+    font.mFace     = nullptr;
+
+    FT_Error ftError;
+    {
+        lock_guard< mutex > lock( mFtHandleMutex );
+
+        ftError = FT_New_Memory_Face( mFtHandle, font.mData, font.mDataSize, 0, &font.mFace );
+    }
+
+    if ( ftError != FT_Err_Ok ) {
+
+        cerr << "Free Type error: " << ftError << "\n";
+        munmap( font.mData, font.mDataSize );
+        return false;
+    }
+
+    return true;
+}
+
+
+void GeneratorCache::releaseFont( Font& font )
+{
+    {
+        lock_guard< mutex > lock( mFtHandleMutex );
+
+        FT_Done_Face( font.mFace );
+    }
+
+    munmap( font.mData, font.mDataSize );
+}
+
+
+void GeneratorCache::dropFont( const string& fontPath )
+{
+    for ( auto it = mOutlines.begin(); it != mOutlines.end(); ) {
+
+        it = ( get< 0 >( it->first ) == fontPath ) ? mOutlines.erase( it ) : next( it );
+    }
+
+    for ( auto it = mSignedDists.begin(); it != mSignedDists.end(); ) {
+
+        if ( get< 0 >( it->first ) == fontPath ) {
+
+            mSignedDistBytes -= ( it->second.mDist.size() + it->second.mDistMulti.size() ) * sizeof( float );
+            it = mSignedDists.erase( it );
+        }
+        else {
+            it++;
+        }
+    }
+
+    auto it = mFonts.find( fontPath );
+
+    if ( it != mFonts.end() ) {
+
+        releaseFont( it->second );
+        mFonts.erase( it );
+    }
+}
+
+
+bool GeneratorCache::findOutline(
+    const string&  fontPath,
+    const long     samplingSize,
+    const FT_UInt  glyphIndex,
+    GlyphOutline&  outline,
+    string&        glyphName
+) const {
+
+    const auto it = mOutlines.find( OutlineKey( fontPath, samplingSize, glyphIndex ) );
+
+    if ( it == mOutlines.end() ) {
+
+        return false;
+    }
+
+    if ( outline.copyFrom( *( it->second.mOutline ) ) != FT_Err_Ok ) {
+
+        return false;
+    }
+
+    glyphName = it->second.mGlyphName;
+
+    return true;
+}
+
+
+void GeneratorCache::storeOutline(
+    const string&       fontPath,
+    const long          samplingSize,
+    const FT_UInt       glyphIndex,
+    const GlyphOutline& outline,
+    const string&       glyphName
+) {
+    Outline entry;
+
+    entry.mOutline.reset( new GlyphOutline() );
+
+    if ( entry.mOutline->copyFrom( outline ) != FT_Err_Ok ) {
+
+        return;
+    }
+
+    entry.mGlyphName = glyphName;
+
+    mOutlines[ OutlineKey( fontPath, samplingSize, glyphIndex ) ] = std::move( entry );
+}
+
+
+GeneratorCache::SignedDistKey GeneratorCache::makeSignedDistKey(
+    const GeneratorConfig& conf,
+    const FT_UInt          glyphIndex
+) {
+    return SignedDistKey(
+        conf.fontPath(),
+        conf.glyphBitmapSizeForSampling(),
+        conf.ratioSpreadToGlyph(),
+        conf.glyphScalingFromSamplingToPackedSignedDist(),
+        conf.isDeadReckoningSet(),
+        conf.isMultiChannelSet(),
+        glyphIndex
+    );
+}
+
+
+const GeneratorCache::SignedDist* GeneratorCache::findSignedDist(
+    const GeneratorConfig& conf,
+    const FT_UInt          glyphIndex
+) const {
+
+    const auto it = mSignedDists.find( makeSignedDistKey( conf, glyphIndex ) );
+
+    return ( it != mSignedDists.end() ) ? &( it->second ) : nullptr;
+}
+
+
+void GeneratorCache::storeSignedDist(
+    const GeneratorConfig& conf,
+    const FT_UInt          glyphIndex,
+    SignedDist&&           signedDist
+) {
+    const size_t bytes = ( signedDist.mDist.size() + signedDist.mDistMulti.size() ) * sizeof( float );
+
+    if ( mSignedDistBytes + bytes > mMaxSignedDistBytes ) {
+
+        // Simply started over, as the entries of the previous settings
+        // are less likely to be used again.
+        mSignedDists.clear();
+        mSignedDistBytes = 0;
+    }
+
+    const auto key = makeSignedDistKey( conf, glyphIndex );
+    const auto it  = mSignedDists.find( key );
+
+    if ( it != mSignedDists.end() ) {
+
+        mSignedDistBytes -= ( it->second.mDist.size() + it->second.mDistMulti.size() ) * sizeof( float );
+    }
+
+    mSignedDists[ key ] = std::move( signedDist );
+    mSignedDistBytes   += bytes;
+}
+
+} // namespace SDFont
@@ -5,10 +5,16 @@ namespace SDFont {
 const string GeneratorConfig::FileNameExtraGlyphLineFeed       = "lf.png";
 const string GeneratorConfig::FileNameExtraGlyphBlank          = "blank.png";
 
+const string GeneratorConfig::OutputFormatPNG                  = "png";
+const string GeneratorConfig::OutputFormatBC4                  = "bc4";
+const string GeneratorConfig::OutputFormatEACR11               = "eac_r11";
+const string GeneratorConfig::OutputFormatR8                   = "r8";
+
 const string GeneratorConfig::DefaultFontPath = "/usr/share/fonts/Arial.ttf" ;
 const string GeneratorConfig::DefaultExtraGlyphPath = "" ;
 const string GeneratorConfig::DefaultOutputFileName = "signed_dist_font" ;
 const string GeneratorConfig::DefaultEncoding = "unicode" ;
+const string GeneratorConfig::DefaultOutputFormat = "png" ;
 
 const long   GeneratorConfig::DefaultOutputTextureSize      =  512 ;
 const float  GeneratorConfig::DefaultRatioSpreadToGlyph     =  0.2f ;
@@ -17,6 +23,9 @@ const long   GeneratorConfig::DefaultNumThreads             =  0 ;
 const long   GeneratorConfig::DefaultGlyphBitmapSizeForSampling = 1024 ;
 const bool   GeneratorConfig::DefaultEnableDeadReckoning    = false;
 const bool   GeneratorConfig::DefaultReverseYDirectionForGlyphs = false;
+const bool   GeneratorConfig::DefaultEnableMultiChannel = false;
+const bool   GeneratorConfig::DefaultPackChannels = false;
+const bool   GeneratorConfig::DefaultEmitHeader   = false;
 const bool   GeneratorConfig::DefaultFaceHasGlyphNames = false;
 
 void GeneratorConfig::trim( string& line ) const
@@ -92,6 +101,9 @@ void GeneratorConfig::emitVerbose() const {
         }
         cerr << "]\n";
     }
+    for ( const auto& path : mCorpusPaths ) {
+        cerr << "Corpus: [" << path << "]\n";
+    }
     if ( mProcessHiddenGlyphs ) {
         cerr << "Processing Hidden Glyphs.\n";
     }
@@ -105,6 +117,10 @@ void GeneratorConfig::emitVerbose() const {
     cerr << "Ratio Spread to Glyph: [" << ratioSpreadToGlyph()   << "]\n";
     cerr << "Dead Reckoning: [" << isDeadReckoningSet() << "]\n";
     cerr << "ReverseYDirectionForGlyphSet: [" << isReverseYDirectionForGlyphsSet() << "]\n";
+    cerr << "Multi-Channel Signed Distance: [" << isMultiChannelSet() << "]\n";
+    cerr << "Pack Channels: [" << isPackChannelsSet() << "]\n";
+    cerr << "Emit Header: [" << isEmitHeaderSet() << "]\n";
+    cerr << "Output Format: [" << mOutputFormat << "]\n";
 }
 
 
@@ -125,6 +141,9 @@ void GeneratorConfig::outputMetricsHeader( ostream& os ) const  {
         os << " (" << pair.first << "," << pair.second << ")";
     }
     os << "]\n";
+    for ( const auto& path : mCorpusPaths ) {
+        os << "# Corpus: " << path << "\n";
+    }
     os << "# Glyph Bitmap Size for Sampling: ";
     os << glyphBitmapSizeForSampling();
     os << "\n";
@@ -134,8 +153,16 @@ void GeneratorConfig::outputMetricsHeader( ostream& os ) const  {
     os << "# Glyph Scaling from Sampling to Packed Signed Dist: ";
     os << mGlyphScalingFromSamplingToPackedSignedDist;
     os << "\n";
+    os << "# Channels: ";
+    if ( mPackChannels ) {
+        os << "RGBA (packed, one channel per glyph)";
+    }
+    else {
+        os << ( mEnableMultiChannel ? "RGB (multi-channel, use the median)" : "GRAY" );
+    }
+    os << "\n";
     os << "# Associated Texture File: ";
-    os << mOutputFileName << ".png\n";
+    os << mOutputFileName << textureFileExtension() << "\n";
     os << "#\t";
     os << "Code Point";
     os << "\t";
@@ -164,6 +191,10 @@ void GeneratorConfig::outputMetricsHeader( ostream& os ) const  {
     os << "Texture Width";
     os << "\t";
     os << "Texture Height";
+    if ( mPackChannels ) {
+        os << "\t";
+        os << "Texture Channel";
+    }
     os << "\n";
 }
 
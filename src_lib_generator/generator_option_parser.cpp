@@ -19,9 +19,14 @@ const string GeneratorOptionParser::Usage = "Usage: "
                                             "-ratio_spread_to_glyph [float] "
                                             "-process_hidden_glyphs "
                                             "-char_code_range 0X********-0X******** (can be specified multiple times) "
+                                            "-corpus [UTF-8 text file] (can be specified multiple times) "
                                             "-num_threads [num 1-64] "
                                             " -enable_dead_reckoning  "
                                             " -reverse_y_direction_for_glyphs  "
+                                            " -enable_msdf  "
+                                            " -pack_channels  "
+                                            " -emit_header  "
+                                            "-output_format [png|bc4|eac_r11|r8] "
                                             "[output file name w/o ext]"
                                             "\n";
 
@@ -32,11 +37,16 @@ const string GeneratorOptionParser::GlyphSizeForSampling = "-glyph_size_for_samp
 const string GeneratorOptionParser::RatioSpreadToGlyph   = "-ratio_spread_to_glyph" ;
 const string GeneratorOptionParser::ProcessHiddenGlyphs  = "-process_hidden_glyphs" ;
 const string GeneratorOptionParser::CharCodeRange        = "-char_code_range" ;
+const string GeneratorOptionParser::Corpus               = "-corpus" ;
 const string GeneratorOptionParser::NumThreads           = "-num_threads" ;
 const string GeneratorOptionParser::Encoding             = "-encoding" ;
 const string GeneratorOptionParser::EnableDeadReckoning  = "-enable_dead_reckoning" ;
 const string GeneratorOptionParser::ReverseYDirectionForGlyphs
                                                          = "-reverse_y_direction_for_glyphs";
+const string GeneratorOptionParser::EnableMultiChannel   = "-enable_msdf" ;
+const string GeneratorOptionParser::PackChannels         = "-pack_channels" ;
+const string GeneratorOptionParser::EmitHeader           = "-emit_header" ;
+const string GeneratorOptionParser::OutputFormat         = "-output_format" ;
 const string GeneratorOptionParser::Help                 = "-help" ;
 const string GeneratorOptionParser::DashH                = "-h" ;
 const string GeneratorOptionParser::Verbose              = "-verbose" ;
@@ -141,6 +151,18 @@ bool GeneratorOptionParser::parse( int argc, char* argv[] )
                 break;
             }
         }
+        else if ( arg.compare ( Corpus ) == 0 ) {
+
+            if ( i < argc - 1 ) {
+
+                string arg2( argv[++i] );
+                processCorpus( arg2 );
+            }
+            else {
+                mError = true;
+                break;
+            }
+        }
         else if ( arg.compare ( NumThreads ) == 0 ) {
 
             if ( i < argc - 1 ) {
@@ -172,6 +194,30 @@ bool GeneratorOptionParser::parse( int argc, char* argv[] )
         else if ( arg.compare ( ReverseYDirectionForGlyphs ) == 0 ) {
 
             processReverseYDirectionForGlyphs( true );
+        }
+        else if ( arg.compare ( EnableMultiChannel ) == 0 ) {
+
+            processMultiChannel( true );
+        }
+        else if ( arg.compare ( PackChannels ) == 0 ) {
+
+            processPackChannels( true );
+        }
+        else if ( arg.compare ( EmitHeader ) == 0 ) {
+
+            processEmitHeader( true );
+        }
+        else if ( arg.compare ( OutputFormat ) == 0 ) {
+
+            if ( i < argc - 1 ) {
+
+                string arg2( argv[++i] );
+                processOutputFormat( arg2 );
+            }
+            else {
+                mError = true;
+                break;
+            }
         }
 	    else {
 
@@ -179,6 +225,21 @@ bool GeneratorOptionParser::parse( int argc, char* argv[] )
         }
     }
 
+    if (    mConfig.isMultiChannelSet()
+         && mConfig.outputFormat() != GeneratorConfig::OutputFormatPNG ) {
+
+        // The KTX2 formats have only one channel.
+        mError = true;
+    }
+
+    if (    mConfig.isPackChannelsSet()
+         && (    mConfig.isMultiChannelSet()
+              || mConfig.outputFormat() != GeneratorConfig::OutputFormatPNG ) ) {
+
+        // A glyph in the packed texture has only one channel.
+        mError = true;
+    }
+
     return !mError;
 }
 
@@ -298,6 +359,18 @@ void GeneratorOptionParser::processCharCodeRange( const string& s )
     }
 }
 
+void GeneratorOptionParser::processCorpus( const string& s )
+{
+    if ( doesFileExist( s ) ) {
+
+        mConfig.addCorpusPath( s );
+    }
+    else {
+
+        mError = true;
+    }
+}
+
 void GeneratorOptionParser::processOutputFileName( const string& s ) {
 
     if ( isValidFileName ( s ) ) {
@@ -325,6 +398,36 @@ void GeneratorOptionParser::processReverseYDirectionForGlyphs ( const bool b ) {
     mConfig.setReverseYDirectionForGlyphs ( b );
 }
 
+void GeneratorOptionParser::processMultiChannel ( const bool b ) {
+
+    mConfig.setMultiChannel ( b );
+}
+
+void GeneratorOptionParser::processPackChannels ( const bool b ) {
+
+    mConfig.setPackChannels ( b );
+}
+
+void GeneratorOptionParser::processEmitHeader ( const bool b ) {
+
+    mConfig.setEmitHeader ( b );
+}
+
+void GeneratorOptionParser::processOutputFormat ( const string& s ) {
+
+    if (    s.compare( GeneratorConfig::OutputFormatPNG    ) == 0
+         || s.compare( GeneratorConfig::OutputFormatBC4    ) == 0
+         || s.compare( GeneratorConfig::OutputFormatEACR11 ) == 0
+         || s.compare( GeneratorConfig::OutputFormatR8     ) == 0 ) {
+
+        mConfig.setOutputFormat( s );
+    }
+    else {
+
+        mError = true;
+    }
+}
+
 
 bool GeneratorOptionParser::doesFileExist ( const string& s ) const {
 
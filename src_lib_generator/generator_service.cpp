@@ -0,0 +1,407 @@
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "sdfont/generator/generator_service.hpp"
+#include "sdfont/generator/generator_option_parser.hpp"
+#include "sdfont/generator/generator_config.hpp"
+#include "sdfont/generator/generator.hpp"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // SO_NOSIGPIPE is set on the socket instead.
+#endif
+
+namespace SDFont {
+
+GeneratorService::GeneratorService( const string& socketPath, const bool verbose ):
+    mSocketPath ( socketPath ),
+    mVerbose    ( verbose ),
+    mFtHandle   ( nullptr ),
+    mCache      ( nullptr ),
+    mListenFd   ( -1 )
+{
+    auto ftError = FT_Init_FreeType( &mFtHandle );
+
+    if ( ftError != FT_Err_Ok ) {
+
+        cerr << "FreeType error: " << ftError << "\n";
+        mFtHandle = nullptr;
+        return;
+    }
+
+    mCache = new GeneratorCache( mFtHandle, mFtHandleMutex );
+}
+
+
+GeneratorService::~GeneratorService()
+{
+    if ( mListenFd >= 0 ) {
+
+        close( mListenFd );
+        unlink( mSocketPath.c_str() );
+    }
+
+    // The faces in the cache must be done before the library.
+    if ( mCache != nullptr ) {
+
+        delete mCache;
+    }
+
+    if ( mFtHandle != nullptr ) {
+
+        FT_Done_FreeType( mFtHandle );
+    }
+}
+
+
+bool GeneratorService::run()
+{
+    if ( mFtHandle == nullptr ) {
+
+        return false;
+    }
+
+    struct sockaddr_un addr;
+
+    memset( &addr, 0, sizeof( addr ) );
+    addr.sun_family = AF_UNIX;
+
+    if ( mSocketPath.empty() || mSocketPath.size() >= sizeof( addr.sun_path ) ) {
+
+        cerr << "Invalid socket path [" << mSocketPath << "]\n";
+        return false;
+    }
+
+    strncpy( addr.sun_path, mSocketPath.c_str(), sizeof( addr.sun_path ) - 1 );
+
+    mListenFd = socket( AF_UNIX, SOCK_STREAM, 0 );
+
+    if ( mListenFd < 0 ) {
+
+        cerr << "Can not create a socket: " << strerror( errno ) << "\n";
+        return false;
+    }
+
+    // The socket left by a previous service that did not shut down.
+    unlink( mSocketPath.c_str() );
+
+    if (    bind( mListenFd, reinterpret_cast< struct sockaddr* >( &addr ), sizeof( addr ) ) != 0
+         || listen( mListenFd, 8 ) != 0                                                          ) {
+
+        cerr << "Can not listen on [" << mSocketPath << "]: " << strerror( errno ) << "\n";
+        close( mListenFd );
+        mListenFd = -1;
+        return false;
+    }
+
+    if ( mVerbose ) {
+
+        cerr << "Serving on [" << mSocketPath << "]\n";
+    }
+
+    bool running = true;
+
+    while ( running ) {
+
+        const int fd = accept( mListenFd, nullptr, nullptr );
+
+        if ( fd < 0 ) {
+
+            if ( errno == EINTR ) {
+
+                continue;
+            }
+            cerr << "Can not accept: " << strerror( errno ) << "\n";
+            return false;
+        }
+
+#ifdef SO_NOSIGPIPE
+        const int on = 1;
+        setsockopt( fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof( on ) );
+#endif
+        running = serveConnection( fd );
+
+        close( fd );
+    }
+
+    return true;
+}
+
+
+bool GeneratorService::serveConnection( const int fd )
+{
+    while ( true ) {
+
+        uint8_t header[ 12 ];
+
+        if ( !readFully( fd, header, sizeof( header ) ) ) {
+
+            // Closed by the client.
+            return true;
+        }
+
+        const uint32_t magic       = get32( &header[ 0 ] );
+        const uint32_t type        = get32( &header[ 4 ] );
+        const uint32_t payloadSize = get32( &header[ 8 ] );
+
+        if ( magic != Magic || payloadSize > MaxRequestPayload ) {
+
+            const string message( "Invalid request" );
+
+            sendResponse( fd, StatusError, vector< uint8_t >( message.begin(), message.end() ) );
+            return true;
+        }
+
+        vector< uint8_t > payload( payloadSize );
+
+        if ( payloadSize > 0 && !readFully( fd, payload.data(), payloadSize ) ) {
+
+            return true;
+        }
+
+        uint32_t          status = StatusOK;
+        vector< uint8_t > response;
+
+        switch ( type ) {
+
+          case RequestGenerate:
+
+            handleGenerate( payload, status, response );
+            break;
+
+          case RequestClearCache:
+
+            mCache->clear();
+            break;
+
+          case RequestShutdown:
+
+            sendResponse( fd, StatusOK, response );
+            return false;
+
+          default:
+          {
+            const string message( "Unknown request type" );
+
+            status = StatusError;
+            response.assign( message.begin(), message.end() );
+          }
+        }
+
+        if ( !sendResponse( fd, status, response ) ) {
+
+            return true;
+        }
+    }
+}
+
+
+void GeneratorService::handleGenerate(
+    const vector< uint8_t >& payload,
+    uint32_t&                status,
+    vector< uint8_t >&       response
+) {
+    auto fail = [ &status, &response ]( const string& message ) {
+
+        status = StatusError;
+        response.assign( message.begin(), message.end() );
+    };
+
+    vector< string > args{ "sdfont_commandline" };
+
+    if ( !parseArguments( payload, args ) ) {
+
+        fail( "Malformed arguments" );
+        return;
+    }
+
+    vector< char* > argv;
+
+    for ( auto& a : args ) {
+
+        argv.push_back( &a[0] );
+    }
+
+    GeneratorConfig       conf;
+    GeneratorOptionParser parser( conf );
+
+    if ( !parser.parse( argv.size(), argv.data() ) || parser.hasError() || parser.hasHelp() ) {
+
+        fail( "Invalid options\n" + parser.Usage );
+        return;
+    }
+
+    // The signed distances are computed on -num_threads as in the command
+    // line. The cache is touched only from this thread, before and after
+    // each glyph is handed to the threads.
+    Generator generator( conf, mVerbose, mFtHandle, mFtHandleMutex );
+
+    generator.setCache( mCache );
+
+    if ( !generator.generate() ) {
+
+        fail( "Generation failed" );
+        return;
+    }
+
+    unsigned char** rows = generator.textureBitmap();
+
+    if ( rows == nullptr ) {
+
+        fail( "Texture generation failed" );
+        return;
+    }
+
+    ostringstream osMetrics;
+
+    generator.emitMetrics( osMetrics );
+
+    const string   metrics     = osMetrics.str();
+    const uint32_t textureSize = conf.outputTextureSize();
+    const uint32_t numChannels = conf.numChannels();
+    const size_t   rowBytes    = (size_t)textureSize * numChannels;
+
+    response.clear();
+    response.reserve( 20 + rowBytes * textureSize + metrics.size() );
+
+    put32( response, textureSize );
+    put32( response, numChannels );
+    put32( response, generator.numGlyphs() );
+    put32( response, generator.numGlyphsFromCache() );
+    put32( response, metrics.size() );
+
+    for ( uint32_t i = 0; i < textureSize; i++ ) {
+
+        response.insert( response.end(), rows[ i ], rows[ i ] + rowBytes );
+    }
+
+    generator.releaseTexture();
+
+    response.insert( response.end(), metrics.begin(), metrics.end() );
+
+    if ( mVerbose ) {
+
+        cerr << "Generated " << generator.numGlyphs() << " glyphs, "
+             << generator.numGlyphsFromCache() << " from the cache.\n";
+    }
+}
+
+
+bool GeneratorService::parseArguments( const vector< uint8_t >& payload, vector< string >& args ) const
+{
+    if ( payload.size() < 4 ) {
+
+        return false;
+    }
+
+    const uint32_t numArgs = get32( &payload[ 0 ] );
+    size_t         pos     = 4;
+
+    for ( uint32_t i = 0; i < numArgs; i++ ) {
+
+        if ( pos + 4 > payload.size() ) {
+
+            return false;
+        }
+
+        const uint32_t len = get32( &payload[ pos ] );
+
+        pos += 4;
+
+        if ( len == 0 || len > payload.size() - pos ) {
+
+            return false;
+        }
+
+        args.emplace_back( reinterpret_cast< const char* >( &payload[ pos ] ), len );
+
+        pos += len;
+    }
+
+    return pos == payload.size();
+}
+
+
+bool GeneratorService::readFully( const int fd, void* buf, const size_t size )
+{
+    uint8_t* p    = static_cast< uint8_t* >( buf );
+    size_t   done = 0;
+
+    while ( done < size ) {
+
+        const ssize_t n = recv( fd, p + done, size - done, 0 );
+
+        if ( n < 0 && errno == EINTR ) {
+
+            continue;
+        }
+        if ( n <= 0 ) {
+
+            return false;
+        }
+        done += n;
+    }
+
+    return true;
+}
+
+
+bool GeneratorService::writeFully( const int fd, const void* buf, const size_t size )
+{
+    const uint8_t* p    = static_cast< const uint8_t* >( buf );
+    size_t         done = 0;
+
+    while ( done < size ) {
+
+        const ssize_t n = send( fd, p + done, size - done, MSG_NOSIGNAL );
+
+        if ( n < 0 && errno == EINTR ) {
+
+            continue;
+        }
+        if ( n <= 0 ) {
+
+            return false;
+        }
+        done += n;
+    }
+
+    return true;
+}
+
+
+bool GeneratorService::sendResponse( const int fd, const uint32_t status, const vector< uint8_t >& payload )
+{
+    vector< uint8_t > header;
+
+    put32( header, Magic          );
+    put32( header, status         );
+    put32( header, payload.size() );
+
+    return    writeFully( fd, header.data(), header.size() )
+           && writeFully( fd, payload.data(), payload.size() );
+}
+
+
+void GeneratorService::put32( vector< uint8_t >& buf, const uint32_t v )
+{
+    buf.push_back(   v         & 0xff );
+    buf.push_back( ( v >>  8 ) & 0xff );
+    buf.push_back( ( v >> 16 ) & 0xff );
+    buf.push_back( ( v >> 24 ) & 0xff );
+}
+
+
+uint32_t GeneratorService::get32( const uint8_t* p )
+{
+    return    (uint32_t)p[0]
+           | ( (uint32_t)p[1] <<  8 )
+           | ( (uint32_t)p[2] << 16 )
+           | ( (uint32_t)p[3] << 24 );
+}
+
+} // namespace SDFont
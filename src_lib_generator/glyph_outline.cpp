@@ -0,0 +1,169 @@
+#include <cstring>
+#include <cstdint>
+
+#include "sdfont/generator/glyph_outline.hpp"
+
+namespace SDFont {
+
+// FNV-1a over the bytes.
+static uint64_t hashBytes( uint64_t h, const void* bytes, const size_t len )
+{
+    const auto* p = static_cast< const unsigned char* >( bytes );
+
+    for ( size_t i = 0; i < len; i++ ) {
+
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+
+    return h;
+}
+
+GlyphOutline::GlyphOutline():
+    mGlyph   ( nullptr ),
+    mMetrics ( FT_Glyph_Metrics{} )
+    {;}
+
+
+GlyphOutline::~GlyphOutline()
+{
+    release();
+}
+
+
+FT_Error GlyphOutline::capture( FT_GlyphSlot slot )
+{
+    release();
+
+    mMetrics = slot->metrics;
+
+    return FT_Get_Glyph( slot, &mGlyph );
+}
+
+
+FT_Error GlyphOutline::copyFrom( const GlyphOutline& src )
+{
+    release();
+
+    mMetrics = src.mMetrics;
+
+    if ( src.mGlyph == nullptr ) {
+
+        return FT_Err_Ok;
+    }
+
+    return FT_Glyph_Copy( src.mGlyph, &mGlyph );
+}
+
+
+const FT_Outline* GlyphOutline::outline() const
+{
+    if ( mGlyph == nullptr || mGlyph->format != FT_GLYPH_FORMAT_OUTLINE ) {
+
+        return nullptr;
+    }
+
+    return &reinterpret_cast< FT_OutlineGlyph >( mGlyph )->outline;
+}
+
+
+bool GlyphOutline::isEmpty() const
+{
+    const auto* o = outline();
+
+    return o != nullptr && o->n_points == 0;
+}
+
+
+size_t GlyphOutline::shapeHash() const
+{
+    const auto* o = outline();
+
+    if ( o == nullptr ) {
+
+        return 0;
+    }
+
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    h = hashBytes( h, &( mMetrics.width  ), sizeof( mMetrics.width  ) );
+    h = hashBytes( h, &( mMetrics.height ), sizeof( mMetrics.height ) );
+    h = hashBytes( h, &( o->n_points     ), sizeof( o->n_points     ) );
+    h = hashBytes( h, &( o->n_contours   ), sizeof( o->n_contours   ) );
+    h = hashBytes( h, &( o->flags        ), sizeof( o->flags        ) );
+    h = hashBytes( h, o->points,   sizeof( FT_Vector ) * o->n_points   );
+    h = hashBytes( h, o->tags,     sizeof( char      ) * o->n_points   );
+    h = hashBytes( h, o->contours, sizeof( o->contours[0] ) * o->n_contours );
+
+    return (size_t)h;
+}
+
+
+bool GlyphOutline::hasSameShape( const GlyphOutline& other ) const
+{
+    const auto* a = outline();
+    const auto* b = other.outline();
+
+    if ( a == nullptr || b == nullptr ) {
+
+        return false;
+    }
+
+    if (    mMetrics.width  != other.mMetrics.width
+         || mMetrics.height != other.mMetrics.height
+         || a->n_points     != b->n_points
+         || a->n_contours   != b->n_contours
+         || a->flags        != b->flags             ) {
+
+        return false;
+    }
+
+    // The arrays can be nullptr for the empty outline.
+    return    ( a->n_points   == 0 || memcmp( a->points,   b->points,   sizeof( FT_Vector ) * a->n_points ) == 0 )
+           && ( a->n_points   == 0 || memcmp( a->tags,     b->tags,     sizeof( char      ) * a->n_points ) == 0 )
+           && ( a->n_contours == 0 || memcmp( a->contours, b->contours, sizeof( a->contours[0] ) * a->n_contours ) == 0 );
+}
+
+
+FT_Error GlyphOutline::renderMono(
+    const function< void( FT_Bitmap& bm, const long left, const long top ) >& consume
+) const {
+
+    if ( mGlyph == nullptr ) {
+
+        return FT_Err_Invalid_Glyph_Index;
+    }
+
+    // The copy is kept, as FT_Glyph_To_Bitmap() replaces the handle with a
+    // new bitmap glyph, unless it is a bitmap already.
+    FT_Glyph glyph   = mGlyph;
+    auto     ftError = FT_Glyph_To_Bitmap( &glyph, FT_RENDER_MODE_MONO, nullptr, 0 );
+
+    if ( ftError != FT_Err_Ok ) {
+
+        return ftError;
+    }
+
+    auto bitmapGlyph = reinterpret_cast< FT_BitmapGlyph >( glyph );
+
+    consume( bitmapGlyph->bitmap, bitmapGlyph->left, bitmapGlyph->top );
+
+    if ( glyph != mGlyph ) {
+
+        FT_Done_Glyph( glyph );
+    }
+
+    return FT_Err_Ok;
+}
+
+
+void GlyphOutline::release()
+{
+    if ( mGlyph != nullptr ) {
+
+        FT_Done_Glyph( mGlyph );
+        mGlyph = nullptr;
+    }
+}
+
+} // namespace SDFont
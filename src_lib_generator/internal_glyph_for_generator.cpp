@@ -33,6 +33,7 @@ InternalGlyphForGen::InternalGlyphForGen (
     mTextureCoordY      ( 0.0 ),
     mTextureWidth       ( 0.0 ),
     mTextureHeight      ( 0.0 ),
+    mTextureChannel     ( 0 ),
 
     mWidth              ( m.width        / FREE_TYPE_FIXED_POINT_SCALING ),
     mHeight             ( m.height       / FREE_TYPE_FIXED_POINT_SCALING ),
@@ -43,6 +44,7 @@ InternalGlyphForGen::InternalGlyphForGen (
     mVerticalBearingY   ( m.vertBearingY / FREE_TYPE_FIXED_POINT_SCALING ),
     mVerticalAdvance    ( m.vertAdvance  / FREE_TYPE_FIXED_POINT_SCALING ),
     mSignedDist         ( nullptr ),
+    mSignedDistMulti    ( nullptr ),
     mSignedDistWidth    ( 0 ),
     mSignedDistHeight   ( 0 ),
     mSignedDistBaseX    ( 0 ),
@@ -50,8 +52,10 @@ InternalGlyphForGen::InternalGlyphForGen (
     mHasExternalBitmap  ( false ),
     mExternalBitmapWidth( 0 ),
     mExternalBitmapHeight( 0 ),
-    mExternalBitmap     ( nullptr )
-
+    mExternalBitmap     ( nullptr ),
+    mOutline            ( nullptr ),
+    mRectangleOwner     ( nullptr ),
+    mEmpty              ( false )
 {
     mSignedDistWidth  = ceil( (float)mWidth  + 2.0f * mConf.signedDistExtent() );
     mSignedDistHeight = ceil( (float)mHeight + 2.0f * mConf.signedDistExtent() );
@@ -77,6 +81,7 @@ InternalGlyphForGen::InternalGlyphForGen (
     mTextureCoordY      ( 0.0 ),
     mTextureWidth       ( 0.0 ),
     mTextureHeight      ( 0.0 ),
+    mTextureChannel     ( 0 ),
 
     mWidth              ( width ),
     mHeight             ( height ),
@@ -87,6 +92,7 @@ InternalGlyphForGen::InternalGlyphForGen (
     mVerticalBearingY   ( 0.0f ),
     mVerticalAdvance    ( height ),
     mSignedDist         ( nullptr ),
+    mSignedDistMulti    ( nullptr ),
     mSignedDistWidth    ( 0 ),
     mSignedDistHeight   ( 0 ),
     mSignedDistBaseX    ( 0 ),
@@ -94,7 +100,10 @@ InternalGlyphForGen::InternalGlyphForGen (
     mHasExternalBitmap  ( true ),
     mExternalBitmapWidth( external_bitmap_width ),
     mExternalBitmapHeight(external_bitmap_height ),
-    mExternalBitmap     ( external_bitmap )
+    mExternalBitmap     ( external_bitmap ),
+    mOutline            ( nullptr ),
+    mRectangleOwner     ( nullptr ),
+    mEmpty              ( false )
 {
     mSignedDistWidth  = ceil( (float)mWidth  + 2.0f * mConf.signedDistExtent() );
     mSignedDistHeight = ceil( (float)mHeight + 2.0f * mConf.signedDistExtent() );
@@ -110,7 +119,24 @@ InternalGlyphForGen::~InternalGlyphForGen () {
 
     if ( mSignedDist != nullptr ) {
 
-        free ( mSignedDist );
+        delete[] mSignedDist;
+    }
+
+    if ( mSignedDistMulti != nullptr ) {
+
+        delete[] mSignedDistMulti;
+    }
+
+    releaseOutline();
+}
+
+
+void InternalGlyphForGen::releaseOutline()
+{
+    if ( mOutline != nullptr ) {
+
+        delete mOutline;
+        mOutline = nullptr;
     }
 }
 
@@ -135,9 +161,11 @@ void InternalGlyphForGen::setBaseXY( long x, long y ) {
 }
 
 
-void InternalGlyphForGen::addKerning( long followingCodePoint, FT_Pos v ) {
+float InternalGlyphForGen::normalizedKerning( FT_Pos v ) const {
 
-    mKernings[ followingCodePoint ] = v / FREE_TYPE_FIXED_POINT_SCALING ;
+    float factor =  (float) ( mConf.glyphBitmapSizeForSampling() );
+
+    return (float)( ( v / FREE_TYPE_FIXED_POINT_SCALING ) / factor ) ;
 }
 
 
@@ -826,6 +854,17 @@ void InternalGlyphForGen::setSignedDistBySeparateVicinitySearch( FT_Bitmap& bm )
 }
 
 
+void InternalGlyphForGen::setEmptySignedDist()
+{
+    releaseBitmap();
+
+    const auto scale = mConf.glyphScalingFromSamplingToPackedSignedDist();
+
+    mSignedDistWidth  = ceil(mWidth  * scale + 2 * mConf.signedDistExtent());
+    mSignedDistHeight = ceil(mHeight * scale + 2 * mConf.signedDistExtent());
+}
+
+
 void InternalGlyphForGen::setSignedDistBySeparateVicinitySearch()
 {
     const auto scale = mConf.glyphScalingFromSamplingToPackedSignedDist();
@@ -852,6 +891,129 @@ void InternalGlyphForGen::setSignedDistBySeparateVicinitySearch()
     }
 }
 
+void InternalGlyphForGen::setSignedDistMultiChannel(
+    FT_Bitmap&       bm,
+    const MSDFShape& shape,
+    const long       left,
+    const long       top
+) {
+    const auto scale  = mConf.glyphScalingFromSamplingToPackedSignedDist();
+    const long offset = mConf.signedDistExtent();
+
+    mSignedDistWidth  = ceil(mWidth  * scale + 2 * mConf.signedDistExtent());
+    mSignedDistHeight = ceil(mHeight * scale + 2 * mConf.signedDistExtent());
+
+    size_t arraySize = mSignedDistWidth * mSignedDistHeight;
+
+    mSignedDist      = new float[ arraySize ];
+    mSignedDistMulti = new float[ arraySize * 3 ];
+
+    // Same sampling points as the single channel field, i.e., the center
+    // of the packed texel mapped back to the bitmap for sampling.
+    const double step      = 1.0 / (double)scale;
+    const double areaLeft  = (double)left - (double)offset * step;
+    const double areaTop   = (double)top  + (double)offset * step;
+    const double range     = 2.0 * (double)offset * step;
+
+    auto generateRow = [ this, &bm, &shape, offset, scale, step, areaLeft, areaTop, range ]( long j ) {
+
+        shape.generateRow( mSignedDistMulti, j, mSignedDistWidth, areaLeft, areaTop, step, range );
+
+        const auto fj      = static_cast<float>( j - offset ) + 0.5f;
+        const auto yCenter = static_cast<long>( fj / scale );
+
+        // The pseudo distances can have the wrong sign far from the edges
+        // for the overlapping contours. Such texels are flipped to agree
+        // with the rendered bitmap. The texels within one texel from the
+        // edge are left as they are as the bitmap is quantized there.
+        const float margin = 1.0f / static_cast<float>( 2 * offset );
+
+        for ( long i = 0; i < mSignedDistWidth; i++ ) {
+
+            auto* texel = &mSignedDistMulti[ ( j * mSignedDistWidth + i ) * 3 ];
+
+            const auto fi      = static_cast<float>( i - offset ) + 0.5f;
+            const auto xCenter = static_cast<long>( fi / scale );
+            const auto m       = MSDFShape::median( texel[0], texel[1], texel[2] );
+            const auto inside  = isPixelSet( bm, xCenter, yCenter );
+
+            const bool flip = ( inside && m < 0.5f - margin ) || ( !inside && m > 0.5f + margin );
+
+            for ( long c = 0; c < 3; c++ ) {
+
+                if ( flip ) {
+                    texel[c] = 1.0f - texel[c];
+                }
+                texel[c] = std::max( 0.0f, std::min( 1.0f, texel[c] ) );
+            }
+        }
+    };
+
+    if ( mThreadDriver == nullptr ) {
+
+        for ( long j = 0; j < mSignedDistHeight; j++ ) {
+
+            generateRow( j );
+        }
+    }
+    else {
+        mThreadDriver->runRows( mSignedDistHeight, generateRow );
+    }
+
+    MSDFShape::correctErrors(
+        mSignedDistMulti,
+        mSignedDistWidth,
+        mSignedDistHeight,
+        1.001f / static_cast<float>( 2 * offset )
+    );
+
+    for ( size_t k = 0; k < arraySize; k++ ) {
+
+        const auto* texel = &mSignedDistMulti[ k * 3 ];
+
+        mSignedDist[ k ] = MSDFShape::median( texel[0], texel[1], texel[2] );
+    }
+}
+
+
+void InternalGlyphForGen::copySignedDist( vector< float >& dist, vector< float >& distMulti ) const
+{
+    const size_t arraySize = mSignedDistWidth * mSignedDistHeight;
+
+    dist.assign( mSignedDist, mSignedDist + arraySize );
+
+    if ( mSignedDistMulti != nullptr ) {
+
+        distMulti.assign( mSignedDistMulti, mSignedDistMulti + arraySize * 3 );
+    }
+    else {
+        distMulti.clear();
+    }
+}
+
+
+void InternalGlyphForGen::restoreSignedDist(
+    const long             width,
+    const long             height,
+    const vector< float >& dist,
+    const vector< float >& distMulti
+) {
+    releaseBitmap();
+
+    mSignedDistWidth  = width;
+    mSignedDistHeight = height;
+
+    mSignedDist = new float[ dist.size() ];
+    std::copy( dist.begin(), dist.end(), mSignedDist );
+
+    if ( !distMulti.empty() ) {
+
+        mSignedDistMulti = new float[ distMulti.size() ];
+        std::copy( distMulti.begin(), distMulti.end(), mSignedDistMulti );
+    }
+}
+
+
 void InternalGlyphForGen::releaseBitmap() {
 
     if ( mSignedDist != nullptr ) {
@@ -862,6 +1024,13 @@ void InternalGlyphForGen::releaseBitmap() {
         mSignedDistWidth  = 0;
         mSignedDistHeight = 0;
     }
+
+    if ( mSignedDistMulti != nullptr ) {
+
+        delete[] mSignedDistMulti;
+
+        mSignedDistMulti  = nullptr;
+    }
 }
 
 
@@ -921,25 +1090,10 @@ void InternalGlyphForGen::emitMetrics( ostream& os ) const {
     os << "\t";
     os << mTextureHeight ;
 
-}
+    if ( mConf.isPackChannelsSet() ) {
 
-
-void InternalGlyphForGen::emitKernings( ostream& os ) const {
-
-    if ( mKernings.size() > 0 ) {
-
-        float factor =  (float) ( mConf.glyphBitmapSizeForSampling() );
-
-        os << "0X" << toHexString( (uint32_t) mCodePoint ) ;
-
-        for ( auto it = mKernings.begin(); it != mKernings.end(); it++ ) {
-
-            os << "\t" << "0X" << toHexString( (uint32_t) (it->first) ) ;
-
-            os << "\t" << (float)( (it->second ) / factor ) ;
-        }
-
-        os << "\n";
+        os << "\t";
+        os << mTextureChannel ;
     }
 }
 
@@ -963,12 +1117,8 @@ Glyph InternalGlyphForGen::generateSDGlyph() const {
     g.mTextureCoordY      = mTextureCoordY ;
     g.mTextureWidth       = mTextureWidth  ;
     g.mTextureHeight      = mTextureHeight ;
+    g.mTextureChannel     = mTextureChannel ;
 
-    for ( auto it = mKernings.begin(); it != mKernings.end(); it++ ) {
-
-        g.mKernings[ it->first ] = (float)( (it->second ) / factor ) ;
-
-    }
     return g;
 
 }
@@ -7,6 +7,8 @@ InternalGlyphThreadDriver::InternalGlyphThreadDriver( const int32_t num_threads
     :m_fan_out    ( num_threads )
     ,m_fan_in     ( num_threads )
     ,m_num_threads( num_threads )
+    ,m_num_rows   ( 0 )
+    ,m_row_func   ( nullptr )
 {
     auto thread_lambda = [ this ]( const size_t thread_index ) {
 
@@ -18,18 +20,27 @@ InternalGlyphThreadDriver::InternalGlyphThreadDriver( const int32_t num_threads
                 break;
             }
 
-            for ( long i = thread_index ; i < m_glyph->mSignedDistHeight; i += this->m_num_threads ) {
+            if ( m_row_func != nullptr ) {
 
-                for ( long j = 0 ; j < m_glyph->mSignedDistWidth; j++ ) {
+                for ( long i = thread_index ; i < m_num_rows; i += this->m_num_threads ) {
 
-                    auto val = m_glyph->getSignedDistance(
-                        *m_bm,
-                        m_scale,
-                        m_spreadInBitmapPixels,
-                        j - m_offset,
-                        i - m_offset
-                                        );
-                    m_glyph->mSignedDist[ i * m_glyph->mSignedDistWidth + j] = val;
+                    ( *m_row_func )( i );
+                }
+            }
+            else {
+                for ( long i = thread_index ; i < m_glyph->mSignedDistHeight; i += this->m_num_threads ) {
+
+                    for ( long j = 0 ; j < m_glyph->mSignedDistWidth; j++ ) {
+
+                        auto val = m_glyph->getSignedDistance(
+                            *m_bm,
+                            m_scale,
+                            m_spreadInBitmapPixels,
+                            j - m_offset,
+                            i - m_offset
+                                            );
+                        m_glyph->mSignedDist[ i * m_glyph->mSignedDistWidth + j] = val;
+                    }
                 }
             }
 
@@ -65,6 +76,8 @@ void InternalGlyphThreadDriver::run(
     long                 spreadInBitmapPixels,
     long                 offset
 ) {
+    std::lock_guard< std::mutex > lock( m_caller_mutex );
+
     m_glyph                = glyph;
     m_bm                   = bm;
     m_scale                = scale;
@@ -82,4 +95,20 @@ void InternalGlyphThreadDriver::run(
     m_offset               = 0;
 }
 
+
+void InternalGlyphThreadDriver::runRows( const long numRows, const std::function< void( long ) >& rowFunc )
+{
+    std::lock_guard< std::mutex > lock( m_caller_mutex );
+
+    m_num_rows = numRows;
+    m_row_func = &rowFunc;
+
+    m_fan_out.notify();
+
+    m_fan_in.wait();
+
+    m_num_rows = 0;
+    m_row_func = nullptr;
+}
+
 } // namespace SDFont
@@ -0,0 +1,780 @@
+/*
+ * The root solvers, the signed distances of the edges, the edge coloring,
+ * and the clash correction are adapted from msdfgen.
+ *
+ * msdfgen: https://github.com/Chlumsky/msdfgen
+ *
+ * Copyright (c) 2014 - 2024 Viktor Chlumsky
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "sdfont/generator/msdf_shape.hpp"
+
+namespace SDFont {
+
+static const double FREE_TYPE_FIXED_POINT_SCALING = 64.0;
+
+static double nonZeroSign( const double v ) { return ( v > 0.0 ) ? 1.0 : -1.0; }
+
+
+static int solveQuadratic( double x[2], const double a, const double b, const double c )
+{
+    if ( a == 0.0 || fabs( b ) > 1.0e12 * fabs( a ) ) {
+
+        if ( b == 0.0 ) {
+            return 0;
+        }
+        x[0] = -c / b;
+        return 1;
+    }
+
+    double discriminant = b * b - 4.0 * a * c;
+
+    if ( discriminant > 0.0 ) {
+
+        discriminant = sqrt( discriminant );
+        x[0] = ( -b + discriminant ) / ( 2.0 * a );
+        x[1] = ( -b - discriminant ) / ( 2.0 * a );
+        return 2;
+    }
+    else if ( discriminant == 0.0 ) {
+
+        x[0] = -b / ( 2.0 * a );
+        return 1;
+    }
+    return 0;
+}
+
+
+static int solveCubicNormed( double x[3], double a, const double b, const double c )
+{
+    const double a2 = a * a;
+    double       q  = ( a2 - 3.0 * b ) / 9.0;
+    const double r  = ( a * ( 2.0 * a2 - 9.0 * b ) + 27.0 * c ) / 54.0;
+    const double r2 = r * r;
+    const double q3 = q * q * q;
+
+    a /= 3.0;
+
+    if ( r2 < q3 ) {
+
+        double t = std::max( -1.0, std::min( 1.0, r / sqrt( q3 ) ) );
+        t = acos( t );
+        q = -2.0 * sqrt( q );
+        x[0] = q * cos(   t               / 3.0 ) - a;
+        x[1] = q * cos( ( t + 2.0 * M_PI ) / 3.0 ) - a;
+        x[2] = q * cos( ( t - 2.0 * M_PI ) / 3.0 ) - a;
+        return 3;
+    }
+    else {
+        const double u = ( r < 0.0 ? 1.0 : -1.0 ) * pow( fabs( r ) + sqrt( r2 - q3 ), 1.0 / 3.0 );
+        const double v = ( u == 0.0 ) ? 0.0 : q / u;
+
+        x[0] = ( u + v ) - a;
+
+        if ( u == v || fabs( u - v ) < 1.0e-12 * fabs( u + v ) ) {
+
+            x[1] = -0.5 * ( u + v ) - a;
+            return 2;
+        }
+        return 1;
+    }
+}
+
+
+static int solveCubic( double x[3], const double a, const double b, const double c, const double d )
+{
+    if ( a != 0.0 ) {
+
+        const double bn = b / a;
+
+        // Above this ratio, the numerical error gets larger than treating a as zero.
+        if ( fabs( bn ) < 1.0e6 ) {
+
+            return solveCubicNormed( x, bn, c / a, d / a );
+        }
+    }
+    return solveQuadratic( x, b, c, d );
+}
+
+
+static bool isCorner( const MSDFShape::Vec2& a, const MSDFShape::Vec2& b, const double crossThreshold )
+{
+    return a.dot( b ) <= 0.0 || fabs( a.cross( b ) ) > crossThreshold;
+}
+
+
+double MSDFShape::Vec2::length() const
+{
+    return sqrt( mX * mX + mY * mY );
+}
+
+
+MSDFShape::Vec2 MSDFShape::Vec2::normalize() const
+{
+    const auto len = length();
+
+    if ( len == 0.0 ) {
+        return Vec2( 0.0, 1.0 );
+    }
+    return Vec2( mX / len, mY / len );
+}
+
+
+MSDFShape::SignedDistance::SignedDistance():
+    mDistance( -1.0e240 ),
+    mDot     ( 1.0      )
+{;}
+
+
+bool MSDFShape::SignedDistance::operator < ( const SignedDistance& rhs ) const
+{
+    return    fabs( mDistance ) <  fabs( rhs.mDistance )
+           || ( fabs( mDistance ) == fabs( rhs.mDistance ) && mDot < rhs.mDot );
+}
+
+
+MSDFShape::Vec2 MSDFShape::Edge::point( const double t ) const
+{
+    const double s = 1.0 - t;
+
+    switch ( mDegree ) {
+
+      case 1:
+        return mP[0] * s + mP[1] * t;
+
+      case 2:
+        return mP[0] * ( s * s ) + mP[1] * ( 2.0 * s * t ) + mP[2] * ( t * t );
+
+      default:
+        return   mP[0] * ( s * s * s )
+               + mP[1] * ( 3.0 * s * s * t )
+               + mP[2] * ( 3.0 * s * t * t )
+               + mP[3] * ( t * t * t );
+    }
+}
+
+
+MSDFShape::Vec2 MSDFShape::Edge::direction( const double t ) const
+{
+    switch ( mDegree ) {
+
+      case 1:
+        return mP[1] - mP[0];
+
+      case 2: {
+        const auto tangent = ( mP[1] - mP[0] ) * ( 1.0 - t ) + ( mP[2] - mP[1] ) * t;
+
+        if ( tangent.mX == 0.0 && tangent.mY == 0.0 ) {
+            return mP[2] - mP[0];
+        }
+        return tangent;
+      }
+
+      default: {
+        const double s = 1.0 - t;
+        const auto tangent =   ( mP[1] - mP[0] ) * ( s * s )
+                             + ( mP[2] - mP[1] ) * ( 2.0 * s * t )
+                             + ( mP[3] - mP[2] ) * ( t * t );
+
+        if ( tangent.mX == 0.0 && tangent.mY == 0.0 ) {
+
+            if ( t == 0.0 ) {
+                return mP[2] - mP[0];
+            }
+            if ( t == 1.0 ) {
+                return mP[3] - mP[1];
+            }
+        }
+        return tangent;
+      }
+    }
+}
+
+
+MSDFShape::Edge MSDFShape::Edge::subEdge( const double t0, const double t1 ) const
+{
+    // de Casteljau: first cut off the part after t1, then the part before t0
+    // in the parameter space of the remaining curve.
+    Edge e = *this;
+
+    auto cutAfter = [ ]( Edge& edge, const double t ) {
+
+        Vec2 q[4];
+        for ( int i = 0; i <= edge.mDegree; i++ ) {
+            q[i] = edge.mP[i];
+        }
+        Vec2 out[4];
+        out[0] = q[0];
+        for ( int level = 1; level <= edge.mDegree; level++ ) {
+            for ( int i = 0; i <= edge.mDegree - level; i++ ) {
+                q[i] = q[i] * ( 1.0 - t ) + q[i + 1] * t;
+            }
+            out[level] = q[0];
+        }
+        for ( int i = 0; i <= edge.mDegree; i++ ) {
+            edge.mP[i] = out[i];
+        }
+    };
+
+    auto cutBefore = [ ]( Edge& edge, const double t ) {
+
+        Vec2 q[4];
+        for ( int i = 0; i <= edge.mDegree; i++ ) {
+            q[i] = edge.mP[i];
+        }
+        Vec2 out[4];
+        out[edge.mDegree] = q[edge.mDegree];
+        for ( int level = 1; level <= edge.mDegree; level++ ) {
+            for ( int i = 0; i <= edge.mDegree - level; i++ ) {
+                q[i] = q[i] * ( 1.0 - t ) + q[i + 1] * t;
+            }
+            out[edge.mDegree - level] = q[edge.mDegree - level];
+        }
+        for ( int i = 0; i <= edge.mDegree; i++ ) {
+            edge.mP[i] = out[i];
+        }
+    };
+
+    cutAfter( e, t1 );
+
+    if ( t1 > 0.0 ) {
+        cutBefore( e, t0 / t1 );
+    }
+    return e;
+}
+
+
+MSDFShape::SignedDistance MSDFShape::Edge::signedDistance( const Vec2& origin, double& param ) const
+{
+    if ( mDegree == 1 ) {
+
+        const auto aq = origin - mP[0];
+        const auto ab = mP[1] - mP[0];
+
+        param = aq.dot( ab ) / ab.dot( ab );
+
+        const auto   eq               = ( param > 0.5 ? mP[1] : mP[0] ) - origin;
+        const double endpointDistance = eq.length();
+
+        if ( param > 0.0 && param < 1.0 ) {
+
+            const double orthoDistance = aq.cross( ab ) / ab.length();
+
+            if ( fabs( orthoDistance ) < endpointDistance ) {
+
+                return SignedDistance( orthoDistance, 0.0 );
+            }
+        }
+        return SignedDistance(
+                   nonZeroSign( aq.cross( ab ) ) * endpointDistance,
+                   fabs( ab.normalize().dot( eq.normalize() ) )
+               );
+    }
+
+    const auto   last = mP[ mDegree ];
+    const auto   qa   = mP[0] - origin;
+    const auto   ab   = mP[1] - mP[0];
+    const auto   br   = mP[2] - mP[1] - ab;
+
+    auto         epDir       = direction( 0.0 );
+    double       minDistance = nonZeroSign( epDir.cross( qa ) ) * qa.length();
+
+    param = -qa.dot( epDir ) / epDir.dot( epDir );
+
+    {
+        epDir = direction( 1.0 );
+        const double distance = ( last - origin ).length();
+
+        if ( distance < fabs( minDistance ) ) {
+
+            minDistance = nonZeroSign( epDir.cross( last - origin ) ) * distance;
+            param       = ( origin - mP[ mDegree - 1 ] ).dot( epDir ) / epDir.dot( epDir );
+        }
+    }
+
+    if ( mDegree == 2 ) {
+
+        const double a = br.dot( br );
+        const double b = 3.0 * ab.dot( br );
+        const double c = 2.0 * ab.dot( ab ) + qa.dot( br );
+        const double d = qa.dot( ab );
+        double       t[3];
+        const int    solutions = solveCubic( t, a, b, c, d );
+
+        for ( int i = 0; i < solutions; i++ ) {
+
+            if ( t[i] > 0.0 && t[i] < 1.0 ) {
+
+                const auto   qe       = qa + ab * ( 2.0 * t[i] ) + br * ( t[i] * t[i] );
+                const double distance = qe.length();
+
+                if ( distance <= fabs( minDistance ) ) {
+
+                    minDistance = nonZeroSign( ( ab + br * t[i] ).cross( qe ) ) * distance;
+                    param       = t[i];
+                }
+            }
+        }
+    }
+    else {
+        static const int SEARCH_STARTS = 4;
+        static const int SEARCH_STEPS  = 4;
+
+        const auto as = ( mP[3] - mP[2] ) - ( mP[2] - mP[1] ) - br;
+
+        for ( int i = 0; i <= SEARCH_STARTS; i++ ) {
+
+            double t  = (double)i / (double)SEARCH_STARTS;
+            auto   qe = qa + ab * ( 3.0 * t ) + br * ( 3.0 * t * t ) + as * ( t * t * t );
+
+            for ( int step = 0; step < SEARCH_STEPS; step++ ) {
+
+                // Newton's method on the derivative of the squared distance.
+                const auto d1 = ab * 3.0 + br * ( 6.0 * t ) + as * ( 3.0 * t * t );
+                const auto d2 = br * 6.0 + as * ( 6.0 * t );
+
+                t -= qe.dot( d1 ) / ( d1.dot( d1 ) + qe.dot( d2 ) );
+
+                if ( t <= 0.0 || t >= 1.0 ) {
+                    break;
+                }
+
+                qe = qa + ab * ( 3.0 * t ) + br * ( 3.0 * t * t ) + as * ( t * t * t );
+
+                const double distance = qe.length();
+
+                if ( distance < fabs( minDistance ) ) {
+
+                    minDistance = nonZeroSign( direction( t ).cross( qe ) ) * distance;
+                    param       = t;
+                }
+            }
+        }
+    }
+
+    if ( param >= 0.0 && param <= 1.0 ) {
+
+        return SignedDistance( minDistance, 0.0 );
+    }
+    if ( param < 0.5 ) {
+
+        return SignedDistance( minDistance, fabs( direction( 0.0 ).normalize().dot( qa.normalize() ) ) );
+    }
+    return SignedDistance( minDistance, fabs( direction( 1.0 ).normalize().dot( ( last - origin ).normalize() ) ) );
+}
+
+
+void MSDFShape::Edge::distanceToPseudoDistance(
+    SignedDistance& d,
+    const Vec2&     origin,
+    const double    param
+) const {
+
+    if ( param < 0.0 ) {
+
+        const auto   dir = direction( 0.0 ).normalize();
+        const auto   aq  = origin - point( 0.0 );
+
+        if ( aq.dot( dir ) < 0.0 ) {
+
+            const double pseudoDistance = aq.cross( dir );
+
+            if ( fabs( pseudoDistance ) <= fabs( d.mDistance ) ) {
+
+                d.mDistance = pseudoDistance;
+                d.mDot      = 0.0;
+            }
+        }
+    }
+    else if ( param > 1.0 ) {
+
+        const auto   dir = direction( 1.0 ).normalize();
+        const auto   bq  = origin - point( 1.0 );
+
+        if ( bq.dot( dir ) > 0.0 ) {
+
+            const double pseudoDistance = bq.cross( dir );
+
+            if ( fabs( pseudoDistance ) <= fabs( d.mDistance ) ) {
+
+                d.mDistance = pseudoDistance;
+                d.mDot      = 0.0;
+            }
+        }
+    }
+}
+
+
+int MSDFShape::moveTo( const FT_Vector* to, void* user )
+{
+    auto* shape = static_cast< MSDFShape* >( user );
+
+    if ( shape->mContours.empty() || !shape->mContours.back().empty() ) {
+
+        shape->mContours.emplace_back();
+    }
+
+    shape->mCursor = Vec2( to->x / FREE_TYPE_FIXED_POINT_SCALING, to->y / FREE_TYPE_FIXED_POINT_SCALING );
+
+    return 0;
+}
+
+
+int MSDFShape::lineTo( const FT_Vector* to, void* user )
+{
+    auto* shape = static_cast< MSDFShape* >( user );
+
+    const Vec2 p( to->x / FREE_TYPE_FIXED_POINT_SCALING, to->y / FREE_TYPE_FIXED_POINT_SCALING );
+
+    if ( p.mX != shape->mCursor.mX || p.mY != shape->mCursor.mY ) {
+
+        Edge e;
+        e.mDegree = 1;
+        e.mP[0]   = shape->mCursor;
+        e.mP[1]   = p;
+        e.mColor  = WHITE;
+        shape->mContours.back().push_back( e );
+        shape->mCursor = p;
+    }
+    return 0;
+}
+
+
+int MSDFShape::conicTo( const FT_Vector* control, const FT_Vector* to, void* user )
+{
+    auto* shape = static_cast< MSDFShape* >( user );
+
+    Edge e;
+    e.mDegree = 2;
+    e.mP[0]   = shape->mCursor;
+    e.mP[1]   = Vec2( control->x / FREE_TYPE_FIXED_POINT_SCALING, control->y / FREE_TYPE_FIXED_POINT_SCALING );
+    e.mP[2]   = Vec2( to->x      / FREE_TYPE_FIXED_POINT_SCALING, to->y      / FREE_TYPE_FIXED_POINT_SCALING );
+    e.mColor  = WHITE;
+    shape->mContours.back().push_back( e );
+    shape->mCursor = e.mP[2];
+
+    return 0;
+}
+
+
+int MSDFShape::cubicTo(
+    const FT_Vector* control1,
+    const FT_Vector* control2,
+    const FT_Vector* to,
+    void*            user
+) {
+    auto* shape = static_cast< MSDFShape* >( user );
+
+    Edge e;
+    e.mDegree = 3;
+    e.mP[0]   = shape->mCursor;
+    e.mP[1]   = Vec2( control1->x / FREE_TYPE_FIXED_POINT_SCALING, control1->y / FREE_TYPE_FIXED_POINT_SCALING );
+    e.mP[2]   = Vec2( control2->x / FREE_TYPE_FIXED_POINT_SCALING, control2->y / FREE_TYPE_FIXED_POINT_SCALING );
+    e.mP[3]   = Vec2( to->x       / FREE_TYPE_FIXED_POINT_SCALING, to->y       / FREE_TYPE_FIXED_POINT_SCALING );
+    e.mColor  = WHITE;
+    shape->mContours.back().push_back( e );
+    shape->mCursor = e.mP[3];
+
+    return 0;
+}
+
+
+bool MSDFShape::loadFromOutline( const FT_Outline& constOutline )
+{
+    // FreeType only reads the outline, though the parameters are not const.
+    FT_Outline& outline = const_cast< FT_Outline& >( constOutline );
+
+    mContours.clear();
+
+    FT_Outline_Funcs funcs;
+
+    funcs.move_to  = &MSDFShape::moveTo;
+    funcs.line_to  = &MSDFShape::lineTo;
+    funcs.conic_to = &MSDFShape::conicTo;
+    funcs.cubic_to = &MSDFShape::cubicTo;
+    funcs.shift    = 0;
+    funcs.delta    = 0;
+
+    const auto ftError = FT_Outline_Decompose( &outline, &funcs, this );
+
+    if ( ftError != FT_Err_Ok ) {
+
+        mContours.clear();
+        return false;
+    }
+
+    if ( !mContours.empty() && mContours.back().empty() ) {
+
+        mContours.pop_back();
+    }
+
+    // The distances are positive inside. The filled area is on the right
+    // side of the TrueType contours and on the left side of the PostScript ones.
+    mOrientationSign = ( FT_Outline_Get_Orientation( &outline ) == FT_ORIENTATION_POSTSCRIPT ) ? -1.0 : 1.0;
+
+    return true;
+}
+
+
+void MSDFShape::switchColor( EdgeColor& color, unsigned long long& seed, const EdgeColor banned )
+{
+    const int combined = color & banned;
+
+    if ( combined == RED || combined == GREEN || combined == BLUE ) {
+
+        color = static_cast< EdgeColor >( combined ^ WHITE );
+        return;
+    }
+
+    if ( color == BLACK || color == WHITE ) {
+
+        static const EdgeColor start[3] = { CYAN, MAGENTA, YELLOW };
+
+        color = start[ seed % 3 ];
+        seed /= 3;
+        return;
+    }
+
+    const int shifted = color << ( 1 + ( seed & 1 ) );
+
+    color = static_cast< EdgeColor >( ( shifted | shifted >> 3 ) & WHITE );
+    seed >>= 1;
+}
+
+
+void MSDFShape::colorEdges( const double angleThreshold )
+{
+    const double       crossThreshold = sin( angleThreshold );
+    unsigned long long seed           = 0;
+
+    for ( auto& contour : mContours ) {
+
+        vector< int > corners;
+
+        auto prevDirection = contour.back().direction( 1.0 );
+
+        for ( size_t i = 0; i < contour.size(); i++ ) {
+
+            if ( isCorner( prevDirection.normalize(), contour[i].direction( 0.0 ).normalize(), crossThreshold ) ) {
+
+                corners.push_back( i );
+            }
+            prevDirection = contour[i].direction( 1.0 );
+        }
+
+        if ( corners.empty() ) {
+
+            // Smooth contour. All the channels see the same edges.
+            for ( auto& e : contour ) {
+                e.mColor = WHITE;
+            }
+        }
+        else if ( corners.size() == 1 ) {
+
+            // Teardrop. The contour is split into three parts colored
+            // differently so that the corner is still seen by two channels.
+            EdgeColor colors[3] = { WHITE, WHITE, WHITE };
+
+            switchColor( colors[0], seed );
+            colors[2] = colors[0];
+            switchColor( colors[2], seed );
+
+            const int corner = corners[0];
+            const int m      = contour.size();
+
+            if ( m >= 3 ) {
+
+                for ( int i = 0; i < m; i++ ) {
+
+                    const int index = (int)( 3.0 + 2.875 * i / ( m - 1 ) - 1.4375 + 0.5 ) - 2;
+                    contour[ ( corner + i ) % m ].mColor = colors[ index ];
+                }
+            }
+            else {
+                Contour parts;
+
+                for ( int i = 0; i < m; i++ ) {
+
+                    const auto& e = contour[ ( corner + i ) % m ];
+
+                    parts.push_back( e.subEdge( 0.0,       1.0 / 3.0 ) );
+                    parts.push_back( e.subEdge( 1.0 / 3.0, 2.0 / 3.0 ) );
+                    parts.push_back( e.subEdge( 2.0 / 3.0, 1.0       ) );
+                }
+
+                for ( size_t i = 0; i < parts.size(); i++ ) {
+
+                    parts[i].mColor = colors[ i * 3 / parts.size() ];
+                }
+                contour = parts;
+            }
+        }
+        else {
+            const int cornerCount = corners.size();
+            const int start       = corners[0];
+            const int m           = contour.size();
+            int       spline      = 0;
+
+            EdgeColor color = WHITE;
+            switchColor( color, seed );
+            const EdgeColor initialColor = color;
+
+            for ( int i = 0; i < m; i++ ) {
+
+                const int index = ( start + i ) % m;
+
+                if ( spline + 1 < cornerCount && corners[ spline + 1 ] == index ) {
+
+                    spline++;
+                    // The last spline must not share a color with the first one.
+                    switchColor( color, seed, ( spline == cornerCount - 1 ) ? initialColor : BLACK );
+                }
+                contour[ index ].mColor = color;
+            }
+        }
+    }
+}
+
+
+void MSDFShape::generateRow(
+    float*       dst,
+    const long   row,
+    const long   width,
+    const double left,
+    const double top,
+    const double step,
+    const double range
+) const {
+
+    const double y = top - ( (double)row + 0.5 ) * step;
+
+    for ( long x = 0; x < width; x++ ) {
+
+        const Vec2 p( left + ( (double)x + 0.5 ) * step, y );
+
+        SignedDistance minDist[3];
+        const Edge*    nearEdge [3] = { nullptr, nullptr, nullptr };
+        double         nearParam[3] = { 0.0, 0.0, 0.0 };
+
+        for ( const auto& contour : mContours ) {
+
+            for ( const auto& e : contour ) {
+
+                double     param;
+                const auto d = e.signedDistance( p, param );
+
+                for ( int c = 0; c < 3; c++ ) {
+
+                    if ( ( e.mColor & ( 1 << c ) ) != 0 && d < minDist[c] ) {
+
+                        minDist  [c] = d;
+                        nearEdge [c] = &e;
+                        nearParam[c] = param;
+                    }
+                }
+            }
+        }
+
+        auto* texel = &dst[ ( row * width + x ) * 3 ];
+
+        for ( int c = 0; c < 3; c++ ) {
+
+            if ( nearEdge[c] != nullptr ) {
+
+                nearEdge[c]->distanceToPseudoDistance( minDist[c], p, nearParam[c] );
+                texel[c] = (float)( mOrientationSign * minDist[c].mDistance / range + 0.5 );
+            }
+            else {
+                texel[c] = 0.0f;
+            }
+        }
+    }
+}
+
+
+float MSDFShape::median( const float r, const float g, const float b )
+{
+    return std::max( std::min( r, g ), std::min( std::max( r, g ), b ) );
+}
+
+
+bool MSDFShape::detectClash( const float* a, const float* b, const float threshold )
+{
+    // Sort the channels so that the pairs go from the biggest to the
+    // smallest absolute difference.
+    float a0 = a[0], a1 = a[1], a2 = a[2];
+    float b0 = b[0], b1 = b[1], b2 = b[2];
+
+    if ( fabs( b0 - a0 ) < fabs( b1 - a1 ) ) {
+        std::swap( a0, a1 );
+        std::swap( b0, b1 );
+    }
+    if ( fabs( b1 - a1 ) < fabs( b2 - a2 ) ) {
+        std::swap( a1, a2 );
+        std::swap( b1, b2 );
+
+        if ( fabs( b0 - a0 ) < fabs( b1 - a1 ) ) {
+            std::swap( a0, a1 );
+            std::swap( b0, b1 );
+        }
+    }
+    return    fabs( b1 - a1 ) >= threshold
+           && !( b0 == b1 && b0 == b2 )    // Ignore if the other texel has been equalized.
+           && fabs( a2 - 0.5f ) >= fabs( b2 - 0.5f );
+}
+
+
+void MSDFShape::correctErrors( float* msd, const long width, const long height, const float threshold )
+{
+    vector< long > clashes;
+
+    for ( long y = 0; y < height; y++ ) {
+
+        for ( long x = 0; x < width; x++ ) {
+
+            const auto* texel = &msd[ ( y * width + x ) * 3 ];
+
+            if (    ( x > 0          && detectClash( texel, texel - 3,         threshold ) )
+                 || ( x < width - 1  && detectClash( texel, texel + 3,         threshold ) )
+                 || ( y > 0          && detectClash( texel, texel - width * 3, threshold ) )
+                 || ( y < height - 1 && detectClash( texel, texel + width * 3, threshold ) ) ) {
+
+                clashes.push_back( y * width + x );
+            }
+        }
+    }
+
+    for ( const auto index : clashes ) {
+
+        auto*       texel = &msd[ index * 3 ];
+        const float m     = median( texel[0], texel[1], texel[2] );
+
+        texel[0] = m;
+        texel[1] = m;
+        texel[2] = m;
+    }
+}
+
+} // namespace SDFont
@@ -57,22 +57,12 @@ static bool checkPNG(
 }
 
 
-/** @brief load a PNG image file.
- *
- *  @param filepath (in):  path to the PNG file
- *
- *  @param width     (out): from png_get_IHDR(). upto 2^31
- *
- *  @param data      (out): the pixmap data loaded
- *
- *  @reference https://gist.github.com/mortennobel/5299151
- */
 bool loadPngImage(
 
-    string          filePath,
-    unsigned long&  width,
-    unsigned long&  height,
-    unsigned char** data
+    string                         filePath,
+    unsigned long&                 width,
+    unsigned long&                 height,
+    const PngDestinationAllocator& allocate
 ) {
 
     FILE* fp = fopen( filePath.c_str(), "rb" );
@@ -122,16 +112,17 @@ bool loadPngImage(
 
     png_set_sig_bytes( pngStruct, sigRead );
 
-    png_read_png (
+    png_read_info( pngStruct, pngInfo );
 
-        pngStruct,
-        pngInfo,
-        PNG_TRANSFORM_STRIP_16 | PNG_TRANSFORM_PACKING | PNG_TRANSFORM_EXPAND,
-        NULL
-    );
+    // Same transformations as PNG_TRANSFORM_STRIP_16 | PNG_TRANSFORM_PACKING
+    // | PNG_TRANSFORM_EXPAND for png_read_png().
+    png_set_strip_16( pngStruct );
+    png_set_packing ( pngStruct );
+    png_set_expand  ( pngStruct );
 
+    png_read_update_info( pngStruct, pngInfo );
 
-    png_uint_32   png_width = width;
+    png_uint_32   png_width;
     png_uint_32   png_height;
     int           color ;
     int           interlace ;
@@ -154,29 +145,60 @@ bool loadPngImage(
     width  = png_width;
     height = png_height;
 
-    auto rowBytes = png_get_rowbytes( pngStruct, pngInfo );
-    (*data) = (unsigned char*) malloc( rowBytes * height );
+    // Check before decoding anything.
+    if ( !checkPNG( width, height, color, interlace, depth ) ) {
+
+        png_destroy_read_struct( &pngStruct, &pngInfo, NULL );
+        fclose( fp );
+        return false;
+    }
 
-    auto rowPointers = png_get_rows( pngStruct, pngInfo );
+    const size_t rowBytes = png_get_rowbytes( pngStruct, pngInfo );
 
-    for ( int i = 0; i < height; i++ ) {
+    unsigned char* dst = allocate( width, height, rowBytes );
 
-        memcpy(
-            *data + ( rowBytes * (height - 1 - i) ),
-            rowPointers[i],
-            rowBytes
-        );
+    if ( dst == nullptr ) {
+
+        png_destroy_read_struct( &pngStruct, &pngInfo, NULL );
+        fclose( fp );
+        return false;
+    }
+
+    // The rows are flipped such that the first row is at the bottom.
+    for ( unsigned long i = 0; i < height; i++ ) {
+
+        png_read_row( pngStruct, dst + ( rowBytes * (height - 1 - i) ), NULL );
     }
 
+    png_read_end( pngStruct, NULL );
+
     png_destroy_read_struct( &pngStruct, &pngInfo, NULL );
 
     fclose( fp );
 
+    return true;
+}
+
+
+bool loadPngImage(
+
+    string          filePath,
+    unsigned long&  width,
+    unsigned long&  height,
+    unsigned char** data
+) {
+    (*data) = nullptr;
+
+    auto allocate = [ data ]( unsigned long, unsigned long h, size_t rowBytes ) {
+
+        (*data) = (unsigned char*) malloc( rowBytes * h );
+        return (*data);
+    };
 
-    auto valid = checkPNG( width, height, color, interlace, depth );
+    const bool valid = loadPngImage( filePath, width, height, allocate );
+
+    if ( !valid && (*data) != nullptr ) {
 
-    if ( !valid ){
-        
         free( *data );
         *data = nullptr;
     }
@@ -184,4 +206,26 @@ bool loadPngImage(
     return valid;
 }
 
+
+bool loadPngImage(
+
+    string          filePath,
+    unsigned long&  width,
+    unsigned long&  height,
+    unsigned char*  buffer,
+    size_t          bufferSize
+) {
+    auto allocate = [ & ]( unsigned long, unsigned long h, size_t rowBytes ) -> unsigned char* {
+
+        if ( rowBytes * h > bufferSize ) {
+
+            cerr << "Buffer too small for [" << filePath << "]\n";
+            return nullptr;
+        }
+        return buffer;
+    };
+
+    return loadPngImage( filePath, width, height, allocate );
+}
+
 } // namespace SDFont
@@ -0,0 +1,255 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#elif defined( __ARM_NEON ) && defined( __aarch64__ )
+#include <arm_neon.h>
+#endif
+
+#include "sdfont/generator/utf8_corpus_scanner.hpp"
+
+namespace SDFont {
+
+// Below this length, the text is scanned on the calling thread.
+static const size_t MinBytesPerChunk = 64 * 1024;
+
+static const uint32_t ByteOrderMark  = 0xFEFF;
+
+
+UTF8CorpusScanner::UTF8CorpusScanner( InternalGlyphThreadDriver* threadDriver ):
+    mThreadDriver        ( threadDriver ),
+    mBits                ( NumWords, 0 ),
+    mNumInvalidSequences ( 0 )
+    {;}
+
+
+bool UTF8CorpusScanner::scanFile( const string& filePath )
+{
+    ifstream is( filePath, ios::binary );
+
+    if ( !is ) {
+
+        cerr << "Can not open the corpus [" << filePath << "]\n";
+        return false;
+    }
+
+    is.seekg( 0, ios::end );
+    const auto len = (size_t)is.tellg();
+    is.seekg( 0, ios::beg );
+
+    vector< unsigned char > text( len );
+
+    if ( !is.read( reinterpret_cast< char* >( text.data() ), len ) ) {
+
+        cerr << "Can not read the corpus [" << filePath << "]\n";
+        return false;
+    }
+
+    scan( text.data(), text.size() );
+
+    return true;
+}
+
+
+void UTF8CorpusScanner::scan( const unsigned char* text, const size_t len )
+{
+    long numChunks = 1;
+
+    if ( mThreadDriver != nullptr ) {
+
+        numChunks = std::max( 1L, std::min( (long)mThreadDriver->m_num_threads, (long)( len / MinBytesPerChunk ) ) );
+    }
+
+    if ( numChunks == 1 ) {
+
+        mNumInvalidSequences += scanChunk( text, text + len, mBits.data() );
+        return;
+    }
+
+    // The boundaries are moved forward to the beginnings of the characters,
+    // so that no sequence is decoded by two chunks, and the result is the
+    // same as the serial scan.
+    vector< size_t > boundaries( numChunks + 1 );
+
+    for ( long i = 0; i < numChunks; i++ ) {
+
+        boundaries[ i ] = skipContinuationBytes( text, len, len * i / numChunks );
+    }
+    boundaries[ numChunks ] = len;
+
+    vector< vector< uint64_t > > chunkBits( numChunks, vector< uint64_t >( NumWords, 0 ) );
+    vector< long >               chunkInvalid( numChunks, 0 );
+
+    mThreadDriver->runRows( numChunks, [ & ]( const long i ) {
+
+        chunkInvalid[ i ] = scanChunk( text + boundaries[ i ], text + boundaries[ i + 1 ], chunkBits[ i ].data() );
+    } );
+
+    for ( long i = 0; i < numChunks; i++ ) {
+
+        for ( size_t w = 0; w < NumWords; w++ ) {
+
+            mBits[ w ] |= chunkBits[ i ][ w ];
+        }
+        mNumInvalidSequences += chunkInvalid[ i ];
+    }
+}
+
+
+set< uint32_t > UTF8CorpusScanner::codePoints() const
+{
+    set< uint32_t > codes;
+
+    for ( size_t w = 0; w < NumWords; w++ ) {
+
+        uint64_t word = mBits[ w ];
+
+        while ( word != 0 ) {
+
+            const uint32_t code = w * 64 + __builtin_ctzll( word );
+
+            word &= word - 1;
+
+            if ( code < 0x20 || code == 0x7F || code == ByteOrderMark ) {
+
+                continue;
+            }
+            codes.insert( codes.end(), code );
+        }
+    }
+
+    return codes;
+}
+
+
+size_t UTF8CorpusScanner::skipContinuationBytes( const unsigned char* text, const size_t len, size_t pos )
+{
+    // A sequence has at most 3 continuation bytes. A longer run is invalid
+    // anyway, and the extra bytes are counted one by one in either chunk.
+    for ( int i = 0; i < 3 && pos < len && ( text[ pos ] & 0xC0 ) == 0x80; i++ ) {
+
+        pos++;
+    }
+
+    return pos;
+}
+
+
+long UTF8CorpusScanner::scanChunk(
+    const unsigned char* begin,
+    const unsigned char* end,
+    uint64_t*            bits
+) {
+    long                 numInvalid = 0;
+    const unsigned char* p          = begin;
+
+    // Flags of the ASCII characters, which are set with independent stores
+    // rather than the read-modify-writes of the same two words of the bits.
+    unsigned char        ascii[ 128 ] = { 0 };
+
+    while ( p < end ) {
+
+#if defined( __SSE2__ ) || ( defined( __ARM_NEON ) && defined( __aarch64__ ) )
+
+        // Fast path over the runs of ASCII characters.
+        while ( end - p >= 16 ) {
+
+#if defined( __SSE2__ )
+            const __m128i v = _mm_loadu_si128( reinterpret_cast< const __m128i* >( p ) );
+            if ( _mm_movemask_epi8( v ) != 0 ) {
+                break;
+            }
+#else
+            const uint8x16_t v = vld1q_u8( p );
+            if ( vmaxvq_u8( v ) >= 0x80 ) {
+                break;
+            }
+#endif
+            for ( int i = 0; i < 16; i++ ) {
+
+                ascii[ p[ i ] ] = 1;
+            }
+            p += 16;
+        }
+
+        if ( p == end ) {
+
+            break;
+        }
+#endif
+        const unsigned char c = *p;
+
+        if ( c < 0x80 ) {
+
+            ascii[ c ] = 1;
+            p++;
+            continue;
+        }
+
+        long     numContinuations;
+        uint32_t code;
+        uint32_t minCode;
+
+        if ( ( c & 0xE0 ) == 0xC0 ) {
+
+            numContinuations = 1;
+            code             = c & 0x1F;
+            minCode          = 0x80;
+        }
+        else if ( ( c & 0xF0 ) == 0xE0 ) {
+
+            numContinuations = 2;
+            code             = c & 0x0F;
+            minCode          = 0x800;
+        }
+        else if ( ( c & 0xF8 ) == 0xF0 ) {
+
+            numContinuations = 3;
+            code             = c & 0x07;
+            minCode          = 0x10000;
+        }
+        else {
+            // Stray continuation byte or invalid lead byte.
+            numInvalid++;
+            p++;
+            continue;
+        }
+
+        bool valid = ( end - p > numContinuations );
+
+        for ( long i = 1; valid && i <= numContinuations; i++ ) {
+
+            if ( ( p[ i ] & 0xC0 ) != 0x80 ) {
+
+                valid = false;
+            }
+            else {
+                code = ( code << 6 ) | ( p[ i ] & 0x3F );
+            }
+        }
+
+        if (    !valid
+             || code <  minCode
+             || code >  MaxCodePoint
+             || ( 0xD800 <= code && code <= 0xDFFF ) ) {
+
+            numInvalid++;
+            p++;
+            continue;
+        }
+
+        bits[ code >> 6 ] |= 1ULL << ( code & 63 );
+        p += numContinuations + 1;
+    }
+
+    for ( uint32_t c = 0; c < 128; c++ ) {
+
+        bits[ c >> 6 ] |= (uint64_t)ascii[ c ] << ( c & 63 );
+    }
+
+    return numInvalid;
+}
+
+} // namespace SDFont
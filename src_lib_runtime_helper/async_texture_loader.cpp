@@ -0,0 +1,413 @@
+#include <iostream>
+#include <cstring>
+
+#include "sdfont/runtime_helper/async_texture_loader.hpp"
+
+namespace SDFont {
+
+GLuint OpenGLTextureUploadBackend::createTexture( long width, int numChannels )
+{
+    GLuint texture;
+
+    glGenTextures( 1, &texture );
+
+    glBindTexture( GL_TEXTURE_2D, texture );
+
+    glTexImage2D( GL_TEXTURE_2D,
+                  0,
+                  TextureLoader::internalFormat( numChannels ),
+                  width,
+                  width,
+                  0,
+                  TextureLoader::pixelFormat( numChannels ),
+                  GL_UNSIGNED_BYTE,
+                  nullptr            );
+
+    return texture;
+}
+
+
+void OpenGLTextureUploadBackend::finishTexture( GLuint texture )
+{
+    glBindTexture( GL_TEXTURE_2D, texture );
+
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_REPEAT  );
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_REPEAT  );
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR  );
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR  );
+}
+
+
+void OpenGLTextureUploadBackend::deleteTexture( GLuint texture )
+{
+    glDeleteTextures( 1, &texture );
+}
+
+
+GLuint OpenGLTextureUploadBackend::createPixelBuffer( size_t size )
+{
+    GLuint buffer;
+
+    glGenBuffers( 1, &buffer );
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, buffer );
+    glBufferData( GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW );
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+
+    return buffer;
+}
+
+
+void OpenGLTextureUploadBackend::deletePixelBuffer( GLuint buffer )
+{
+    glDeleteBuffers( 1, &buffer );
+}
+
+
+void* OpenGLTextureUploadBackend::mapPixelBuffer( GLuint buffer, size_t size )
+{
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, buffer );
+
+    // Invalidated, as the previous contents are not needed.
+    return glMapBufferRange( GL_PIXEL_UNPACK_BUFFER,
+                             0,
+                             size,
+                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT );
+}
+
+
+bool OpenGLTextureUploadBackend::unmapPixelBuffer( GLuint buffer )
+{
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, buffer );
+
+    return glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER ) == GL_TRUE;
+}
+
+
+void OpenGLTextureUploadBackend::uploadRows(
+    GLuint texture,
+    GLuint buffer,
+    long   yOffset,
+    long   width,
+    long   numRows,
+    int    numChannels
+) {
+    glBindTexture( GL_TEXTURE_2D, texture );
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, buffer );
+
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+    glTexSubImage2D( GL_TEXTURE_2D,
+                     0,
+                     0,
+                     yOffset,
+                     width,
+                     numRows,
+                     TextureLoader::pixelFormat( numChannels ),
+                     GL_UNSIGNED_BYTE,
+                     nullptr              );
+
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+}
+
+
+GLsync OpenGLTextureUploadBackend::insertFence()
+{
+    return glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+}
+
+
+bool OpenGLTextureUploadBackend::isFenceSignaled( GLsync fence )
+{
+    // Flushed such that the fence is signaled eventually without blocking.
+    return glClientWaitSync( fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0 ) != GL_TIMEOUT_EXPIRED;
+}
+
+
+void OpenGLTextureUploadBackend::deleteFence( GLsync fence )
+{
+    glDeleteSync( fence );
+}
+
+
+AsyncTextureLoader::AsyncTextureLoader(
+    string                filePath,
+    TextureUploadBackend* backend,
+    const long            numPixelBuffers,
+    const size_t          chunkSize
+):
+    mFilePath        ( filePath ),
+    mBackend         ( ( backend != nullptr ) ? backend : &mOpenGLBackend ),
+    mNumPixelBuffers ( std::max( 1L, numPixelBuffers ) ),
+    mChunkSize       ( chunkSize ),
+    mPixMap          ( nullptr ),
+    mWidth           ( 0 ),
+    mRowBytes        ( 0 ),
+    mHeaderDecoded   ( false ),
+    mNumRowsDecoded  ( 0 ),
+    mDecodeFailed    ( false ),
+    mAbort           ( false ),
+    mNextPixelBuffer ( 0 ),
+    mNumRowsUploaded ( 0 ),
+    mNumChannels     ( 1 ),
+    mGLtexture       ( 0 ),
+    mReady           ( false ),
+    mFailed          ( false )
+{
+    mReadyFuture = mReadyPromise.get_future().share();
+
+    mWorker = thread( &AsyncTextureLoader::decode, this );
+}
+
+
+AsyncTextureLoader::~AsyncTextureLoader()
+{
+    mAbort.store( true, memory_order_release );
+
+    if ( mWorker.joinable() ) {
+
+        mWorker.join();
+    }
+
+    releasePixelBuffers();
+
+    if ( !isReady() && !hasFailed() ) {
+
+        // Aborted after startUpload(). finish() has not deleted the texture.
+        if ( mGLtexture != 0 ) {
+
+            mBackend->deleteTexture( mGLtexture );
+            mGLtexture = 0;
+        }
+
+        mReadyPromise.set_value( false );
+    }
+
+    if ( mPixMap != nullptr ) {
+
+        free( mPixMap );
+    }
+}
+
+
+void AsyncTextureLoader::decode()
+{
+    auto allocate = [ this ]( unsigned long width, unsigned long height, size_t rowBytes ) {
+
+        mPixMap   = (GLubyte*) malloc( rowBytes * height );
+        mWidth    = width;
+        mRowBytes = rowBytes;
+
+        if ( mPixMap != nullptr ) {
+
+            mHeaderDecoded.store( true, memory_order_release );
+        }
+        return mPixMap;
+    };
+
+    auto rowDecoded = [ this ]( unsigned long numRowsDecoded ) {
+
+        mNumRowsDecoded.store( numRowsDecoded, memory_order_release );
+
+        return !mAbort.load( memory_order_acquire );
+    };
+
+    unsigned long width;
+    int           numChannels;
+
+    const bool ok = TextureLoader::loadPngImage( mFilePath, width, numChannels, allocate, rowDecoded );
+
+    if ( !ok ) {
+
+        if ( !mAbort.load( memory_order_acquire ) ) {
+
+            cerr << "Can not load [" << mFilePath << "]\n";
+        }
+        mDecodeFailed.store( true, memory_order_release );
+    }
+}
+
+
+bool AsyncTextureLoader::update( const chrono::microseconds budget )
+{
+    if ( isReady() || hasFailed() ) {
+
+        return isReady();
+    }
+
+    if ( mDecodeFailed.load( memory_order_acquire ) ) {
+
+        finish( false );
+        return false;
+    }
+
+    if ( !mHeaderDecoded.load( memory_order_acquire ) ) {
+
+        return false;
+    }
+
+    if ( mPixelBuffers.empty() && !startUpload() ) {
+
+        finish( false );
+        return false;
+    }
+
+    const auto startTime = chrono::steady_clock::now();
+
+    // At least one chunk per call so that the upload always progresses.
+    do {
+        const long numRowsDecoded = mNumRowsDecoded.load( memory_order_acquire );
+
+        if ( numRowsDecoded == mNumRowsUploaded ) {
+
+            break;
+        }
+
+        if ( !uploadChunk( numRowsDecoded ) ) {
+
+            break;
+        }
+
+    } while ( chrono::steady_clock::now() - startTime < budget );
+
+    if ( mNumRowsUploaded == (long)mWidth ) {
+
+        // The rows had been decoded before the last one was counted.
+        if ( mWorker.joinable() ) {
+
+            mWorker.join();
+        }
+
+        if ( mDecodeFailed.load( memory_order_acquire ) ) {
+
+            finish( false );
+            return false;
+        }
+
+        mBackend->finishTexture( mGLtexture );
+
+        finish( true );
+    }
+
+    return isReady();
+}
+
+
+bool AsyncTextureLoader::startUpload()
+{
+    // Only the dimensions are published by the worker before decoding.
+    mNumChannels = mRowBytes / mWidth;
+
+    mGLtexture = mBackend->createTexture( mWidth, mNumChannels );
+
+    const size_t chunkSize = std::max( mRowBytes, mChunkSize / mRowBytes * mRowBytes );
+
+    for ( long i = 0; i < mNumPixelBuffers; i++ ) {
+
+        mPixelBuffers.push_back( PixelBuffer{ mBackend->createPixelBuffer( chunkSize ), nullptr } );
+    }
+
+    return mGLtexture != 0;
+}
+
+
+bool AsyncTextureLoader::uploadChunk( const long numRowsDecoded )
+{
+    auto& pb = mPixelBuffers[ mNextPixelBuffer ];
+
+    if ( pb.mFence != nullptr ) {
+
+        if ( !mBackend->isFenceSignaled( pb.mFence ) ) {
+
+            // The GPU is still reading the buffer. Try again next frame.
+            return false;
+        }
+
+        mBackend->deleteFence( pb.mFence );
+        pb.mFence = nullptr;
+    }
+
+    const long maxRowsPerChunk = std::max( 1L, (long)( mChunkSize / mRowBytes ) );
+    const long numRows         = std::min( maxRowsPerChunk, numRowsDecoded - mNumRowsUploaded );
+
+    // The rows are decoded from the top of the image, which is at the
+    // end of the pixmap, as the first row is at the bottom.
+    const long yOffset = mWidth - mNumRowsUploaded - numRows;
+    const auto size    = numRows * mRowBytes;
+
+    void* dst = mBackend->mapPixelBuffer( pb.mBuffer, size );
+
+    if ( dst == nullptr ) {
+
+        return false;
+    }
+
+    memcpy( dst, mPixMap + yOffset * mRowBytes, size );
+
+    if ( !mBackend->unmapPixelBuffer( pb.mBuffer ) ) {
+
+        // The contents have been lost. Retry the same rows next time.
+        return false;
+    }
+
+    mBackend->uploadRows( mGLtexture, pb.mBuffer, yOffset, mWidth, numRows, mNumChannels );
+
+    pb.mFence = mBackend->insertFence();
+
+    mNumRowsUploaded += numRows;
+    mNextPixelBuffer  = ( mNextPixelBuffer + 1 ) % mNumPixelBuffers;
+
+    return true;
+}
+
+
+void AsyncTextureLoader::releasePixelBuffers()
+{
+    for ( auto& pb : mPixelBuffers ) {
+
+        if ( pb.mFence != nullptr ) {
+
+            mBackend->deleteFence( pb.mFence );
+        }
+        mBackend->deletePixelBuffer( pb.mBuffer );
+    }
+
+    mPixelBuffers.clear();
+}
+
+
+void AsyncTextureLoader::finish( const bool ok )
+{
+    releasePixelBuffers();
+
+    // On a failure of the upload the worker may still be decoding into the
+    // pixmap. It stops at the next row.
+    mAbort.store( true, memory_order_release );
+
+    if ( mWorker.joinable() ) {
+
+        mWorker.join();
+    }
+
+    if ( mPixMap != nullptr ) {
+
+        free( mPixMap );
+        mPixMap = nullptr;
+    }
+
+    if ( ok ) {
+
+        mReady.store( true, memory_order_release );
+    }
+    else {
+        if ( mGLtexture != 0 ) {
+
+            mBackend->deleteTexture( mGLtexture );
+            mGLtexture = 0;
+        }
+        mFailed.store( true, memory_order_release );
+    }
+
+    mReadyPromise.set_value( ok );
+}
+
+} // namespace SDFont
@@ -0,0 +1,135 @@
+#include "sdfont/runtime_helper/gl_state_cache.hpp"
+
+namespace SDFont {
+
+void GLStateCache::invalidate()
+{
+    mProgram            = Unknown;
+    mVertexArray        = Unknown;
+    mArrayBuffer        = Unknown;
+    mUniformBuffer      = Unknown;
+    mUniformBufferIndex = Unknown;
+    mActiveTexture      = Unknown;
+    mTexture2D          = Unknown;
+    mBlend              = Unknown;
+    mDepthMask          = Unknown;
+    mBlendSrc           = Unknown;
+    mBlendDst           = Unknown;
+}
+
+
+void GLStateCache::useProgram( const GLuint program )
+{
+    if ( mProgram != program ) {
+
+        glUseProgram( program );
+        mProgram = program;
+        mNumCalls++;
+    }
+}
+
+
+void GLStateCache::bindVertexArray( const GLuint vertexArray )
+{
+    if ( mVertexArray != vertexArray ) {
+
+        glBindVertexArray( vertexArray );
+        mVertexArray = vertexArray;
+        mNumCalls++;
+    }
+}
+
+
+void GLStateCache::bindBuffer( const GLenum target, const GLuint buffer )
+{
+    GLuint& bound = ( target == GL_UNIFORM_BUFFER ) ? mUniformBuffer : mArrayBuffer;
+
+    if ( bound != buffer ) {
+
+        glBindBuffer( target, buffer );
+        bound = buffer;
+        mNumCalls++;
+    }
+}
+
+
+void GLStateCache::bindBufferBase( const GLenum target, const GLuint index, const GLuint buffer )
+{
+    // Only one indexed binding point is kept.
+    if ( mUniformBufferIndex != index || mUniformBuffer != buffer ) {
+
+        glBindBufferBase( target, index, buffer );
+
+        // It binds the generic binding point, too.
+        mUniformBufferIndex = index;
+        mUniformBuffer      = buffer;
+        mNumCalls++;
+    }
+}
+
+
+void GLStateCache::activeTexture( const GLenum unit )
+{
+    if ( mActiveTexture != unit ) {
+
+        glActiveTexture( unit );
+        mActiveTexture = unit;
+
+        // The binding is per unit.
+        mTexture2D     = Unknown;
+        mNumCalls++;
+    }
+}
+
+
+void GLStateCache::bindTexture2D( const GLuint texture )
+{
+    if ( mTexture2D != texture ) {
+
+        glBindTexture( GL_TEXTURE_2D, texture );
+        mTexture2D = texture;
+        mNumCalls++;
+    }
+}
+
+
+void GLStateCache::enableBlend( const bool enable )
+{
+    if ( mBlend != (GLuint)enable ) {
+
+        if ( enable ) {
+
+            glEnable( GL_BLEND );
+        }
+        else {
+            glDisable( GL_BLEND );
+        }
+        mBlend = enable;
+        mNumCalls++;
+    }
+}
+
+
+void GLStateCache::depthMask( const bool enable )
+{
+    if ( mDepthMask != (GLuint)enable ) {
+
+        glDepthMask( enable ? GL_TRUE : GL_FALSE );
+        mDepthMask = enable;
+        mNumCalls++;
+    }
+}
+
+
+void GLStateCache::blendFunc( const GLenum src, const GLenum dst )
+{
+    if ( mBlendSrc != src || mBlendDst != dst ) {
+
+        glBlendFunc( src, dst );
+        mBlendSrc = src;
+        mBlendDst = dst;
+        mNumCalls++;
+    }
+}
+
+} // namespace SDFont
@@ -3,6 +3,7 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <algorithm>
 
 #include "sdfont/runtime_helper/metrics_parser.hpp"
 
@@ -12,6 +13,7 @@ const std::string MetricsParser::SPREAD_IN_TEXTURE      = "SPREAD IN TEXTURE";
 const std::string MetricsParser::SPREAD_IN_FONT_METRICS = "SPREAD IN FONT METRICS";
 const std::string MetricsParser::GLYPHS                 = "GLYPHS";
 const std::string MetricsParser::KERNINGS               = "KERNINGS";
+const std::string MetricsParser::KERNING_CLASSES        = "KERNING CLASSES";
 const std::string MetricsParser::CHAR_MAPS              = "CHAR MAPS";
 const std::string MetricsParser::CHAR_MAP_DEFAULT       = "default";
 
@@ -90,6 +92,11 @@ bool MetricsParser::parseSpec( string fileName )
             handleKerning ( line, fileName, lineNumber, error );
             break;
 
+          case IN_KERNING_CLASSES:
+
+            handleKerningClass ( line, fileName, lineNumber, error );
+            break;
+
           case IN_CHAR_MAPS:
 
             handleCharMap ( line, fileName, lineNumber, error );
@@ -107,6 +114,11 @@ bool MetricsParser::parseSpec( string fileName )
         return false;
     }
 
+    if ( mHasKerningPairs ) {
+
+        mKerningBuilder.build( mKerning );
+    }
+
     return true;
 }
 
@@ -132,6 +144,11 @@ bool MetricsParser::isSectionHeader (
         state = IN_GLYPHS;
         return true;
     }
+    else if ( line.compare( 0, KERNING_CLASSES.size(), KERNING_CLASSES ) == 0 ) {
+
+        state = IN_KERNING_CLASSES;
+        return true;
+    }
     else if ( line.compare( 0, KERNINGS.size(), KERNINGS ) == 0 ) {
 
         state = IN_KERNINGS;
@@ -282,7 +299,10 @@ void MetricsParser::handleGlyph (
 
     vector<std::string> fields;
 
-    if ( splitLine( line, fields, '\t' ) != 14 ) {
+    // The texture channel follows for the packed texture.
+    const auto numFields = splitLine( line, fields, '\t' );
+
+    if ( numFields != 14 && numFields != 15 ) {
 
         emitError( filename, lineNumber, "Invalid Node", errorFlag );
         return;
@@ -304,6 +324,7 @@ void MetricsParser::handleGlyph (
     g.mTextureCoordY      = stof( fields[11] );
     g.mTextureWidth       = stof( fields[12] );
     g.mTextureHeight      = stof( fields[13] );
+    g.mTextureChannel     = ( numFields == 15 ) ? stol( fields[14] ) : 0;
 
     mGlyphs[ g.mCodePoint ] = g;
 }
@@ -325,13 +346,108 @@ void MetricsParser::handleKerning (
     if ( numFields < 3 || (numFields - 1) % 2 != 0 ) {
 
         emitError( filename, lineNumber, "Invalid Kerning Line", errorFlag );
+        return;
     }
 
-    auto& g = mGlyphs[ convertToLong( fields[ 0] ) ];
+    KerningTableBuilder::Row row;
 
     for ( int i = 1; i < numFields; i +=2 ) {
 
-        g.mKernings[ convertToLong( fields[ i ] ) ] = stof( fields[ i+1 ] );
+        row.emplace_back( convertToLong( fields[ i ] ), stof( fields[ i+1 ] ) );
+    }
+
+    sort( row.begin(), row.end() );
+
+    mKerningBuilder.addRow( convertToLong( fields[ 0] ), std::move( row ) );
+
+    mHasKerningPairs = true;
+}
+
+
+void MetricsParser::handleKerningClass (
+
+    string      line,
+    string      filename,
+    long        lineNumber,
+    bool&       errorFlag
+
+) {
+    vector<std::string> fields;
+
+    auto numFields = splitLine( line, fields, '\t' );
+
+    if ( numFields < 2 ) {
+
+        emitError( filename, lineNumber, "Invalid Kerning Class Line", errorFlag );
+        return;
+    }
+
+    const auto& tag = fields[ 0 ];
+
+    if ( tag == KerningTable::CLASSES ) {
+
+        const long numLeft  = numFields == 3 ? stol( fields[ 1 ] ) : 0;
+        const long numRight = numFields == 3 ? stol( fields[ 2 ] ) : 0;
+
+        if ( numLeft < 1 || numLeft > 65536 || numRight < 1 || numRight > 65536 ) {
+
+            emitError( filename, lineNumber, "Invalid Kerning Classes", errorFlag );
+            return;
+        }
+
+        mKerning.resize( numLeft, numRight );
+        mHasKerningClasses = true;
+        return;
+    }
+
+    if ( !mHasKerningClasses ) {
+
+        emitError( filename, lineNumber, "Kerning Classes Not Defined", errorFlag );
+        return;
+    }
+
+    const long c = stol( fields[ 1 ] );
+
+    if ( tag == KerningTable::LEFT || tag == KerningTable::RIGHT ) {
+
+        const bool isLeft     = ( tag == KerningTable::LEFT );
+        const long numClasses = isLeft ? mKerning.numLeftClasses() : mKerning.numRightClasses();
+
+        if ( c < 1 || c >= numClasses ) {
+
+            emitError( filename, lineNumber, "Invalid Kerning Class", errorFlag );
+            return;
+        }
+
+        for ( size_t i = 2; i < numFields; i++ ) {
+
+            const long codePoint = convertToLong( fields[ i ] );
+
+            if ( isLeft ) {
+                mKerning.setLeftClass ( codePoint, (uint16_t)c );
+            }
+            else {
+                mKerning.setRightClass( codePoint, (uint16_t)c );
+            }
+        }
+    }
+    else if ( tag == KerningTable::VALUES ) {
+
+        const long numRight = mKerning.numRightClasses();
+
+        if ( c < 1 || c >= mKerning.numLeftClasses() || (long)numFields != numRight + 2 ) {
+
+            emitError( filename, lineNumber, "Invalid Kerning Values", errorFlag );
+            return;
+        }
+
+        for ( long r = 0; r < numRight; r++ ) {
+
+            mKerning.value( c, r ) = stof( fields[ r + 2 ] );
+        }
+    }
+    else {
+        emitError( filename, lineNumber, "Invalid Kerning Class Line", errorFlag );
     }
 }
 
@@ -0,0 +1,1014 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <tuple>
+
+#include "sdfont/runtime_helper/paragraph_layouter.hpp"
+
+namespace SDFont {
+
+static bool isSpace( const char c )
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+
+ParagraphLayouter::ParagraphLayouter(
+    const RuntimeHelper& helper,
+    const float          fontSize,
+    const float          spreadRatio,
+    const float          letterSpacing,
+    const int32_t        charMapIndex
+):
+    mHelper           ( helper ),
+    mFontSize         ( fontSize ),
+    mSpreadRatio      ( spreadRatio ),
+    mLetterSpacing    ( letterSpacing ),
+    mCharMapIndex     ( charMapIndex ),
+    mWidth            ( numeric_limits< float >::infinity() ),
+    mLineBreaking     ( GREEDY ),
+    mAlignment        ( ALIGN_LEFT ),
+    mLeftX            ( 0.0f ),
+    mBaselineY        ( 0.0f ),
+    mZ                ( 0.0f ),
+    mSpaceWidth       ( 0.25f * fontSize ),
+    mVerticalAdvance  ( fontSize ),
+    mMaxAboveBaselineY( 0.0f ),
+    mMaxBelowBaselineY( 0.0f ),
+    mNumSlots         ( 0 )
+{
+    // The space is looked up through the char map, as getGlyph() takes
+    // the glyph code point, i.e., the glyph index in the face.
+    float                  width, firstBearingX, bearingY, belowBaselineY, advanceY;
+    vector< float >        posXs;
+    vector< const Glyph* > glyphs;
+
+    helper.getMetricsNormalized( string_view( " " ), charMapIndex, width, posXs,
+                                 firstBearingX, bearingY, belowBaselineY, advanceY, glyphs );
+
+    const Glyph* space = glyphs.empty() ? nullptr : glyphs[ 0 ];
+
+    if ( space != nullptr ) {
+
+        mSpaceWidth = space->mHorizontalAdvance * fontSize * letterSpacing;
+    }
+    else if ( !helper.glyphs().empty() ) {
+
+        space = &( helper.glyphs().begin()->second );
+    }
+
+    if ( space != nullptr && space->mVerticalAdvance > 0.0f ) {
+
+        mVerticalAdvance = space->mVerticalAdvance * fontSize;
+    }
+
+    mLineAdvance = mVerticalAdvance;
+}
+
+
+void ParagraphLayouter::setWidth( const float width )
+{
+    mWidth = width;
+    relayout( 0, mWords.size(), 0 );
+}
+
+
+void ParagraphLayouter::setLineBreaking( const LineBreaking lineBreaking )
+{
+    mLineBreaking = lineBreaking;
+    relayout( 0, mWords.size(), 0 );
+}
+
+
+void ParagraphLayouter::setAlignment( const Alignment alignment )
+{
+    mAlignment = alignment;
+    relayout( 0, mWords.size(), 0 );
+}
+
+
+void ParagraphLayouter::setPosition( const float leftX, const float baselineY, const float Z )
+{
+    if ( Z != mZ ) {
+
+        for ( auto& word : mWords ) {
+
+            word.mPlaced = false;
+        }
+    }
+
+    mLeftX     = leftX;
+    mBaselineY = baselineY;
+    mZ         = Z;
+    relayout( 0, mWords.size(), 0 );
+}
+
+
+void ParagraphLayouter::setLineSpacing( const float lineSpacing )
+{
+    mLineAdvance = mVerticalAdvance * lineSpacing;
+    relayout( 0, mWords.size(), 0 );
+}
+
+
+void ParagraphLayouter::setText( const string_view utf8 )
+{
+    mText.assign( utf8.data(), utf8.size() );
+    mWords.clear();
+    mLines.clear();
+    mVertices.clear();
+    mIndices.clear();
+    mSlotGlyphs.clear();
+    mSlotOrigins.clear();
+    mNumSlots = 0;
+    mFreeSlots.clear();
+    mFreeSlotsBySize.clear();
+    mDirtySlots.clear();
+    mMaxAboveBaselineY = 0.0f;
+    mMaxBelowBaselineY = 0.0f;
+
+    tokenize( 0, mText.size(), mWords );
+
+    for ( auto& word : mWords ) {
+
+        measure( word );
+    }
+
+    relayout( 0, mWords.size(), 0 );
+}
+
+
+bool ParagraphLayouter::replace( const size_t pos, const size_t len, const string_view utf8 )
+{
+    if ( pos > mText.size() || len > mText.size() - pos ) {
+
+        return false;
+    }
+
+    // The words touching the range are replaced. The others keep the
+    // separators around them, and hence they stay as they are.
+    const auto wordBegin = partition_point(
+
+        mWords.begin(), mWords.end(),
+        [ pos ]( const Word& w ){ return w.mEnd < pos; }
+    );
+
+    const auto wordEnd = partition_point(
+
+        wordBegin, mWords.end(),
+        [ pos, len ]( const Word& w ){ return w.mBegin <= pos + len; }
+    );
+
+    const long   firstWord = wordBegin - mWords.begin();
+    const long   endWord   = wordEnd   - mWords.begin();
+    const size_t begin     = ( firstWord > 0 ) ? mWords[ firstWord - 1 ].mEnd : 0;
+    const size_t end       = ( endWord < (long)mWords.size() ) ? mWords[ endWord ].mBegin : mText.size();
+
+    mText.replace( pos, len, utf8.data(), utf8.size() );
+
+    const size_t newEnd = end + utf8.size() - len;
+
+    vector< Word > newWords;
+
+    tokenize( begin, newEnd, newWords );
+
+    for ( long i = firstWord; i < endWord; i++ ) {
+
+        freeSlots( mWords[ i ].mFirstSlot, mWords[ i ].mNumGlyphs );
+    }
+
+    for ( auto& word : newWords ) {
+
+        measure( word );
+    }
+
+    // The line that has the word before the edit may take the new words.
+    long fromLine = 0;
+
+    if ( !mLines.empty() ) {
+
+        fromLine = findLine( std::max( firstWord - 1, 0L ) );
+
+        if ( mLineBreaking == OPTIMAL ) {
+
+            while ( fromLine > 0 && !endsParagraph( mLines[ fromLine - 1 ] ) ) {
+
+                fromLine--;
+            }
+        }
+    }
+
+    const long numNewWords = newWords.size();
+    const long numOldWords = endWord - firstWord;
+
+    // The words are trivially copyable, and they are moved only if the
+    // number of the words changes, e.g., not while typing in a word.
+    if ( numNewWords > numOldWords ) {
+
+        mWords.insert( wordEnd, numNewWords - numOldWords, newWords.back() );
+    }
+    else if ( numNewWords < numOldWords ) {
+
+        mWords.erase( wordBegin + numNewWords, wordEnd );
+    }
+
+    copy( newWords.begin(), newWords.end(), mWords.begin() + firstWord );
+
+    if ( utf8.size() != len ) {
+
+        for ( long i = firstWord + numNewWords; i < (long)mWords.size(); i++ ) {
+
+            mWords[ i ].mBegin = mWords[ i ].mBegin + utf8.size() - len;
+            mWords[ i ].mEnd   = mWords[ i ].mEnd   + utf8.size() - len;
+        }
+    }
+
+    relayout( fromLine, firstWord + numNewWords, numNewWords - ( endWord - firstWord ) );
+
+    return true;
+}
+
+
+vector< pair< long, long > > ParagraphLayouter::dirtySlotRanges() const
+{
+    auto ranges = mDirtySlots;
+
+    sort( ranges.begin(), ranges.end() );
+
+    vector< pair< long, long > > merged;
+
+    for ( const auto& r : ranges ) {
+
+        if ( !merged.empty() && r.first <= merged.back().second ) {
+
+            merged.back().second = std::max( merged.back().second, r.second );
+        }
+        else {
+            merged.push_back( r );
+        }
+    }
+
+    return merged;
+}
+
+
+void ParagraphLayouter::findVisibleLines(
+
+    const float bottomY,
+    const float topY,
+    long&       firstLine,
+    long&       endLine
+
+) const {
+
+    const float spread = mHelper.spreadInFontMetrics() * mSpreadRatio * mFontSize;
+
+    // The baselines decrease with the lines.
+    const float highest = topY    + mMaxBelowBaselineY + spread;
+    const float lowest  = bottomY - mMaxAboveBaselineY - spread;
+
+    const auto first = partition_point(
+
+        mLines.begin(), mLines.end(),
+        [ highest ]( const Line& line ){ return line.mBaselineY > highest; }
+    );
+
+    const auto end = partition_point(
+
+        first, mLines.end(),
+        [ lowest ]( const Line& line ){ return line.mBaselineY >= lowest; }
+    );
+
+    firstLine = first - mLines.begin();
+    endLine   = end   - mLines.begin();
+}
+
+
+long ParagraphLayouter::generateVisibleElements(
+
+    const Rect&             clip,
+    vector< float >&        arrayBuf,
+    vector< unsigned int >& indices
+
+) const {
+
+    arrayBuf.clear();
+    indices.clear();
+
+    const float spread = mHelper.spreadInFontMetrics() * mSpreadRatio * mFontSize;
+    const float left   = clip.mX;
+    const float right  = clip.mX + clip.mW;
+    const float bottom = clip.mY;
+    const float top    = clip.mY + clip.mH;
+
+    long firstLine;
+    long endLine;
+
+    findVisibleLines( bottom, top, firstLine, endLine );
+
+    long numGlyphs = 0;
+
+    for ( long l = firstLine; l < endLine; l++ ) {
+
+        const Line& line = mLines[ l ];
+
+        if (    line.mBaselineY - line.mBelowBaselineY - spread > top
+             || line.mBaselineY + line.mAboveBaselineY + spread < bottom ) {
+
+            continue;
+        }
+
+        for ( long w = line.mFirstWord; w < line.mEndWord; w++ ) {
+
+            const Word& word = mWords[ w ];
+
+            if ( word.mNumGlyphs == 0 ) {
+
+                continue;
+            }
+
+            const long first = word.mFirstSlot;
+            const long last  = first + word.mNumGlyphs - 1;
+
+            if ( word.mX - spread > right || wordRight( word ) + spread < left ) {
+
+                continue;
+            }
+
+            arrayBuf.insert(
+
+                arrayBuf.end(),
+                mVertices.begin() +   first      * RuntimeHelper::NUM_FLOATS_PER_GLYPH,
+                mVertices.begin() + ( last + 1 ) * RuntimeHelper::NUM_FLOATS_PER_GLYPH
+            );
+
+            for ( long s = first; s <= last; s++ ) {
+
+                for ( long i = 0; i < RuntimeHelper::NUM_INDICES_PER_GLYPH; i++ ) {
+
+                    indices.push_back(
+                          mIndices[ s * RuntimeHelper::NUM_INDICES_PER_GLYPH + i ]
+                        - s         * RuntimeHelper::NUM_POINTS_PER_GLYPH
+                        + numGlyphs * RuntimeHelper::NUM_POINTS_PER_GLYPH
+                    );
+                }
+                numGlyphs++;
+            }
+        }
+    }
+
+    return numGlyphs;
+}
+
+
+bool ParagraphLayouter::hitTest( const float x, const float y, Caret& caret ) const
+{
+    if ( mLines.empty() ) {
+
+        return false;
+    }
+
+    const float below = lineBandBelowBaseline();
+
+    const auto it = partition_point(
+
+        mLines.begin(), mLines.end(),
+        [ y, below ]( const Line& line ){ return line.mBaselineY - below > y; }
+    );
+
+    caret.mLine = std::min( (long)( it - mLines.begin() ), (long)mLines.size() - 1 );
+
+    const Line& line    = mLines[ caret.mLine ];
+    const long  endWord = endOfWords( line );
+
+    caret.mWord  = line.mFirstWord;
+    caret.mGlyph = 0;
+
+    if ( endWord == line.mFirstWord ) {
+
+        return true;
+    }
+
+    // The last word that starts at or before x.
+    const auto wordIt = partition_point(
+
+        mWords.begin() + line.mFirstWord + 1, mWords.begin() + endWord,
+        [ x ]( const Word& w ){ return w.mX <= x; }
+    );
+
+    caret.mWord = ( wordIt - mWords.begin() ) - 1;
+
+    const Word& word  = mWords[ caret.mWord ];
+    const float right = wordRight( word );
+
+    if ( x > right ) {
+
+        // In the space after the word.
+        if ( caret.mWord + 1 < endWord && x - right > mWords[ caret.mWord + 1 ].mX - x ) {
+
+            caret.mWord++;
+            caret.mGlyph = 0;
+        }
+        else {
+            caret.mGlyph = word.mNumGlyphs;
+        }
+        return true;
+    }
+
+    // The number of the glyphs whose centers are before x.
+    const long first = word.mFirstSlot;
+    long       low   = 0;
+    long       high  = word.mNumGlyphs;
+
+    while ( low < high ) {
+
+        const long   mid    = ( low + high ) / 2;
+        const Glyph* g      = mSlotGlyphs[ first + mid ];
+        const float  center =   word.mX + mSlotOrigins[ first + mid ].mX
+                              + ( g->mHorizontalBearingX + g->mWidth * 0.5f ) * mFontSize;
+
+        if ( center < x ) {
+
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    caret.mGlyph = low;
+
+    return true;
+}
+
+
+float ParagraphLayouter::caretX( const Caret& caret ) const
+{
+    const Line& line = mLines[ caret.mLine ];
+
+    if ( caret.mWord >= endOfWords( line ) ) {
+
+        return line.mLeftX;
+    }
+
+    const Word& word = mWords[ caret.mWord ];
+
+    if ( caret.mGlyph >= word.mNumGlyphs ) {
+
+        return wordRight( word );
+    }
+
+    const long   slot = word.mFirstSlot + caret.mGlyph;
+    const Glyph* g    = mSlotGlyphs[ slot ];
+
+    return word.mX + mSlotOrigins[ slot ].mX + g->mHorizontalBearingX * mFontSize;
+}
+
+
+Rect ParagraphLayouter::lineRect( const long line ) const
+{
+    const Line& l       = mLines[ line ];
+    const long  endWord = endOfWords( l );
+    const float right   = ( endWord > l.mFirstWord ) ? wordRight( mWords[ endWord - 1 ] ) : l.mLeftX;
+
+    return Rect( l.mLeftX, l.mBaselineY - lineBandBelowBaseline(), right - l.mLeftX, mLineAdvance );
+}
+
+
+void ParagraphLayouter::selectionRects(
+
+    const Caret&    from,
+    const Caret&    to,
+    vector< Rect >& rects
+
+) const {
+
+    rects.clear();
+
+    const bool   inOrder = make_tuple( from.mLine, from.mWord, from.mGlyph )
+                        <= make_tuple( to.mLine,   to.mWord,   to.mGlyph   );
+    const Caret& first   = inOrder ? from : to;
+    const Caret& last    = inOrder ? to   : from;
+
+    for ( long l = first.mLine; l <= last.mLine; l++ ) {
+
+        Rect rect = lineRect( l );
+
+        const float left  = ( l == first.mLine ) ? caretX( first ) : rect.mX;
+        const float right = ( l == last.mLine  ) ? caretX( last  ) : rect.mX + rect.mW;
+
+        rect.mX = left;
+        rect.mW = std::max( 0.0f, right - left );
+        rects.push_back( rect );
+    }
+}
+
+
+void ParagraphLayouter::tokenize(
+
+    const size_t    begin,
+    const size_t    end,
+    vector< Word >& words
+
+) const {
+
+    size_t i = begin;
+
+    while ( i < end ) {
+
+        if ( mText[ i ] == '\n' ) {
+
+            words.emplace_back( i, i + 1, true );
+            i++;
+        }
+        else if ( isSpace( mText[ i ] ) ) {
+
+            i++;
+        }
+        else {
+            size_t j = i;
+
+            while ( j < end && mText[ j ] != '\n' && !isSpace( mText[ j ] ) ) {
+
+                j++;
+            }
+
+            words.emplace_back( i, j, false );
+            i = j;
+        }
+    }
+}
+
+
+void ParagraphLayouter::measure( Word& word )
+{
+    if ( word.mIsBreak ) {
+
+        return;
+    }
+
+    float height;
+
+    mHelper.getGlyphOriginsWidthAndHeight(
+
+        string_view( mText ).substr( word.mBegin, word.mEnd - word.mBegin ),
+        mCharMapIndex,
+        mFontSize,
+        mLetterSpacing,
+        0.0f,
+        0.0f,
+        mGlyphsWork,
+        mOriginsWork,
+        word.mWidth,
+        height,
+        word.mAboveBaselineY,
+        word.mBelowBaselineY
+    );
+
+    mMaxAboveBaselineY = std::max( mMaxAboveBaselineY, word.mAboveBaselineY );
+    mMaxBelowBaselineY = std::max( mMaxBelowBaselineY, word.mBelowBaselineY );
+
+    word.mNumGlyphs = mGlyphsWork.size();
+    word.mFirstSlot = allocateSlots( word.mNumGlyphs );
+
+    copy( mGlyphsWork.begin(),  mGlyphsWork.end(),  mSlotGlyphs.begin()  + word.mFirstSlot );
+    copy( mOriginsWork.begin(), mOriginsWork.end(), mSlotOrigins.begin() + word.mFirstSlot );
+}
+
+
+void ParagraphLayouter::relayout( const long fromLine, const long endNewWords, const long wordDelta )
+{
+    const long     numWords  = mWords.size();
+    long           w         = mLines.empty() ? 0 : mLines[ fromLine ].mFirstWord;
+    long           oldLine   = fromLine;
+    bool           converged = false;
+    vector< Line > newLines;
+
+    while ( w < numWords ) {
+
+        w = ( mLineBreaking == OPTIMAL ) ? breakOptimal( w, newLines )
+                                         : breakGreedy ( w, newLines );
+
+        if ( w >= endNewWords && w < numWords ) {
+
+            // The rest is the same as before if an old line starts there.
+            const long oldWord = w - wordDelta;
+
+            while (    oldLine < (long)mLines.size()
+                    && mLines[ oldLine ].mFirstWord < oldWord ) {
+
+                oldLine++;
+            }
+
+            if (    oldLine < (long)mLines.size()
+                 && mLines[ oldLine ].mFirstWord == oldWord ) {
+
+                converged = true;
+                break;
+            }
+        }
+    }
+
+    if ( !converged ) {
+
+        oldLine = mLines.size();
+    }
+
+    for ( long i = oldLine; i < (long)mLines.size(); i++ ) {
+
+        mLines[ i ].mFirstWord += wordDelta;
+        mLines[ i ].mEndWord   += wordDelta;
+    }
+
+    const long numNewLines = newLines.size();
+    const bool moved       = numNewLines != oldLine - fromLine;
+
+    mLines.erase ( mLines.begin() + fromLine, mLines.begin() + oldLine );
+    mLines.insert( mLines.begin() + fromLine, newLines.begin(), newLines.end() );
+
+    for ( long i = fromLine; i < fromLine + numNewLines; i++ ) {
+
+        mLines[ i ].mBaselineY = mBaselineY - i * mLineAdvance;
+        alignLine( mLines[ i ] );
+        placeLine( mLines[ i ] );
+    }
+
+    if ( moved ) {
+
+        for ( long i = fromLine + numNewLines; i < (long)mLines.size(); i++ ) {
+
+            mLines[ i ].mBaselineY = mBaselineY - i * mLineAdvance;
+            placeLine( mLines[ i ] );
+        }
+    }
+}
+
+
+long ParagraphLayouter::breakGreedy( const long firstWord, vector< Line >& lines ) const
+{
+    const long numWords = mWords.size();
+
+    Line  line( firstWord );
+    float width    = 0.0f;
+    long  n        = 0;
+    long  w        = firstWord;
+
+    while ( w < numWords ) {
+
+        const Word& word = mWords[ w ];
+
+        if ( word.mIsBreak ) {
+
+            w++;
+            break;
+        }
+
+        const float next = ( n == 0 ) ? word.mWidth : width + mSpaceWidth + word.mWidth;
+
+        if ( n > 0 && next > mWidth ) {
+
+            break;
+        }
+
+        width = next;
+        line.mAboveBaselineY = std::max( line.mAboveBaselineY, word.mAboveBaselineY );
+        line.mBelowBaselineY = std::max( line.mBelowBaselineY, word.mBelowBaselineY );
+        n++;
+        w++;
+    }
+
+    line.mEndWord      = w;
+    line.mNaturalWidth = width;
+    lines.push_back( line );
+
+    return w;
+}
+
+
+long ParagraphLayouter::breakOptimal( const long firstWord, vector< Line >& lines ) const
+{
+    if ( !isfinite( mWidth ) ) {
+
+        return breakGreedy( firstWord, lines );
+    }
+
+    const long numWords = mWords.size();
+    long       endWord  = firstWord;
+
+    while ( endWord < numWords && !mWords[ endWord ].mIsBreak ) {
+
+        endWord++;
+    }
+
+    const long n = endWord - firstWord;
+
+    // The least sum of the squares of the spaces left from each word to
+    // the end of the paragraph, and the word that starts the next line.
+    vector< double > cost( n + 1, 0.0 );
+    vector< long >   next( n + 1, n );
+
+    for ( long i = n - 1; i >= 0; i-- ) {
+
+        float width = 0.0f;
+
+        cost[ i ] = numeric_limits< double >::infinity();
+
+        for ( long j = i; j < n; j++ ) {
+
+            width = ( j == i ) ? mWords[ firstWord + j ].mWidth
+                               : width + mSpaceWidth + mWords[ firstWord + j ].mWidth;
+
+            if ( j > i && width > mWidth ) {
+
+                break;
+            }
+
+            const double space = std::max( 0.0, (double)mWidth - width );
+            const double c     = ( ( j == n - 1 ) ? 0.0 : space * space ) + cost[ j + 1 ];
+
+            if ( c < cost[ i ] ) {
+
+                cost[ i ] = c;
+                next[ i ] = j + 1;
+            }
+        }
+    }
+
+    long i = 0;
+
+    do {
+        Line line( firstWord + i );
+
+        const long j = ( n == 0 ) ? 0 : next[ i ];
+
+        for ( long k = i; k < j; k++ ) {
+
+            const Word& word = mWords[ firstWord + k ];
+
+            line.mNaturalWidth  += ( k == i ? 0.0f : mSpaceWidth ) + word.mWidth;
+            line.mAboveBaselineY = std::max( line.mAboveBaselineY, word.mAboveBaselineY );
+            line.mBelowBaselineY = std::max( line.mBelowBaselineY, word.mBelowBaselineY );
+        }
+
+        line.mEndWord = firstWord + j;
+
+        if ( j == n && endWord < numWords ) {
+
+            line.mEndWord++;
+        }
+
+        lines.push_back( line );
+        i = j;
+
+    } while ( i < n );
+
+    return lines.back().mEndWord;
+}
+
+
+void ParagraphLayouter::alignLine( Line& line ) const
+{
+    line.mLeftX = mLeftX;
+    line.mSpace = mSpaceWidth;
+
+    if ( !isfinite( mWidth ) ) {
+
+        return;
+    }
+
+    const float margin = mWidth - line.mNaturalWidth;
+    long        n      = line.mEndWord - line.mFirstWord;
+
+    if ( n > 0 && mWords[ line.mEndWord - 1 ].mIsBreak ) {
+
+        n--;
+    }
+
+    switch ( mAlignment ) {
+
+      case ALIGN_RIGHT:
+
+        line.mLeftX += margin;
+        break;
+
+      case ALIGN_CENTER:
+
+        line.mLeftX += margin * 0.5f;
+        break;
+
+      case ALIGN_JUSTIFY:
+      case ALIGN_JUSTIFY_ALL:
+
+        if (    n > 1 && margin > 0.0f
+             && ( mAlignment == ALIGN_JUSTIFY_ALL || !endsParagraph( line ) ) ) {
+
+            line.mSpace += margin / ( n - 1 );
+        }
+        break;
+
+      default:
+        break;
+    }
+}
+
+
+void ParagraphLayouter::placeLine( const Line& line )
+{
+    float x = line.mLeftX;
+
+    for ( long i = line.mFirstWord; i < line.mEndWord; i++ ) {
+
+        auto& word = mWords[ i ];
+
+        if ( !word.mIsBreak ) {
+
+            placeWord( word, x, line.mBaselineY );
+            x += word.mWidth + line.mSpace;
+        }
+    }
+}
+
+
+void ParagraphLayouter::placeWord( Word& word, const float x, const float baselineY )
+{
+    if ( word.mPlaced && word.mX == x && word.mBaselineY == baselineY ) {
+
+        return;
+    }
+
+    word.mPlaced    = true;
+    word.mX         = x;
+    word.mBaselineY = baselineY;
+
+    const long first     = word.mFirstSlot;
+    const long numGlyphs = word.mNumGlyphs;
+
+    if ( numGlyphs == 0 ) {
+
+        return;
+    }
+
+    mGlyphsWork.assign( mSlotGlyphs.begin() + first, mSlotGlyphs.begin() + first + numGlyphs );
+    mPlacedWork.clear();
+
+    for ( long i = first; i < first + numGlyphs; i++ ) {
+
+        mPlacedWork.emplace_back( mSlotOrigins[ i ].mX + x, mSlotOrigins[ i ].mY + baselineY );
+    }
+
+    mHelper.generateOpenGLDrawElements(
+
+        mFontSize,
+        mSpreadRatio,
+        mGlyphsWork,
+        mPlacedWork,
+        mZ,
+        &( mVertices[ word.mFirstSlot * RuntimeHelper::NUM_FLOATS_PER_GLYPH  ] ),
+        word.mFirstSlot * RuntimeHelper::NUM_POINTS_PER_GLYPH,
+        &( mIndices [ word.mFirstSlot * RuntimeHelper::NUM_INDICES_PER_GLYPH ] )
+    );
+
+    mDirtySlots.emplace_back( word.mFirstSlot, word.mFirstSlot + numGlyphs );
+}
+
+
+long ParagraphLayouter::allocateSlots( const long num )
+{
+    if ( num == 0 ) {
+
+        return 0;
+    }
+
+    // The smallest free run that fits.
+    const auto it = mFreeSlotsBySize.lower_bound( make_pair( num, 0L ) );
+
+    if ( it != mFreeSlotsBySize.end() ) {
+
+        const long first = it->second;
+        const long rest  = it->first - num;
+
+        mFreeSlotsBySize.erase( it );
+        mFreeSlots.erase( first );
+
+        if ( rest > 0 ) {
+
+            addFreeSlots( first + num, rest );
+        }
+        return first;
+    }
+
+    const long first = mNumSlots;
+
+    mNumSlots += num;
+    mVertices   .resize( mNumSlots * RuntimeHelper::NUM_FLOATS_PER_GLYPH,  0.0f );
+    mIndices    .resize( mNumSlots * RuntimeHelper::NUM_INDICES_PER_GLYPH, 0    );
+    mSlotGlyphs .resize( mNumSlots, nullptr );
+    mSlotOrigins.resize( mNumSlots, Point2D( 0.0f, 0.0f ) );
+
+    return first;
+}
+
+
+void ParagraphLayouter::freeSlots( const long first, const long num )
+{
+    if ( num == 0 ) {
+
+        return;
+    }
+
+    // Degenerate quads.
+    fill( mVertices.begin() +   first          * RuntimeHelper::NUM_FLOATS_PER_GLYPH,
+          mVertices.begin() + ( first + num )  * RuntimeHelper::NUM_FLOATS_PER_GLYPH,
+          0.0f );
+
+    fill( mSlotGlyphs.begin() + first, mSlotGlyphs.begin() + first + num, nullptr );
+
+    mDirtySlots.emplace_back( first, first + num );
+
+    long begin = first;
+    long end   = first + num;
+
+    // Merged with the adjacent free runs.
+    const auto next = mFreeSlots.lower_bound( begin );
+
+    if ( next != mFreeSlots.end() && next->first == end ) {
+
+        end = next->first + next->second;
+        mFreeSlotsBySize.erase( make_pair( next->second, next->first ) );
+        mFreeSlots.erase( next );
+    }
+
+    const auto prev = mFreeSlots.lower_bound( begin );
+
+    if ( prev != mFreeSlots.begin() ) {
+
+        const auto p = std::prev( prev );
+
+        if ( p->first + p->second == begin ) {
+
+            begin = p->first;
+            mFreeSlotsBySize.erase( make_pair( p->second, p->first ) );
+            mFreeSlots.erase( p );
+        }
+    }
+
+    addFreeSlots( begin, end - begin );
+}
+
+
+void ParagraphLayouter::addFreeSlots( const long first, const long num )
+{
+    mFreeSlots[ first ] = num;
+    mFreeSlotsBySize.emplace( num, first );
+}
+
+
+long ParagraphLayouter::findLine( const long word ) const
+{
+    const auto it = upper_bound(
+
+        mLines.begin(), mLines.end(), word,
+        []( const long w, const Line& line ){ return w < line.mFirstWord; }
+    );
+
+    return std::max( (long)( it - mLines.begin() ) - 1, 0L );
+}
+
+
+long ParagraphLayouter::endOfWords( const Line& line ) const
+{
+    if ( line.mEndWord > line.mFirstWord && mWords[ line.mEndWord - 1 ].mIsBreak ) {
+
+        return line.mEndWord - 1;
+    }
+    return line.mEndWord;
+}
+
+
+float ParagraphLayouter::wordRight( const Word& word ) const
+{
+    if ( word.mNumGlyphs == 0 ) {
+
+        return word.mX;
+    }
+
+    const long   last = word.mFirstSlot + word.mNumGlyphs - 1;
+    const Glyph* g    = mSlotGlyphs[ last ];
+
+    return word.mX + mSlotOrigins[ last ].mX + ( g->mHorizontalBearingX + g->mWidth ) * mFontSize;
+}
+
+
+float ParagraphLayouter::lineBandBelowBaseline() const
+{
+    return mMaxBelowBaselineY + 0.5f * ( mLineAdvance - mMaxAboveBaselineY - mMaxBelowBaselineY );
+}
+
+
+bool ParagraphLayouter::endsParagraph( const Line& line ) const
+{
+    return    line.mEndWord == (long)mWords.size()
+           || ( line.mEndWord > line.mFirstWord && mWords[ line.mEndWord - 1 ].mIsBreak );
+}
+
+} // namespace SDFont
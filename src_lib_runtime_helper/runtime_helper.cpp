@@ -1,7 +1,20 @@
 #include <string>
 #include <iostream>
+#include <cmath>
+#include <thread>
+#include <functional>
+#include <cstddef>
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ )
+#include <emmintrin.h>
+#elif defined( __ARM_NEON ) && defined( __aarch64__ )
+#include <arm_neon.h>
+#endif
 
 #include "sdfont/runtime_helper/runtime_helper.hpp"
+#include "sdfont/runtime_helper/utf8_decoder.hpp"
 
 namespace SDFont {
 
@@ -10,16 +23,84 @@ const int RuntimeHelper::NUM_FLOATS_PER_POINT  = 8;
 const int RuntimeHelper::NUM_FLOATS_PER_GLYPH  = 4 * 8;
 const int RuntimeHelper::NUM_INDICES_PER_GLYPH = 6;
 
-RuntimeHelper::RuntimeHelper( string fileName ): mSpreadInTexture(0.0), mSpreadInFontMetrics(0.0)
+const float RuntimeHelper::TEXTURE_CHANNEL_OFFSET = 2.0f;
+
+RuntimeHelper::RuntimeHelper( string fileName ):
+    mSpreadInTexture(0.0),
+    mSpreadInFontMetrics(0.0),
+    mEmbeddedFont(nullptr),
+    mGlyphProvider(nullptr)
 {
-    MetricsParser parser( mGlyphs, mSpreadInTexture, mSpreadInFontMetrics, mCharMaps );
+    MetricsParser parser( mGlyphs, mSpreadInTexture, mSpreadInFontMetrics, mCharMaps, mKerning );
     parser.parseSpec( fileName );
 }
 
+RuntimeHelper::RuntimeHelper( FontAtlas atlas ):
+    mSpreadInTexture(atlas.mSpreadInTexture),
+    mSpreadInFontMetrics(atlas.mSpreadInFontMetrics),
+    mGlyphs(std::move(atlas.mGlyphs)),
+    mCharMaps(std::move(atlas.mCharMaps)),
+    mKerning(std::move(atlas.mKerning)),
+    mEmbeddedFont(nullptr),
+    mGlyphProvider(nullptr)
+{
+    ;
+}
+
+RuntimeHelper::RuntimeHelper( const EmbeddedFont& font ):
+    mSpreadInTexture(font.mSpreadInTexture),
+    mSpreadInFontMetrics(font.mSpreadInFontMetrics),
+    mEmbeddedFont(&font),
+    mEmbeddedGlyphs(font.mNumGlyphs),
+    mGlyphProvider(nullptr)
+{
+    for ( long i = 0; i < font.mNumGlyphs; i++ ) {
+
+        const auto& e = font.mGlyphs[ i ];
+        auto&       g = mEmbeddedGlyphs[ i ];
+
+        g.mCodePoint          = e.mCodePoint;
+        g.mWidth              = e.mWidth;
+        g.mHeight             = e.mHeight;
+        g.mHorizontalBearingX = e.mHorizontalBearingX;
+        g.mHorizontalBearingY = e.mHorizontalBearingY;
+        g.mHorizontalAdvance  = e.mHorizontalAdvance;
+        g.mVerticalBearingX   = e.mVerticalBearingX;
+        g.mVerticalBearingY   = e.mVerticalBearingY;
+        g.mVerticalAdvance    = e.mVerticalAdvance;
+        g.mTextureCoordX      = e.mTextureCoordX;
+        g.mTextureCoordY      = e.mTextureCoordY;
+        g.mTextureWidth       = e.mTextureWidth;
+        g.mTextureHeight      = e.mTextureHeight;
+        g.mTextureChannel     = e.mTextureChannel;
+    }
+}
+
+RuntimeHelper::RuntimeHelper(
+    GlyphProvider& provider,
+    const float    spreadInTexture,
+    const float    spreadInFontMetrics
+):
+    mSpreadInTexture(spreadInTexture),
+    mSpreadInFontMetrics(spreadInFontMetrics),
+    mEmbeddedFont(nullptr),
+    mGlyphProvider(&provider)
+{
+    ;
+}
+
 RuntimeHelper::~RuntimeHelper() {;}
 
+
 const Glyph* RuntimeHelper::getGlyph( const long c ) const
 {
+    if ( mEmbeddedFont != nullptr ) {
+
+        const long index = mEmbeddedFont->indexByCodePoint( c );
+
+        return ( index >= 0 ) ? &( mEmbeddedGlyphs[ index ] ) : nullptr;
+    }
+
     auto git = mGlyphs.find( c );
 
     if ( git != mGlyphs.end() ) {
@@ -32,8 +113,94 @@ const Glyph* RuntimeHelper::getGlyph( const long c ) const
     }
 }
 
+const Glyph* RuntimeHelper::findGlyph( const int32_t charMap, const uint32_t charCode ) const
+{
+    bool fromProvider;
+
+    return findGlyph( charMap, charCode, fromProvider );
+}
+
+const Glyph* RuntimeHelper::findGlyph(
+    const int32_t  charMap,
+    const uint32_t charCode,
+    bool&          fromProvider
+) const {
+    fromProvider = false;
+
+    if ( charMap >= 0 ) {
+
+        if ( mEmbeddedFont != nullptr ) {
+
+            const long index = mEmbeddedFont->indexByCharCode( charMap, charCode );
+
+            return ( index >= 0 ) ? &( mEmbeddedGlyphs[ index ] ) : nullptr;
+        }
+
+        const auto& codepoints = mCharMaps[ charMap ].m_char_to_codepoint;
+
+        const auto cit = codepoints.find( charCode );
+
+        if ( cit != codepoints.end() ) {
+
+            const auto git = mGlyphs.find( cit->second );
+
+            if ( git != mGlyphs.end() ) {
+
+                return &( git->second );
+            }
+        }
+    }
+
+    if ( mGlyphProvider != nullptr ) {
+
+        fromProvider = true;
+
+        return mGlyphProvider->provideGlyph( charCode );
+    }
+
+    return nullptr;
+}
+
+float RuntimeHelper::kerningBetween( const long leftCodePoint, const long rightCodePoint ) const
+{
+    if ( mEmbeddedFont != nullptr ) {
+
+        return mEmbeddedFont->mKerning.kerning( leftCodePoint, rightCodePoint );
+    }
+
+    return mKerning.kerning( leftCodePoint, rightCodePoint );
+}
+
+int32_t RuntimeHelper::findCharMap( const int32_t charMapIndex ) const
+{
+    auto ind = charMapIndex;
+    if ( ind == -1 ) {
+        ind = getActiveCharMapIndex();
+    }
+    if ( ind < 0 || ind >= numCharMaps() ) {
+        return -1;
+    }
+    return ind;
+}
+
+int32_t RuntimeHelper::numCharMaps() const
+{
+    if ( mEmbeddedFont != nullptr ) {
+        return mEmbeddedFont->mNumCharMaps;
+    }
+    return mCharMaps.size();
+}
+
 int32_t RuntimeHelper::getActiveCharMapIndex() const
 {
+    if ( mEmbeddedFont != nullptr ) {
+        for ( int32_t i = 0; i < mEmbeddedFont->mNumCharMaps; i++ ) {
+            if ( mEmbeddedFont->mCharMaps[i].mDefault ) {
+                return i;
+            }
+        }
+        return -1;
+    }
     for ( int32_t i = 0; i < mCharMaps.size(); i++ ) {
         const auto& charMap = mCharMaps[i];
         if ( charMap.m_default ) {
@@ -43,8 +210,53 @@ int32_t RuntimeHelper::getActiveCharMapIndex() const
     return -1;
 }
 
+/** @brief the X positions in getMetrics() are accumulated in the fixed
+ *         point, so that the sums over the chunks of the text in
+ *         getMetricsParallel() are exact, and the same as the serial ones.
+ *         The advances and the kernings are rounded to 1/2^32 of the
+ *         font size, far below the precision of the float positions.
+ */
+static const double FixedXOne = 4294967296.0;
+
+static inline int64_t toFixedX( const float x )
+{
+    return llround( (double)x * FixedXOne );
+}
+
+static inline float fromFixedX( const int64_t x )
+{
+    return (float)( (double)x / FixedXOne );
+}
+
+
+/** @brief reads the code points of the vector in the same way as
+ *         UTF8Decoder, for the layout templates below.
+ */
+class UTF32Source {
+
+  public:
+
+    UTF32Source( const vector< uint32_t >& s ) : mS( s ), mPos( 0 ) {;}
+
+    bool next( uint32_t& code )
+    {
+        if ( mPos >= mS.size() ) {
+
+            return false;
+        }
+        code = mS[ mPos++ ];
+        return true;
+    }
+
+  private:
+
+    const vector< uint32_t >& mS;
+    size_t                    mPos;
+};
+
+
 void RuntimeHelper::getGlyphOriginsWidthAndHeight(
-        
+
     const vector<uint32_t>& s,
     const int32_t           charMapIndex,
     const float             fontSize,
@@ -52,6 +264,53 @@ void RuntimeHelper::getGlyphOriginsWidthAndHeight(
     const float&            leftX,
     const float&            baselineY,
 
+    vector< const Glyph* >& glyphs,
+    vector< Point2D >&      instanceOrigins,
+    float&                  width,
+    float&                  height,
+    float&                  aboveBaselineY,
+    float&                  belowBaselineY
+) const {
+    UTF32Source source( s );
+
+    glyphOriginsWidthAndHeight( source, charMapIndex, fontSize, letterSpacing, leftX, baselineY,
+                                glyphs, instanceOrigins, width, height, aboveBaselineY, belowBaselineY );
+}
+
+
+void RuntimeHelper::getGlyphOriginsWidthAndHeight(
+
+    const string_view       utf8,
+    const int32_t           charMapIndex,
+    const float             fontSize,
+    const float             letterSpacing,
+    const float&            leftX,
+    const float&            baselineY,
+
+    vector< const Glyph* >& glyphs,
+    vector< Point2D >&      instanceOrigins,
+    float&                  width,
+    float&                  height,
+    float&                  aboveBaselineY,
+    float&                  belowBaselineY
+) const {
+    UTF8Decoder source( utf8 );
+
+    glyphOriginsWidthAndHeight( source, charMapIndex, fontSize, letterSpacing, leftX, baselineY,
+                                glyphs, instanceOrigins, width, height, aboveBaselineY, belowBaselineY );
+}
+
+
+template< class Source >
+void RuntimeHelper::glyphOriginsWidthAndHeight(
+
+    Source&                 source,
+    const int32_t           charMapIndex,
+    const float             fontSize,
+    const float             letterSpacing,
+    const float&            leftX,
+    const float&            baselineY,
+
     vector< const Glyph* >& glyphs,
     vector< Point2D >&      instanceOrigins,
     float&                  width,
@@ -67,22 +326,17 @@ void RuntimeHelper::getGlyphOriginsWidthAndHeight(
     aboveBaselineY = 0.0f;
     belowBaselineY = 0.0f;    
 
-    auto ind = charMapIndex;
-    if ( ind == -1 ) {
-        ind = getActiveCharMapIndex();
-    }
-    const auto& charMap = mCharMaps[ ind ];
+    const int32_t charMap = findCharMap( charMapIndex );
 
-    for ( auto i = 0 ; i < s.size() ; i++ ) {
+    uint32_t code;
 
-        const auto ch32 = s[i];
-        const auto cp   = charMap.getCodepoint( ch32 );
+    while ( source.next( code ) ) {
 
-        auto it = mGlyphs.find(cp);
+        const auto* g = findGlyph( charMap, code );
 
-        if ( it != mGlyphs.end() ) {
+        if ( g != nullptr ) {
 
-            glyphs.push_back( &(it->second) );
+            glyphs.push_back( g );
         }
     }
 
@@ -168,7 +422,7 @@ void RuntimeHelper::getBoundingBoxes(
             glyph->mTextureHeight + 2.0f * spreadTexture
         );
 
-        bounds.emplace_back( frameBound, textureBound );
+        bounds.emplace_back( frameBound, textureBound, glyph->mTextureChannel );
     }
 }
 
@@ -185,17 +439,45 @@ void RuntimeHelper::getMetrics(
     float&                  advanceY,
     vector< const Glyph* >& glyphs
 ) const {
-    getMetricsNormalized(
-        s,
-        charMapIndex,
-        width,
-        posXs,
-        firstBearingX,
-        bearingY,
-        belowBaselineY,
-        advanceY,
-        glyphs
-    );
+    UTF32Source source( s );
+
+    metricsNormalized( source, charMapIndex, width, posXs, firstBearingX, bearingY, belowBaselineY, advanceY, glyphs );
+
+    scaleMetrics( fontSize, width, posXs, firstBearingX, bearingY, belowBaselineY, advanceY );
+}
+
+
+void RuntimeHelper::getMetrics(
+
+    const string_view       utf8,
+    const int32_t           charMapIndex,
+    const float             fontSize,
+    float&                  width,
+    vector< float >&        posXs,
+    float&                  firstBearingX,
+    float&                  bearingY,
+    float&                  belowBaselineY,
+    float&                  advanceY,
+    vector< const Glyph* >& glyphs
+) const {
+    UTF8Decoder source( utf8 );
+
+    metricsNormalized( source, charMapIndex, width, posXs, firstBearingX, bearingY, belowBaselineY, advanceY, glyphs );
+
+    scaleMetrics( fontSize, width, posXs, firstBearingX, bearingY, belowBaselineY, advanceY );
+}
+
+
+void RuntimeHelper::scaleMetrics(
+
+    const float             fontSize,
+    float&                  width,
+    vector< float >&        posXs,
+    float&                  firstBearingX,
+    float&                  bearingY,
+    float&                  belowBaselineY,
+    float&                  advanceY
+) {
     width *= fontSize;
     for ( auto& x : posXs ) {
         x *= fontSize;
@@ -218,6 +500,43 @@ void RuntimeHelper::getMetricsNormalized(
     float&                  belowBaselineY,
     float&                  advanceY,
     vector< const Glyph* >& glyphs
+) const {
+    UTF32Source source( s );
+
+    metricsNormalized( source, charMapIndex, width, posXs, firstBearingX, bearingY, belowBaselineY, advanceY, glyphs );
+}
+
+
+void RuntimeHelper::getMetricsNormalized(
+
+    const string_view       utf8,
+    const int32_t           charMapIndex,
+    float&                  width,
+    vector< float >&        posXs,
+    float&                  firstBearingX,
+    float&                  bearingY,
+    float&                  belowBaselineY,
+    float&                  advanceY,
+    vector< const Glyph* >& glyphs
+) const {
+    UTF8Decoder source( utf8 );
+
+    metricsNormalized( source, charMapIndex, width, posXs, firstBearingX, bearingY, belowBaselineY, advanceY, glyphs );
+}
+
+
+template< class Source >
+void RuntimeHelper::metricsNormalized(
+
+    Source&                 source,
+    const int32_t           charMapIndex,
+    float&                  width,
+    vector< float >&        posXs,
+    float&                  firstBearingX,
+    float&                  bearingY,
+    float&                  belowBaselineY,
+    float&                  advanceY,
+    vector< const Glyph* >& glyphs
 
 ) const {
 
@@ -227,31 +546,28 @@ void RuntimeHelper::getMetricsNormalized(
     belowBaselineY = 0.0;
     advanceY       = 0.0;
 
-    bool  firstFound     = false;
-    float curX           = 0.0;
-    float lastAdjustment = 0.0;
-    uint32_t chPrev      = 0;
+    bool    firstFound     = false;
+    int64_t curX           = 0;
+    float   lastAdjustment = 0.0;
+    const Glyph* gPrev   = nullptr;
     bool  chPrevSet      = false;
-    auto  len            = s.size();
+    bool  prevKerned     = false;
 
     glyphs.clear();
 
-    auto ind = charMapIndex;
-    if ( ind == -1 ) {
-        ind = getActiveCharMapIndex();
-    }
-    const auto& charMap = mCharMaps[ ind ];
+    const int32_t charMap = findCharMap( charMapIndex );
 
-    for ( auto i = 0 ; i < len ; i++ ) {
+    uint32_t code;
 
-        const auto ch32 = s[i];
-        const auto cp   = charMap.getCodepoint( ch32 );
+    while ( source.next( code ) ) {
 
-        auto git = mGlyphs.find(cp);
+        // The glyphs from the provider are not in the kerning table.
+        bool        fromProvider;
+        const auto* gFound = findGlyph( charMap, code, fromProvider );
 
-        if ( git != mGlyphs.end() ) {
+        if ( gFound != nullptr ) {
 
-            auto& g = git->second;
+            auto& g = *gFound;
 
             if ( !firstFound ) {
 
@@ -267,20 +583,14 @@ void RuntimeHelper::getMetricsNormalized(
             advanceY       = max( advanceY, g.mVerticalAdvance );
 
 
-            if ( chPrevSet ) {
-
-                const auto  git     = mGlyphs.find( chPrev );
-                const auto& gPrev   = git->second;
-                const auto  gitKern = gPrev.mKernings.find( cp );
+            if ( chPrevSet && prevKerned && !fromProvider ) {
 
-                if ( gitKern != gPrev.mKernings.end() ) {
-                    curX += (gitKern->second);
-                }
+                curX += toFixedX( kerningBetween( gPrev->mCodePoint, g.mCodePoint ) );
             }
 
-            posXs.push_back( curX + g.mHorizontalBearingX );
+            posXs.push_back( fromFixedX( curX ) + g.mHorizontalBearingX );
 
-            curX += g.mHorizontalAdvance;
+            curX += toFixedX( g.mHorizontalAdvance );
 
             lastAdjustment =   g.mHorizontalAdvance
                              - ( g.mHorizontalBearingX + g.mWidth );
@@ -289,7 +599,8 @@ void RuntimeHelper::getMetricsNormalized(
 
                 chPrevSet = true ;
             }
-            chPrev = cp;
+            gPrev      = &g;
+            prevKerned = !fromProvider;
 
             glyphs.push_back( &g );
 
@@ -305,8 +616,335 @@ void RuntimeHelper::getMetricsNormalized(
         x -= firstBearingX;
     }
 
-    width = curX - ( firstBearingX + lastAdjustment );
+    width = fromFixedX( curX ) - ( firstBearingX + lastAdjustment );
+
+}
+
+
+/** @brief the minimum size of a chunk for the threads. Smaller texts are
+ *         laid out on the calling thread.
+ */
+static const size_t MinBytesPerChunk  = 64 * 1024;
+static const size_t MinGlyphsPerChunk = 16 * 1024;
+
+static long numChunksFor( const size_t size, const size_t minPerChunk, const long numThreads )
+{
+    const long n = ( numThreads > 0 ) ? numThreads
+                                      : std::max( 1L, (long)thread::hardware_concurrency() );
+
+    return std::max( 1L, std::min( n, (long)( size / minPerChunk ) ) );
+}
+
+/** @brief runs func( i ) for the chunks [ 0, numChunks ), the first one on
+ *         the calling thread.
+ */
+static void runChunks( const long numChunks, const function< void( long ) >& func )
+{
+    if ( numChunks <= 0 ) {
+
+        return;
+    }
+
+    vector< thread > workers;
+
+    for ( long i = 1; i < numChunks; i++ ) {
+
+        workers.emplace_back( func, i );
+    }
+
+    func( 0 );
+
+    for ( auto& w : workers ) {
+
+        w.join();
+    }
+}
+
+/** @brief a chunk of the text for getMetricsParallel(), laid out as if
+ *         it started the text.
+ */
+class MetricsChunk {
+
+  public:
+
+    MetricsChunk( const size_t begin, const size_t end ):
+        mBegin          ( begin ),
+        mEnd            ( end ),
+        mAdvance        ( 0 ),
+        mFirstKerned    ( false ),
+        mLastKerned     ( false ),
+        mLast           ( nullptr ),
+        mFirstFound     ( nullptr ),
+        mLastFound      ( nullptr ),
+        mBearingY       ( 0.0 ),
+        mBelowBaselineY ( 0.0 ),
+        mAdvanceY       ( 0.0 ),
+        mStartX         ( 0 ),
+        mFirstIndex     ( 0 )
+        {;}
+
+    /** @brief range in the bytes. */
+    size_t                 mBegin;
+    size_t                 mEnd;
+
+    /** @brief by code point. */
+    vector< const Glyph* > mGlyphs;
+
+    /** @brief X before the bearing by code point, from the chunk start. */
+    vector< int64_t >      mXs;
+
+    /** @brief sum of the advances and the kernings in the chunk. */
+    int64_t                mAdvance;
+
+    /** @brief the first code point can be kerned with the preceding glyph. */
+    bool                   mFirstKerned;
+
+    /** @brief the last code point can be kerned with the following glyph,
+     *         which is mLast.
+     */
+    bool                   mLastKerned;
+    const Glyph*           mLast;
+
+    const Glyph*           mFirstFound;
+    const Glyph*           mLastFound;
+    float                  mBearingY;
+    float                  mBelowBaselineY;
+    float                  mAdvanceY;
+
+    /** @brief X of the chunk start and the index of its first code point
+     *         in the text, from the exclusive scan.
+     */
+    int64_t                mStartX;
+    size_t                 mFirstIndex;
+};
+
+
+void RuntimeHelper::getMetricsParallel(
+
+    const string_view       utf8,
+    const int32_t           charMapIndex,
+    const float             fontSize,
+    float&                  width,
+    vector< float >&        posXs,
+    float&                  firstBearingX,
+    float&                  bearingY,
+    float&                  belowBaselineY,
+    float&                  advanceY,
+    vector< const Glyph* >& glyphs,
+    const long              numThreads
+) const {
+    metricsParallel( utf8, charMapIndex, true, fontSize, width, posXs, firstBearingX,
+                     bearingY, belowBaselineY, advanceY, glyphs, numThreads           );
+}
+
+
+void RuntimeHelper::getMetricsNormalizedParallel(
+
+    const string_view       utf8,
+    const int32_t           charMapIndex,
+    float&                  width,
+    vector< float >&        posXs,
+    float&                  firstBearingX,
+    float&                  bearingY,
+    float&                  belowBaselineY,
+    float&                  advanceY,
+    vector< const Glyph* >& glyphs,
+    const long              numThreads
+) const {
+    metricsParallel( utf8, charMapIndex, false, 1.0f, width, posXs, firstBearingX,
+                     bearingY, belowBaselineY, advanceY, glyphs, numThreads          );
+}
+
+
+void RuntimeHelper::metricsParallel(
+
+    const string_view       utf8,
+    const int32_t           charMapIndex,
+    const bool              scale,
+    const float             fontSize,
+    float&                  width,
+    vector< float >&        posXs,
+    float&                  firstBearingX,
+    float&                  bearingY,
+    float&                  belowBaselineY,
+    float&                  advanceY,
+    vector< const Glyph* >& glyphs,
+    const long              numThreads
+) const {
+    const long numChunks = ( mGlyphProvider != nullptr )
+                           ? 1 : numChunksFor( utf8.size(), MinBytesPerChunk, numThreads );
+
+    // The chunks start at the code point boundaries, i.e., not at the
+    // continuation bytes. UTF8Decoder never takes any other byte into the
+    // preceding sequence, and hence the chunks decode as the whole text.
+    vector< MetricsChunk > chunks;
+
+    size_t begin = 0;
+
+    for ( long i = 1; i <= numChunks && begin < utf8.size(); i++ ) {
+
+        size_t end = std::max( begin, utf8.size() * i / numChunks );
+
+        while ( end < utf8.size() && ( (unsigned char)utf8[ end ] & 0xC0 ) == 0x80 ) {
+
+            end++;
+        }
+
+        if ( end > begin ) {
+
+            chunks.emplace_back( begin, end );
+            begin = end;
+        }
+    }
+
+    const int32_t charMap = findCharMap( charMapIndex );
+
+    // Phase 1: the glyphs and the advances in each chunk.
+    runChunks( chunks.size(), [ & ]( const long i ) {
+
+        auto& c = chunks[ i ];
+
+        UTF8Decoder source( utf8.substr( c.mBegin, c.mEnd - c.mBegin ) );
+
+        int64_t      curX       = 0;
+        const Glyph* gPrev      = nullptr;
+        bool         prevKerned = false;
+
+        uint32_t code;
+
+        while ( source.next( code ) ) {
+
+            bool        fromProvider;
+            const auto* g = findGlyph( charMap, code, fromProvider );
+
+            if ( c.mGlyphs.empty() ) {
+
+                c.mFirstKerned = ( g != nullptr && !fromProvider );
+            }
+
+            if ( g != nullptr ) {
+
+                if ( c.mFirstFound == nullptr ) {
+
+                    c.mFirstFound = g;
+                }
+                c.mLastFound = g;
+
+                c.mBearingY       = max( c.mBearingY, g->mHorizontalBearingY );
+                c.mBelowBaselineY = min( c.mBelowBaselineY, g->mHorizontalBearingY - g->mHeight );
+                c.mAdvanceY       = max( c.mAdvanceY, g->mVerticalAdvance );
+
+                if ( prevKerned && !fromProvider ) {
+
+                    curX += toFixedX( kerningBetween( gPrev->mCodePoint, g->mCodePoint ) );
+                }
+
+                c.mXs.push_back( curX );
+
+                curX      += toFixedX( g->mHorizontalAdvance );
+                gPrev      = g;
+                prevKerned = !fromProvider;
+            }
+            else {
+                c.mXs.push_back( 0 );
+                prevKerned = false;
+            }
+
+            c.mGlyphs.push_back( g );
+        }
+
+        c.mAdvance    = curX;
+        c.mLastKerned = prevKerned;
+        c.mLast       = gPrev;
+    } );
+
+    // Phase 2: the exclusive scan of the advances with the kernings over
+    // the chunk boundaries.
+    int64_t curX  = 0;
+    size_t  index = 0;
+
+    firstBearingX  = 0.0;
+    bearingY       = 0.0;
+    belowBaselineY = 0.0;
+    advanceY       = 0.0;
+
+    float lastAdjustment = 0.0;
+    bool  firstFound     = false;
+
+    for ( long i = 0; i < (long)chunks.size(); i++ ) {
+
+        auto& c = chunks[ i ];
+
+        if ( i > 0 && chunks[ i - 1 ].mLastKerned && c.mFirstKerned ) {
+
+            curX += toFixedX( kerningBetween( chunks[ i - 1 ].mLast->mCodePoint,
+                                              c.mGlyphs[ 0 ]->mCodePoint         ) );
+        }
+
+        c.mStartX     = curX;
+        c.mFirstIndex = index;
+
+        curX  += c.mAdvance;
+        index += c.mGlyphs.size();
+
+        if ( c.mFirstFound != nullptr ) {
+
+            if ( !firstFound ) {
+
+                firstBearingX = c.mFirstFound->mHorizontalBearingX;
+                firstFound    = true;
+            }
+
+            const auto& g = *( c.mLastFound );
+
+            lastAdjustment =   g.mHorizontalAdvance
+                             - ( g.mHorizontalBearingX + g.mWidth );
+        }
+
+        bearingY       = max( bearingY,       c.mBearingY       );
+        belowBaselineY = min( belowBaselineY, c.mBelowBaselineY );
+        advanceY       = max( advanceY,       c.mAdvanceY       );
+    }
+
+    width = fromFixedX( curX ) - ( firstBearingX + lastAdjustment );
+
+    // Phase 3: the positions with the same operations as metricsNormalized()
+    // and scaleMetrics().
+    glyphs.resize( index );
+    posXs.resize ( index );
+
+    const float firstX = firstBearingX;
+
+    runChunks( chunks.size(), [ & ]( const long i ) {
+
+        const auto& c = chunks[ i ];
+
+        for ( size_t k = 0; k < c.mGlyphs.size(); k++ ) {
+
+            const auto* g = c.mGlyphs[ k ];
+
+            float x = ( g != nullptr ) ? fromFixedX( c.mStartX + c.mXs[ k ] ) + g->mHorizontalBearingX
+                                       : 0.0f;
+            x -= firstX;
+
+            if ( scale ) {
+
+                x *= fontSize;
+            }
+
+            glyphs[ c.mFirstIndex + k ] = g;
+            posXs [ c.mFirstIndex + k ] = x;
+        }
+    } );
+
+    if ( scale ) {
 
+        width          *= fontSize;
+        firstBearingX  *= fontSize;
+        bearingY       *= fontSize;
+        belowBaselineY *= fontSize;
+        advanceY       *= fontSize;
+    }
 }
 
 
@@ -351,7 +989,7 @@ bool RuntimeHelper::getBoundingBoxes(
         const Rect frame  ( leftX, bottomY, width, height );
         const Rect texture( textureX, textureY, textureWidth, textureHeight );
 
-        bounds.emplace_back( frame, texture );
+        bounds.emplace_back( frame, texture, g->mTextureChannel );
     }
 
     return true;
@@ -373,6 +1011,8 @@ void RuntimeHelper::generateOpenGLDrawElements (
 
     for(  auto& b : bounds ) {
 
+        const float channelU = TEXTURE_CHANNEL_OFFSET * (float)b.mTextureChannel;
+
         indexP[0] = index;
         indexP[1] = index + 1;
         indexP[2] = index + 3;
@@ -386,7 +1026,7 @@ void RuntimeHelper::generateOpenGLDrawElements (
         arrayP[ 3]  = 0.0;
         arrayP[ 4]  = 0.0;
         arrayP[ 5]  = 1.0;
-        arrayP[ 6]  = b.mTexture.mX;
+        arrayP[ 6]  = b.mTexture.mX + channelU;
         arrayP[ 7]  = b.mTexture.mY;
 
         arrayP[ 8]  = b.mFrame.mX + b.mFrame.mW;
@@ -395,7 +1035,7 @@ void RuntimeHelper::generateOpenGLDrawElements (
         arrayP[11]  = 0.0;
         arrayP[12]  = 0.0;
         arrayP[13]  = 1.0;
-        arrayP[14]  = b.mTexture.mX + b.mTexture.mW;
+        arrayP[14]  = ( b.mTexture.mX + b.mTexture.mW ) + channelU;
         arrayP[15]  = b.mTexture.mY;
 
         arrayP[16]  = b.mFrame.mX + b.mFrame.mW;
@@ -404,7 +1044,7 @@ void RuntimeHelper::generateOpenGLDrawElements (
         arrayP[19]  = 0.0;
         arrayP[20]  = 0.0;
         arrayP[21]  = 1.0;
-        arrayP[22]  = b.mTexture.mX + b.mTexture.mW;
+        arrayP[22]  = ( b.mTexture.mX + b.mTexture.mW ) + channelU;
         arrayP[23]  = b.mTexture.mY + b.mTexture.mH;
 
         arrayP[24]  = b.mFrame.mX;
@@ -413,7 +1053,7 @@ void RuntimeHelper::generateOpenGLDrawElements (
         arrayP[27]  = 0.0;
         arrayP[28]  = 0.0;
         arrayP[29]  = 1.0;
-        arrayP[30]  = b.mTexture.mX;
+        arrayP[30]  = b.mTexture.mX + channelU;
         arrayP[31]  = b.mTexture.mY + b.mTexture.mH;
 
         index  += NUM_POINTS_PER_GLYPH;
@@ -423,6 +1063,573 @@ void RuntimeHelper::generateOpenGLDrawElements (
 }
 
 
+// The SIMD paths below load the four metrics from mWidth and the four
+// texture coordinates from mTextureCoordX at once, and the origins as pairs.
+static_assert( offsetof( Glyph, mHorizontalBearingY ) == offsetof( Glyph, mWidth ) + 3 * sizeof( float ),
+               "mWidth, mHeight, mHorizontalBearingX, and mHorizontalBearingY must be contiguous" );
+static_assert( offsetof( Glyph, mTextureHeight ) == offsetof( Glyph, mTextureCoordX ) + 3 * sizeof( float ),
+               "the texture coordinates must be contiguous" );
+static_assert( sizeof( Point2D ) == 2 * sizeof( float ), "Point2D must be two floats" );
+
+/** @brief the vertices are written with the streaming stores from this
+ *         number of glyphs, i.e., 1 [MB] of the vertices.
+ */
+static const size_t StreamingMinGlyphs = 8 * 1024;
+
+/** @brief the constants of the quads in generateOpenGLDrawElements(). */
+class QuadParams {
+
+  public:
+
+    QuadParams(
+        const float fontSize,
+        const float spreadVertex,
+        const float spreadTexture,
+        const float Z
+    ):
+        mFontSize       ( fontSize ),
+        mSpreadFont     ( spreadVertex * fontSize ),
+        mSpreadVertex2  ( 2.0f * spreadVertex ),
+        mSpreadTexture  ( spreadTexture ),
+        mSpreadTexture2 ( 2.0f * spreadTexture ),
+        mZ              ( Z )
+        {;}
+
+    const float mFontSize;
+    const float mSpreadFont;
+    const float mSpreadVertex2;
+    const float mSpreadTexture;
+    const float mSpreadTexture2;
+    const float mZ;
+};
+
+/** @brief 6 indices of the two triangles per quad from its first vertex. */
+alignas( 32 ) static const uint32_t QuadIndexOffsets[ 48 ] = {
+     0,  1,  3,  2,  3,  1,
+     4,  5,  7,  6,  7,  5,
+     8,  9, 11, 10, 11,  9,
+    12, 13, 15, 14, 15, 13,
+    16, 17, 19, 18, 19, 17,
+    20, 21, 23, 22, 23, 21,
+    24, 25, 27, 26, 27, 25,
+    28, 29, 31, 30, 31, 29
+};
+
+/** @return the offset of the texture coordinate X of the vertices for the
+ *          channel of the glyph. See RuntimeHelper::TEXTURE_CHANNEL_OFFSET.
+ */
+static inline float channelOffset( const Glyph& g )
+{
+    return RuntimeHelper::TEXTURE_CHANNEL_OFFSET * (float)g.mTextureChannel;
+}
+
+/** @brief one quad in the same way as getBoundingBoxes() and
+ *         generateOpenGLDrawElements( bounds, ... ).
+ */
+static inline void expandQuad(
+
+    const Glyph&       g,
+    const Point2D&     o,
+    const QuadParams&  p,
+    float*             arrayP,
+    const unsigned int index,
+    unsigned int*      indexP
+) {
+    const float x0 = ( o.mX + g.mHorizontalBearingX * p.mFontSize ) - p.mSpreadFont;
+    const float y0 = ( o.mY + ( g.mHorizontalBearingY - g.mHeight ) * p.mFontSize ) - p.mSpreadFont;
+    const float x1 = x0 + ( g.mWidth  + p.mSpreadVertex2 ) * p.mFontSize;
+    const float y1 = y0 + ( g.mHeight + p.mSpreadVertex2 ) * p.mFontSize;
+
+    const float s0 = g.mTextureCoordX - p.mSpreadTexture;
+    const float v0 = g.mTextureCoordY - p.mSpreadTexture;
+    const float s1 = s0 + ( g.mTextureWidth  + p.mSpreadTexture2 );
+    const float v1 = v0 + ( g.mTextureHeight + p.mSpreadTexture2 );
+    const float u0 = s0 + channelOffset( g );
+    const float u1 = s1 + channelOffset( g );
+
+    const float corners[ 4 ][ 4 ] = { { x0, y0, u0, v0 },
+                                      { x1, y0, u1, v0 },
+                                      { x1, y1, u1, v1 },
+                                      { x0, y1, u0, v1 } };
+    for ( long c = 0; c < 4; c++ ) {
+
+        float* v = arrayP + c * 8;
+
+        v[0] = corners[c][0];
+        v[1] = corners[c][1];
+        v[2] = p.mZ;
+        v[3] = 0.0;
+        v[4] = 0.0;
+        v[5] = 1.0;
+        v[6] = corners[c][2];
+        v[7] = corners[c][3];
+    }
+
+    for ( long k = 0; k < 6; k++ ) {
+
+        indexP[k] = index + QuadIndexOffsets[k];
+    }
+}
+
+#if defined( __AVX2__ )
+
+static const size_t QuadsPerBatch = 8;
+
+/** @brief expands one corner of the 8 quads from its coordinates in the
+ *         SoA form. Each vertex of 8 floats is one register.
+ *
+ *  @param v (out): the vertex of the corner by quad.
+ */
+static inline void expandCorner8(
+
+    const __m256 X,
+    const __m256 Y,
+    const __m256 U,
+    const __m256 V,
+    const __m256 cZ,
+    const __m256 c01,
+    __m256*      v
+) {
+    const __m256 xyLo = _mm256_unpacklo_ps( X, Y ); // x0 y0 x1 y1 | x4 y4 x5 y5
+    const __m256 xyHi = _mm256_unpackhi_ps( X, Y ); // x2 y2 x3 y3 | x6 y6 x7 y7
+    const __m256 uvLo = _mm256_unpacklo_ps( U, V );
+    const __m256 uvHi = _mm256_unpackhi_ps( U, V );
+
+    // x y Z 0 | 0 1 u v for the quads ( 0, 4 ), ( 1, 5 ), ( 2, 6 ), ( 3, 7 ).
+    const __m256 a0 = _mm256_shuffle_ps( xyLo, cZ,   _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    const __m256 b0 = _mm256_shuffle_ps( c01,  uvLo, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    const __m256 a1 = _mm256_shuffle_ps( xyLo, cZ,   _MM_SHUFFLE( 1, 0, 3, 2 ) );
+    const __m256 b1 = _mm256_shuffle_ps( c01,  uvLo, _MM_SHUFFLE( 3, 2, 1, 0 ) );
+    const __m256 a2 = _mm256_shuffle_ps( xyHi, cZ,   _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    const __m256 b2 = _mm256_shuffle_ps( c01,  uvHi, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    const __m256 a3 = _mm256_shuffle_ps( xyHi, cZ,   _MM_SHUFFLE( 1, 0, 3, 2 ) );
+    const __m256 b3 = _mm256_shuffle_ps( c01,  uvHi, _MM_SHUFFLE( 3, 2, 1, 0 ) );
+
+    v[0] = _mm256_permute2f128_ps( a0, b0, 0x20 );
+    v[1] = _mm256_permute2f128_ps( a1, b1, 0x20 );
+    v[2] = _mm256_permute2f128_ps( a2, b2, 0x20 );
+    v[3] = _mm256_permute2f128_ps( a3, b3, 0x20 );
+    v[4] = _mm256_permute2f128_ps( a0, b0, 0x31 );
+    v[5] = _mm256_permute2f128_ps( a1, b1, 0x31 );
+    v[6] = _mm256_permute2f128_ps( a2, b2, 0x31 );
+    v[7] = _mm256_permute2f128_ps( a3, b3, 0x31 );
+}
+
+/** @brief 8 quads. */
+static inline void expandQuads(
+
+    const Glyph* const* glyphs,
+    const Point2D*      origins,
+    const QuadParams&   p,
+    float*              arrayP,
+    const unsigned int  index,
+    unsigned int*       indexP,
+    const bool          streaming
+) {
+    // Transposes ( w, h, bx, by ) and ( tx, ty, tw, th ) of the quads
+    // ( k, k + 4 ) in the two lanes.
+    __m256 m[4];
+    __m256 t[4];
+
+    for ( long k = 0; k < 4; k++ ) {
+
+        m[k] = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( &( glyphs[ k     ]->mWidth ) ) ),
+                                                             _mm_loadu_ps( &( glyphs[ k + 4 ]->mWidth ) ), 1 );
+
+        t[k] = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( &( glyphs[ k     ]->mTextureCoordX ) ) ),
+                                                             _mm_loadu_ps( &( glyphs[ k + 4 ]->mTextureCoordX ) ), 1 );
+    }
+
+    const __m256 m01Lo = _mm256_unpacklo_ps( m[0], m[1] );
+    const __m256 m01Hi = _mm256_unpackhi_ps( m[0], m[1] );
+    const __m256 m23Lo = _mm256_unpacklo_ps( m[2], m[3] );
+    const __m256 m23Hi = _mm256_unpackhi_ps( m[2], m[3] );
+
+    const __m256 W  = _mm256_shuffle_ps( m01Lo, m23Lo, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    const __m256 H  = _mm256_shuffle_ps( m01Lo, m23Lo, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+    const __m256 BX = _mm256_shuffle_ps( m01Hi, m23Hi, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    const __m256 BY = _mm256_shuffle_ps( m01Hi, m23Hi, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+
+    const __m256 t01Lo = _mm256_unpacklo_ps( t[0], t[1] );
+    const __m256 t01Hi = _mm256_unpackhi_ps( t[0], t[1] );
+    const __m256 t23Lo = _mm256_unpacklo_ps( t[2], t[3] );
+    const __m256 t23Hi = _mm256_unpackhi_ps( t[2], t[3] );
+
+    const __m256 TX = _mm256_shuffle_ps( t01Lo, t23Lo, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    const __m256 TY = _mm256_shuffle_ps( t01Lo, t23Lo, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+    const __m256 TW = _mm256_shuffle_ps( t01Hi, t23Hi, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    const __m256 TH = _mm256_shuffle_ps( t01Hi, t23Hi, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+
+    // x0 y0 x1 y1 x2 y2 x3 y3 and x4 y4 ... x7 y7 into the same lanes.
+    const __m256 o0 = _mm256_loadu_ps( &( origins[0].mX ) );
+    const __m256 o1 = _mm256_loadu_ps( &( origins[4].mX ) );
+    const __m256 oLo = _mm256_permute2f128_ps( o0, o1, 0x20 );
+    const __m256 oHi = _mm256_permute2f128_ps( o0, o1, 0x31 );
+
+    const __m256 OX = _mm256_shuffle_ps( oLo, oHi, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+    const __m256 OY = _mm256_shuffle_ps( oLo, oHi, _MM_SHUFFLE( 3, 1, 3, 1 ) );
+
+    const __m256 fontSize       = _mm256_set1_ps( p.mFontSize       );
+    const __m256 spreadFont     = _mm256_set1_ps( p.mSpreadFont     );
+    const __m256 spreadVertex2  = _mm256_set1_ps( p.mSpreadVertex2  );
+    const __m256 spreadTexture  = _mm256_set1_ps( p.mSpreadTexture  );
+    const __m256 spreadTexture2 = _mm256_set1_ps( p.mSpreadTexture2 );
+
+    const __m256 X0 = _mm256_sub_ps( _mm256_add_ps( OX, _mm256_mul_ps( BX, fontSize ) ), spreadFont );
+    const __m256 Y0 = _mm256_sub_ps( _mm256_add_ps( OY, _mm256_mul_ps( _mm256_sub_ps( BY, H ), fontSize ) ), spreadFont );
+    const __m256 X1 = _mm256_add_ps( X0, _mm256_mul_ps( _mm256_add_ps( W, spreadVertex2 ), fontSize ) );
+    const __m256 Y1 = _mm256_add_ps( Y0, _mm256_mul_ps( _mm256_add_ps( H, spreadVertex2 ), fontSize ) );
+
+    const __m256 CH = _mm256_setr_ps( channelOffset( *glyphs[0] ), channelOffset( *glyphs[1] ),
+                                      channelOffset( *glyphs[2] ), channelOffset( *glyphs[3] ),
+                                      channelOffset( *glyphs[4] ), channelOffset( *glyphs[5] ),
+                                      channelOffset( *glyphs[6] ), channelOffset( *glyphs[7] ) );
+
+    const __m256 S0 = _mm256_sub_ps( TX, spreadTexture );
+    const __m256 V0 = _mm256_sub_ps( TY, spreadTexture );
+    const __m256 S1 = _mm256_add_ps( S0, _mm256_add_ps( TW, spreadTexture2 ) );
+    const __m256 V1 = _mm256_add_ps( V0, _mm256_add_ps( TH, spreadTexture2 ) );
+    const __m256 U0 = _mm256_add_ps( S0, CH );
+    const __m256 U1 = _mm256_add_ps( S1, CH );
+
+    const __m256 cZ  = _mm256_setr_ps( p.mZ, 0.0f, p.mZ, 0.0f, p.mZ, 0.0f, p.mZ, 0.0f );
+    const __m256 c01 = _mm256_setr_ps( 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f );
+
+    __m256 v[4][8];
+
+    expandCorner8( X0, Y0, U0, V0, cZ, c01, v[0] );
+    expandCorner8( X1, Y0, U1, V0, cZ, c01, v[1] );
+    expandCorner8( X1, Y1, U1, V1, cZ, c01, v[2] );
+    expandCorner8( X0, Y1, U0, V1, cZ, c01, v[3] );
+
+    // Quad by quad, so that the streaming stores fill one cache line after
+    // another in the write combining buffers.
+    for ( long q = 0; q < 8; q++ ) {
+
+        for ( long c = 0; c < 4; c++ ) {
+
+            if ( streaming ) {
+
+                _mm256_stream_ps( arrayP + q * 32 + c * 8, v[c][q] );
+            }
+            else {
+                _mm256_storeu_ps( arrayP + q * 32 + c * 8, v[c][q] );
+            }
+        }
+    }
+
+    const __m256i base = _mm256_set1_epi32( (int)index );
+
+    for ( long k = 0; k < 6; k++ ) {
+
+        const __m256i offsets = _mm256_load_si256( reinterpret_cast< const __m256i* >( QuadIndexOffsets + k * 8 ) );
+
+        _mm256_storeu_si256( reinterpret_cast< __m256i* >( indexP + k * 8 ), _mm256_add_epi32( base, offsets ) );
+    }
+}
+
+#elif defined( __SSE2__ )
+
+static const size_t QuadsPerBatch = 4;
+
+/** @brief expands one corner of the 4 quads from its coordinates in the
+ *         SoA form. Each vertex is two registers.
+ *
+ *  @param v (out): the halves of the vertex of the corner by quad.
+ */
+static inline void expandCorner4(
+
+    const __m128 X,
+    const __m128 Y,
+    const __m128 U,
+    const __m128 V,
+    const __m128 cZ,
+    const __m128 c01,
+    __m128*      v
+) {
+    const __m128 xyLo = _mm_unpacklo_ps( X, Y ); // x0 y0 x1 y1
+    const __m128 xyHi = _mm_unpackhi_ps( X, Y ); // x2 y2 x3 y3
+    const __m128 uvLo = _mm_unpacklo_ps( U, V );
+    const __m128 uvHi = _mm_unpackhi_ps( U, V );
+
+    // x y Z 0 and 0 1 u v for each quad.
+    v[0] = _mm_shuffle_ps( xyLo, cZ,   _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    v[1] = _mm_shuffle_ps( c01,  uvLo, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    v[2] = _mm_shuffle_ps( xyLo, cZ,   _MM_SHUFFLE( 1, 0, 3, 2 ) );
+    v[3] = _mm_shuffle_ps( c01,  uvLo, _MM_SHUFFLE( 3, 2, 1, 0 ) );
+    v[4] = _mm_shuffle_ps( xyHi, cZ,   _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    v[5] = _mm_shuffle_ps( c01,  uvHi, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+    v[6] = _mm_shuffle_ps( xyHi, cZ,   _MM_SHUFFLE( 1, 0, 3, 2 ) );
+    v[7] = _mm_shuffle_ps( c01,  uvHi, _MM_SHUFFLE( 3, 2, 1, 0 ) );
+}
+
+/** @brief 4 quads. */
+static inline void expandQuads(
+
+    const Glyph* const* glyphs,
+    const Point2D*      origins,
+    const QuadParams&   p,
+    float*              arrayP,
+    const unsigned int  index,
+    unsigned int*       indexP,
+    const bool          streaming
+) {
+    __m128 W  = _mm_loadu_ps( &( glyphs[0]->mWidth ) );
+    __m128 H  = _mm_loadu_ps( &( glyphs[1]->mWidth ) );
+    __m128 BX = _mm_loadu_ps( &( glyphs[2]->mWidth ) );
+    __m128 BY = _mm_loadu_ps( &( glyphs[3]->mWidth ) );
+
+    _MM_TRANSPOSE4_PS( W, H, BX, BY );
+
+    __m128 TX = _mm_loadu_ps( &( glyphs[0]->mTextureCoordX ) );
+    __m128 TY = _mm_loadu_ps( &( glyphs[1]->mTextureCoordX ) );
+    __m128 TW = _mm_loadu_ps( &( glyphs[2]->mTextureCoordX ) );
+    __m128 TH = _mm_loadu_ps( &( glyphs[3]->mTextureCoordX ) );
+
+    _MM_TRANSPOSE4_PS( TX, TY, TW, TH );
+
+    const __m128 o0 = _mm_loadu_ps( &( origins[0].mX ) );
+    const __m128 o1 = _mm_loadu_ps( &( origins[2].mX ) );
+    const __m128 OX = _mm_shuffle_ps( o0, o1, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+    const __m128 OY = _mm_shuffle_ps( o0, o1, _MM_SHUFFLE( 3, 1, 3, 1 ) );
+
+    const __m128 fontSize       = _mm_set1_ps( p.mFontSize       );
+    const __m128 spreadFont     = _mm_set1_ps( p.mSpreadFont     );
+    const __m128 spreadVertex2  = _mm_set1_ps( p.mSpreadVertex2  );
+    const __m128 spreadTexture  = _mm_set1_ps( p.mSpreadTexture  );
+    const __m128 spreadTexture2 = _mm_set1_ps( p.mSpreadTexture2 );
+
+    const __m128 X0 = _mm_sub_ps( _mm_add_ps( OX, _mm_mul_ps( BX, fontSize ) ), spreadFont );
+    const __m128 Y0 = _mm_sub_ps( _mm_add_ps( OY, _mm_mul_ps( _mm_sub_ps( BY, H ), fontSize ) ), spreadFont );
+    const __m128 X1 = _mm_add_ps( X0, _mm_mul_ps( _mm_add_ps( W, spreadVertex2 ), fontSize ) );
+    const __m128 Y1 = _mm_add_ps( Y0, _mm_mul_ps( _mm_add_ps( H, spreadVertex2 ), fontSize ) );
+
+    const __m128 CH = _mm_setr_ps( channelOffset( *glyphs[0] ), channelOffset( *glyphs[1] ),
+                                   channelOffset( *glyphs[2] ), channelOffset( *glyphs[3] ) );
+
+    const __m128 S0 = _mm_sub_ps( TX, spreadTexture );
+    const __m128 V0 = _mm_sub_ps( TY, spreadTexture );
+    const __m128 S1 = _mm_add_ps( S0, _mm_add_ps( TW, spreadTexture2 ) );
+    const __m128 V1 = _mm_add_ps( V0, _mm_add_ps( TH, spreadTexture2 ) );
+    const __m128 U0 = _mm_add_ps( S0, CH );
+    const __m128 U1 = _mm_add_ps( S1, CH );
+
+    const __m128 cZ  = _mm_setr_ps( p.mZ, 0.0f, p.mZ, 0.0f );
+    const __m128 c01 = _mm_setr_ps( 0.0f, 1.0f, 0.0f, 1.0f );
+
+    __m128 v[4][8];
+
+    expandCorner4( X0, Y0, U0, V0, cZ, c01, v[0] );
+    expandCorner4( X1, Y0, U1, V0, cZ, c01, v[1] );
+    expandCorner4( X1, Y1, U1, V1, cZ, c01, v[2] );
+    expandCorner4( X0, Y1, U0, V1, cZ, c01, v[3] );
+
+    // Quad by quad, so that the streaming stores fill one cache line after
+    // another in the write combining buffers.
+    for ( long q = 0; q < 4; q++ ) {
+
+        for ( long c = 0; c < 4; c++ ) {
+
+            if ( streaming ) {
+
+                _mm_stream_ps( arrayP + q * 32 + c * 8,     v[c][ q * 2     ] );
+                _mm_stream_ps( arrayP + q * 32 + c * 8 + 4, v[c][ q * 2 + 1 ] );
+            }
+            else {
+                _mm_storeu_ps( arrayP + q * 32 + c * 8,     v[c][ q * 2     ] );
+                _mm_storeu_ps( arrayP + q * 32 + c * 8 + 4, v[c][ q * 2 + 1 ] );
+            }
+        }
+    }
+
+    const __m128i base = _mm_set1_epi32( (int)index );
+
+    for ( long k = 0; k < 6; k++ ) {
+
+        const __m128i offsets = _mm_load_si128( reinterpret_cast< const __m128i* >( QuadIndexOffsets + k * 4 ) );
+
+        _mm_storeu_si128( reinterpret_cast< __m128i* >( indexP + k * 4 ), _mm_add_epi32( base, offsets ) );
+    }
+}
+
+#elif defined( __ARM_NEON ) && defined( __aarch64__ )
+
+static const size_t QuadsPerBatch = 4;
+
+/** @brief writes one corner of the 4 quads from its coordinates in the
+ *         SoA form. Each vertex is two registers.
+ */
+static inline void storeCorner4(
+
+    const float32x4_t X,
+    const float32x4_t Y,
+    const float32x4_t U,
+    const float32x4_t V,
+    const float32x2_t cZ,
+    const float32x2_t c01,
+    float*            arrayP
+) {
+    const float32x4_t xyLo = vzip1q_f32( X, Y ); // x0 y0 x1 y1
+    const float32x4_t xyHi = vzip2q_f32( X, Y ); // x2 y2 x3 y3
+    const float32x4_t uvLo = vzip1q_f32( U, V );
+    const float32x4_t uvHi = vzip2q_f32( U, V );
+
+    vst1q_f32( arrayP,          vcombine_f32( vget_low_f32 ( xyLo ), cZ ) );
+    vst1q_f32( arrayP +      4, vcombine_f32( c01, vget_low_f32 ( uvLo ) ) );
+    vst1q_f32( arrayP + 32,     vcombine_f32( vget_high_f32( xyLo ), cZ ) );
+    vst1q_f32( arrayP + 32 + 4, vcombine_f32( c01, vget_high_f32( uvLo ) ) );
+    vst1q_f32( arrayP + 64,     vcombine_f32( vget_low_f32 ( xyHi ), cZ ) );
+    vst1q_f32( arrayP + 64 + 4, vcombine_f32( c01, vget_low_f32 ( uvHi ) ) );
+    vst1q_f32( arrayP + 96,     vcombine_f32( vget_high_f32( xyHi ), cZ ) );
+    vst1q_f32( arrayP + 96 + 4, vcombine_f32( c01, vget_high_f32( uvHi ) ) );
+}
+
+/** @brief 4 quads. There are no streaming stores in NEON. */
+static inline void expandQuads(
+
+    const Glyph* const* glyphs,
+    const Point2D*      origins,
+    const QuadParams&   p,
+    float*              arrayP,
+    const unsigned int  index,
+    unsigned int*       indexP,
+    const bool          streaming
+) {
+    const float32x4x2_t m01 = vtrnq_f32( vld1q_f32( &( glyphs[0]->mWidth ) ), vld1q_f32( &( glyphs[1]->mWidth ) ) );
+    const float32x4x2_t m23 = vtrnq_f32( vld1q_f32( &( glyphs[2]->mWidth ) ), vld1q_f32( &( glyphs[3]->mWidth ) ) );
+
+    const float32x4_t W  = vcombine_f32( vget_low_f32 ( m01.val[0] ), vget_low_f32 ( m23.val[0] ) );
+    const float32x4_t H  = vcombine_f32( vget_low_f32 ( m01.val[1] ), vget_low_f32 ( m23.val[1] ) );
+    const float32x4_t BX = vcombine_f32( vget_high_f32( m01.val[0] ), vget_high_f32( m23.val[0] ) );
+    const float32x4_t BY = vcombine_f32( vget_high_f32( m01.val[1] ), vget_high_f32( m23.val[1] ) );
+
+    const float32x4x2_t t01 = vtrnq_f32( vld1q_f32( &( glyphs[0]->mTextureCoordX ) ), vld1q_f32( &( glyphs[1]->mTextureCoordX ) ) );
+    const float32x4x2_t t23 = vtrnq_f32( vld1q_f32( &( glyphs[2]->mTextureCoordX ) ), vld1q_f32( &( glyphs[3]->mTextureCoordX ) ) );
+
+    const float32x4_t TX = vcombine_f32( vget_low_f32 ( t01.val[0] ), vget_low_f32 ( t23.val[0] ) );
+    const float32x4_t TY = vcombine_f32( vget_low_f32 ( t01.val[1] ), vget_low_f32 ( t23.val[1] ) );
+    const float32x4_t TW = vcombine_f32( vget_high_f32( t01.val[0] ), vget_high_f32( t23.val[0] ) );
+    const float32x4_t TH = vcombine_f32( vget_high_f32( t01.val[1] ), vget_high_f32( t23.val[1] ) );
+
+    const float32x4x2_t o = vld2q_f32( &( origins[0].mX ) );
+
+    const float32x4_t fontSize       = vdupq_n_f32( p.mFontSize       );
+    const float32x4_t spreadFont     = vdupq_n_f32( p.mSpreadFont     );
+    const float32x4_t spreadVertex2  = vdupq_n_f32( p.mSpreadVertex2  );
+    const float32x4_t spreadTexture  = vdupq_n_f32( p.mSpreadTexture  );
+    const float32x4_t spreadTexture2 = vdupq_n_f32( p.mSpreadTexture2 );
+
+    // vmulq and vaddq separately, as the scalar path, not fused.
+    const float32x4_t X0 = vsubq_f32( vaddq_f32( o.val[0], vmulq_f32( BX, fontSize ) ), spreadFont );
+    const float32x4_t Y0 = vsubq_f32( vaddq_f32( o.val[1], vmulq_f32( vsubq_f32( BY, H ), fontSize ) ), spreadFont );
+    const float32x4_t X1 = vaddq_f32( X0, vmulq_f32( vaddq_f32( W, spreadVertex2 ), fontSize ) );
+    const float32x4_t Y1 = vaddq_f32( Y0, vmulq_f32( vaddq_f32( H, spreadVertex2 ), fontSize ) );
+
+    const float chc[4] = { channelOffset( *glyphs[0] ), channelOffset( *glyphs[1] ),
+                           channelOffset( *glyphs[2] ), channelOffset( *glyphs[3] ) };
+
+    const float32x4_t CH = vld1q_f32( chc );
+
+    const float32x4_t S0 = vsubq_f32( TX, spreadTexture );
+    const float32x4_t V0 = vsubq_f32( TY, spreadTexture );
+    const float32x4_t S1 = vaddq_f32( S0, vaddq_f32( TW, spreadTexture2 ) );
+    const float32x4_t V1 = vaddq_f32( V0, vaddq_f32( TH, spreadTexture2 ) );
+    const float32x4_t U0 = vaddq_f32( S0, CH );
+    const float32x4_t U1 = vaddq_f32( S1, CH );
+
+    const float       zc[2]  = { p.mZ, 0.0f };
+    const float       oc[2]  = { 0.0f, 1.0f };
+    const float32x2_t cZ     = vld1_f32( zc );
+    const float32x2_t c01    = vld1_f32( oc );
+
+    storeCorner4( X0, Y0, U0, V0, cZ, c01, arrayP      );
+    storeCorner4( X1, Y0, U1, V0, cZ, c01, arrayP +  8 );
+    storeCorner4( X1, Y1, U1, V1, cZ, c01, arrayP + 16 );
+    storeCorner4( X0, Y1, U0, V1, cZ, c01, arrayP + 24 );
+
+    const uint32x4_t base = vdupq_n_u32( index );
+
+    for ( long k = 0; k < 6; k++ ) {
+
+        vst1q_u32( indexP + k * 4, vaddq_u32( base, vld1q_u32( QuadIndexOffsets + k * 4 ) ) );
+    }
+}
+
+#else
+
+static const size_t QuadsPerBatch = 1;
+
+static inline void expandQuads(
+
+    const Glyph* const* glyphs,
+    const Point2D*      origins,
+    const QuadParams&   p,
+    float*              arrayP,
+    const unsigned int  index,
+    unsigned int*       indexP,
+    const bool          streaming
+) {
+    expandQuad( *glyphs[0], origins[0], p, arrayP, index, indexP );
+}
+
+#endif
+
+
+void RuntimeHelper::generateOpenGLDrawElements (
+
+    const float                   fontSize,
+    const float                   spreadRatio,
+    const vector< const Glyph* >& glyphs,
+    const vector< Point2D >&      instanceOrigins,
+    const float                   Z,
+    float*                        arrayBuf,
+    const unsigned int            indexStart,
+    unsigned int*                 indices
+
+) const {
+
+    const QuadParams p( fontSize,
+                        spreadInFontMetrics() * spreadRatio,
+                        spreadInTexture()     * spreadRatio,
+                        Z                                    );
+
+    const size_t numGlyphs = glyphs.size();
+
+    const bool streaming =    numGlyphs >= StreamingMinGlyphs
+                           && ( reinterpret_cast< uintptr_t >( arrayBuf ) & 31 ) == 0;
+    size_t i = 0;
+
+    for ( ; i + QuadsPerBatch <= numGlyphs; i += QuadsPerBatch ) {
+
+        expandQuads( &( glyphs[i] ),
+                     &( instanceOrigins[i] ),
+                     p,
+                     arrayBuf + i * NUM_FLOATS_PER_GLYPH,
+                     indexStart + i * NUM_POINTS_PER_GLYPH,
+                     indices + i * NUM_INDICES_PER_GLYPH,
+                     streaming                              );
+    }
+
+    for ( ; i < numGlyphs; i++ ) {
+
+        expandQuad( *glyphs[i],
+                    instanceOrigins[i],
+                    p,
+                    arrayBuf + i * NUM_FLOATS_PER_GLYPH,
+                    indexStart + i * NUM_POINTS_PER_GLYPH,
+                    indices + i * NUM_INDICES_PER_GLYPH    );
+    }
+
+#if defined( __SSE2__ )
+    if ( streaming ) {
+
+        // The streaming stores are weakly ordered.
+        _mm_sfence();
+    }
+#endif
+}
+
+
 void RuntimeHelper::generateOpenGLDrawElementsForOneChar (
 
     const Glyph&       g,
@@ -453,13 +1660,16 @@ void RuntimeHelper::generateOpenGLDrawElementsForOneChar (
     float leftPos       = leftX - spreadInFont;
     float rightPos      = leftX + g.mWidth * fontSize + spreadInFont;
 
+    float leftU         = g.mTextureCoordX - spreadInTexture + channelOffset( g );
+    float rightU        = g.mTextureCoordX + g.mTextureWidth + spreadInTexture + channelOffset( g );
+
     arrayBuf[ 0]  = leftPos;
     arrayBuf[ 1]  = belowBaseline;
     arrayBuf[ 2]  = Z ;
     arrayBuf[ 3]  = 0.0;
     arrayBuf[ 4]  = 0.0;
     arrayBuf[ 5]  = 1.0;
-    arrayBuf[ 6]  = g.mTextureCoordX - spreadInTexture;
+    arrayBuf[ 6]  = leftU;
     arrayBuf[ 7]  = g.mTextureCoordY + g.mTextureHeight + spreadInTexture;
 
     arrayBuf[ 8]  = rightPos;
@@ -468,7 +1678,7 @@ void RuntimeHelper::generateOpenGLDrawElementsForOneChar (
     arrayBuf[11]  = 0.0;
     arrayBuf[12]  = 0.0;
     arrayBuf[13]  = 1.0;
-    arrayBuf[14]  = g.mTextureCoordX + g.mTextureWidth  + spreadInTexture;
+    arrayBuf[14]  = rightU;
     arrayBuf[15]  = g.mTextureCoordY + g.mTextureHeight + spreadInTexture;
 
     arrayBuf[16]  = rightPos;
@@ -477,7 +1687,7 @@ void RuntimeHelper::generateOpenGLDrawElementsForOneChar (
     arrayBuf[19]  = 0.0;
     arrayBuf[20]  = 0.0;
     arrayBuf[21]  = 1.0;
-    arrayBuf[22]  = g.mTextureCoordX + g.mTextureWidth + spreadInTexture;
+    arrayBuf[22]  = rightU;
     arrayBuf[23]  = g.mTextureCoordY - spreadInTexture;
 
     arrayBuf[24]  = leftPos;
@@ -486,7 +1696,7 @@ void RuntimeHelper::generateOpenGLDrawElementsForOneChar (
     arrayBuf[27]  = 0.0;
     arrayBuf[28]  = 0.0;
     arrayBuf[29]  = 1.0;
-    arrayBuf[30]  = g.mTextureCoordX - spreadInTexture;
+    arrayBuf[30]  = leftU;
     arrayBuf[31]  = g.mTextureCoordY - spreadInTexture;
 }
 
@@ -538,4 +1748,51 @@ void RuntimeHelper::generateOpenGLDrawElements (
 }
 
 
+
+void RuntimeHelper::generateOpenGLDrawElementsParallel (
+
+    const vector< const Glyph* >& glyphs,
+    const vector< float >&        posXs,
+    const float                   leftX,
+    const float                   baselineY,
+    const float                   fontSize,
+    const float                   spreadRatio,
+    const float                   distribution,
+    const float                   Z,
+    float*                        arrayBuf,
+    const unsigned int            indexStart,
+    unsigned int*                 indices,
+    const long                    numThreads
+
+) const {
+
+    const long   numChunks = numChunksFor( glyphs.size(), MinGlyphsPerChunk, numThreads );
+    const size_t numGlyphs = glyphs.size();
+
+    runChunks( numChunks, [ & ]( const long c ) {
+
+        const size_t end = numGlyphs * ( c + 1 ) / numChunks;
+
+        for ( size_t i = numGlyphs * c / numChunks; i < end; i++ ) {
+
+            if ( glyphs[i] != nullptr ) {
+
+                generateOpenGLDrawElementsForOneChar (
+
+                    *( glyphs[i] ),
+                    leftX + posXs[i] * distribution,
+                    baselineY,
+                    fontSize,
+                    spreadRatio,
+                    Z,
+                    &( arrayBuf[ i * NUM_FLOATS_PER_GLYPH ] ),
+                    indexStart + i * NUM_POINTS_PER_GLYPH,
+                    &( indices[ i * NUM_INDICES_PER_GLYPH ] )
+                );
+            }
+        }
+    } );
+}
+
+
 } // namespace SDFont
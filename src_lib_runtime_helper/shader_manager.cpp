@@ -1,12 +1,247 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
 #include <GL/glew.h>
 
 #include "sdfont/runtime_helper/shader_manager.hpp"
 
 namespace SDFont {
 
+string ShaderManager::mProgramBinaryCacheDir;
+
+static const uint32_t ProgramBinaryMagic   = 0x42504453; // "SDPB"
+static const uint32_t ProgramBinaryVersion = 1;
+
+/** @brief FNV-1a. Only for the file names, as the whole key is stored
+ *         in the file and compared.
+ */
+static uint64_t hashString( const string& s )
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    for ( const unsigned char c : s ) {
+
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static string toHex( const uint64_t v )
+{
+    ostringstream os;
+
+    os << hex << setw( 16 ) << setfill( '0' ) << v;
+
+    return os.str();
+}
+
+static string glString( const GLenum name )
+{
+    const auto* s = glGetString( name );
+
+    return ( s != nullptr ) ? string( reinterpret_cast< const char* >( s ) ) : string();
+}
+
+
+void ShaderManager::loadShadersFromStrings( string vertexStr, string fragmentStr )
+{
+    mOK = loadProgramFromStrings( vertexStr, fragmentStr, mProgramID, mLoadStats );
+}
+
+
+bool ShaderManager::loadProgramFromStrings(
+    const string&     vertexStr,
+    const string&     fragmentStr,
+    GLuint&           progID,
+    ProgramLoadStats& stats
+) {
+    const auto begin = chrono::steady_clock::now();
+
+    stats = ProgramLoadStats();
+
+    bool         ok = false;
+    string       key;
+    const string path = programBinaryPath( vertexStr, fragmentStr, key );
+
+    if ( !path.empty() && loadProgramBinary( path, key, progID ) ) {
+
+        ok               = true;
+        stats.mFromCache = true;
+    }
+    else {
+        ok = loadShaderPairFromStrings( vertexStr, fragmentStr, progID, !path.empty() );
+    }
+
+    const chrono::duration< double > elapsed = chrono::steady_clock::now() - begin;
+
+    stats.mSeconds = elapsed.count();
+
+    if ( ok && !path.empty() && !stats.mFromCache ) {
+
+        stats.mStoredToCache = storeProgramBinary( path, key, progID );
+    }
+
+    return ok;
+}
+
+
+string ShaderManager::programBinaryPath(
+    const string& vertexShaderCode,
+    const string& fragmentShaderCode,
+    string&       key
+) {
+    if ( mProgramBinaryCacheDir.empty() ) {
+
+        return "";
+    }
+
+#ifdef GLEW_ARB_get_program_binary
+    if ( !GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary ) {
+
+        return "";
+    }
+#endif
+
+    GLint numFormats = 0;
+    glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats );
+
+    if ( numFormats <= 0 ) {
+
+        return "";
+    }
+
+    key =   glString( GL_VENDOR   ) + "\n"
+          + glString( GL_RENDERER ) + "\n"
+          + glString( GL_VERSION  ) + "\n"
+          + toHex( hashString( vertexShaderCode   ) )
+          + toHex( hashString( fragmentShaderCode ) );
+
+    return mProgramBinaryCacheDir + "/sdfont_program_" + toHex( hashString( key ) ) + ".bin";
+}
+
+
+bool ShaderManager::loadProgramBinary( const string& path, const string& key, GLuint& progID )
+{
+    ifstream is( path, ios::binary );
+
+    if ( !is ) {
+
+        return false;
+    }
+
+    uint32_t magic, version, keyLength, format, length;
+
+    is.read( reinterpret_cast< char* >( &magic     ), sizeof( magic     ) );
+    is.read( reinterpret_cast< char* >( &version   ), sizeof( version   ) );
+    is.read( reinterpret_cast< char* >( &keyLength ), sizeof( keyLength ) );
+
+    if ( !is || magic != ProgramBinaryMagic || version != ProgramBinaryVersion || keyLength != key.size() ) {
+
+        return false;
+    }
+
+    string storedKey( keyLength, '\0' );
+
+    is.read( &storedKey[0], keyLength );
+    is.read( reinterpret_cast< char* >( &format ), sizeof( format ) );
+    is.read( reinterpret_cast< char* >( &length ), sizeof( length ) );
+
+    if ( !is || storedKey != key || length == 0 ) {
+
+        return false;
+    }
+
+    vector< char > binary( length );
+
+    is.read( binary.data(), length );
+
+    if ( !is ) {
+
+        return false;
+    }
+
+    progID = glCreateProgram();
+
+    glProgramBinary( progID, format, binary.data(), length );
+
+    GLint res = GL_FALSE;
+    glGetProgramiv( progID, GL_LINK_STATUS, &res );
+
+    if ( res == GL_FALSE ) {
+
+        // Rejected by the driver. Compiled and stored again.
+        glDeleteProgram( progID );
+        progID = 0;
+        return false;
+    }
+
+    return true;
+}
+
+
+bool ShaderManager::storeProgramBinary( const string& path, const string& key, GLuint progID )
+{
+    GLint length = 0;
+    glGetProgramiv( progID, GL_PROGRAM_BINARY_LENGTH, &length );
+
+    if ( length <= 0 ) {
+
+        return false;
+    }
+
+    vector< char > binary( length );
+    GLenum         format  = 0;
+    GLsizei        written = 0;
+
+    glGetProgramBinary( progID, length, &written, &format, binary.data() );
+
+    if ( written <= 0 ) {
+
+        return false;
+    }
+
+    // Renamed at the end, so that the other processes do not see a
+    // partially written file.
+    const string tmpPath = path + ".tmp";
+
+    {
+        ofstream os( tmpPath, ios::binary | ios::trunc );
+
+        if ( !os ) {
+
+            cerr << "failed to open:[" << tmpPath << "]\n";
+            return false;
+        }
+
+        const uint32_t keyLength    = key.size();
+        const uint32_t binaryFormat = format;
+        const uint32_t binaryLength = written;
+
+        os.write( reinterpret_cast< const char* >( &ProgramBinaryMagic   ), sizeof( uint32_t ) );
+        os.write( reinterpret_cast< const char* >( &ProgramBinaryVersion ), sizeof( uint32_t ) );
+        os.write( reinterpret_cast< const char* >( &keyLength            ), sizeof( uint32_t ) );
+        os.write( key.data(), keyLength );
+        os.write( reinterpret_cast< const char* >( &binaryFormat         ), sizeof( uint32_t ) );
+        os.write( reinterpret_cast< const char* >( &binaryLength         ), sizeof( uint32_t ) );
+        os.write( binary.data(), binaryLength );
+
+        if ( !os ) {
+
+            os.close();
+            remove( tmpPath.c_str() );
+            return false;
+        }
+    }
+
+    return rename( tmpPath.c_str(), path.c_str() ) == 0;
+}
+
 
 string ShaderManager::fileToString( string path )
 {
@@ -103,7 +338,8 @@ bool ShaderManager::link( GLuint prog, GLuint vertex, GLuint fragment )
 bool ShaderManager::loadShaderPairFromStrings (
     string  vertexShaderCode,
     string  fragmentShaderCode,
-    GLuint& progID
+    GLuint& progID,
+    bool    retrievable
 ) {
     if ( vertexShaderCode == "" || fragmentShaderCode == "" ) {
         return false;
@@ -127,6 +363,12 @@ bool ShaderManager::loadShaderPairFromStrings (
     }
 
     progID = glCreateProgram();
+
+    if ( retrievable ) {
+
+        glProgramParameteri( progID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+    }
+
     if ( !link( progID, vertexShaderID, fragmentShaderID ) ) {
 
         glDeleteShader( vertexShaderID   );
@@ -141,17 +383,6 @@ bool ShaderManager::loadShaderPairFromStrings (
     return true;
 }
 
-bool ShaderManager::loadShaderPair (
-    string  vertexPath,
-    string  fragmentPath,
-    GLuint& progID
-) {
-    string vertexShaderCode   = fileToString( vertexPath   ) ;
-    string fragmentShaderCode = fileToString( fragmentPath ) ;
-
-    return loadShaderPairFromStrings( vertexShaderCode, fragmentShaderCode, progID );
-}
-
 void ShaderManager::unloadShaderPair( GLuint progID )
 {
     glDeleteProgram( progID );
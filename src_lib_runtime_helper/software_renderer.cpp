@@ -0,0 +1,516 @@
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#elif defined( __ARM_NEON ) && defined( __aarch64__ )
+#include <arm_neon.h>
+#endif
+
+#include "sdfont/runtime_helper/software_renderer.hpp"
+
+namespace SDFont {
+
+namespace {
+
+// 4 floats shaded at a time, with the same operations as the shader.
+#if defined( __SSE2__ )
+
+struct F4 { __m128 v; };
+struct M4 { __m128 v; };
+
+inline F4 splat ( const float f )       { return { _mm_set1_ps( f ) }; }
+inline F4 load  ( const float* p )      { return { _mm_loadu_ps( p ) }; }
+inline void store( float* p, F4 a )     { _mm_storeu_ps( p, a.v ); }
+inline F4 operator + ( F4 a, F4 b )     { return { _mm_add_ps( a.v, b.v ) }; }
+inline F4 operator - ( F4 a, F4 b )     { return { _mm_sub_ps( a.v, b.v ) }; }
+inline F4 operator * ( F4 a, F4 b )     { return { _mm_mul_ps( a.v, b.v ) }; }
+inline F4 operator / ( F4 a, F4 b )     { return { _mm_div_ps( a.v, b.v ) }; }
+inline F4 vmin  ( F4 a, F4 b )          { return { _mm_min_ps( a.v, b.v ) }; }
+inline F4 vmax  ( F4 a, F4 b )          { return { _mm_max_ps( a.v, b.v ) }; }
+inline M4 ge    ( F4 a, F4 b )          { return { _mm_cmpge_ps( a.v, b.v ) }; }
+inline M4 le    ( F4 a, F4 b )          { return { _mm_cmple_ps( a.v, b.v ) }; }
+inline M4 lt    ( F4 a, F4 b )          { return { _mm_cmplt_ps( a.v, b.v ) }; }
+inline M4 operator & ( M4 a, M4 b )     { return { _mm_and_ps( a.v, b.v ) }; }
+inline M4 noMask()                      { return { _mm_setzero_ps() }; }
+inline F4 select( M4 m, F4 a, F4 b )    { return { _mm_or_ps( _mm_and_ps( m.v, a.v ), _mm_andnot_ps( m.v, b.v ) ) }; }
+inline int bits ( M4 m )                { return _mm_movemask_ps( m.v ); }
+
+// 4 bytes, e.g., a pixel in RGBA, from and to the lanes.
+inline F4 loadBytes( const uint8_t* p )
+{
+    int32_t word;
+    std::memcpy( &word, p, 4 );
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i b    = _mm_cvtsi32_si128( word );
+
+    return { _mm_cvtepi32_ps( _mm_unpacklo_epi16( _mm_unpacklo_epi8( b, zero ), zero ) ) };
+}
+
+inline void storeBytes( uint8_t* p, F4 a )
+{
+    // Non-negative, and rounded by the truncation.
+    const __m128i i = _mm_cvttps_epi32( _mm_add_ps( _mm_max_ps( a.v, _mm_setzero_ps() ), _mm_set1_ps( 0.5f ) ) );
+    const __m128i w = _mm_packs_epi32( i, i );
+
+    const int32_t word = _mm_cvtsi128_si32( _mm_packus_epi16( w, w ) );
+    std::memcpy( p, &word, 4 );
+}
+
+inline F4 vfloor( F4 a )
+{
+    // SSE2 has only the truncation.
+    const __m128 t = _mm_cvtepi32_ps( _mm_cvttps_epi32( a.v ) );
+    return { _mm_sub_ps( t, _mm_and_ps( _mm_cmpgt_ps( t, a.v ), _mm_set1_ps( 1.0f ) ) ) };
+}
+
+#elif defined( __ARM_NEON ) && defined( __aarch64__ )
+
+struct F4 { float32x4_t v; };
+struct M4 { uint32x4_t  v; };
+
+inline F4 splat ( const float f )       { return { vdupq_n_f32( f ) }; }
+inline F4 load  ( const float* p )      { return { vld1q_f32( p ) }; }
+inline void store( float* p, F4 a )     { vst1q_f32( p, a.v ); }
+inline F4 operator + ( F4 a, F4 b )     { return { vaddq_f32( a.v, b.v ) }; }
+inline F4 operator - ( F4 a, F4 b )     { return { vsubq_f32( a.v, b.v ) }; }
+inline F4 operator * ( F4 a, F4 b )     { return { vmulq_f32( a.v, b.v ) }; }
+inline F4 operator / ( F4 a, F4 b )     { return { vdivq_f32( a.v, b.v ) }; }
+inline F4 vmin  ( F4 a, F4 b )          { return { vminq_f32( a.v, b.v ) }; }
+inline F4 vmax  ( F4 a, F4 b )          { return { vmaxq_f32( a.v, b.v ) }; }
+inline M4 ge    ( F4 a, F4 b )          { return { vcgeq_f32( a.v, b.v ) }; }
+inline M4 le    ( F4 a, F4 b )          { return { vcleq_f32( a.v, b.v ) }; }
+inline M4 lt    ( F4 a, F4 b )          { return { vcltq_f32( a.v, b.v ) }; }
+inline M4 operator & ( M4 a, M4 b )     { return { vandq_u32( a.v, b.v ) }; }
+inline M4 noMask()                      { return { vdupq_n_u32( 0 ) }; }
+inline F4 select( M4 m, F4 a, F4 b )    { return { vbslq_f32( m.v, a.v, b.v ) }; }
+inline F4 vfloor( F4 a )                { return { vrndmq_f32( a.v ) }; }
+
+inline F4 loadBytes( const uint8_t* p )
+{
+    uint32_t word;
+    std::memcpy( &word, p, 4 );
+
+    const uint8x8_t b = vreinterpret_u8_u32( vdup_n_u32( word ) );
+
+    return { vcvtq_f32_u32( vmovl_u16( vget_low_u16( vmovl_u8( b ) ) ) ) };
+}
+
+inline void storeBytes( uint8_t* p, F4 a )
+{
+    const uint32x4_t i = vcvtq_u32_f32( vaddq_f32( vmaxq_f32( a.v, vdupq_n_f32( 0.0f ) ), vdupq_n_f32( 0.5f ) ) );
+    const uint16x4_t w = vqmovn_u32( i );
+    const uint8x8_t  b = vqmovn_u16( vcombine_u16( w, w ) );
+
+    vst1_lane_u32( reinterpret_cast< uint32_t* >( p ), vreinterpret_u32_u8( b ), 0 );
+}
+
+inline int bits( M4 m )
+{
+    return   ( vgetq_lane_u32( m.v, 0 ) & 1 )        | ( ( vgetq_lane_u32( m.v, 1 ) & 1 ) << 1 )
+           | ( ( vgetq_lane_u32( m.v, 2 ) & 1 ) << 2 ) | ( ( vgetq_lane_u32( m.v, 3 ) & 1 ) << 3 );
+}
+
+#else
+
+struct F4 { float v[4]; };
+struct M4 { bool  v[4]; };
+
+#define SDFONT_F4_LANES( expr ) for ( int i = 0; i < 4; i++ ) { expr; }
+
+inline F4 splat ( const float f )       { F4 r; SDFONT_F4_LANES( r.v[i] = f ); return r; }
+inline F4 load  ( const float* p )      { F4 r; SDFONT_F4_LANES( r.v[i] = p[i] ); return r; }
+inline void store( float* p, F4 a )     { SDFONT_F4_LANES( p[i] = a.v[i] ); }
+inline F4 operator + ( F4 a, F4 b )     { F4 r; SDFONT_F4_LANES( r.v[i] = a.v[i] + b.v[i] ); return r; }
+inline F4 operator - ( F4 a, F4 b )     { F4 r; SDFONT_F4_LANES( r.v[i] = a.v[i] - b.v[i] ); return r; }
+inline F4 operator * ( F4 a, F4 b )     { F4 r; SDFONT_F4_LANES( r.v[i] = a.v[i] * b.v[i] ); return r; }
+inline F4 operator / ( F4 a, F4 b )     { F4 r; SDFONT_F4_LANES( r.v[i] = a.v[i] / b.v[i] ); return r; }
+inline F4 vmin  ( F4 a, F4 b )          { F4 r; SDFONT_F4_LANES( r.v[i] = std::min( a.v[i], b.v[i] ) ); return r; }
+inline F4 vmax  ( F4 a, F4 b )          { F4 r; SDFONT_F4_LANES( r.v[i] = std::max( a.v[i], b.v[i] ) ); return r; }
+inline M4 ge    ( F4 a, F4 b )          { M4 r; SDFONT_F4_LANES( r.v[i] = a.v[i] >= b.v[i] ); return r; }
+inline M4 le    ( F4 a, F4 b )          { M4 r; SDFONT_F4_LANES( r.v[i] = a.v[i] <= b.v[i] ); return r; }
+inline M4 lt    ( F4 a, F4 b )          { M4 r; SDFONT_F4_LANES( r.v[i] = a.v[i] <  b.v[i] ); return r; }
+inline M4 operator & ( M4 a, M4 b )     { M4 r; SDFONT_F4_LANES( r.v[i] = a.v[i] && b.v[i] ); return r; }
+inline M4 noMask()                      { M4 r; SDFONT_F4_LANES( r.v[i] = false ); return r; }
+inline F4 select( M4 m, F4 a, F4 b )    { F4 r; SDFONT_F4_LANES( r.v[i] = m.v[i] ? a.v[i] : b.v[i] ); return r; }
+inline F4 vfloor( F4 a )                { F4 r; SDFONT_F4_LANES( r.v[i] = floorf( a.v[i] ) ); return r; }
+inline int bits ( M4 m )                { int r = 0; SDFONT_F4_LANES( r |= ( m.v[i] ? 1 : 0 ) << i ); return r; }
+inline F4 loadBytes( const uint8_t* p ) { F4 r; SDFONT_F4_LANES( r.v[i] = p[i] ); return r; }
+
+inline void storeBytes( uint8_t* p, F4 a )
+{
+    SDFONT_F4_LANES( p[i] = (uint8_t)std::min( 255.0f, std::max( 0.0f, a.v[i] ) + 0.5f ) );
+}
+
+#undef SDFONT_F4_LANES
+
+#endif
+
+inline F4 clamp01( F4 x ) { return vmin( vmax( x, splat( 0.0f ) ), splat( 1.0f ) ); }
+
+inline F4 smoothstep( const float edge0, const float edge1, F4 x )
+{
+    const F4 t = clamp01( ( x - splat( edge0 ) ) / splat( edge1 - edge0 ) );
+
+    return t * t * ( splat( 3.0f ) - splat( 2.0f ) * t );
+}
+
+inline F4 median( F4 r, F4 g, F4 b )
+{
+    return vmax( vmin( r, g ), vmin( vmax( r, g ), b ) );
+}
+
+
+} // namespace
+
+
+const long SoftwareRenderer::TileHeight = 16;
+
+
+SoftwareRenderer::SoftwareRenderer(
+    const uint8_t* texture,
+    const long     textureSize,
+    const int      numChannels,
+    const long     numThreads
+):
+    mTexture     ( texture     ),
+    mTextureSize ( textureSize ),
+    mNumChannels ( numChannels ),
+    mNumThreads  ( ( numThreads > 0 ) ? numThreads : std::max( 1L, (long)thread::hardware_concurrency() ) )
+    {;}
+
+
+SoftwareRenderer::SoftwareRenderer( const FontAtlas& atlas, const long numThreads ):
+    SoftwareRenderer( atlas.pixels(), atlas.textureSize(), atlas.numChannels(), numThreads )
+    {;}
+
+
+SoftwareRenderer::~SoftwareRenderer() {;}
+
+
+long SoftwareRenderer::wrap( const long i ) const
+{
+    // The texels are mostly in the texture or next to its sides.
+    if ( 0 <= i && i < mTextureSize ) {
+
+        return i;
+    }
+    if ( -mTextureSize <= i && i < 0 ) {
+
+        return i + mTextureSize;
+    }
+
+    const long r = i % mTextureSize;
+
+    return ( r < 0 ) ? r + mTextureSize : r;
+}
+
+
+bool SoftwareRenderer::draw(
+    const vector< GlyphBound >& bounds,
+    const int                   effect,
+    const float                 lowThreshold,
+    const float                 highThreshold,
+    const float                 smoothing,
+    const float                 baseColor[3],
+    const float                 borderColor[3],
+    uint8_t*                    rgba,
+    const long                  width,
+    const long                  height,
+    const long                  rowBytes
+) const {
+
+    if (    mTexture == nullptr || mTextureSize <= 0
+         || ( mNumChannels != 1 && mNumChannels != 3 && mNumChannels != 4 ) ) {
+
+        return false;
+    }
+
+    Shading shading;
+
+    shading.mEffect        = effect;
+    shading.mLowThreshold  = lowThreshold;
+    shading.mHighThreshold = highThreshold;
+    shading.mSmoothing     = smoothing;
+
+    for ( int c = 0; c < 3; c++ ) {
+
+        shading.mBaseColor  [c] = baseColor  [c];
+        shading.mBorderColor[c] = borderColor[c];
+    }
+
+    const long stride   = ( rowBytes > 0 ) ? rowBytes : width * 4;
+    const long numTiles = ( height + TileHeight - 1 ) / TileHeight;
+
+    // The bounds are binned to the tiles they overlap in the order of
+    // drawing, so that the overlapping glyphs are blended in order.
+    vector< vector< long > > bins( numTiles );
+
+    for ( long i = 0; i < (long)bounds.size(); i++ ) {
+
+        const auto& f = bounds[i].mFrame;
+
+        // Rows of the pixel centers in [ mY, mY + mH ), from the top.
+        const long rowFirst = std::max( 0L,         (long)ceilf( height - 0.5f - ( f.mY + f.mH ) + 1e-6f ) );
+        const long rowLast  = std::min( height - 1, (long)floorf( height - 0.5f - f.mY ) );
+
+        if ( rowFirst > rowLast || f.mW <= 0.0f || f.mH <= 0.0f ) {
+
+            continue;
+        }
+
+        for ( long t = rowFirst / TileHeight; t <= rowLast / TileHeight; t++ ) {
+
+            bins[t].push_back( i );
+        }
+    }
+
+    auto drawTiles = [ & ]( atomic< long >& nextTile ) {
+
+        while ( true ) {
+
+            const long t = nextTile.fetch_add( 1 );
+
+            if ( t >= numTiles ) {
+
+                break;
+            }
+
+            if ( !bins[t].empty() ) {
+
+                drawTile( bounds, bins[t], shading, rgba, width, height, stride,
+                          t * TileHeight, std::min( height, ( t + 1 ) * TileHeight ) );
+            }
+        }
+    };
+
+    atomic< long > nextTile( 0 );
+
+    const long numThreads = std::min( mNumThreads, numTiles );
+
+    if ( numThreads <= 1 ) {
+
+        drawTiles( nextTile );
+        return true;
+    }
+
+    vector< thread > threads;
+
+    for ( long i = 0; i < numThreads; i++ ) {
+
+        threads.emplace_back( drawTiles, std::ref( nextTile ) );
+    }
+
+    for ( auto& t : threads ) {
+
+        t.join();
+    }
+
+    return true;
+}
+
+
+void SoftwareRenderer::drawTile(
+    const vector< GlyphBound >& bounds,
+    const vector< long >&       boundIndices,
+    const Shading&              shading,
+    uint8_t*                    rgba,
+    const long                  width,
+    const long                  height,
+    const long                  rowBytes,
+    const long                  rowBegin,
+    const long                  rowEnd
+) const {
+
+    for ( const auto i : boundIndices ) {
+
+        const auto& b = bounds[i];
+        const auto& f = b.mFrame;
+
+        // Pixel centers in [ mX, mX + mW ).
+        const long pxBegin = std::max( 0L,    (long)ceilf( f.mX - 0.5f ) );
+        const long pxEnd   = std::min( width, (long)ceilf( f.mX + f.mW - 0.5f ) );
+
+        if ( pxBegin >= pxEnd ) {
+
+            continue;
+        }
+
+        for ( long row = rowBegin; row < rowEnd; row++ ) {
+
+            const float cy = (float)( height - row ) - 0.5f;
+
+            if ( cy < f.mY || f.mY + f.mH <= cy ) {
+
+                continue;
+            }
+
+            drawSpan( b, shading, rgba + rowBytes * row, cy, pxBegin, pxEnd );
+        }
+    }
+}
+
+
+void SoftwareRenderer::drawSpan(
+    const GlyphBound& b,
+    const Shading&    shading,
+    uint8_t*          row,
+    const float       cy,
+    const long        pxBegin,
+    const long        pxEnd
+) const {
+
+    const float N   = (float)mTextureSize;
+    const long  ch  = mNumChannels;
+
+    // A glyph of the packed texture is sampled only in its channel.
+    const long  firstChannel = ( ch == 4 ) ? b.mTextureChannel : 0;
+    const long  numSampled   = ( ch == 4 ) ? 1 : ch;
+
+    // The texture coordinates are linear in the frame, as the quad is
+    // parallel to the image.
+    const float du  = b.mTexture.mW / b.mFrame.mW;
+    const float v   = b.mTexture.mY + ( cy - b.mFrame.mY ) * ( b.mTexture.mH / b.mFrame.mH );
+
+    const float ty  = v * N - 0.5f;
+    const float ty0 = floorf( ty );
+    const F4    fy  = splat( ty - ty0 );
+
+    const uint8_t* texRow0 = mTexture + wrap( (long)ty0     ) * mTextureSize * ch;
+    const uint8_t* texRow1 = mTexture + wrap( (long)ty0 + 1 ) * mTextureSize * ch;
+
+    const float offsets[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+
+    const F4 laneOffsets = load( offsets );
+    const F4 inv255      = splat( 1.0f / 255.0f );
+
+    // Premultiplied colors in [0, 255] with the alpha.
+    const float baseColor  [4] = { shading.mBaseColor  [0] * 255.0f, shading.mBaseColor  [1] * 255.0f, shading.mBaseColor  [2] * 255.0f, 255.0f };
+    const float borderColor[4] = { shading.mBorderColor[0] * 255.0f, shading.mBorderColor[1] * 255.0f, shading.mBorderColor[2] * 255.0f, 255.0f };
+
+    const F4 base   = load( baseColor   );
+    const F4 border = load( borderColor );
+
+    const float low  = shading.mLowThreshold;
+    const float high = shading.mHighThreshold;
+    const float s    = shading.mSmoothing;
+
+    for ( long px = pxBegin; px < pxEnd; px += 4 ) {
+
+        const F4 cx = splat( (float)px ) + laneOffsets;
+        const F4 u  = splat( b.mTexture.mX ) + ( cx - splat( b.mFrame.mX ) ) * splat( du );
+        const F4 tx = u * splat( N ) - splat( 0.5f );
+        const F4 x0 = vfloor( tx );
+        const F4 fx = tx - x0;
+
+        float x0s[4];
+        store( x0s, x0 );
+
+        long offset0[4];
+        long offset1[4];
+
+        for ( int i = 0; i < 4; i++ ) {
+
+            const long x = wrap( (long)x0s[i] );
+
+            offset0[i] = x * ch;
+            offset1[i] = ( ( x + 1 == mTextureSize ) ? 0 : x + 1 ) * ch;
+        }
+
+        // Bilinear interpolation per channel.
+        F4 dist[3];
+
+        for ( long c = 0; c < numSampled; c++ ) {
+
+            float s00[4], s10[4], s01[4], s11[4];
+
+            for ( int i = 0; i < 4; i++ ) {
+
+                s00[i] = texRow0[ offset0[i] + firstChannel + c ];
+                s10[i] = texRow0[ offset1[i] + firstChannel + c ];
+                s01[i] = texRow1[ offset0[i] + firstChannel + c ];
+                s11[i] = texRow1[ offset1[i] + firstChannel + c ];
+            }
+
+            const F4 bottom = load( s00 ) + ( load( s10 ) - load( s00 ) ) * fx;
+            const F4 top    = load( s01 ) + ( load( s11 ) - load( s01 ) ) * fx;
+
+            dist[c] = ( bottom + ( top - bottom ) * fy ) * inv255;
+        }
+
+        const F4 d = ( ch == 3 ) ? median( dist[0], dist[1], dist[2] ) : dist[0];
+
+        F4 alpha;
+        M4 useBorder = noMask();
+
+        switch ( shading.mEffect ) {
+
+          case 0:
+            alpha = d;
+            break;
+
+          case 1:
+            alpha = smoothstep( low - s, high + s, d );
+            break;
+
+          case 2:
+            alpha = select( ge( d, splat( low ) ), splat( 1.0f ), splat( 0.0f ) );
+            break;
+
+          case 3:
+          {
+            const M4 inside = ge( d, splat( low ) );
+
+            alpha     = select( inside, splat( 1.0f ), d );
+            useBorder = lt( d, splat( low ) );
+            break;
+          }
+
+          case 4:
+          {
+            const M4 border = ge( d, splat( low ) ) & le( d, splat( high ) );
+
+            alpha     = select( border, splat( 1.0f ), select( ge( d, splat( high ) ), splat( 1.0f ), splat( 0.0f ) ) );
+            useBorder = border;
+            break;
+          }
+
+          case 5:
+            alpha = select( lt( d, splat( 0.5f ) ),
+                            smoothstep( 0.5f - s, 0.5f + s, d ),
+                            splat( 0.5f ) - smoothstep( 0.5f - s, 0.5f + s, d * splat( 0.75f ) ) );
+            break;
+
+          default:
+            alpha = splat( 1.0f );
+        }
+
+        // The output of the shader is clamped for the 8-bit image.
+        float alphas[4];
+        store( alphas, clamp01( alpha ) );
+
+        const int  borderBits = bits( useBorder );
+        const long numPixels  = std::min( 4L, pxEnd - px );
+
+        for ( long i = 0; i < numPixels; i++ ) {
+
+            const float a = alphas[i];
+
+            if ( a <= 0.0f ) {
+
+                continue;
+            }
+
+            const F4 color = ( ( borderBits >> i ) & 1 ) ? border : base;
+            uint8_t* dst   = row + ( px + i ) * 4;
+
+            storeBytes( dst, vmin( color * splat( a ) + loadBytes( dst ) * splat( 1.0f - a ), splat( 255.0f ) ) );
+        }
+    }
+}
+
+} // namespace SDFont
@@ -7,12 +7,13 @@
 
 namespace SDFont {
 
-TextureLoader::TextureLoader ( GLubyte* pixMap, int width ):
+TextureLoader::TextureLoader ( GLubyte* pixMap, int width, int numChannels ):
 
     mOk             ( false  ),
     mPixMap         ( pixMap ),
     mPixMapAllocated( false  ),
-    mWidth          ( width  )
+    mWidth          ( width  ),
+    mNumChannels    ( numChannels )
 
 {
     mOk = true;
@@ -20,6 +21,49 @@ TextureLoader::TextureLoader ( GLubyte* pixMap, int width ):
 }
 
 
+TextureLoader::TextureLoader ( const FontAtlas& atlas ):
+
+    mOk             ( false ),
+    mPixMap         ( const_cast< GLubyte* >( atlas.pixels() ) ),
+    mPixMapAllocated( false ),
+    mWidth          ( (unsigned long)atlas.textureSize() ),
+    mNumChannels    ( atlas.numChannels() ),
+    mGLtexture      ( 0 )
+
+{
+    mOk = !atlas.empty();
+
+    if ( mOk ) {
+
+        generateOpenGLTexture();
+    }
+
+    // Not kept, as the atlas can release the texture after this.
+    mPixMap = nullptr;
+}
+
+
+TextureLoader::TextureLoader ( const EmbeddedFont& font ):
+
+    mOk             ( false ),
+    mPixMap         ( const_cast< GLubyte* >( font.mPixels ) ),
+    mPixMapAllocated( false ),
+    mWidth          ( (unsigned long)font.mTextureSize ),
+    mNumChannels    ( font.mNumChannels ),
+    mGLtexture      ( 0 )
+
+{
+    mOk = ( font.mPixels != nullptr && font.mTextureSize > 0 );
+
+    if ( mOk ) {
+
+        generateOpenGLTexture();
+    }
+
+    mPixMap = nullptr;
+}
+
+
 TextureLoader::~TextureLoader ()
 {
     if ( mPixMapAllocated && mPixMap != nullptr ) {
@@ -35,13 +79,16 @@ void TextureLoader::generateOpenGLTexture()
 
     glBindTexture( GL_TEXTURE_2D, mGLtexture );
 
+    // The rows of the RGB pixmap are not necessarily aligned to 4 bytes.
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
     glTexImage2D( GL_TEXTURE_2D,
                   0,
-                  GL_R8,
+                  internalFormat( mNumChannels ),
                   mWidth,
                   mWidth,
                   0,
-                  GL_RED,
+                  pixelFormat( mNumChannels ),
                   GL_UNSIGNED_BYTE,
                   mPixMap            );
 
@@ -52,18 +99,168 @@ void TextureLoader::generateOpenGLTexture()
 }
 
 
+GLint TextureLoader::internalFormat( const int numChannels )
+{
+    switch ( numChannels ) {
+
+      case 3:
+        return GL_RGB8;
+
+      case 4:
+        return GL_RGBA8;
+
+      default:
+        return GL_R8;
+    }
+}
+
+
+GLenum TextureLoader::pixelFormat( const int numChannels )
+{
+    switch ( numChannels ) {
+
+      case 3:
+        return GL_RGB;
+
+      case 4:
+        return GL_RGBA;
+
+      default:
+        return GL_RED;
+    }
+}
+
+
 TextureLoader::TextureLoader( string filePath ):
     mOk             ( false   ),
     mPixMap         ( nullptr ),
     mPixMapAllocated( true    ),
-    mWidth          ( 0       )
+    mWidth          ( 0       ),
+    mNumChannels    ( 1       )
 {
-    mOk = loadPngImage( filePath, mWidth, &mPixMap );
+    static const string extKTX2 = ".ktx2";
+
+    if (    filePath.size() > extKTX2.size()
+         && filePath.compare( filePath.size() - extKTX2.size(), extKTX2.size(), extKTX2 ) == 0 ) {
+
+        KTX2Container ktx2;
+
+        mOk = ktx2.readFromFile( filePath ) && ktx2.width() == ktx2.height();
+
+        if (mOk) {
+
+            mWidth = ktx2.width();
+            generateOpenGLTextureFromKTX2( ktx2 );
+        }
+        else {
+            cerr << "Can not load [" << filePath << "]\n";
+        }
+        return;
+    }
+
+    // The image is decoded directly into a pixel unpack buffer, from which
+    // the driver copies it into the texture. It falls back to the pixmap
+    // in the main memory if the buffer can not be mapped.
+    GLuint pixelBuffer = 0;
+
+    glGenBuffers( 1, &pixelBuffer );
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, pixelBuffer );
+
+    bool mapped = false;
+
+    auto allocate = [ this, &mapped ]( unsigned long, unsigned long height, size_t rowBytes ) {
+
+        const GLsizeiptr size = rowBytes * height;
+
+        glBufferData( GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW );
+
+        auto* ptr = (GLubyte*) glMapBufferRange(
+                                   GL_PIXEL_UNPACK_BUFFER,
+                                   0,
+                                   size,
+                                   GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
+                               );
+        if ( ptr != nullptr ) {
+
+            mapped = true;
+            return ptr;
+        }
+
+        glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+
+        mPixMap = (GLubyte*) malloc( size );
+        return mPixMap;
+    };
+
+    mOk = loadPngImage( filePath, mWidth, mNumChannels, allocate );
+
+    if ( mapped ) {
+
+        // The contents can be lost while mapped, e.g., on a mode switch.
+        mOk = ( glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER ) == GL_TRUE ) && mOk;
+    }
 
     if (mOk) {
 
+        // With the buffer bound, mPixMap (nullptr) is the offset into it.
         generateOpenGLTexture();
     }
+
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+    glDeleteBuffers( 1, &pixelBuffer );
+}
+
+
+void TextureLoader::generateOpenGLTextureFromKTX2( const KTX2Container& ktx2 )
+{
+    glGenTextures( 1, &mGLtexture );
+
+    glBindTexture( GL_TEXTURE_2D, mGLtexture );
+
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+    // The levels are stored bottom row first, as OpenGL expects,
+    // and go to the driver without any conversion.
+    for ( size_t i = 0; i < ktx2.numLevels(); i++ ) {
+
+        const auto& level = ktx2.level( i );
+
+        if ( ktx2.isBlockCompressed() ) {
+
+            const GLenum format = ( ktx2.vkFormat() == KTX2Container::VK_FORMAT_BC4_UNORM_BLOCK )
+                                  ? GL_COMPRESSED_RED_RGTC1
+                                  : GL_COMPRESSED_R11_EAC ;
+
+            glCompressedTexImage2D( GL_TEXTURE_2D,
+                                    i,
+                                    format,
+                                    ktx2.levelWidth ( i ),
+                                    ktx2.levelHeight( i ),
+                                    0,
+                                    level.size(),
+                                    level.data()           );
+        }
+        else {
+            glTexImage2D( GL_TEXTURE_2D,
+                          i,
+                          GL_R8,
+                          ktx2.levelWidth ( i ),
+                          ktx2.levelHeight( i ),
+                          0,
+                          GL_RED,
+                          GL_UNSIGNED_BYTE,
+                          level.data()           );
+        }
+    }
+
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0 );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,  ktx2.numLevels() - 1 );
+
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_REPEAT  );
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_REPEAT  );
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR  );
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                     ( ktx2.numLevels() > 1 ) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR );
 }
 
 
@@ -98,7 +295,9 @@ bool TextureLoader::checkPNG(
     }
 
 
-    if ( color != PNG_COLOR_TYPE_GRAY ) {
+    if (    color != PNG_COLOR_TYPE_GRAY
+         && color != PNG_COLOR_TYPE_RGB
+         && color != PNG_COLOR_TYPE_RGBA ) {
 
         return false;
     }
@@ -122,6 +321,8 @@ bool TextureLoader::checkPNG(
  *
  *  @param width     (out): from png_get_IHDR(). upto 2^31
  *
+ *  @param numChannels (out): 1 for GRAY, 3 for RGB, 4 for RGBA.
+ *
  *  @param data      (out): the pixmap data loaded
  *
  *  @reference https://gist.github.com/mortennobel/5299151
@@ -130,8 +331,38 @@ bool TextureLoader::loadPngImage(
 
     string         filePath,
     unsigned long& width,
+    int&           numChannels,
     GLubyte**      data
 
+) {
+    (*data) = nullptr;
+
+    auto allocate = [ data ]( unsigned long, unsigned long height, size_t rowBytes ) {
+
+        (*data) = (GLubyte*) malloc( rowBytes * height );
+        return (*data);
+    };
+
+    const bool valid = loadPngImage( filePath, width, numChannels, allocate );
+
+    if ( !valid && (*data) != nullptr ) {
+
+        free( *data );
+        *data = nullptr;
+    }
+
+    return valid;
+}
+
+
+bool TextureLoader::loadPngImage(
+
+    string                      filePath,
+    unsigned long&              width,
+    int&                        numChannels,
+    const DestinationAllocator& allocate,
+    const RowCallback&          rowDecoded
+
 ) {
 
     FILE* fp = fopen( filePath.c_str(), "rb" );
@@ -181,16 +412,17 @@ bool TextureLoader::loadPngImage(
 
     png_set_sig_bytes( pngStruct, sigRead );
 
-    png_read_png (
+    png_read_info( pngStruct, pngInfo );
 
-        pngStruct,
-        pngInfo,
-        PNG_TRANSFORM_STRIP_16 | PNG_TRANSFORM_PACKING | PNG_TRANSFORM_EXPAND,
-        NULL
-    );
+    // Same transformations as PNG_TRANSFORM_STRIP_16 | PNG_TRANSFORM_PACKING
+    // | PNG_TRANSFORM_EXPAND for png_read_png().
+    png_set_strip_16( pngStruct );
+    png_set_packing ( pngStruct );
+    png_set_expand  ( pngStruct );
 
+    png_read_update_info( pngStruct, pngInfo );
 
-    png_uint_32   png_width = width;
+    png_uint_32   png_width;
     png_uint_32   png_height;
     int           color ;
     int           interlace ;
@@ -211,37 +443,50 @@ bool TextureLoader::loadPngImage(
     );
 
     width = png_width;
-    int height = png_height;
+    unsigned long height = png_height;
 
-    auto rowBytes = png_get_rowbytes( pngStruct, pngInfo );
+    numChannels = png_get_channels( pngStruct, pngInfo );
 
-    (*data) = (unsigned char*) malloc( rowBytes * height );
+    // Check before decoding anything.
+    if ( !checkPNG( width, height, color, interlace, depth ) ) {
 
-    auto rowPointers = png_get_rows( pngStruct, pngInfo );
+        png_destroy_read_struct( &pngStruct, &pngInfo, NULL );
+        fclose( fp );
+        return false;
+    }
 
-    for ( int i = 0; i < height; i++ ) {
+    const size_t rowBytes = png_get_rowbytes( pngStruct, pngInfo );
 
-        memcpy(
-            *data + ( rowBytes * (height - 1 - i) ),
-            rowPointers[i],
-            rowBytes
-        );
-    }
+    GLubyte* dst = allocate( width, height, rowBytes );
 
-    png_destroy_read_struct( &pngStruct, &pngInfo, NULL );
+    if ( dst == nullptr ) {
 
-    fclose( fp );
+        png_destroy_read_struct( &pngStruct, &pngInfo, NULL );
+        fclose( fp );
+        return false;
+    }
 
+    // The rows are flipped such that the first row is at the bottom
+    // as OpenGL expects.
+    for ( unsigned long i = 0; i < height; i++ ) {
 
-    auto valid = checkPNG( width, height, color, interlace, depth );
+        png_read_row( pngStruct, dst + ( rowBytes * (height - 1 - i) ), NULL );
 
-    if ( !valid ){
-        
-        free( *data );
-        *data = nullptr;
+        if ( rowDecoded && !rowDecoded( i + 1 ) ) {
+
+            png_destroy_read_struct( &pngStruct, &pngInfo, NULL );
+            fclose( fp );
+            return false;
+        }
     }
 
-    return valid;
+    png_read_end( pngStruct, NULL );
+
+    png_destroy_read_struct( &pngStruct, &pngInfo, NULL );
+
+    fclose( fp );
+
+    return true;
 }
 
 } // namespace SDFont
@@ -0,0 +1,140 @@
+#include <cstring>
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#elif defined( __ARM_NEON ) && defined( __aarch64__ )
+#include <arm_neon.h>
+#endif
+
+#include "sdfont/runtime_helper/utf8_decoder.hpp"
+
+namespace SDFont {
+
+size_t UTF8Decoder::findAsciiEnd( const unsigned char* text, const size_t len, size_t pos )
+{
+#if defined( __SSE2__ )
+
+    while ( len - pos >= 16 ) {
+
+        const __m128i v    = _mm_loadu_si128( reinterpret_cast< const __m128i* >( text + pos ) );
+        const int     mask = _mm_movemask_epi8( v );
+
+        if ( mask != 0 ) {
+
+            return pos + __builtin_ctz( mask );
+        }
+        pos += 16;
+    }
+
+#elif defined( __ARM_NEON ) && defined( __aarch64__ )
+
+    while ( len - pos >= 16 ) {
+
+        const uint8x16_t v = vld1q_u8( text + pos );
+
+        if ( vmaxvq_u8( v ) >= 0x80 ) {
+
+            break;
+        }
+        pos += 16;
+    }
+
+#else
+
+    // 8 bytes at a time.
+    while ( len - pos >= 8 ) {
+
+        uint64_t word;
+
+        memcpy( &word, text + pos, sizeof( word ) );
+
+        if ( ( word & 0x8080808080808080ULL ) != 0 ) {
+
+            break;
+        }
+        pos += 8;
+    }
+
+#endif
+
+    while ( pos < len && text[ pos ] < 0x80 ) {
+
+        pos++;
+    }
+
+    return pos;
+}
+
+
+uint32_t UTF8Decoder::decodeSequence()
+{
+    const unsigned char c = mText[ mPos ];
+
+    long          numContinuations;
+    uint32_t      code;
+
+    // The range of the first continuation byte excludes the overlong forms,
+    // the surrogates, and the code points above U+10FFFF.
+    unsigned char low  = 0x80;
+    unsigned char high = 0xBF;
+
+    if ( 0xC2 <= c && c <= 0xDF ) {
+
+        numContinuations = 1;
+        code             = c & 0x1F;
+    }
+    else if ( 0xE0 <= c && c <= 0xEF ) {
+
+        numContinuations = 2;
+        code             = c & 0x0F;
+
+        if ( c == 0xE0 ) {
+            low  = 0xA0;
+        }
+        else if ( c == 0xED ) {
+            high = 0x9F;
+        }
+    }
+    else if ( 0xF0 <= c && c <= 0xF4 ) {
+
+        numContinuations = 3;
+        code             = c & 0x07;
+
+        if ( c == 0xF0 ) {
+            low  = 0x90;
+        }
+        else if ( c == 0xF4 ) {
+            high = 0x8F;
+        }
+    }
+    else {
+
+        // A stray continuation byte, or a byte never used in UTF-8.
+        mPos++;
+        mNumInvalid++;
+        return ReplacementCharacter;
+    }
+
+    mPos++;
+
+    for ( long i = 0; i < numContinuations; i++ ) {
+
+        if ( mPos >= mLen || mText[ mPos ] < low || mText[ mPos ] > high ) {
+
+            // The valid prefix is replaced as a whole, and the decoding
+            // resumes at the offending byte.
+            mNumInvalid++;
+            return ReplacementCharacter;
+        }
+
+        code = ( code << 6 ) | ( mText[ mPos ] & 0x3F );
+        mPos++;
+
+        low  = 0x80;
+        high = 0xBF;
+    }
+
+    return code;
+}
+
+} // namespace SDFont
@@ -1,21 +1,86 @@
+#include <iostream>
+#include <cstring>
+#include <cstddef>
+#include <string>
+
 #include "sdfont/runtime_helper/vanilla_shader_manager.hpp"
 
 namespace SDFont {
 
-
-const char* VanillaShaderManager::VERTEX_STR = "#version 330 core\n\
-\n\
-in vec3 vertexLCS;\n\
-in vec3 normalLCS;\n\
-in vec2 texCoordIn;\n\
-\n\
-uniform mat4 P;\n\
-uniform mat4 M;\n\
-uniform mat4 V;\n\
-uniform vec3 lightWCS;\n\
+// The parameters of a draw in std140, same as VanillaShaderManager::DrawParams.
+#define SDFONT_DRAW_PARAMS_BLOCK "\n\
+layout(std140) uniform DrawParams {\n\
+    mat4  P;\n\
+    mat4  M;\n\
+    mat4  V;\n\
+    vec4  lightWCS;\n\
+    vec4  baseColor;\n\
+    vec4  borderColor;\n\
+    int   effect;\n\
+    int   useLight;\n\
+    float lowThreshold;\n\
+    float highThreshold;\n\
+    float smoothing;\n\
+    int   multiChannel;\n\
+    int   packedChannels;\n\
+};\n\
+"
+
+static_assert( sizeof( VanillaShaderManager::DrawParams ) == 272,                     "std140 size" );
+static_assert( offsetof( VanillaShaderManager::DrawParams, mLightWCS       ) == 192, "std140 offset" );
+static_assert( offsetof( VanillaShaderManager::DrawParams, mEffect         ) == 240, "std140 offset" );
+static_assert( offsetof( VanillaShaderManager::DrawParams, mMultiChannel   ) == 260, "std140 offset" );
+static_assert( offsetof( VanillaShaderManager::DrawParams, mPackedChannels ) == 264, "std140 offset" );
+
+const GLuint VanillaShaderManager::DrawParamsBinding = 0;
+
+static const GLuint VertexSlot   = 0;
+static const GLuint NormalSlot   = 1;
+static const GLuint TexCoordSlot = 2;
+
+// The variants define EFFECT, USE_LIGHT, MULTI_CHANNEL, and PACKED_CHANNELS in the header
+// of the sources. The conditions on them are constant, and only the
+// chosen path is compiled. Without the defines, e.g., the files under
+// shaders/, the shaders branch on the uniforms at run time.
+#define SDFONT_VARIANT_SELECTORS "\n\
+#ifdef EFFECT\n\
+  #define SELECTED_EFFECT EFFECT\n\
+#else\n\
+  #define SELECTED_EFFECT effect\n\
+#endif\n\
+\n\
+#ifdef USE_LIGHT\n\
+  #define SELECTED_USE_LIGHT ( USE_LIGHT != 0 )\n\
+#else\n\
+  #define SELECTED_USE_LIGHT ( useLight != 0 )\n\
+#endif\n\
+\n\
+#ifdef MULTI_CHANNEL\n\
+  #define SELECTED_MULTI_CHANNEL ( MULTI_CHANNEL != 0 )\n\
+#else\n\
+  #define SELECTED_MULTI_CHANNEL ( multiChannel != 0 )\n\
+#endif\n\
+\n\
+#ifdef PACKED_CHANNELS\n\
+  #define SELECTED_PACKED_CHANNELS ( PACKED_CHANNELS != 0 )\n\
+#else\n\
+  #define SELECTED_PACKED_CHANNELS ( packedChannels != 0 )\n\
+#endif\n\
+"
+
+
+const char* VanillaShaderManager::VERSION_STR = "#version 330 core\n";
+
+
+const char* VanillaShaderManager::VERTEX_STR = "\n\
+layout(location = 0) in vec3 vertexLCS;\n\
+layout(location = 1) in vec3 normalLCS;\n\
+layout(location = 2) in vec2 texCoordIn;\n\
+" SDFONT_DRAW_PARAMS_BLOCK "\
 \n\
 out vec3 vertexWCS;\n\
 out vec2 texCoordOut;\n\
+flat out int textureChannel;\n\
 out vec3 normalECS;\n\
 out vec3 vertexToEyeECS;\n\
 out vec3 vertexToLightECS;\n\
@@ -29,7 +94,11 @@ void main() {\n\
 \n\
     gl_Position      = ( MVP * vec4( vertexLCS, 1.0 ) );\n\
 \n\
-    texCoordOut      = texCoordIn;\n\
+    // The channel of the packed texture is in the integer part of\n\
+    // the texture coordinate X, offset by 2 per channel.\n\
+    textureChannel   = int( floor( ( texCoordIn.x + 0.5 ) / 2.0 ) );\n\
+\n\
+    texCoordOut      = vec2( texCoordIn.x - 2.0 * float( textureChannel ), texCoordIn.y );\n\
 \n\
     vertexWCS        = ( M   * vec4( vertexLCS, 1.0 ) ).xyz;\n\
 \n\
@@ -37,7 +106,7 @@ void main() {\n\
 \n\
     normalECS        = ( MV  * vec4( normalLCS, 0.0 ) ).xyz;\n\
 \n\
-    vec3 lightECS    = ( V   * vec4( lightWCS,  1.0 ) ).xyz;\n\
+    vec3 lightECS    = ( V   * vec4( lightWCS.xyz, 1.0 ) ).xyz;\n\
 \n\
     vertexToEyeECS   = vec3(0,0,0) - vertexECS;\n\
 \n\
@@ -47,11 +116,11 @@ void main() {\n\
 ";
 
 
-const char* VanillaShaderManager::FRAGMENT_STR = "#version 330 core\n\
-\n\
+const char* VanillaShaderManager::FRAGMENT_STR = "\n\
 precision mediump float;\n\
 \n\
 in vec2 texCoordOut;\n\
+flat in int textureChannel;\n\
 in vec3 vertexWCS;\n\
 in vec3 normalECS;\n\
 in vec3 vertexToEyeECS;\n\
@@ -60,92 +129,111 @@ in vec3 vertexToLightECS;\n\
 out vec4 color;\n\
 \n\
 uniform sampler2D fontTexture;\n\
-uniform int       effect;\n\
-uniform bool      useLight;\n\
-uniform float     lowThreshold;\n\
-uniform float     highThreshold;\n\
-uniform float     smoothing;\n\
-uniform vec3      baseColor;\n\
-uniform vec3      borderColor;\n\
+" SDFONT_DRAW_PARAMS_BLOCK SDFONT_VARIANT_SELECTORS "\
+\n\
+float median( float r, float g, float b ) {\n\
+\n\
+    return max( min( r, g ), min( max( r, g ), b ) );\n\
+}\n\
+\n\
+// The signed distance is the median of the three channels\n\
+// for the multi-channel texture, and the channel of the glyph\n\
+// for the packed texture.\n\
+float sampleDistance( vec2 uv ) {\n\
+\n\
+    if ( SELECTED_PACKED_CHANNELS ) {\n\
+\n\
+        return texture( fontTexture, uv )[ textureChannel ];\n\
+    }\n\
+\n\
+    vec3 s = texture( fontTexture, uv ).rgb;\n\
+\n\
+    if ( SELECTED_MULTI_CHANNEL ) {\n\
+\n\
+        return median( s.r, s.g, s.b );\n\
+    }\n\
+    return s.r;\n\
+}\n\
+\n\
 \n\
 void main (void) {\n\
 \n\
-    if ( effect == 0 ) {\n\
+    if ( SELECTED_EFFECT == 0 ) {\n\
 \n\
         // Raw output with interpolation.\n\
 \n\
-        color.rgb = baseColor;\n\
-        color.a   = texture( fontTexture, texCoordOut ).r;\n\
+        color.rgb = baseColor.rgb;\n\
+        color.a   = sampleDistance( texCoordOut );\n\
     }\n\
-    else if ( effect == 1 ) {\n\
+    else if ( SELECTED_EFFECT == 1 ) {\n\
 \n\
         // Softened edge.\n\
 \n\
-        color.rgb = baseColor;\n\
+        color.rgb = baseColor.rgb;\n\
         color.a   = smoothstep( lowThreshold - smoothing,\n\
                                 highThreshold + smoothing,\n\
-                                texture( fontTexture, texCoordOut ).r );\n\
+                                sampleDistance( texCoordOut ) );\n\
     }\n\
-    else if ( effect == 2 ) {\n\
+    else if ( SELECTED_EFFECT == 2 ) {\n\
 \n\
         // Sharp edge.\n\
 \n\
-        float alpha = texture(fontTexture, texCoordOut).r;\n\
+        float alpha = sampleDistance( texCoordOut );\n\
 \n\
         if ( alpha >= lowThreshold ) {\n\
 \n\
-            color.rgb = baseColor;\n\
+            color.rgb = baseColor.rgb;\n\
             color.a   = 1.0;\n\
         }\n\
         else {\n\
 \n\
-            color.rgb = baseColor;\n\
+            color.rgb = baseColor.rgb;\n\
             color.a   = 0.0;\n\
         }\n\
     }\n\
-    else if ( effect == 3 ) {\n\
+    else if ( SELECTED_EFFECT == 3 ) {\n\
 \n\
         // Sharp edge with outer glow.\n\
 \n\
-        float alpha = texture(fontTexture, texCoordOut).r;\n\
+        float alpha = sampleDistance( texCoordOut );\n\
 \n\
         if ( alpha >= lowThreshold ) {\n\
 \n\
-            color.rgb = baseColor;\n\
+            color.rgb = baseColor.rgb;\n\
             color.a   = 1.0;\n\
         }\n\
         else {\n\
 \n\
-            color.rgb = borderColor;\n\
+            color.rgb = borderColor.rgb;\n\
             color.a   = alpha;\n\
         }\n\
     }\n\
-    else if ( effect == 4 ) {\n\
+    else if ( SELECTED_EFFECT == 4 ) {\n\
 \n\
         // With border.\n\
 \n\
-        float alpha = texture(fontTexture, texCoordOut).r;\n\
+        float alpha = sampleDistance( texCoordOut );\n\
 \n\
         if ( alpha >= lowThreshold && alpha <= highThreshold ) {\n\
 \n\
-            color.rgb = borderColor;\n\
+            color.rgb = borderColor.rgb;\n\
             color.a   = 1.0;\n\
         }\n\
         else if ( alpha >= highThreshold ) {\n\
 \n\
-            color.rgb = baseColor;\n\
+            color.rgb = baseColor.rgb;\n\
             color.a   = 1.0;\n\
         }\n\
         else {\n\
 \n\
-            color.rgb = baseColor;\n\
+            color.rgb = baseColor.rgb;\n\
             color.a = 0.0;\n\
         }\n\
     }\n\
-    else if ( effect == 5 ) {\n\
+    else if ( SELECTED_EFFECT == 5 ) {\n\
         // Softened edge.\n\
-        float alpha = texture(fontTexture, texCoordOut).r;\n\
-        color.rgb = baseColor;\n\
+        float alpha = sampleDistance( texCoordOut );\n\
+        color.rgb = baseColor.rgb;\n\
 \n\
         if ( alpha < 0.5) {\n\
             color.a = smoothstep( 0.5 - smoothing,\n\
@@ -162,14 +250,14 @@ void main (void) {\n\
 \n\
         // Rect box for debugging\n\
 \n\
-        color.rgb = baseColor;\n\
+        color.rgb = baseColor.rgb;\n\
         color.a   = 1.0;\n\
 \n\
     }\n\
 \n\
-    float dist = distance( vertexToLightECS, vec3( 0.0, 0.0, 0.0 ) );\n\
+    if ( SELECTED_USE_LIGHT ) {\n\
 \n\
-    if ( useLight ) {\n\
+        float dist = distance( vertexToLightECS, vec3( 0.0, 0.0, 0.0 ) );\n\
 \n\
         color.rgb = color.rgb / sqrt(dist);\n\
     }\n\
@@ -179,59 +267,147 @@ void main (void) {\n\
 
 VanillaShaderManager::VanillaShaderManager(
     GLuint textureObjectName,
-    GLuint textureActiveNum
+    GLuint textureActiveNum,
+    bool   multiChannel,
+    bool   packedChannels
 ):
 
     ShaderManager      (),
     mTextureObjectName ( textureObjectName ),
-    mTextureUniform    ( 0                 ),
-    mTextureActiveNum  ( textureActiveNum  )
+    mTextureActiveNum  ( textureActiveNum  ),
+    mMultiChannel      ( multiChannel      ),
+    mPackedChannels    ( packedChannels    ),
+    mDrawParamsValid   ( false             ),
+    mNumVariantsLoaded ( 0                 )
 
 {
-    loadShadersFromStrings( VERTEX_STR, FRAGMENT_STR );
+    memset( &mDrawParams, 0, sizeof( mDrawParams ) );
+
+    for ( int i = 0; i < NumEffectVariants; i++ ) {
+
+        mPrograms[ i ][ 0 ] = 0;
+        mPrograms[ i ][ 1 ] = 0;
+    }
+
+    glGenVertexArrays ( 1, &mVertexArray   );
+    glGenBuffers      ( 1, &mVertexBuffer  );
+    glGenBuffers      ( 1, &mIndexBuffer   );
+    glGenBuffers      ( 1, &mUniformBuffer );
 
-    glGenVertexArrays ( 1, &mVertexArray  );
-    glGenBuffers      ( 1, &mVertexBuffer );
-    glGenBuffers      ( 1, &mIndexBuffer  );
+    glBindBuffer( GL_UNIFORM_BUFFER, mUniformBuffer );
+
+    glBufferData( GL_UNIFORM_BUFFER,
+                  sizeof( DrawParams ),
+                  nullptr,
+                  GL_DYNAMIC_DRAW       );
+
+    // The attribute layout and the index buffer are recorded in the vertex
+    // array once, instead of setting them up in every draw.
+    glBindVertexArray( mVertexArray );
+
+    glBindBuffer( GL_ARRAY_BUFFER,         mVertexBuffer );
+
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer  );
+
+    // The locations are fixed in the vertex shader, and shared by the
+    // variants.
+    enableAttribute( VertexSlot,   3, 0 );
+
+    enableAttribute( NormalSlot,   3, 3 );
+
+    enableAttribute( TexCoordSlot, 2, 6 );
+
+    glBindVertexArray( 0 );
 }
 
 
 VanillaShaderManager::~VanillaShaderManager() {
 
-    glDeleteVertexArrays ( 1, &mVertexArray  );
-    glDeleteBuffers      ( 1, &mVertexBuffer );
-    glDeleteBuffers      ( 1, &mIndexBuffer  );
+    glDeleteVertexArrays ( 1, &mVertexArray   );
+    glDeleteBuffers      ( 1, &mVertexBuffer  );
+    glDeleteBuffers      ( 1, &mIndexBuffer   );
+    glDeleteBuffers      ( 1, &mUniformBuffer );
+
+    for ( int i = 0; i < NumEffectVariants; i++ ) {
+
+        for ( int j = 0; j < 2; j++ ) {
 
+            if ( mPrograms[ i ][ j ] != 0 ) {
+
+                unloadProgram( mPrograms[ i ][ j ] );
+            }
+        }
+    }
 }
 
 
-void VanillaShaderManager::load()
+bool VanillaShaderManager::prepareVariant( const int effect, const bool useLight )
+{
+    return program( effect, useLight ) != 0;
+}
+
+
+GLuint VanillaShaderManager::program( const int effect, const bool useLight )
 {
+    // The effects other than 0 - 5 are the same rectangles.
+    const int e = ( 0 <= effect && effect < NumEffectVariants - 1 ) ? effect : NumEffectVariants - 1;
+    const int l = useLight ? 1 : 0;
+
+    if ( mPrograms[ e ][ l ] != 0 ) {
+
+        return mPrograms[ e ][ l ];
+    }
+
+    const string header =   string( VERSION_STR )
+                          + "#define EFFECT "        + to_string( e ) + "\n"
+                          + "#define USE_LIGHT "     + to_string( l ) + "\n"
+                          + "#define MULTI_CHANNEL " + ( mMultiChannel ? "1" : "0" ) + "\n"
+                          + "#define PACKED_CHANNELS " + ( mPackedChannels ? "1" : "0" ) + "\n";
+
+    GLuint           progID = 0;
+    ProgramLoadStats stats;
+
+    if ( !loadProgramFromStrings( header + VERTEX_STR, header + FRAGMENT_STR, progID, stats ) ) {
 
-    glUseProgram( mProgramID );
+        cerr << "failed to build the shader variant for effect " << effect << "\n";
+        return 0;
+    }
 
-    mTextureUniform = glGetUniformLocation ( mProgramID, "fontTexture");
-    mVertexSlot     = glGetAttribLocation  ( mProgramID, "vertexLCS"  );
-    mNormalSlot     = glGetAttribLocation  ( mProgramID, "normalLCS"  );
-    mTexCoordSlot   = glGetAttribLocation  ( mProgramID, "TexCoordIn" );
+    // The stats are accumulated over the variants.
+    mLoadStats.mFromCache      = ( mNumVariantsLoaded == 0 || mLoadStats.mFromCache ) && stats.mFromCache;
+    mLoadStats.mStoredToCache  = mLoadStats.mStoredToCache || stats.mStoredToCache;
+    mLoadStats.mSeconds       += stats.mSeconds;
+    mNumVariantsLoaded++;
 
-    glActiveTexture ( GL_TEXTURE0 + mTextureActiveNum     );
+    const GLuint blockIndex = glGetUniformBlockIndex( progID, "DrawParams" );
 
-    glBindTexture   ( GL_TEXTURE_2D,   mTextureObjectName );
+    glUniformBlockBinding( progID, blockIndex, DrawParamsBinding );
 
-    glUniform1i     ( mTextureUniform, mTextureActiveNum  );
+    // The sampler is set once per program. It goes around the state cache,
+    // which is invalidated for the next load().
+    glUseProgram( progID );
 
-    mUniformEffect        = glGetUniformLocation( mProgramID, "effect"       );
-    mUniformUseLight      = glGetUniformLocation( mProgramID, "useLight"     );
-    mUniformLowThreshold  = glGetUniformLocation( mProgramID, "lowThreshold" );
-    mUniformHighThreshold = glGetUniformLocation( mProgramID, "highThreshold");
-    mUniformSmoothing     = glGetUniformLocation( mProgramID, "smoothing"    );
-    mUniformBaseColor     = glGetUniformLocation( mProgramID, "baseColor"    );
-    mUniformBorderColor   = glGetUniformLocation( mProgramID, "borderColor"  );
-    mUniformP             = glGetUniformLocation( mProgramID, "P"            );
-    mUniformM             = glGetUniformLocation( mProgramID, "M"            );
-    mUniformV             = glGetUniformLocation( mProgramID, "V"            );
-    mUniformLightWCS      = glGetUniformLocation( mProgramID, "lightWCS"     );
+    glUniform1i( glGetUniformLocation( progID, "fontTexture" ), mTextureActiveNum );
+
+    mStateCache.invalidate();
+
+    mPrograms[ e ][ l ] = progID;
+
+    return progID;
+}
+
+
+void VanillaShaderManager::load()
+{
+    // The application may have changed the state since the last frame.
+    // The program is chosen by draw().
+    mStateCache.invalidate();
+
+    mStateCache.activeTexture  ( GL_TEXTURE0 + mTextureActiveNum );
+
+    mStateCache.bindTexture2D  ( mTextureObjectName );
+
+    mStateCache.bindBufferBase ( GL_UNIFORM_BUFFER, DrawParamsBinding, mUniformBuffer );
 }
 
 
@@ -254,83 +430,116 @@ void VanillaShaderManager::draw(
     glm::vec3& lightWCS
 
 ) {
+    DrawParams params;
 
-    glUniform1i        ( mUniformEffect,        effect                );
-    glUniform1i        ( mUniformUseLight,      useLight              );
-    glUniform1f        ( mUniformLowThreshold,  lowThreshold          );
-    glUniform1f        ( mUniformHighThreshold, highThreshold         );
-    glUniform1f        ( mUniformSmoothing,     smoothing             );
-    glUniform3fv       ( mUniformBaseColor,     1, &baseColor[0]      );
-    glUniform3fv       ( mUniformBorderColor,   1, &borderColor[0]    );
-    glUniformMatrix4fv ( mUniformP,             1, GL_FALSE, &P[0][0] );
-    glUniformMatrix4fv ( mUniformM,             1, GL_FALSE, &M[0][0] );
-    glUniformMatrix4fv ( mUniformV,             1, GL_FALSE, &V[0][0] );
-    glUniform3fv       ( mUniformLightWCS,      1, &lightWCS[0]       );
+    memset( &params, 0, sizeof( params ) );
 
-    glBindBuffer( GL_ARRAY_BUFFER, mVertexBuffer );
+    memcpy( params.mP,           &P[0][0],           sizeof( float ) * 16 );
+    memcpy( params.mM,           &M[0][0],           sizeof( float ) * 16 );
+    memcpy( params.mV,           &V[0][0],           sizeof( float ) * 16 );
+    memcpy( params.mLightWCS,    &lightWCS[0],       sizeof( float ) *  3 );
+    memcpy( params.mBaseColor,   &baseColor[0],      sizeof( float ) *  3 );
+    memcpy( params.mBorderColor, &borderColor[0],    sizeof( float ) *  3 );
 
-    glBindVertexArray( mVertexArray );
+    params.mEffect         = effect;
+    params.mUseLight       = useLight ? 1 : 0;
+    params.mLowThreshold   = lowThreshold;
+    params.mHighThreshold  = highThreshold;
+    params.mSmoothing      = smoothing;
+    params.mMultiChannel   = mMultiChannel ? 1 : 0;
+    params.mPackedChannels = mPackedChannels ? 1 : 0;
+
+    const GLuint progID = program( effect, useLight );
+
+    if ( progID == 0 ) {
+
+        return;
+    }
+
+    mProgramID = progID;
+
+    mStateCache.useProgram( progID );
 
+    updateDrawParams( params );
+
+    mStateCache.bindVertexArray( mVertexArray );
+
+    mStateCache.bindBuffer( GL_ARRAY_BUFFER, mVertexBuffer );
+
+    // The index buffer is bound in the vertex array.
     glBufferData( GL_ARRAY_BUFFER,
                   sizeof(float) * attrLen,
                   attributes,
-                  GL_STATIC_DRAW        );
-
-    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer );
+                  GL_STREAM_DRAW        );
 
     glBufferData( GL_ELEMENT_ARRAY_BUFFER,
                   sizeof(GLuint) * indLen,
                   indices,
-                  GL_STATIC_DRAW        );
+                  GL_STREAM_DRAW        );
+
+    mStateCache.count( 2 );
 
-    glEnable     ( GL_BLEND );
+    mStateCache.enableBlend ( true  );
 
-    glDepthMask  ( GL_FALSE );
+    mStateCache.depthMask   ( false );
 
-    glBlendFunc  ( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+    mStateCache.blendFunc   ( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
 
-    mVertexSlot     = glGetAttribLocation  ( mProgramID, "vertexLCS"  );
+    glDrawElements( GL_TRIANGLES, indLen, GL_UNSIGNED_INT, (GLvoid*)0 );
 
-    mNormalSlot     = glGetAttribLocation  ( mProgramID, "normalLCS"  );
+    mStateCache.count();
+}
 
-    mTexCoordSlot   = glGetAttribLocation  ( mProgramID, "texCoordIn" );
 
-    glEnableVertexAttribArray( mVertexSlot );
+void VanillaShaderManager::updateDrawParams( const DrawParams& params )
+{
+    const uint8_t* newBytes = reinterpret_cast< const uint8_t* >( &params      );
+    const uint8_t* oldBytes = reinterpret_cast< const uint8_t* >( &mDrawParams );
 
-    glEnableVertexAttribArray( mNormalSlot );
+    long begin = 0;
+    long end   = sizeof( DrawParams );
 
-    glEnableVertexAttribArray( mTexCoordSlot );
+    if ( mDrawParamsValid ) {
 
-    glVertexAttribPointer( mVertexSlot,
-                           3,
-                           GL_FLOAT,
-                           GL_FALSE,
-                           sizeof(float) * 8,
-                           0                 );
+        // Only the changed range is uploaded, typically M or the colors.
+        while ( begin < end && newBytes[ begin ]   == oldBytes[ begin ]   ) {
+            begin++;
+        }
+        while ( end > begin && newBytes[ end - 1 ] == oldBytes[ end - 1 ] ) {
+            end--;
+        }
+        if ( begin == end ) {
+            return;
+        }
+    }
 
-    glVertexAttribPointer( mNormalSlot,
-                           3,
-                           GL_FLOAT,
-                           GL_FALSE,
-                           sizeof(float) * 8,
-                           (GLvoid*) (sizeof(float) * 3) );
+    mDrawParams      = params;
+    mDrawParamsValid = true;
 
-    glVertexAttribPointer( mTexCoordSlot,
-                           2,
-                           GL_FLOAT,
-                           GL_FALSE,
-                           sizeof(float) * 8,
-                           (GLvoid*) (sizeof(float) * 6) );
+    mStateCache.bindBuffer( GL_UNIFORM_BUFFER, mUniformBuffer );
+
+    glBufferSubData( GL_UNIFORM_BUFFER, begin, end - begin, newBytes + begin );
+
+    mStateCache.count();
+}
 
-    glDrawElements( GL_TRIANGLES, indLen, GL_UNSIGNED_INT, (GLvoid*)0 );
 
-    glDisableVertexAttribArray( mVertexSlot   );
-    glDisableVertexAttribArray( mNormalSlot   );
-    glDisableVertexAttribArray( mTexCoordSlot );
+void VanillaShaderManager::enableAttribute(
+    const GLuint slot,
+    const GLint  size,
+    const long   offset
+) {
+    glEnableVertexAttribArray( slot );
 
+    glVertexAttribPointer( slot,
+                           size,
+                           GL_FLOAT,
+                           GL_FALSE,
+                           sizeof(float) * 8,
+                           (GLvoid*) (sizeof(float) * offset) );
 }
 
+
 void VanillaShaderManager::unload() { }
 
 } // namespace SDFont
-
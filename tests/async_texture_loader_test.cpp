@@ -0,0 +1,342 @@
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include <png.h>
+
+#include "sdfont/runtime_helper/async_texture_loader.hpp"
+#include "recording_texture_upload_backend.hpp"
+
+using namespace std;
+using namespace SDFont;
+
+/** @brief headless tests of AsyncTextureLoader with
+ *         RecordingTextureUploadBackend in place of GL.
+ *
+ *         Usage: sdfont_async_texture_loader_test [temporary directory]
+ */
+
+static long numFailures = 0;
+
+#define CHECK( cond ) check( ( cond ), #cond, __LINE__ )
+
+static void check( const bool ok, const char* expr, const int line )
+{
+    if ( !ok ) {
+
+        cerr << "FAILED line " << line << ": " << expr << "\n";
+        numFailures++;
+    }
+}
+
+
+/** @brief writes a gray PNG with a distinct value per row and column. */
+static bool writePng( const string& filePath, const long width, vector< unsigned char >& rows )
+{
+    rows.resize( width * width );
+
+    for ( long y = 0; y < width; y++ ) {
+        for ( long x = 0; x < width; x++ ) {
+            rows[ y * width + x ] = (unsigned char)( ( y * 7 + x * 3 ) & 0xFF );
+        }
+    }
+
+    FILE* fp = fopen( filePath.c_str(), "wb" );
+
+    if ( fp == nullptr ) {
+        return false;
+    }
+
+    png_structp png  = png_create_write_struct( PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr );
+    png_infop   info = png_create_info_struct( png );
+
+    if ( setjmp( png_jmpbuf( png ) ) ) {
+
+        png_destroy_write_struct( &png, &info );
+        fclose( fp );
+        return false;
+    }
+
+    png_init_io( png, fp );
+    png_set_IHDR( png, info, width, width, 8, PNG_COLOR_TYPE_GRAY, PNG_INTERLACE_NONE,
+                  PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT );
+    png_write_info( png, info );
+
+    for ( long y = 0; y < width; y++ ) {
+        png_write_row( png, &( rows[ y * width ] ) );
+    }
+
+    png_write_end( png, nullptr );
+    png_destroy_write_struct( &png, &info );
+    fclose( fp );
+
+    return true;
+}
+
+
+/** @brief calls update() until the loader is ready or has failed. */
+static bool runToCompletion( AsyncTextureLoader& loader )
+{
+    for ( long i = 0; i < 100000; i++ ) {
+
+        if ( loader.update( chrono::microseconds( 100 ) ) ) {
+            return true;
+        }
+        if ( loader.hasFailed() ) {
+            return false;
+        }
+        this_thread::sleep_for( chrono::microseconds( 50 ) );
+    }
+    return false;
+}
+
+
+/** @brief the texture has the rows of the image with the first row at the bottom. */
+static bool matchesImage( const vector< unsigned char >& texture, const vector< unsigned char >& rows, const long width )
+{
+    for ( long y = 0; y < width; y++ ) {
+        for ( long x = 0; x < width; x++ ) {
+
+            if ( texture[ y * width + x ] != rows[ ( width - 1 - y ) * width + x ] ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/** @brief every row is uploaded once, from the top of the image down. */
+static bool coversAllRowsOnce( const vector< RecordingTextureUploadBackend::Upload >& uploads, const long width )
+{
+    long nextTop = width;
+
+    for ( const auto& u : uploads ) {
+
+        if ( u.mYOffset + u.mNumRows != nextTop || u.mNumRows <= 0 ) {
+            return false;
+        }
+        nextTop = u.mYOffset;
+    }
+    return nextTop == 0;
+}
+
+
+static void testUploadThroughRing( const string& filePath, const vector< unsigned char >& rows, const long width )
+{
+    RecordingTextureUploadBackend backend;
+
+    // Every fence is signaled on the third poll, so the ring wraps around
+    // while the GPU is still reading, and update() has to skip frames.
+    backend.mNumPollsPerFence = 2;
+
+    {
+        AsyncTextureLoader loader( filePath, &backend, 3, width * 5 );
+
+        auto future = loader.readyFuture();
+
+        CHECK( runToCompletion( loader ) );
+        CHECK( loader.isReady() );
+        CHECK( !loader.hasFailed() );
+        CHECK( future.get() );
+        CHECK( loader.size() == width );
+        CHECK( loader.numChannels() == 1 );
+
+        const auto* texture = backend.texture( loader.GLtexture() );
+
+        CHECK( texture != nullptr );
+        CHECK( texture != nullptr && matchesImage( *texture, rows, width ) );
+        CHECK( coversAllRowsOnce( backend.mUploads, width ) );
+
+        // 5 rows per chunk, through the 3 buffers in turn.
+        CHECK( backend.mUploads.size() == (size_t)( ( width + 4 ) / 5 ) );
+        CHECK( backend.mUploads.size() < 2 || backend.mUploads[0].mBuffer != backend.mUploads[1].mBuffer );
+        CHECK( backend.mUploads.size() < 4 || backend.mUploads[0].mBuffer == backend.mUploads[3].mBuffer );
+        CHECK( backend.mNumFencesInserted == (long)backend.mUploads.size() );
+        CHECK( backend.mNumFencePolls > 0 );
+        CHECK( backend.mNumTexturesFinished == 1 );
+
+        // The buffers and the fences are released as soon as it is ready.
+        CHECK( backend.numLiveBuffers() == 0 );
+        CHECK( backend.numLiveFences()  == 0 );
+        CHECK( backend.numLiveTextures() == 1 );
+    }
+
+    // The texture belongs to the caller once it is ready.
+    CHECK( backend.numLiveTextures() == 1 );
+    CHECK( backend.mNumTexturesDeleted == 0 );
+    CHECK( backend.mNumViolations == 0 );
+}
+
+
+static void testStalledFences( const string& filePath, const long width )
+{
+    RecordingTextureUploadBackend backend;
+
+    backend.mNumPollsPerFence = 1000000;
+
+    AsyncTextureLoader loader( filePath, &backend, 2, width );
+
+    // Only one chunk per buffer can be uploaded while the fences are pending.
+    for ( long i = 0; i < 200; i++ ) {
+
+        loader.update( chrono::microseconds( 1000 ) );
+        this_thread::sleep_for( chrono::microseconds( 100 ) );
+    }
+
+    CHECK( !loader.isReady() );
+    CHECK( !loader.hasFailed() );
+    CHECK( backend.mUploads.size() == 2 );
+    CHECK( backend.mNumViolations == 0 );
+}
+
+
+static void testMapAndUnmapFailures( const string& filePath, const vector< unsigned char >& rows, const long width )
+{
+    RecordingTextureUploadBackend backend;
+
+    backend.mNumMapFailures   = 3;
+    backend.mNumUnmapFailures = 2;
+
+    AsyncTextureLoader loader( filePath, &backend, 2, width * 8 );
+
+    CHECK( runToCompletion( loader ) );
+
+    const auto* texture = backend.texture( loader.GLtexture() );
+
+    // The rows lost by the failed unmaps are uploaded again.
+    CHECK( texture != nullptr && matchesImage( *texture, rows, width ) );
+    CHECK( coversAllRowsOnce( backend.mUploads, width ) );
+    CHECK( backend.mNumMapFailures   == 0 );
+    CHECK( backend.mNumUnmapFailures == 0 );
+    CHECK( backend.mNumViolations == 0 );
+}
+
+
+static void testMissingFile( const string& directory )
+{
+    RecordingTextureUploadBackend backend;
+
+    {
+        AsyncTextureLoader loader( directory + "/does_not_exist.png", &backend );
+
+        auto future = loader.readyFuture();
+
+        CHECK( !runToCompletion( loader ) );
+        CHECK( loader.hasFailed() );
+        CHECK( !future.get() );
+        CHECK( loader.GLtexture() == 0 );
+    }
+
+    CHECK( backend.mNumTexturesCreated == 0 );
+    CHECK( backend.numLiveBuffers() == 0 );
+    CHECK( backend.mNumViolations == 0 );
+}
+
+
+static void testCreateTextureFailure( const string& filePath )
+{
+    RecordingTextureUploadBackend backend;
+
+    backend.mFailCreateTexture = true;
+
+    {
+        AsyncTextureLoader loader( filePath, &backend );
+
+        auto future = loader.readyFuture();
+
+        CHECK( !runToCompletion( loader ) );
+        CHECK( loader.hasFailed() );
+        CHECK( !future.get() );
+    }
+
+    CHECK( backend.mNumTexturesCreated == 1 );
+    CHECK( backend.mUploads.empty() );
+    CHECK( backend.numLiveBuffers() == 0 );
+    CHECK( backend.mNumViolations == 0 );
+}
+
+
+static void testDestroyedDuringUpload( const string& filePath, const long width )
+{
+    RecordingTextureUploadBackend backend;
+
+    backend.mNumPollsPerFence = 1000000;
+
+    shared_future< bool > future;
+
+    {
+        AsyncTextureLoader loader( filePath, &backend, 1, width );
+
+        future = loader.readyFuture();
+
+        for ( long i = 0; i < 100000 && backend.mUploads.empty(); i++ ) {
+
+            loader.update( chrono::microseconds( 100 ) );
+            this_thread::sleep_for( chrono::microseconds( 50 ) );
+        }
+
+        CHECK( backend.mNumTexturesCreated == 1 );
+        CHECK( !loader.isReady() );
+    }
+
+    // Nothing is leaked by the aborted upload.
+    CHECK( !future.get() );
+    CHECK( backend.mNumTexturesDeleted == 1 );
+    CHECK( backend.numLiveTextures() == 0 );
+    CHECK( backend.numLiveBuffers()  == 0 );
+    CHECK( backend.numLiveFences()   == 0 );
+    CHECK( backend.mNumViolations == 0 );
+}
+
+
+static void testDestroyedDuringDecode( const string& filePath )
+{
+    RecordingTextureUploadBackend backend;
+
+    {
+        AsyncTextureLoader loader( filePath, &backend );
+    }
+
+    CHECK( backend.numLiveTextures() == 0 );
+    CHECK( backend.numLiveBuffers()  == 0 );
+    CHECK( backend.mNumViolations == 0 );
+}
+
+
+int main( int argc, char* argv[] )
+{
+    const string directory = ( argc > 1 ) ? argv[1] : ".";
+    const string filePath  = directory + "/sdfont_async_texture_loader_test.png";
+    const long   width     = 256;
+
+    vector< unsigned char > rows;
+
+    if ( !writePng( filePath, width, rows ) ) {
+
+        cerr << "Can not write [" << filePath << "]\n";
+        return 1;
+    }
+
+    testUploadThroughRing     ( filePath, rows, width );
+    testStalledFences         ( filePath, width );
+    testMapAndUnmapFailures   ( filePath, rows, width );
+    testMissingFile           ( directory );
+    testCreateTextureFailure  ( filePath );
+    testDestroyedDuringUpload ( filePath, width );
+    testDestroyedDuringDecode ( filePath );
+
+    remove( filePath.c_str() );
+
+    if ( numFailures > 0 ) {
+
+        cerr << numFailures << " check(s) failed.\n";
+        return 1;
+    }
+
+    cerr << "All checks passed.\n";
+    return 0;
+}
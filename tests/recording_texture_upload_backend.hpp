@@ -0,0 +1,291 @@
+#ifndef __SDFONT_RECORDING_TEXTURE_UPLOAD_BACKEND_HPP__
+#define __SDFONT_RECORDING_TEXTURE_UPLOAD_BACKEND_HPP__
+
+#include <map>
+#include <vector>
+#include <cstring>
+
+#include "sdfont/runtime_helper/async_texture_loader.hpp"
+
+using namespace std;
+
+namespace SDFont {
+
+/** @brief TextureUploadBackend without GL for the tests.
+ *
+ *         The textures and the pixel buffers are byte arrays, and
+ *         uploadRows() copies the rows from the buffer to the texture, so
+ *         the uploaded texture can be compared with the image. Every call
+ *         is counted, and the misuses are counted in mNumViolations:
+ *
+ *         - a pixel buffer mapped or deleted while the fence of its last
+ *           upload has not been deleted,
+ *         - a fence polled or deleted after it has been deleted,
+ *         - an unknown texture, buffer, or fence.
+ *
+ *         The failures can be injected with the counters below.
+ */
+class RecordingTextureUploadBackend : public TextureUploadBackend {
+
+  public:
+
+    struct Upload {
+
+        GLuint mTexture;
+        GLuint mBuffer;
+        long   mYOffset;
+        long   mNumRows;
+    };
+
+    RecordingTextureUploadBackend():
+        mFailCreateTexture    ( false ),
+        mNumMapFailures       ( 0 ),
+        mNumUnmapFailures     ( 0 ),
+        mNumPollsPerFence     ( 0 ),
+        mNumViolations        ( 0 ),
+        mNumTexturesCreated   ( 0 ),
+        mNumTexturesDeleted   ( 0 ),
+        mNumTexturesFinished  ( 0 ),
+        mNumFencesInserted    ( 0 ),
+        mNumFencePolls        ( 0 ),
+        mNextName             ( 1 ),
+        mNextFence            ( 1 ),
+        mLastUploadBuffer     ( 0 )
+        {;}
+
+    virtual ~RecordingTextureUploadBackend() {;}
+
+    GLuint createTexture( long width, int numChannels ) override
+    {
+        mNumTexturesCreated++;
+
+        if ( mFailCreateTexture ) {
+            return 0;
+        }
+
+        const GLuint texture = mNextName++;
+
+        mTextures[ texture ] = Texture{ width, numChannels, vector< unsigned char >( width * width * numChannels, 0 ) };
+
+        return texture;
+    }
+
+    void finishTexture( GLuint texture ) override
+    {
+        mNumTexturesFinished++;
+
+        if ( mTextures.find( texture ) == mTextures.end() ) {
+            mNumViolations++;
+        }
+    }
+
+    void deleteTexture( GLuint texture ) override
+    {
+        mNumTexturesDeleted++;
+
+        if ( mTextures.erase( texture ) == 0 ) {
+            mNumViolations++;
+        }
+    }
+
+    GLuint createPixelBuffer( size_t size ) override
+    {
+        const GLuint buffer = mNextName++;
+
+        mBuffers[ buffer ] = Buffer{ vector< unsigned char >( size, 0 ), 0, false };
+
+        return buffer;
+    }
+
+    void deletePixelBuffer( GLuint buffer ) override
+    {
+        const auto it = mBuffers.find( buffer );
+
+        if ( it == mBuffers.end() || it->second.mFence != 0 || it->second.mMapped ) {
+            mNumViolations++;
+        }
+        if ( it != mBuffers.end() ) {
+            mBuffers.erase( it );
+        }
+    }
+
+    void* mapPixelBuffer( GLuint buffer, size_t size ) override
+    {
+        const auto it = mBuffers.find( buffer );
+
+        if ( it == mBuffers.end() || size > it->second.mData.size() ) {
+            mNumViolations++;
+            return nullptr;
+        }
+
+        // The GPU may still be reading the buffer.
+        if ( it->second.mFence != 0 ) {
+            mNumViolations++;
+        }
+
+        if ( mNumMapFailures > 0 ) {
+            mNumMapFailures--;
+            return nullptr;
+        }
+
+        it->second.mMapped = true;
+
+        return it->second.mData.data();
+    }
+
+    bool unmapPixelBuffer( GLuint buffer ) override
+    {
+        const auto it = mBuffers.find( buffer );
+
+        if ( it == mBuffers.end() || !it->second.mMapped ) {
+            mNumViolations++;
+            return false;
+        }
+
+        it->second.mMapped = false;
+
+        if ( mNumUnmapFailures > 0 ) {
+
+            // The contents are lost as in GL.
+            mNumUnmapFailures--;
+            fill( it->second.mData.begin(), it->second.mData.end(), 0 );
+            return false;
+        }
+        return true;
+    }
+
+    void uploadRows(
+        GLuint texture,
+        GLuint buffer,
+        long   yOffset,
+        long   width,
+        long   numRows,
+        int    numChannels
+    ) override {
+
+        mUploads.push_back( Upload{ texture, buffer, yOffset, numRows } );
+
+        const auto tit = mTextures.find( texture );
+        const auto bit = mBuffers.find( buffer );
+
+        if (    tit == mTextures.end() || bit == mBuffers.end() || bit->second.mMapped
+             || width != tit->second.mWidth || numChannels != tit->second.mNumChannels
+             || yOffset < 0 || yOffset + numRows > width ) {
+            mNumViolations++;
+            return;
+        }
+
+        const size_t rowBytes = width * numChannels;
+
+        memcpy( tit->second.mData.data() + yOffset * rowBytes, bit->second.mData.data(), numRows * rowBytes );
+
+        mLastUploadBuffer = buffer;
+    }
+
+    GLsync insertFence() override
+    {
+        mNumFencesInserted++;
+
+        const uintptr_t fence = mNextFence++;
+
+        mFences[ fence ] = mNumPollsPerFence;
+
+        const auto bit = mBuffers.find( mLastUploadBuffer );
+
+        if ( bit != mBuffers.end() ) {
+            bit->second.mFence = fence;
+        }
+
+        return reinterpret_cast< GLsync >( fence );
+    }
+
+    bool isFenceSignaled( GLsync fence ) override
+    {
+        mNumFencePolls++;
+
+        const auto it = mFences.find( reinterpret_cast< uintptr_t >( fence ) );
+
+        if ( it == mFences.end() ) {
+            mNumViolations++;
+            return true;
+        }
+
+        if ( it->second > 0 ) {
+            it->second--;
+            return false;
+        }
+        return true;
+    }
+
+    void deleteFence( GLsync fence ) override
+    {
+        const auto key = reinterpret_cast< uintptr_t >( fence );
+
+        if ( mFences.erase( key ) == 0 ) {
+            mNumViolations++;
+        }
+
+        for ( auto& pair : mBuffers ) {
+
+            if ( pair.second.mFence == key ) {
+                pair.second.mFence = 0;
+            }
+        }
+    }
+
+    /** @return the contents of the texture, or nullptr if it does not exist. */
+    const vector< unsigned char >* texture( GLuint texture ) const
+    {
+        const auto it = mTextures.find( texture );
+
+        return ( it != mTextures.end() ) ? &( it->second.mData ) : nullptr;
+    }
+
+    size_t numLiveTextures() const { return mTextures.size(); }
+    size_t numLiveBuffers()  const { return mBuffers.size();  }
+    size_t numLiveFences()   const { return mFences.size();   }
+
+    // Injected failures.
+    bool              mFailCreateTexture;
+    long              mNumMapFailures;
+    long              mNumUnmapFailures;
+
+    /** @brief a fence is signaled after this number of polls. */
+    long              mNumPollsPerFence;
+
+    // Recorded calls.
+    long              mNumViolations;
+    long              mNumTexturesCreated;
+    long              mNumTexturesDeleted;
+    long              mNumTexturesFinished;
+    long              mNumFencesInserted;
+    long              mNumFencePolls;
+    vector< Upload >  mUploads;
+
+  private:
+
+    struct Texture {
+
+        long                    mWidth;
+        int                     mNumChannels;
+        vector< unsigned char > mData;
+    };
+
+    struct Buffer {
+
+        vector< unsigned char > mData;
+        uintptr_t               mFence;
+        bool                    mMapped;
+    };
+
+    GLuint                       mNextName;
+    uintptr_t                    mNextFence;
+    GLuint                       mLastUploadBuffer;
+    map< GLuint, Texture >       mTextures;
+    map< GLuint, Buffer >        mBuffers;
+    map< uintptr_t, long >       mFences;
+};
+
+} // namespace SDFont
+
+#endif /*__SDFONT_RECORDING_TEXTURE_UPLOAD_BACKEND_HPP__*/